@@ -0,0 +1,186 @@
+#include <benchmark/benchmark.h>
+
+#include "biorbd.h"
+
+using namespace BIORBD_NAMESPACE;
+
+// The second argument of the benchmarks chooses the path: the type-sorted tables of the models (0)
+// or a loop that casts every element to its type, as the models used to do (1)
+static void applyModelsAndPaths(
+    benchmark::internal::Benchmark* bench,
+    const std::vector<std::string>& models)
+{
+    for (size_t i=0; i<models.size(); ++i) {
+        bench->Args({static_cast<int64_t>(i), 0});
+        bench->Args({static_cast<int64_t>(i), 1});
+    }
+}
+
+static void setCounters(
+    benchmark::State& state,
+    const Model& model,
+    const std::string& path)
+{
+    state.SetLabel(path);
+    state.counters["nbDof"] = static_cast<double>(model.nbDof());
+}
+
+#ifdef MODULE_ACTUATORS
+static std::vector<std::string> actuatorModels({
+    "models/pyomecaman_withActuators.bioMod",
+    "models/withAllActuatorsTypes.bioMod"
+});
+
+static void allActuatorModelsAndPaths(benchmark::internal::Benchmark* bench)
+{
+    applyModelsAndPaths(bench, actuatorModels);
+}
+
+static utils::Scalar perElementTorqueMax(
+    const std::shared_ptr<internal_forces::actuator::Actuator>& actuator,
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& Qdot)
+{
+    using namespace internal_forces::actuator;
+    if (std::dynamic_pointer_cast<ActuatorGauss3p>(actuator)) {
+        return std::static_pointer_cast<ActuatorGauss3p>(actuator)->torqueMax(Q, Qdot);
+    } else if (std::dynamic_pointer_cast<ActuatorConstant>(actuator)) {
+        return std::static_pointer_cast<ActuatorConstant>(actuator)->torqueMax();
+    } else if (std::dynamic_pointer_cast<ActuatorLinear>(actuator)) {
+        return std::static_pointer_cast<ActuatorLinear>(actuator)->torqueMax(Q);
+    } else if (std::dynamic_pointer_cast<ActuatorGauss6p>(actuator)) {
+        return std::static_pointer_cast<ActuatorGauss6p>(actuator)->torqueMax(Q, Qdot);
+    } else {
+        return std::static_pointer_cast<ActuatorSigmoidGauss3p>(actuator)->torqueMax(Q, Qdot);
+    }
+}
+
+static void BM_ActuatorsJointTorque(benchmark::State& state)
+{
+    const std::string& path(actuatorModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    utils::Vector activation(static_cast<unsigned int>(model.nbDof()));
+    Q.setOnes();
+    QDot.setOnes();
+    activation.setConstant(0.5);
+    if (state.range(1) == 0) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.torque(activation, Q, QDot));
+        }
+    } else {
+        for (auto _ : state) {
+            // The velocity is resigned for the eccentric actuators, the activation being positive here it is not
+            rigidbody::GeneralizedTorque tau(model);
+            for (unsigned int i=0; i<model.nbDof(); ++i) {
+                const std::pair<std::shared_ptr<internal_forces::actuator::Actuator>, std::shared_ptr<internal_forces::actuator::Actuator>>&
+                        actuator(model.actuator(i));
+                tau[i] = activation[i] * perElementTorqueMax(
+                             activation[i] >= 0 ? actuator.first : actuator.second, Q, QDot);
+            }
+            benchmark::DoNotOptimize(tau);
+        }
+    }
+    setCounters(state, model, path);
+    state.counters["nbActuators"] = static_cast<double>(model.nbActuators());
+}
+BENCHMARK(BM_ActuatorsJointTorque)->Apply(allActuatorModelsAndPaths);
+#endif
+
+#ifdef MODULE_PASSIVE_TORQUES
+static std::vector<std::string> passiveTorqueModels({
+    "models/arm26_WithOnePassiveTorques.bioMod",
+    "models/arm26_WithPassiveTorques.bioMod"
+});
+
+static void allPassiveTorqueModelsAndPaths(benchmark::internal::Benchmark* bench)
+{
+    applyModelsAndPaths(bench, passiveTorqueModels);
+}
+
+static utils::Scalar perElementPassiveTorque(
+    const std::shared_ptr<internal_forces::passive_torques::PassiveTorque>& passiveTorque,
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& Qdot)
+{
+    using namespace internal_forces::passive_torques;
+    if (std::dynamic_pointer_cast<PassiveTorqueConstant>(passiveTorque)) {
+        return std::static_pointer_cast<PassiveTorqueConstant>(passiveTorque)->passiveTorque();
+    } else if (std::dynamic_pointer_cast<PassiveTorqueLinear>(passiveTorque)) {
+        return std::static_pointer_cast<PassiveTorqueLinear>(passiveTorque)->passiveTorque(Q);
+    } else {
+        return std::static_pointer_cast<PassiveTorqueExponential>(passiveTorque)->passiveTorque(Q, Qdot);
+    }
+}
+
+static void BM_PassiveJointTorque(benchmark::State& state)
+{
+    const std::string& path(passiveTorqueModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    if (state.range(1) == 0) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.passiveJointTorque(Q, QDot));
+        }
+    } else {
+        for (auto _ : state) {
+            rigidbody::GeneralizedTorque tau(model);
+            tau.setZero();
+            // The passive torques are stored by DoF, the DoFs without one are left empty
+            for (unsigned int i=0; i<model.nbDof() && i<model.nbPassiveTorques(); ++i) {
+                const std::shared_ptr<internal_forces::passive_torques::PassiveTorque>& passiveTorque(
+                    model.getPassiveTorque(i));
+                if (passiveTorque) {
+                    tau[i] = perElementPassiveTorque(passiveTorque, Q, QDot);
+                }
+            }
+            benchmark::DoNotOptimize(tau);
+        }
+    }
+    setCounters(state, model, path);
+    state.counters["nbPassiveTorques"] = static_cast<double>(model.nbPassiveTorques());
+}
+BENCHMARK(BM_PassiveJointTorque)->Apply(allPassiveTorqueModelsAndPaths);
+#endif
+
+#ifdef MODULE_LIGAMENTS
+static std::vector<std::string> ligamentModels({
+    "models/arm26_WithLigaments.bioMod"
+});
+
+static void allLigamentModelsAndPaths(benchmark::internal::Benchmark* bench)
+{
+    applyModelsAndPaths(bench, ligamentModels);
+}
+
+static void BM_LigamentsJointTorque(benchmark::State& state)
+{
+    const std::string& path(ligamentModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    if (state.range(1) == 0) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.ligamentsJointTorque(Q, QDot));
+        }
+    } else {
+        for (auto _ : state) {
+            // Each ligament updates the kinematics of the whole model before computing its force
+            utils::Vector forces(static_cast<unsigned int>(model.nbLigaments()));
+            for (size_t i=0; i<model.nbLigaments(); ++i) {
+                forces[static_cast<unsigned int>(i)] = model.ligament(i).force(model, Q, QDot);
+            }
+            benchmark::DoNotOptimize(model.ligamentsJointTorque(forces));
+        }
+    }
+    setCounters(state, model, path);
+    state.counters["nbLigaments"] = static_cast<double>(model.nbLigaments());
+}
+BENCHMARK(BM_LigamentsJointTorque)->Apply(allLigamentModelsAndPaths);
+#endif
@@ -0,0 +1,226 @@
+#include <benchmark/benchmark.h>
+
+#include "biorbd.h"
+#ifdef MODULE_STATIC_OPTIM
+#include "InternalForces/Muscles/StaticOptimization.h"
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+// Models of the same skeleton with different muscle types
+static std::vector<std::string> muscleModels({
+    "models/arm26.bioMod",
+    "models/arm26_degroote.bioMod",
+    "models/arm26_buchanan.bioMod"
+});
+
+static void allMuscleModels(benchmark::internal::Benchmark* bench)
+{
+    for (size_t i=0; i<muscleModels.size(); ++i) {
+        bench->Arg(static_cast<int64_t>(i));
+    }
+}
+
+static void setCounters(
+    benchmark::State& state,
+    const Model& model,
+    const std::string& path)
+{
+    state.SetLabel(path);
+    state.counters["nbDof"] = static_cast<double>(model.nbDof());
+    state.counters["nbMuscles"] = static_cast<double>(model.nbMuscles());
+}
+
+static void BM_UpdateMuscles(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    for (auto _ : state) {
+        model.updateMuscles(Q, QDot, true);
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_UpdateMuscles)->Apply(allMuscleModels);
+
+static void BM_MuscleForces(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+    for (auto& s : states) {
+        s->setActivation(0.5);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.muscleForces(states, Q, QDot));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_MuscleForces)->Apply(allMuscleModels);
+
+static void BM_ActivationDot(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+    for (auto& s : states) {
+        s->setExcitation(0.8);
+        s->setActivation(0.5);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.activationDot(states));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_ActivationDot)->Apply(allMuscleModels);
+
+static void BM_ActivationsDot(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    utils::Vector excitations(utils::Vector::Constant(static_cast<unsigned int>(model.nbMuscles()), 0.8));
+    utils::Vector activations(utils::Vector::Constant(static_cast<unsigned int>(model.nbMuscles()), 0.5));
+    utils::Vector activationsDot;
+    for (auto _ : state) {
+        model.activationsDot(excitations, activations, activationsDot);
+        benchmark::DoNotOptimize(activationsDot.data());
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_ActivationsDot)->Apply(allMuscleModels);
+
+static void BM_FatigueStatesDot(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    unsigned int nbMuscles(static_cast<unsigned int>(model.nbMuscles()));
+    utils::Vector activations(utils::Vector::Constant(nbMuscles, 0.8));
+    utils::Vector activeFibers(utils::Vector::Constant(nbMuscles, 0.5));
+    utils::Vector fatiguedFibers(utils::Vector::Constant(nbMuscles, 0.2));
+    utils::Vector restingFibers(utils::Vector::Constant(nbMuscles, 0.3));
+    utils::Vector activeFibersDot;
+    utils::Vector fatiguedFibersDot;
+    utils::Vector restingFibersDot;
+    for (auto _ : state) {
+        model.fatigueStatesDot(activations, activeFibers, fatiguedFibers, restingFibers,
+                               activeFibersDot, fatiguedFibersDot, restingFibersDot);
+        benchmark::DoNotOptimize(activeFibersDot.data());
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_FatigueStatesDot)->Apply(allMuscleModels);
+
+static void BM_MusclesLengthJacobian(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    Q.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.musclesLengthJacobian(Q));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_MusclesLengthJacobian)->Apply(allMuscleModels);
+
+static void BM_MuscularJointTorque(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+    for (auto& s : states) {
+        s->setActivation(0.5);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.muscularJointTorque(states, Q, QDot));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_MuscularJointTorque)->Apply(allMuscleModels);
+
+static void BM_MuscleDrivenForwardDynamicsByStages(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+    for (auto& s : states) {
+        s->setActivation(0.5);
+    }
+    for (auto _ : state) {
+        rigidbody::GeneralizedTorque Tau(model.muscularJointTorque(states, Q, QDot));
+        benchmark::DoNotOptimize(model.ForwardDynamics(Q, QDot, Tau));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_MuscleDrivenForwardDynamicsByStages)->Apply(allMuscleModels);
+
+static void BM_MuscleDrivenForwardDynamics(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedAcceleration QDDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+    for (auto& s : states) {
+        s->setActivation(0.5);
+    }
+    for (auto _ : state) {
+        model.muscleDrivenForwardDynamics(Q, QDot, states, nullptr, nullptr, false, QDDot);
+        benchmark::DoNotOptimize(QDDot.data());
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_MuscleDrivenForwardDynamics)->Apply(allMuscleModels);
+
+static void BM_MusclesDeepCopy(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.internal_forces::muscles::Muscles::DeepCopy());
+    }
+    setCounters(state, model, path);
+    std::map<utils::String, utils::MemoryFootprint> footprints(model.memoryFootprint());
+    state.counters["nbBlocks"] = static_cast<double>(footprints["muscles"].nbBlocks());
+    state.counters["bytes"] = static_cast<double>(footprints["muscles"].bytes());
+}
+BENCHMARK(BM_MusclesDeepCopy)->Apply(allMuscleModels);
+
+#ifdef MODULE_STATIC_OPTIM
+static void BM_StaticOptimization(benchmark::State& state)
+{
+    const std::string& path(muscleModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setZero();
+    QDot.setZero();
+    Tau.setZero();
+    for (auto _ : state) {
+        internal_forces::muscles::StaticOptimization optim(model, Q, QDot, Tau);
+        optim.run();
+        benchmark::DoNotOptimize(optim.finalSolution());
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_StaticOptimization)->Apply(allMuscleModels)->Unit(benchmark::kMillisecond);
+#endif
@@ -0,0 +1,610 @@
+#include <benchmark/benchmark.h>
+
+#include "biorbd.h"
+#ifdef MODULE_KALMAN
+    #include "RigidBody/KalmanReconsMarkers.h"
+    #include "RigidBody/KalmanReconsMarkersTrials.h"
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+// Models sorted by increasing number of degrees of freedom
+static std::vector<std::string> rigidBodyModels({
+    "models/pendulum.bioMod",
+    "models/two_segments.bioMod",
+    "models/cube.bioMod",
+    "models/pyomecaman.bioMod"
+});
+
+// Models sorted by increasing number of contacts
+static std::vector<std::string> contactModels({
+    "models/cubeWithRigidContactsExternalForces.bioMod",
+    "models/pyomecaman.bioMod"
+});
+
+// Models with soft contacts, alone or with rigid contacts and external forces
+static std::vector<std::string> softContactModels({
+    "models/cubeWithSoftContacts.bioMod",
+    "models/cubeWithSoftContactsRigidContactsExternalForces.bioMod"
+});
+
+// Models with rigid contacts and loop constraints, for the constrained solvers
+static std::vector<std::string> constrainedModels({
+    "models/cubeWithRigidContactsExternalForces.bioMod",
+    "models/cubeWithSoftContactsRigidContactsExternalForces.bioMod",
+    "models/loopConstrainedModel.bioMod"
+});
+
+static void applyModelSizes(
+    benchmark::internal::Benchmark* bench,
+    const std::vector<std::string>& models)
+{
+    for (size_t i=0; i<models.size(); ++i) {
+        bench->Arg(static_cast<int64_t>(i));
+    }
+}
+
+static void allRigidBodyModels(benchmark::internal::Benchmark* bench)
+{
+    applyModelSizes(bench, rigidBodyModels);
+}
+
+static void allContactModels(benchmark::internal::Benchmark* bench)
+{
+    applyModelSizes(bench, contactModels);
+}
+
+static void allSoftContactModels(benchmark::internal::Benchmark* bench)
+{
+    applyModelSizes(bench, softContactModels);
+}
+
+static void allConstrainedModelsAndSolvers(benchmark::internal::Benchmark* bench)
+{
+    std::vector<rigidbody::CONSTRAINTS_SOLVER> solvers({
+        rigidbody::CONSTRAINTS_SOLVER_DIRECT,
+        rigidbody::CONSTRAINTS_SOLVER_RANGE_SPACE_SPARSE,
+        rigidbody::CONSTRAINTS_SOLVER_NULL_SPACE
+    });
+    for (size_t i=0; i<constrainedModels.size(); ++i) {
+        for (auto solver : solvers) {
+            bench->Args({static_cast<int64_t>(i), static_cast<int64_t>(solver)});
+        }
+    }
+}
+
+static void setCounters(
+    benchmark::State& state,
+    const Model& model,
+    const std::string& path)
+{
+    state.SetLabel(path);
+    state.counters["nbDof"] = static_cast<double>(model.nbDof());
+}
+
+static void BM_ReadModel(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    for (auto _ : state) {
+        Model model(path);
+        benchmark::DoNotOptimize(model);
+    }
+    setCounters(state, Model(path), path);
+}
+BENCHMARK(BM_ReadModel)->Apply(allRigidBodyModels);
+
+static void BM_ForwardDynamics(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setOnes();
+    QDot.setOnes();
+    Tau.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.ForwardDynamics(Q, QDot, Tau));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_ForwardDynamics)->Apply(allRigidBodyModels);
+
+static void BM_InverseDynamics(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedAcceleration QDDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    QDDot.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.InverseDynamics(Q, QDot, QDDot));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_InverseDynamics)->Apply(allRigidBodyModels);
+
+static void BM_MassMatrix(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    Q.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.massMatrix(Q));
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_MassMatrix)->Apply(allRigidBodyModels);
+
+#ifndef BIORBD_USE_CASADI_MATH
+// The derivatives are computed analytically (0) or by finite differences of the whole state (1)
+static void allRigidBodyModelsAnalyticalAndFiniteDifferences(benchmark::internal::Benchmark* bench)
+{
+    for (size_t i=0; i<rigidBodyModels.size(); ++i) {
+        bench->Args({static_cast<int64_t>(i), 0});
+        bench->Args({static_cast<int64_t>(i), 1});
+    }
+}
+
+static void BM_InverseDynamicsDerivatives(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedAcceleration QDDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    QDDot.setOnes();
+    if (state.range(1) == 0) {
+        utils::Matrix dTau_dQ, dTau_dQdot, dTau_dQddot;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.InverseDynamicsDerivatives(
+                                         Q, QDot, QDDot, dTau_dQ, dTau_dQdot, dTau_dQddot));
+        }
+    } else {
+        unsigned int nQ(static_cast<unsigned int>(model.nbQ()));
+        unsigned int nQdot(static_cast<unsigned int>(model.nbQdot()));
+        utils::Vector x(nQ + 2 * nQdot);
+        x << Q, QDot, QDDot;
+        std::function<utils::Vector(const utils::Vector&)> f([&model, nQ, nQdot](const utils::Vector& x) {
+            return utils::Vector(model.InverseDynamics(
+                                     rigidbody::GeneralizedCoordinates(utils::Vector(x.segment(0, nQ))),
+                                     rigidbody::GeneralizedVelocity(utils::Vector(x.segment(nQ, nQdot))),
+                                     rigidbody::GeneralizedAcceleration(utils::Vector(x.segment(nQ + nQdot, nQdot)))));
+        });
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(utils::Differentiation::finiteDifferences(f, x));
+        }
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_InverseDynamicsDerivatives)->Apply(allRigidBodyModelsAnalyticalAndFiniteDifferences);
+
+static void BM_ForwardDynamicsDerivatives(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setOnes();
+    QDot.setOnes();
+    Tau.setOnes();
+    if (state.range(1) == 0) {
+        utils::Matrix dQddot_dQ, dQddot_dQdot, dQddot_dTau;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(model.ForwardDynamicsDerivatives(
+                                         Q, QDot, Tau, dQddot_dQ, dQddot_dQdot, dQddot_dTau));
+        }
+    } else {
+        unsigned int nQ(static_cast<unsigned int>(model.nbQ()));
+        unsigned int nQdot(static_cast<unsigned int>(model.nbQdot()));
+        unsigned int nTau(static_cast<unsigned int>(model.nbGeneralizedTorque()));
+        utils::Vector x(nQ + nQdot + nTau);
+        x << Q, QDot, Tau;
+        std::function<utils::Vector(const utils::Vector&)> f([&model, nQ, nQdot, nTau](const utils::Vector& x) {
+            return utils::Vector(model.ForwardDynamics(
+                                     rigidbody::GeneralizedCoordinates(utils::Vector(x.segment(0, nQ))),
+                                     rigidbody::GeneralizedVelocity(utils::Vector(x.segment(nQ, nQdot))),
+                                     rigidbody::GeneralizedTorque(utils::Vector(x.segment(nQ + nQdot, nTau)))));
+        });
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(utils::Differentiation::finiteDifferences(f, x));
+        }
+    }
+    setCounters(state, model, path);
+}
+BENCHMARK(BM_ForwardDynamicsDerivatives)->Apply(allRigidBodyModelsAnalyticalAndFiniteDifferences);
+#endif
+
+static void BM_ForwardDynamicsConstraintsDirect(benchmark::State& state)
+{
+    const std::string& path(contactModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setOnes();
+    QDot.setOnes();
+    Tau.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+    }
+    setCounters(state, model, path);
+    state.counters["nbContacts"] = static_cast<double>(model.nbContacts());
+}
+BENCHMARK(BM_ForwardDynamicsConstraintsDirect)->Apply(allContactModels);
+
+static void BM_ForwardDynamicsConstraintsSolver(benchmark::State& state)
+{
+    const std::string& path(constrainedModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    model.setConstraintsSolver(static_cast<rigidbody::CONSTRAINTS_SOLVER>(state.range(1)));
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setOnes();
+    QDot.setOnes();
+    Tau.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+    }
+    setCounters(state, model, path + " (" + rigidbody::CONSTRAINTS_SOLVER_toStr(model.constraintsSolver()) + ")");
+    state.counters["nbContacts"] = static_cast<double>(model.nbContacts());
+}
+BENCHMARK(BM_ForwardDynamicsConstraintsSolver)->Apply(allConstrainedModelsAndSolvers);
+
+static void BM_ForwardDynamicsConstraintsReusedFactorization(benchmark::State& state)
+{
+    // Only Tau changes between the calls, as in the stages of an integrator sharing the same state
+    const std::string& path(constrainedModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    model.setFactorizationReuse(true);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setOnes();
+    QDot.setOnes();
+    Tau.setOnes();
+    for (auto _ : state) {
+        Tau[0] += 1e-6;
+        benchmark::DoNotOptimize(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+    }
+    setCounters(state, model, path);
+    state.counters["nbContacts"] = static_cast<double>(model.nbContacts());
+}
+BENCHMARK(BM_ForwardDynamicsConstraintsReusedFactorization)->Arg(0)->Arg(1)->Arg(2);
+
+static void BM_ContactForces(benchmark::State& state)
+{
+    const std::string& path(contactModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setOnes();
+    QDot.setOnes();
+    Tau.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.ContactForcesFromForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+    }
+    setCounters(state, model, path);
+    state.counters["nbContacts"] = static_cast<double>(model.nbContacts());
+}
+BENCHMARK(BM_ContactForces)->Apply(allContactModels);
+
+static void BM_Markers(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    Q.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.markers(Q));
+    }
+    setCounters(state, model, path);
+    state.counters["nbMarkers"] = static_cast<double>(model.nbMarkers());
+}
+BENCHMARK(BM_Markers)->Apply(allRigidBodyModels);
+
+static void BM_MarkersJacobian(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    Q.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.markersJacobian(Q));
+    }
+    setCounters(state, model, path);
+    state.counters["nbMarkers"] = static_cast<double>(model.nbMarkers());
+}
+BENCHMARK(BM_MarkersJacobian)->Apply(allRigidBodyModels);
+
+static void BM_SoftContactForces(benchmark::State& state)
+{
+    const std::string& path(softContactModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    QDot.setOnes();
+    rigidbody::ExternalForceSet externalForces(model.externalForceSet(false, true));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(externalForces.computeRbdlSpatialVectors(Q, QDot));
+    }
+    setCounters(state, model, path);
+    state.counters["nbSoftContacts"] = static_cast<double>(model.nbSoftContacts());
+}
+BENCHMARK(BM_SoftContactForces)->Apply(allSoftContactModels);
+
+#ifndef BIORBD_USE_CASADI_MATH
+// Mesh soft contact on a bumpy height field of 101x101 nodes, resting on it (0) or above it (1)
+static void BM_SoftContactMeshForces(benchmark::State& state)
+{
+    const std::string path("models/cubeWithMeshSoftContact.bioMod");
+    Model model(path);
+    utils::Matrix heights(101, 101);
+    for (unsigned int i=0; i<101; ++i) {
+        for (unsigned int j=0; j<101; ++j) {
+            heights(i, j) = 0.05 * std::sin(0.5 * i) * std::cos(0.5 * j);
+        }
+    }
+    model.setTerrain(std::make_shared<rigidbody::TerrainHeightfield>(-5, -5, 0.1, 0.1, heights));
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setZero();
+    Q[2] = state.range(0) ? 3 : 1;
+    QDot.setOnes();
+    rigidbody::ExternalForceSet externalForces(model.externalForceSet(false, true));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(externalForces.computeRbdlSpatialVectors(Q, QDot));
+    }
+    setCounters(state, model, path);
+    state.counters["nbPoints"] = static_cast<double>(
+                                     dynamic_cast<rigidbody::SoftContactMesh&>(model.softContact(0)).nbPoints());
+}
+BENCHMARK(BM_SoftContactMeshForces)->Arg(0)->Arg(1);
+#endif
+
+static void BM_SegmentsByName(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    std::vector<utils::String> names;
+    for (size_t i=0; i<model.nbSegment(); ++i) {
+        names.push_back(model.segment(i).name());
+    }
+    for (auto _ : state) {
+        for (const auto& name : names) {
+            benchmark::DoNotOptimize(model.segment(name).getFirstDofIndexInGeneralizedCoordinates(model));
+            benchmark::DoNotOptimize(model.getBodyRbdlId(name));
+        }
+    }
+    setCounters(state, model, path);
+    state.counters["lookups"] = benchmark::Counter(
+        static_cast<double>(2 * names.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_SegmentsByName)->Apply(allRigidBodyModels);
+
+#ifndef BIORBD_USE_CASADI_MATH
+static void BM_ReducedModel(benchmark::State& state)
+{
+    // The arms of pyomecaman are locked and its left leg is pruned in the reduced model
+    const std::string path("models/pyomecaman.bioMod");
+    Model full(path);
+    ReducedModel reduced(full, {3, 4, 5, 6}, {0.1, 0.2, 0.3, 0.4}, {"CuisseG"});
+    Model& model(state.range(0) ? static_cast<Model&>(reduced) : full);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    Q.setOnes();
+    QDot.setOnes();
+    Tau.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.ForwardDynamics(Q, QDot, Tau));
+        benchmark::DoNotOptimize(model.markers(Q));
+    }
+    setCounters(state, model, state.range(0) ? path + " (reduced)" : path);
+}
+BENCHMARK(BM_ReducedModel)->Arg(0)->Arg(1);
+#endif
+
+#ifdef MODULE_KALMAN
+static void BM_KalmanReconsMarkers(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Qtarget(model);
+    Qtarget.setOnes();
+    Qtarget /= 10;
+    std::vector<rigidbody::NodeSegment> targetMarkers(model.technicalMarkers(Qtarget));
+
+    rigidbody::KalmanReconsMarkers kalman(model, rigidbody::KalmanParam(100));
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedAcceleration QDDot(model);
+
+    // The first frame converges to the initial pose, it is not representative
+    kalman.reconstructFrame(model, targetMarkers, &Q, &QDot, &QDDot);
+    for (auto _ : state) {
+        kalman.reconstructFrame(model, targetMarkers, &Q, &QDot, &QDDot);
+        benchmark::DoNotOptimize(Q);
+    }
+    setCounters(state, model, path);
+    state.counters["nbMarkers"] = static_cast<double>(model.nbTechnicalMarkers());
+}
+BENCHMARK(BM_KalmanReconsMarkers)->Arg(2)->Arg(3);
+
+// 16 trials of 50 frames, on 1 thread and on all the threads
+static void BM_KalmanReconsMarkersTrials(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    rigidbody::KalmanReconsMarkersTrials trials(path, rigidbody::KalmanParam(100), static_cast<size_t>(state.range(1)));
+    Model model(path);
+    rigidbody::GeneralizedCoordinates Qtarget(model);
+    Qtarget.setOnes();
+    Qtarget /= 10;
+    std::vector<rigidbody::NodeSegment> targetMarkers(model.technicalMarkers(Qtarget));
+    utils::Vector frame(static_cast<unsigned int>(3 * targetMarkers.size()));
+    for (size_t i=0; i<targetMarkers.size(); ++i) {
+        frame.block(static_cast<unsigned int>(3 * i), 0, 3, 1) = targetMarkers[i];
+    }
+    std::vector<std::vector<utils::Vector>> markers(16, std::vector<utils::Vector>(50, frame));
+
+    std::vector<std::vector<rigidbody::GeneralizedCoordinates>> Q;
+    for (auto _ : state) {
+        trials.reconstructTrials(markers, Q);
+    }
+    setCounters(state, model, path);
+    state.counters["nbThreads"] = static_cast<double>(trials.nbThreads());
+}
+BENCHMARK(BM_KalmanReconsMarkersTrials)->Args({2, 1})->Args({2, 0})->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+#ifndef BIORBD_USE_CASADI_MATH
+// Distance and penetration between the two meshes of the pendulum (about 2000 triangles each) while
+// the second segment swings, on 1 thread (sequential) and on all the threads
+static void BM_MeshCollisionsTrajectory(benchmark::State& state)
+{
+    const std::string path("models/pendulum.bioMod");
+    Model model(path);
+    rigidbody::MeshCollisions collisions(model, static_cast<size_t>(state.range(0)));
+    collisions.addPair(0, 1);
+    std::vector<rigidbody::GeneralizedCoordinates> Q(200, rigidbody::GeneralizedCoordinates(model));
+    for (size_t i=0; i<Q.size(); ++i) {
+        Q[i].setZero();
+        Q[i][2] = 2 * M_PI * static_cast<double>(i) / static_cast<double>(Q.size());
+    }
+
+    std::vector<std::vector<double>> distances, penetrations;
+    for (auto _ : state) {
+        collisions.evaluateTrajectory(Q, distances, &penetrations);
+        benchmark::DoNotOptimize(distances);
+    }
+    setCounters(state, model, path);
+    state.counters["nbThreads"] = static_cast<double>(collisions.nbThreads());
+    state.counters["frames"] = benchmark::Counter(
+                                   static_cast<double>(Q.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_MeshCollisionsTrajectory)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+#ifdef MODULE_SIMULATION
+static void BM_Rollouts(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    Model model(path);
+    simulation::Integrator integrator(model);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setZero();
+    QDot.setOnes();
+    std::vector<utils::Vector> initialStates(64, integrator.state(Q, QDot));
+
+    simulation::Rollouts rollouts(path, simulation::INTEGRATOR_RK4, 0);
+    rollouts.setTimeStep(1e-3);
+    for (auto _ : state) {
+        std::vector<utils::Vector> states(initialStates);
+        rollouts.run(0, 0.1, states);
+        benchmark::DoNotOptimize(states);
+    }
+    setCounters(state, model, path);
+    state.counters["steps"] = benchmark::Counter(
+                                  static_cast<double>(rollouts.nbSteps()), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Rollouts)->Apply(allRigidBodyModels)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Scene of 8 copies of a model, evaluated on 1 thread (sequential) and on all the threads
+static void BM_SceneForwardDynamics(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    simulation::Scene scene(static_cast<size_t>(state.range(1)));
+    for (size_t i=0; i<8; ++i) {
+        scene.addSubject(path);
+    }
+    utils::Vector Q(utils::Vector::Zero(static_cast<unsigned int>(scene.nbQ())));
+    utils::Vector QDot(utils::Vector::Ones(static_cast<unsigned int>(scene.nbQdot())));
+    utils::Vector Tau(utils::Vector::Ones(static_cast<unsigned int>(scene.nbGeneralizedTorque())));
+    utils::Vector QDDot;
+    for (auto _ : state) {
+        scene.ForwardDynamics(Q, QDot, Tau, QDDot);
+        benchmark::DoNotOptimize(QDDot.data());
+    }
+    setCounters(state, scene.subject(0), path);
+    state.counters["nbSubjects"] = static_cast<double>(scene.nbSubjects());
+    state.counters["nbThreads"] = static_cast<double>(scene.nbThreads());
+}
+static void sceneModelsAndThreads(benchmark::internal::Benchmark* bench)
+{
+    for (size_t i=0; i<rigidBodyModels.size(); ++i) {
+        bench->Args({static_cast<int64_t>(i), 1});
+        bench->Args({static_cast<int64_t>(i), 0});
+    }
+}
+BENCHMARK(BM_SceneForwardDynamics)->Apply(sceneModelsAndThreads)->UseRealTime();
+
+// Inverse dynamics residuals of 10000 sets of segment masses, on 1 thread and on all the threads
+static void BM_ParameterSweep(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    simulation::ParameterSweep sweep(path, static_cast<size_t>(state.range(1)));
+    Model& model(sweep.model());
+    for (size_t i=0; i<model.nbSegment(); ++i) {
+        sweep.addSegmentParameter(i, simulation::SEGMENT_MASS);
+    }
+    size_t nbSamples(10000);
+    utils::Matrix parameters(static_cast<unsigned int>(sweep.nbParameters()),
+                             static_cast<unsigned int>(nbSamples));
+    utils::Vector nominal(sweep.nominalParameters());
+    for (unsigned int i=0; i<nbSamples; ++i) {
+        parameters.col(i) = nominal * (0.8 + 0.4 * i / nbSamples);
+    }
+    utils::Vector Q(utils::Vector::Zero(static_cast<unsigned int>(model.nbQ())));
+    utils::Vector QDot(utils::Vector::Ones(static_cast<unsigned int>(model.nbQdot())));
+    utils::Vector QDDot(utils::Vector::Ones(static_cast<unsigned int>(model.nbQddot())));
+    utils::Matrix residuals;
+    for (auto _ : state) {
+        sweep.evaluate(parameters, simulation::SWEEP_INVERSE_DYNAMICS_RESIDUALS, Q, &QDot, &QDDot,
+                       nullptr, residuals);
+        benchmark::DoNotOptimize(residuals.data());
+    }
+    setCounters(state, model, path);
+    state.counters["nbThreads"] = static_cast<double>(sweep.nbThreads());
+    state.counters["samples"] = benchmark::Counter(
+                                    static_cast<double>(nbSamples), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_ParameterSweep)->Apply(sceneModelsAndThreads)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Inverse dynamics of a trajectory of 1000 frames, on 1 thread and on all the threads
+static void BM_TrajectoryInverseDynamics(benchmark::State& state)
+{
+    const std::string& path(rigidBodyModels[static_cast<size_t>(state.range(0))]);
+    simulation::TrajectoryDynamics trajectory(path, static_cast<size_t>(state.range(1)));
+    Model& model(trajectory.model());
+    unsigned int nbFrames(1000);
+    utils::Matrix Q(static_cast<unsigned int>(model.nbQ()), nbFrames);
+    utils::Matrix QDot(static_cast<unsigned int>(model.nbQdot()), nbFrames);
+    utils::Matrix QDDot(static_cast<unsigned int>(model.nbQddot()), nbFrames);
+    for (unsigned int j=0; j<nbFrames; ++j) {
+        Q.col(j).setConstant(static_cast<double>(j) / nbFrames);
+        QDot.col(j).setOnes();
+        QDDot.col(j).setOnes();
+    }
+    utils::Matrix Tau;
+    for (auto _ : state) {
+        trajectory.InverseDynamics(Q, QDot, QDDot, Tau);
+        benchmark::DoNotOptimize(Tau.data());
+    }
+    setCounters(state, model, path);
+    state.counters["nbThreads"] = static_cast<double>(trajectory.nbThreads());
+    state.counters["frames"] = benchmark::Counter(
+                                   static_cast<double>(nbFrames), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_TrajectoryInverseDynamics)->Apply(sceneModelsAndThreads)->UseRealTime();
+#endif
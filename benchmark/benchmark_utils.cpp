@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+#include "biorbd.h"
+#include "Utils/Differentiation.h"
+#include "Utils/ThreadPool.h"
+
+using namespace BIORBD_NAMESPACE;
+
+static void BM_MarkersJacobianFiniteDifferences(benchmark::State& state)
+{
+    Model model("models/pyomecaman.bioMod");
+    rigidbody::GeneralizedCoordinates Q(model);
+    Q.setOnes();
+    std::function<utils::Vector(const utils::Vector&)> f([&model](const utils::Vector& x) {
+        rigidbody::GeneralizedCoordinates Q(x);
+        utils::Matrix markers(model.markersInMatrix(Q));
+        return utils::Vector(Eigen::Map<Eigen::VectorXd>(markers.data(), markers.size()));
+    });
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(utils::Differentiation::finiteDifferences(f, Q));
+    }
+}
+BENCHMARK(BM_MarkersJacobianFiniteDifferences);
+
+static void BM_MarkersJacobianAnalytical(benchmark::State& state)
+{
+    Model model("models/pyomecaman.bioMod");
+    rigidbody::GeneralizedCoordinates Q(model);
+    Q.setOnes();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(model.markersJacobian(Q));
+    }
+}
+BENCHMARK(BM_MarkersJacobianAnalytical);
+
+// Cost of a parallelFor of empty tasks: the scheduling overhead, on 1 thread and on all the threads
+static void BM_ThreadPoolOverhead(benchmark::State& state)
+{
+    utils::ThreadPool pool(static_cast<size_t>(state.range(0)));
+    size_t nbTasks(static_cast<size_t>(state.range(1)));
+    for (auto _ : state) {
+        pool.parallelFor(nbTasks, [](size_t task, size_t) {
+            benchmark::DoNotOptimize(task);
+        });
+    }
+    state.counters["nbThreads"] = static_cast<double>(pool.nbThreads());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * nbTasks));
+}
+BENCHMARK(BM_ThreadPoolOverhead)->Args({1, 1000})->Args({0, 1})->Args({0, 1000})->UseRealTime();
+
+// Tasks whose cost grows with their index, so the threads with the last ranges must be helped
+static void BM_ThreadPoolScaling(benchmark::State& state)
+{
+    utils::ThreadPool pool(static_cast<size_t>(state.range(0)));
+    pool.setDeterministic(state.range(1) != 0);
+    size_t nbTasks(256);
+    std::vector<double> results(nbTasks);
+    for (auto _ : state) {
+        pool.parallelFor(nbTasks, [&](size_t task, size_t) {
+            double sum(0);
+            for (size_t i=0; i<task * 200; ++i) {
+                sum += std::sqrt(static_cast<double>(i));
+            }
+            results[task] = sum;
+        });
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.counters["nbThreads"] = static_cast<double>(pool.nbThreads());
+    state.counters["deterministic"] = static_cast<double>(pool.deterministic());
+}
+BENCHMARK(BM_ThreadPoolScaling)->Args({1, 0})->Args({0, 0})->Args({0, 1})->UseRealTime();
@@ -0,0 +1,78 @@
+"""
+Compare the results of biorbd benchmarks against a baseline.
+
+Both files are the json output of the benchmark executable, e.g.:
+    biorbd_eigen_benchmarks --benchmark_out=baseline.json --benchmark_out_format=json
+
+Usage:
+    python compare_benchmarks.py baseline.json current.json [--threshold 0.10]
+
+The script exits with a non-zero code if any benchmark is slower than the baseline by more than the threshold
+(relative), so it can be used in continuous integration.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_benchmarks(path):
+    """
+    Return a dict {benchmark name: cpu time in ns}. If repetitions were run, the median is used.
+    """
+    with open(path, "r") as file:
+        data = json.load(file)
+
+    time_units = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    out = {}
+    has_aggregates = any(b.get("run_type") == "aggregate" for b in data["benchmarks"])
+    for bench in data["benchmarks"]:
+        if has_aggregates:
+            if bench.get("run_type") != "aggregate" or bench.get("aggregate_name") != "median":
+                continue
+            name = bench["run_name"]
+        else:
+            name = bench["name"]
+        out[name] = bench["cpu_time"] * time_units[bench.get("time_unit", "ns")]
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flag the slowdowns of the biorbd benchmarks against a baseline")
+    parser.add_argument("baseline", help="The json file of the baseline")
+    parser.add_argument("current", help="The json file to compare to the baseline")
+    parser.add_argument(
+        "--threshold", type=float, default=0.10, help="Relative slowdown that is flagged (default: 0.10 for 10%%)"
+    )
+    args = parser.parse_args()
+
+    baseline = load_benchmarks(args.baseline)
+    current = load_benchmarks(args.current)
+
+    name_width = max([len(name) for name in current] + [len("Benchmark")])
+    print(f"{'Benchmark':<{name_width}} {'Baseline (ns)':>15} {'Current (ns)':>15} {'Change':>9}")
+
+    regressions = []
+    for name in sorted(current):
+        if name not in baseline:
+            print(f"{name:<{name_width}} {'-':>15} {current[name]:>15.1f} {'new':>9}")
+            continue
+
+        change = (current[name] - baseline[name]) / baseline[name]
+        flag = ""
+        if change > args.threshold:
+            flag = "  <-- SLOWER"
+            regressions.append(name)
+        print(f"{name:<{name_width}} {baseline[name]:>15.1f} {current[name]:>15.1f} {change:>+8.1%}{flag}")
+
+    for name in sorted(set(baseline) - set(current)):
+        print(f"{name:<{name_width}} {baseline[name]:>15.1f} {'-':>15} {'removed':>9}")
+
+    if regressions:
+        print(f"\n{len(regressions)} benchmark(s) slower than the baseline by more than {args.threshold:.0%}")
+        sys.exit(1)
+    print("\nNo regression")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,7 +1,9 @@
 #ifndef BIORBD_MODEL_H
 #define BIORBD_MODEL_H
 
+#include <map>
 #include "biorbdConfig.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Path.h"
 #include "RigidBody/RotoTransNodes.h"
 #include "RigidBody/Joints.h"
@@ -70,6 +72,7 @@ namespace BIORBD_NAMESPACE
 {
     namespace rigidbody {
         class ExternalForceSet;
+        class KinematicsResults;
     }
 
 ///
@@ -118,8 +121,124 @@ public:
         bool useSoftContacts = true
     );
 
+    ///
+    /// \brief Compute several kinematic quantities, including the markers, from a single update of the kinematics
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities (can be nullptr if no quantity needs it)
+    /// \param QDDot The Generalized Accelerations (can be nullptr if no quantity needs it)
+    /// \param quantities The requested quantities, a combination of KINEMATICS_QUANTITY
+    /// \param results The results to fill
+    /// \param removeAxis If there are axis to remove from the position of the markers
+    /// \param updateKin If the kinematics should be updated
+    ///
+    void evaluate(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity* QDot,
+        const rigidbody::GeneralizedAcceleration* QDDot,
+        int quantities,
+        rigidbody::KinematicsResults& results,
+        bool removeAxis = true,
+        bool updateKin = true);
+
+    ///
+    /// \brief Return the memory held by each subsystem of the model
+    /// \return The footprint of the segments, the markers, the IMUs, the RTs, the contacts and the muscles
+    ///
+    /// An element shared by several copies of the model is counted once per report
+    ///
+    std::map<utils::String, utils::MemoryFootprint> memoryFootprint() const;
+
+#ifdef MODULE_MUSCLES
+    ///
+    /// \brief Compute the generalized accelerations from the muscle states
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param emg The dynamic state of each muscle
+    /// \param residualTau The generalized torques added to the internal forces (can be nullptr)
+    /// \return The Generalized Accelerations
+    ///
+    /// The torques of the muscles, the ligaments and the passive torques are accumulated from
+    /// a single update of the kinematics and handed to the forward dynamics. The stages are
+    /// timed by the profiler when biorbd is compiled with USE_PROFILER
+    ///
+    rigidbody::GeneralizedAcceleration muscleDrivenForwardDynamics(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity& QDot,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+        const rigidbody::GeneralizedTorque* residualTau = nullptr);
+
+    ///
+    /// \brief Compute the generalized accelerations from the muscle states with external forces
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param emg The dynamic state of each muscle
+    /// \param externalForces The external forces
+    /// \param residualTau The generalized torques added to the internal forces (can be nullptr)
+    /// \return The Generalized Accelerations
+    ///
+    rigidbody::GeneralizedAcceleration muscleDrivenForwardDynamics(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity& QDot,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+        rigidbody::ExternalForceSet& externalForces,
+        const rigidbody::GeneralizedTorque* residualTau = nullptr);
+
+    ///
+    /// \brief Compute the generalized accelerations from the muscle states, with the contacts of the model
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param emg The dynamic state of each muscle
+    /// \param residualTau The generalized torques added to the internal forces (can be nullptr)
+    /// \return The Generalized Accelerations
+    ///
+    rigidbody::GeneralizedAcceleration muscleDrivenForwardDynamicsConstraintsDirect(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity& QDot,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+        const rigidbody::GeneralizedTorque* residualTau = nullptr);
+
+    ///
+    /// \brief Compute the generalized accelerations from the muscle states, with the contacts of the model and external forces
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param emg The dynamic state of each muscle
+    /// \param externalForces The external forces
+    /// \param residualTau The generalized torques added to the internal forces (can be nullptr)
+    /// \return The Generalized Accelerations
+    ///
+    rigidbody::GeneralizedAcceleration muscleDrivenForwardDynamicsConstraintsDirect(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity& QDot,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+        rigidbody::ExternalForceSet& externalForces,
+        const rigidbody::GeneralizedTorque* residualTau = nullptr);
+
+    ///
+    /// \brief Compute the generalized accelerations from the muscle states in place
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param emg The dynamic state of each muscle
+    /// \param residualTau The generalized torques added to the internal forces (can be nullptr)
+    /// \param externalForces The external forces (can be nullptr)
+    /// \param useConstraints If the contacts of the model are enforced
+    /// \param QDDot The Generalized Accelerations (output, resized if needed)
+    ///
+    void muscleDrivenForwardDynamics(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity& QDot,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+        const rigidbody::GeneralizedTorque* residualTau,
+        rigidbody::ExternalForceSet* externalForces,
+        bool useConstraints,
+        rigidbody::GeneralizedAcceleration& QDDot);
+#endif
+
 private:
     std::shared_ptr<utils::Path> m_path;
+#if defined(MODULE_MUSCLES) && !defined(SWIG)
+    class ForwardDynamicsWorkspace;
+    std::shared_ptr<ForwardDynamicsWorkspace> m_forwardDynamicsWorkspace; ///< The buffers of muscleDrivenForwardDynamics
+#endif
 public:
     ///
     /// \brief Returns the path of .bioMod file used to load the model. If no file was used, it remains empty
@@ -5,6 +5,7 @@
 #include <memory>
 #include "biorbdConfig.h"
 #include "Utils/Scalar.h"
+#include "InternalForces/Actuators/ActuatorEnums.h"
 
 namespace BIORBD_NAMESPACE
 {
@@ -126,10 +127,46 @@ public:
     size_t nbActuators() const;
 
 protected:
+#ifndef SWIG
+    ///
+    /// \brief Entry of the evaluation table of the actuators. The table is filled when closing
+    /// the actuators and is sorted by type so the evaluation loop does not need RTTI
+    ///
+    class ActuatorTableEntry {
+    public:
+        TYPE m_type; ///< The type of the actuator
+        unsigned int m_dofIdx; ///< Index of the DoF associated with the actuator
+        std::shared_ptr<Actuator> m_actuator; ///< The actuator
+    };
+#endif
+
     std::shared_ptr<std::vector<std::pair<std::shared_ptr<Actuator>, std::shared_ptr<Actuator>>>>
     m_all; ///<All the actuators reunited /pair (+ or -)
     std::shared_ptr<std::vector<bool>> m_isDofSet;///< If DoF all dof are set
     std::shared_ptr<bool> m_isClose; ///< If the set is ready
+#ifndef SWIG
+    std::shared_ptr<std::vector<ActuatorTableEntry>>
+    m_concentricTable; ///< Concentric actuators sorted by type (filled when closing the actuators)
+    std::shared_ptr<std::vector<ActuatorTableEntry>>
+    m_eccentricTable; ///< Eccentric actuators sorted by type (filled when closing the actuators)
+
+    ///
+    /// \brief Fill the evaluation tables from the actuators
+    ///
+    void compileActuatorTables();
+
+    ///
+    /// \brief Get the max torque of an entry of the evaluation tables
+    /// \param entry The entry to evaluate
+    /// \param Q The Generalized coordinates
+    /// \param Qdot The Generalized velocity
+    /// \return The torque max
+    ///
+    utils::Scalar torqueMaxFromTable(
+        const ActuatorTableEntry& entry,
+        const rigidbody::GeneralizedCoordinates &Q,
+        const rigidbody::GeneralizedVelocity &Qdot) const;
+#endif
 
     ///
     /// \brief getTorqueMaxDirection Get the max torque of a specific actuator (interface necessary because of CasADi)
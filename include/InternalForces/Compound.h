@@ -10,6 +10,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class String;
 class Vector3d;
 }
@@ -108,6 +109,12 @@ public:
     ///
     virtual const utils::Scalar& force();
 
+    ///
+    /// \brief Add the memory held by the muscle to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
 
 protected:
     std::shared_ptr<utils::String> m_name; ///< The name of the muscle
@@ -10,6 +10,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class Matrix;
 class Vector;
 class Vector3d;
@@ -200,6 +201,12 @@ public:
     ///
     const utils::Matrix& jacobianLength() const;
 
+    ///
+    /// \brief Add the memory held by the geometry to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
 
 protected:
     ///
@@ -296,6 +303,17 @@ protected:
     ///
     void computeJacobianLength();
 
+    ///
+    /// \brief Resolve the rbdl body of the origin, of the insertion and of the path modifiers
+    /// \param model The joint model
+    /// \param pathModifiers The set of path modifiers
+    ///
+    /// This is done once, the names of the parents are not looked up when the kinematics are updated
+    ///
+    void resolveBodyId(
+        rigidbody::Joints &model,
+        internal_forces::PathModifiers* pathModifiers = nullptr);
+
     // Position des nodes dans le repere local
     std::shared_ptr<utils::Vector3d> m_origin; ///< Origin node
     std::shared_ptr<utils::Vector3d> m_insertion; ///< Insertion node
@@ -304,6 +322,8 @@ protected:
     std::shared_ptr<utils::Vector3d> m_insertionInGlobal; ///< Position of the insertion node in the global reference
     std::shared_ptr<std::vector<utils::Vector3d>> m_pointsInGlobal; ///< Position of all the points in the global reference
     std::shared_ptr<std::vector<utils::Vector3d>> m_pointsInLocal; ///< Position of all the points in local
+    std::shared_ptr<std::vector<unsigned int>> m_pathBodyId; ///< The rbdl body of the origin, of the insertion and of each path modifier
+    std::shared_ptr<std::vector<unsigned int>> m_pointsBodyId; ///< The rbdl body of each point in local
     std::shared_ptr<utils::Matrix> m_jacobian; ///<The jacobian matrix
     std::shared_ptr<utils::Matrix> m_G; ///< Internal matrix of the jacobian dimension to speed up calculation
     std::shared_ptr<utils::Matrix> m_jacobianLength; ///< The muscle length jacobian
@@ -18,6 +18,8 @@ namespace ligaments
 /// \brief Base class for ligament constant
 class BIORBD_API LigamentConstant : public Ligament
 {
+    friend Ligaments;
+
 public:
     ///
     /// \brief Contruct a constant ligament
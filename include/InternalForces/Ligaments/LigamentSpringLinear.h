@@ -19,6 +19,8 @@ namespace ligaments
 /// k(l-l0) with k is the stiffness
 class BIORBD_API LigamentSpringLinear : public Ligament
 {
+    friend Ligaments;
+
 public:
     ///
     /// \brief Contruct a Ligament
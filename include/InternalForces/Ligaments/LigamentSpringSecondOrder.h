@@ -20,6 +20,8 @@ namespace ligaments
 
 class BIORBD_API LigamentSpringSecondOrder : public Ligament
 {
+    friend Ligaments;
+
 public:
     ///
     /// \brief Contruct a Ligament
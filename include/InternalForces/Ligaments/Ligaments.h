@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "biorbdConfig.h"
+#include "Utils/Vector.h"
 
 namespace BIORBD_NAMESPACE
 {
@@ -249,6 +250,55 @@ public:
 protected:
     std::shared_ptr<std::vector<std::shared_ptr<Ligament>>>
             m_ligaments; ///< Holder for ligament groups
+
+#ifndef SWIG
+    ///
+    /// \brief Flat evaluation data of the ligaments. The ligaments are grouped by type so the
+    /// spring laws are evaluated on contiguous arrays instead of one virtual call per ligament
+    ///
+    class LigamentsEngine {
+    public:
+        std::vector<size_t> m_order; ///< Index of the ligaments in m_ligaments, sorted by type
+        size_t m_nbConstant; ///< Number of constant ligaments (first in m_order)
+        size_t m_nbSpringLinear; ///< Number of linear spring ligaments (after the constant ones)
+        size_t m_nbSpringSecondOrder; ///< Number of second order spring ligaments (last in m_order)
+
+        utils::Vector m_length; ///< Length of the ligaments (ordered as m_order)
+        utils::Vector m_velocity; ///< Lengthening velocity of the ligaments (ordered as m_order)
+        utils::Vector m_slackLength; ///< Slack length of the ligaments (ordered as m_order)
+        utils::Vector m_stiffness; ///< Stiffness of the springs, or force of the constant ligaments (ordered as m_order)
+        utils::Vector m_epsilon; ///< Epsilon of the second order springs (ordered as m_order)
+        utils::Vector m_dampingParam; ///< Damping parameter of the ligaments (ordered as m_order)
+        utils::Vector m_maxShorteningSpeed; ///< Maximal shortening speed of the ligaments (ordered as m_order)
+        utils::Vector m_Fl; ///< Force-length part of the ligament forces (ordered as m_order)
+        utils::Vector m_damping; ///< Damping part of the ligament forces (ordered as m_order)
+        utils::Vector m_force; ///< The ligament forces (ordered as m_ligaments)
+    };
+    std::shared_ptr<LigamentsEngine> m_engine; ///< The evaluation data of the ligaments
+
+    ///
+    /// \brief Sort the ligaments by type and size the evaluation buffers
+    ///
+    void compileLigamentsEngine();
+
+    ///
+    /// \brief Evaluate the force of all the ligaments into the engine buffer
+    ///
+    /// Warning: This function assumes that ligaments are already updated (via `updateLigaments`)
+    ///
+    void computeLigamentForces();
+
+    ///
+    /// \brief Accumulate the joint torque of the ligaments from the forces
+    /// \param F The force vector of all the ligaments
+    /// \param tau The generalized torque to write in (must be of size nbDof)
+    ///
+    /// Warning: This function assumes that ligaments are already updated (via `updateLigaments`)
+    ///
+    void accumulateLigamentsJointTorque(
+        const utils::Vector& F,
+        rigidbody::GeneralizedTorque& tau);
+#endif
 };
 
 }
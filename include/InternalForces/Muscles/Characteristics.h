@@ -8,6 +8,11 @@
 
 namespace BIORBD_NAMESPACE
 {
+namespace utils
+{
+class MemoryFootprint;
+}
+
 namespace internal_forces
 {
 namespace  muscles
@@ -218,6 +223,12 @@ public:
     ///
     bool useDamping() const;
 
+    ///
+    /// \brief Add the memory held by the characteristics to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
 
 protected:
     std::shared_ptr<utils::Scalar>
@@ -8,6 +8,11 @@
 
 namespace BIORBD_NAMESPACE
 {
+namespace utils
+{
+class MemoryFootprint;
+}
+
 namespace internal_forces
 {
 namespace muscles
@@ -99,6 +104,13 @@ public:
     ///
     const utils::Scalar& recoveryFactor() const;
 
+    ///
+    /// \brief Add the memory held by the fatigue parameters to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     std::shared_ptr<utils::Scalar> m_fatigueRate; ///< The fatigue rate
     std::shared_ptr<utils::Scalar> m_recoveryRate;///< The recovery rate
@@ -177,12 +177,24 @@ public:
     ///
     const utils::Scalar& damping();
 
+    ///
+    /// \brief Add the memory held by the muscle to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     ///
     /// \brief Set type to Hill
     ///
     virtual void setType();
 
+    ///
+    /// \brief Create the intermediate values and the constants of the force computation in a single block
+    ///
+    void initializeParameters();
+
     ///
     /// \brief Compute the muscle damping
     ///
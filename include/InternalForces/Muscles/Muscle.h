@@ -11,6 +11,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class Matrix;
 class Vector3d;
 }
@@ -248,6 +249,27 @@ public:
     void setForceIsoMax(
         const utils::Scalar& forceMax);
 
+    ///
+    /// \brief Set the optimal length of the contractile element
+    /// \param optimalLength The optimal length to set
+    ///
+    void setOptimalLength(
+        const utils::Scalar& optimalLength);
+
+    ///
+    /// \brief Set the tendon slack length
+    /// \param tendonSlackLength The tendon slack length to set
+    ///
+    void setTendonSlackLength(
+        const utils::Scalar& tendonSlackLength);
+
+    ///
+    /// \brief Set the angle of pennation
+    /// \param pennationAngle The angle of pennation to set
+    ///
+    void setPennationAngle(
+        const utils::Scalar& pennationAngle);
+
     ///
     /// \brief Set the dynamic state
     /// \param emg The dynamic state value
@@ -322,6 +344,13 @@ public:
     ///
     MUSCLE_TYPE type() const;
 
+    ///
+    /// \brief Add the memory held by the muscle to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     ///
     /// \brief Computer the forces from a specific emg
@@ -11,6 +11,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class Matrix;
 class Vector;
 class Vector3d;
@@ -124,6 +125,13 @@ public:
     ///
     const utils::Scalar& musculoTendonLength() const;
 
+    ///
+    /// \brief Add the memory held by the geometry to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     ///
     /// \brief Actual function that implements the update of the kinematics
@@ -10,6 +10,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class String;
 }
 
@@ -232,6 +233,13 @@ public:
     ///
     const utils::String& insertion() const;
 
+    ///
+    /// \brief Add the memory held by the muscle group and its muscles to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     std::shared_ptr<std::vector<std::shared_ptr<Muscle>>>
     m_mus; ///< The set of muscles
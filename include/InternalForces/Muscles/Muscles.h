@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 #include "biorbdConfig.h"
 #include "InternalForces/Geometry.h"
@@ -83,6 +84,9 @@ public:
     /// \param name The name of the muscle group
     /// \return The group ID (returns -1 if not found)
     ///
+    /// The groups are found from a name index, which is rebuilt when a name is missing (e.g. a
+    /// group was renamed)
+    ///
     int getMuscleGroupId(
         const utils::String &name) const;
 
@@ -271,6 +275,55 @@ public:
         const std::vector<std::shared_ptr<State>>& states,
         bool areadyNormalized = true);
 
+    ///
+    /// \brief Compute the time derivative of the activation of all the muscles at once
+    /// \param excitations The excitation of each muscle
+    /// \param activations The activation of each muscle
+    /// \param activationsDot The time derivative of the activation of each muscle (output, resized if needed)
+    /// \param alreadyNormalized If the excitations are already normalized
+    ///
+    /// Each muscle follows the dynamics of its state type (the default first order dynamics,
+    /// DeGroote or Buchanan), as activationDot does. The excitations and activations are bounded
+    /// without any warning. The parameters of the muscles are packed in contiguous arrays the first
+    /// time, and the whole set of muscles is computed without branching nor allocating.
+    /// updateMusclesParameters must be called if the characteristics of the muscles are changed
+    ///
+    void activationsDot(
+        const utils::Vector& excitations,
+        const utils::Vector& activations,
+        utils::Vector& activationsDot,
+        bool alreadyNormalized = true);
+
+    ///
+    /// \brief Compute the time derivative of the Xia fatigue states of all the muscles at once
+    /// \param activations The activation of each muscle (the target command of the fatigue model)
+    /// \param activeFibers The proportion of active fibers of each muscle
+    /// \param fatiguedFibers The proportion of fatigued fibers of each muscle
+    /// \param restingFibers The proportion of resting fibers of each muscle
+    /// \param activeFibersDot The time derivative of the active fibers (output, resized if needed)
+    /// \param fatiguedFibersDot The time derivative of the fatigued fibers (output, resized if needed)
+    /// \param restingFibersDot The time derivative of the resting fibers (output, resized if needed)
+    ///
+    /// Same as FatigueDynamicStateXia::timeDerivativeState for every muscle, using the fatigue
+    /// parameters of their characteristics
+    ///
+    void fatigueStatesDot(
+        const utils::Vector& activations,
+        const utils::Vector& activeFibers,
+        const utils::Vector& fatiguedFibers,
+        const utils::Vector& restingFibers,
+        utils::Vector& activeFibersDot,
+        utils::Vector& fatiguedFibersDot,
+        utils::Vector& restingFibersDot);
+
+    ///
+    /// \brief Pack again the parameters used by activationsDot and fatigueStatesDot
+    ///
+    /// The parameters are packed when the number of muscles changes. This must be called if the
+    /// characteristics or the state type of a muscle were changed since
+    ///
+    void updateMusclesParameters();
+
     ///
     /// \brief Return the previously computed muscle length jacobian
     /// \return The muscle length jacobian
@@ -328,6 +381,41 @@ public:
 protected:
     std::shared_ptr<std::vector<MuscleGroup>>
             m_mus; ///< Holder for muscle groups
+    std::shared_ptr<std::unordered_map<std::string, size_t>>
+            m_musIndex; ///< The index of the muscle groups by name
+
+#ifndef SWIG
+    class MusclesParameters;
+    std::shared_ptr<MusclesParameters> m_musclesParameters; ///< The packed parameters of the dynamics of the muscles
+
+    ///
+    /// \brief Return the packed parameters of the muscles, packing them if the number of muscles changed
+    /// \return The packed parameters of the muscles
+    ///
+    MusclesParameters& musclesParameters();
+#endif
+
+    ///
+    /// \brief Compute the force of all the muscles in place
+    /// \param emg The dynamic state of each muscle
+    /// \param forces The force of each muscle (output, resized if needed)
+    ///
+    /// Warning: This function assumes that muscles are already updated (via `updateMuscles`)
+    ///
+    void computeMuscleForces(
+        const std::vector<std::shared_ptr<State>>& emg,
+        utils::Vector& forces);
+
+    ///
+    /// \brief Accumulate the joint torque of the muscles from the forces
+    /// \param F The force vector of all the muscles
+    /// \param tau The generalized torque to write in (must be of size nbDof)
+    ///
+    /// Warning: This function assumes that muscles are already updated (via `updateMuscles`)
+    ///
+    void accumulateMuscularJointTorque(
+        const utils::Vector& F,
+        rigidbody::GeneralizedTorque& tau);
 };
 
 }
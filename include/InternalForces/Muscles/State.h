@@ -8,6 +8,11 @@
 
 namespace BIORBD_NAMESPACE
 {
+namespace utils
+{
+class MemoryFootprint;
+}
+
 namespace internal_forces
 {
 namespace muscles
@@ -122,6 +127,13 @@ public:
     ///
     STATE_TYPE type() const;
 
+    ///
+    /// \brief Add the memory held by the state to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     ///
     /// \brief Set the type to simple_state
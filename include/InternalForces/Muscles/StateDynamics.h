@@ -6,6 +6,11 @@
 
 namespace BIORBD_NAMESPACE
 {
+namespace utils
+{
+class MemoryFootprint;
+}
+
 namespace internal_forces
 {
 namespace muscles
@@ -132,6 +137,13 @@ public:
     ///
     virtual const utils::Scalar& timeDerivativeActivation();
 
+    ///
+    /// \brief Add the memory held by the state to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     virtual void setType();
     std::shared_ptr<utils::Scalar>
@@ -5,6 +5,7 @@
 #include <memory>
 #include "biorbdConfig.h"
 #include "Utils/Scalar.h"
+#include "InternalForces/PassiveTorques/PassiveTorqueEnums.h"
 
 namespace BIORBD_NAMESPACE
 {
@@ -88,8 +89,41 @@ public:
     const std::shared_ptr<PassiveTorque>& getPassiveTorque(size_t dof);
 
 protected:
+#ifndef SWIG
+    ///
+    /// \brief Entry of the evaluation table of the passive torques. The table is sorted by type
+    /// so the evaluation loop does not need RTTI
+    ///
+    class PassiveTorqueTableEntry {
+    public:
+        TORQUE_TYPE m_type; ///< The type of the passive torque
+        unsigned int m_dofIdx; ///< Index of the DoF associated with the passive torque
+        std::shared_ptr<PassiveTorque> m_passiveTorque; ///< The passive torque
+    };
+#endif
+
     std::shared_ptr<std::vector<std::shared_ptr<internal_forces::passive_torques::PassiveTorque>>>  m_pas; ///< Passive torque to add
     std::shared_ptr<std::vector<bool>> m_isDofSet;///< If DoF all dof are set
+#ifndef SWIG
+    std::shared_ptr<std::vector<PassiveTorqueTableEntry>>
+    m_passiveTorqueTable; ///< The passive torques that are set, sorted by type
+
+    ///
+    /// \brief Fill the evaluation table from the passive torques
+    ///
+    void compilePassiveTorqueTable();
+#endif
+
+    ///
+    /// \brief Add the passive torques to a generalized torque
+    /// \param Q The generalized coordinates of the passive torques
+    /// \param Qdot The generalized velocities of the passive torques
+    /// \param tau The generalized torque to add to (must be of size nbDof)
+    ///
+    void accumulatePassiveJointTorque(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity &Qdot,
+        rigidbody::GeneralizedTorque& tau);
 
 };
 
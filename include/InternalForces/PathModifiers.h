@@ -9,6 +9,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class Vector3d;
 }
 
@@ -78,6 +79,13 @@ public:
     ///
     const utils::Vector3d& object(size_t  idx) const;
 
+    ///
+    /// \brief Add the memory held by the wrapping objects and the via points to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     std::shared_ptr<std::vector<std::shared_ptr<utils::Vector3d>>>
     m_obj; ///< set of objects
@@ -4,6 +4,7 @@
 #include <stddef.h>
 #include <vector>
 #include <map>
+#include <memory>
 #include "biorbdConfig.h"
 
 namespace BIORBD_NAMESPACE
@@ -22,10 +23,12 @@ class Path;
 class String;
 class Vector;
 class Vector3d;
+class Matrix;
 class Matrix3d;
 class SpatialVector;
 class RotoTrans;
 class IfStream;
+class MappedFile;
 class Equation;
 }
 
@@ -92,6 +95,78 @@ public:
     static std::vector<utils::Vector> readGroundReactionForceDataFile(
         const utils::Path &path);
 
+    ///
+    /// \brief Read a bioKin, bioMus, bioTorque or bioGRF file at once
+    /// \param path The path of the file
+    /// \param sizeTag The tag of the number of variables ("nddl", "nbmuscles", "nGeneralizedTorque" or "ngrf")
+    /// \param data The values, one column per frame (nbVariables x nbFrames) (output)
+    /// \param time The time of each frame (output)
+    ///
+    /// The file is mapped in memory and parsed in place. For files too large to be held
+    /// as a matrix, DataFileStream reads the frames one at a time
+    ///
+    static void readDataFile(
+        const utils::Path &path,
+        const utils::String &sizeTag,
+        utils::Matrix &data,
+        utils::Vector &time);
+
+    ///
+    /// \brief Read a bioKin file, containing kinematics data
+    /// \param path The path of the file
+    /// \param Q The generalized coordinates, one column per frame (output)
+    /// \param time The time of each frame (output)
+    ///
+    static void readQDataFile(
+        const utils::Path &path,
+        utils::Matrix &Q,
+        utils::Vector &time);
+
+    ///
+    /// \brief Read a bioMus file, containing muscle activations data
+    /// \param path The path of the file
+    /// \param activations The activations, one column per frame (output)
+    /// \param time The time of each frame (output)
+    ///
+    static void readActivationDataFile(
+        const utils::Path &path,
+        utils::Matrix &activations,
+        utils::Vector &time);
+
+    ///
+    /// \brief Read a bioTorque file containing generalized torques data
+    /// \param path The path of the file
+    /// \param torque The generalized torques, one column per frame (output)
+    /// \param time The time of each frame (output)
+    ///
+    static void readTorqueDataFile(
+        const utils::Path &path,
+        utils::Matrix &torque,
+        utils::Vector &time);
+
+    ///
+    /// \brief Read a bioGRF file containing ground reaction force (GRF) data
+    /// \param path The path of the file
+    /// \param grf The ground reaction forces, one column per frame (output)
+    /// \param time The time of each frame (output)
+    ///
+    static void readGroundReactionForceDataFile(
+        const utils::Path &path,
+        utils::Matrix &grf,
+        utils::Vector &time);
+
+    ///
+    /// \brief Read a Vicon ASCII force file
+    /// \param path The path of the file
+    /// \param data For each platform, a 10 x nbFrames matrix of the frame stamp, the center of pressure (m),
+    /// the force (N) and the moment (Nm) (output)
+    /// \param frequency The acquisition frequency of each platform (output)
+    ///
+    static void readViconForceFile(
+        const utils::Path &path,
+        std::vector<utils::Matrix> &data,
+        std::vector<size_t> &frequency);
+
     ///
     /// \brief Read a Vicon ASCII force file
     /// \param path The path of the file
@@ -231,6 +306,67 @@ protected:
         utils::RotoTrans &RT);
 };
 
+///
+/// \brief Read the frames of a bioKin, bioMus, bioTorque or bioGRF file one at a time
+///
+/// The file is mapped in memory, so only the pages of the frames being read are loaded
+///
+class BIORBD_API DataFileStream
+{
+    friend Reader;
+
+public:
+    ///
+    /// \brief Map a file and read its header
+    /// \param path The path of the file
+    /// \param sizeTag The tag of the number of variables ("nddl", "nbmuscles", "nGeneralizedTorque" or "ngrf")
+    ///
+    DataFileStream(
+        const utils::Path &path,
+        const utils::String &sizeTag);
+
+    ///
+    /// \brief Return the number of variables of each frame
+    /// \return The number of variables
+    ///
+    size_t nbVariables() const;
+
+    ///
+    /// \brief Return the number of frames of the file
+    /// \return The number of frames
+    ///
+    size_t nbFrames() const;
+
+    ///
+    /// \brief Return the index of the next frame
+    /// \return The index of the next frame
+    ///
+    size_t frame() const;
+
+    ///
+    /// \brief Read the next frame
+    /// \param time The time of the frame (output)
+    /// \param values The values of the frame, resized if needed (output)
+    /// \return False if all the frames were read
+    ///
+    bool next(
+        double &time,
+        utils::Vector &values);
+
+    ///
+    /// \brief Go back to the first frame
+    ///
+    void rewind();
+
+protected:
+    std::shared_ptr<utils::MappedFile> m_file; ///< The mapped file
+    std::shared_ptr<size_t> m_nbVariables; ///< The number of variables of each frame
+    std::shared_ptr<size_t> m_nbFrames; ///< The number of frames
+    std::shared_ptr<size_t> m_frame; ///< The index of the next frame
+    std::shared_ptr<size_t> m_firstFramePosition; ///< The position of the first frame in the file
+
+};
+
 }
 
 #endif // BIORBD_UTILS_READ_H
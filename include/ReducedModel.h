@@ -0,0 +1,126 @@
+#ifndef BIORBD_REDUCED_MODEL_H
+#define BIORBD_REDUCED_MODEL_H
+
+#include <vector>
+#include <memory>
+#include "biorbdConfig.h"
+#include "BiorbdModel.h"
+
+#ifndef BIORBD_USE_CASADI_MATH
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class String;
+class Vector;
+}
+
+///
+/// \brief A model built from another one by locking some of its DoF and pruning some of its segments
+///
+/// The locked DoF are removed from the generalized coordinates: their value is folded in the
+/// transformation from the parent to the child. When a locked rotation lies between free DoF of the
+/// same segment, the segment is split in a massless segment holding the DoF before the locked
+/// rotation (named after the segment with a "_part" suffix) and the segment itself, so the kinematics
+/// of the remaining DoF is unchanged. The pruned segments are removed with all their children.
+///
+/// The markers, the IMUs, the custom RTs and the rigid contacts attached to a removed segment are
+/// removed. A muscle is removed if one of its points is attached to a removed segment or, unless
+/// asked otherwise, if none of the remaining DoF can change its length (all its points move with the
+/// same free DoF). The muscle groups left without muscle are removed.
+///
+/// The reduced model is independent of the full model once built. Models with quaternions, loop
+/// constraints, contacts defined by a normal, soft contacts, actuators, passive torques or ligaments
+/// cannot be reduced
+///
+class BIORBD_API ReducedModel : public Model
+{
+public:
+    ///
+    /// \brief Build the reduced model
+    /// \param model The full model
+    /// \param lockedDofs The indices of the DoF to lock in the generalized coordinates of the full model
+    /// \param lockedValues The value of each locked DoF
+    /// \param prunedSegments The names of the segments to remove with their children
+    /// \param keepMusclesWithoutDof If the muscles that cannot move anymore are kept
+    ///
+    ReducedModel(
+        Model& model,
+        const std::vector<size_t>& lockedDofs,
+        const std::vector<double>& lockedValues,
+        const std::vector<utils::String>& prunedSegments = {},
+        bool keepMusclesWithoutDof = false);
+
+    ///
+    /// \brief Return the number of generalized coordinates of the full model
+    /// \return The number of generalized coordinates of the full model
+    ///
+    size_t nbQFull() const;
+
+    ///
+    /// \brief Return the index in the full model of each generalized coordinate of the reduced model
+    /// \return The indices of the DoF
+    ///
+    const std::vector<size_t>& dofIndices() const;
+
+    ///
+    /// \brief Return the index in the full model of each marker of the reduced model
+    /// \return The indices of the markers
+    ///
+    const std::vector<size_t>& markerIndices() const;
+
+    ///
+    /// \brief Return the index in the full model of each contact (axis) of the reduced model
+    /// \return The indices of the contacts
+    ///
+    const std::vector<size_t>& contactIndices() const;
+
+#ifdef MODULE_MUSCLES
+    ///
+    /// \brief Return the index in the full model of each muscle of the reduced model (all the muscle groups put together)
+    /// \return The indices of the muscles
+    ///
+    const std::vector<size_t>& muscleIndices() const;
+#endif
+
+    ///
+    /// \brief Extract the DoF of the reduced model from a vector of the full model (Q, QDot, QDDot or Tau)
+    /// \param full The vector of the full model
+    /// \return The vector of the reduced model
+    ///
+    utils::Vector reduce(
+        const utils::Vector& full) const;
+
+    ///
+    /// \brief Build the generalized coordinates of the full model, the locked DoF being set to their value
+    /// \param reducedQ The generalized coordinates of the reduced model
+    /// \return The generalized coordinates of the full model
+    ///
+    utils::Vector expandQ(
+        const utils::Vector& reducedQ) const;
+
+    ///
+    /// \brief Build a vector of the full model (QDot, QDDot or Tau), the locked DoF being set to zero
+    /// \param reduced The vector of the reduced model
+    /// \return The vector of the full model
+    ///
+    utils::Vector expand(
+        const utils::Vector& reduced) const;
+
+protected:
+#ifndef SWIG
+    std::shared_ptr<std::vector<double>> m_lockedQ; ///< The generalized coordinates of the full model with the locked values (0 for the free DoF)
+    std::shared_ptr<std::vector<size_t>> m_dofIndices; ///< The index in the full model of each DoF
+    std::shared_ptr<std::vector<size_t>> m_markerIndices; ///< The index in the full model of each marker
+    std::shared_ptr<std::vector<size_t>> m_contactIndices; ///< The index in the full model of each contact
+#ifdef MODULE_MUSCLES
+    std::shared_ptr<std::vector<size_t>> m_muscleIndices; ///< The index in the full model of each muscle
+#endif
+#endif
+
+};
+
+}
+#endif
+
+#endif // BIORBD_REDUCED_MODEL_H
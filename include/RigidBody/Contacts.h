@@ -5,6 +5,7 @@
 #include <memory>
 #include <rbdl/Constraints.h>
 #include "biorbdConfig.h"
+#include "RigidBody/RigidBodyEnums.h"
 
 namespace BIORBD_NAMESPACE
 {
@@ -25,6 +26,7 @@ class GeneralizedVelocity;
 class GeneralizedAcceleration;
 class GeneralizedTorque;
 class NodeSegment;
+class Joints;
 
 ///
 /// \brief Class Contacts
@@ -132,6 +134,27 @@ public:
         const rigidbody::GeneralizedTorque& Tau,
         rigidbody::ExternalForceSet& externalForces);
 
+    ///
+    /// \brief Compute the accelerations, the forces of all the constraints and the forces of the loop constraints from a single forward dynamics
+    /// \param Q The generalized coordinates
+    /// \param Qdot The generalized velocities
+    /// \param Tau The generalized torques
+    /// \param externalForces the external forces
+    /// \param QDDot The generalized accelerations to fill
+    /// \param constraintsForces The forces of all the constraints to fill (as getForce())
+    /// \param loopConstraintForces The forces generated by each loop closure at the predecessor in the global frame to fill
+    ///
+    /// The outputs are resized only if their dimensions are wrong, so reusing them from one call to the other does not allocate
+    ///
+    void calcConstrainedDynamics(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity& Qdot,
+        const rigidbody::GeneralizedTorque& Tau,
+        rigidbody::ExternalForceSet& externalForces,
+        rigidbody::GeneralizedAcceleration& QDDot,
+        utils::Vector& constraintsForces,
+        std::vector< utils::SpatialVector >& loopConstraintForces);
+
     ///
     /// \brief Destroy the class properly
     ///
@@ -196,6 +219,72 @@ public:
     ///
     utils::Vector getForce() const;
 
+    ///
+    /// \brief Set the solver used by the forward dynamics with constraints
+    /// \param solver The solver to use
+    ///
+    /// The direct solver factorizes the full KKT system. The range-space solver uses the
+    /// sparse factorization of the mass matrix along the kinematic tree, which pays off with
+    /// many dof and few constraints. The null-space solver pays off with many constraints.
+    /// Only the direct solver is available with CasADi
+    ///
+    void setConstraintsSolver(
+        CONSTRAINTS_SOLVER solver);
+
+    ///
+    /// \brief Return the solver used by the forward dynamics with constraints
+    /// \return The solver used by the forward dynamics with constraints
+    ///
+    CONSTRAINTS_SOLVER constraintsSolver() const;
+
+    ///
+    /// \brief Keep the factorization of the constrained system from one call to the other
+    /// \param reuse If the factorization should be kept
+    ///
+    /// When the forward dynamics with constraints is called again with the same Q, QDot and
+    /// external forces (e.g. only Tau changes inside a time step), the factorized mass matrix and
+    /// Schur complement of the constraints are reused and the solve costs O(n^2) instead of O(n^3).
+    /// This memoizes the last factorization only, there is no warm start of a different state: any
+    /// other Q, QDot or external forces factorize the system again. The kinematics are still updated
+    /// when the factorization is reused, so the functions called afterward with updateKin set to
+    /// false see the current state. The factorization must be discarded with resetFactorization()
+    /// if the inertia of the model is changed. Not available with CasADi
+    ///
+    void setFactorizationReuse(
+        bool reuse);
+
+    ///
+    /// \brief Return if the factorization of the constrained system is kept from one call to the other
+    /// \return If the factorization is kept
+    ///
+    bool factorizationReuse() const;
+
+    ///
+    /// \brief Discard the kept factorization so the next forward dynamics factorizes the system again
+    ///
+    void resetFactorization();
+
+#ifndef SWIG
+    ///
+    /// \brief Solve the forward dynamics with constraints with the selected solver, reusing the factorization if possible
+    /// \param model The model to compute the dynamics of
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param Tau The Generalized Torques
+    /// \param fExt The external forces in RBDL format
+    /// \param QDDot The Generalized Accelerations to fill
+    /// \param updateKin If the kinematics of the model should be computed
+    ///
+    void solveForwardDynamics(
+        Joints& model,
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedTorque& Tau,
+        std::vector<RigidBodyDynamics::Math::SpatialVector>& fExt,
+        GeneralizedAcceleration& QDDot,
+        bool updateKin);
+#endif
+
     ///
     /// \brief Return the segment idx of the contact in biorbd formalism
     /// \param idx The index of the contact
@@ -320,6 +409,14 @@ protected:
     std::shared_ptr<bool> m_isBinded; ///< If the model is ready
     std::shared_ptr<std::vector<rigidbody::NodeSegment>> m_rigidContacts; ///< The rigid contacts declared in the model (copy of RBDL information)
     std::shared_ptr<size_t> m_nbLoopConstraint; ///< Number of constraints
+
+#ifndef SWIG
+    class ConstraintsFactorization;
+    class LoopConstraintsWorkspace;
+    std::shared_ptr<LoopConstraintsWorkspace> m_loopConstraintsWorkspace; ///< The outputs of RBDL kept from one loop constraint force computation to the other
+    std::shared_ptr<CONSTRAINTS_SOLVER> m_solver; ///< The solver of the forward dynamics with constraints
+    std::shared_ptr<std::shared_ptr<ConstraintsFactorization>> m_factorization; ///< The kept factorization (nullptr if it is not reused)
+#endif
 };
 
 }
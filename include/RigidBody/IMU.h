@@ -9,6 +9,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class String;
 }
 
@@ -103,6 +104,13 @@ public:
 #endif
 #endif
 
+    ///
+    /// \brief Add the memory held by the IMU to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     std::shared_ptr<bool> m_technical; ///< If a IMU is a technical IMU
     std::shared_ptr<bool> m_anatomical; ///< It IMU is a anatomical IMU
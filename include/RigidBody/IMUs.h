@@ -157,6 +157,20 @@ public:
         size_t  idx,
         bool updateKin = true);
 
+    ///
+    /// \brief Compute all the inertial measurement units (IMU) at the position given by Q into a matrix
+    /// \param Q The generalized coordinates
+    /// \param rotoTrans The matrix (4 x 4*nbIMUs) to fill. It is resized only if its dimensions are wrong
+    /// \param updateKin If the model should be updated
+    ///
+    /// The 4x4 block starting at column 4*i is the homogeneous matrix of the IMU i.
+    /// Contrary to IMU(Q), no IMU is created so filling an already sized matrix does not allocate
+    ///
+    void IMUInMatrix(
+        const GeneralizedCoordinates& Q,
+        utils::Matrix& rotoTrans,
+        bool updateKin = true);
+
     ///
     /// \brief Return the number of technical inertial measurement units (IMU)
     /// \return The number of technical IMU
@@ -234,8 +248,16 @@ protected:
         bool updateKin,
         bool lookForTechnical);
 
+    ///
+    /// \brief Return the index of the parent segment of each IMU, resolving them if IMUs were added since
+    /// \return The segment index of each IMU
+    ///
+    const std::vector<size_t>& IMUsSegmentIdx();
+
     std::shared_ptr<std::vector<rigidbody::IMU>>
             m_IMUs; ///< All the inertial Measurement Units
+    std::shared_ptr<std::vector<size_t>>
+            m_IMUsSegmentIdx; ///< Index of the parent segment of each IMU, resolved once
 
 };
 
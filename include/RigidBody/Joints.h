@@ -2,6 +2,7 @@
 #define BIORBD_RIGIDBODY_JOINTS_H
 
 #include <memory>
+#include <unordered_map>
 #include <rbdl/Model.h>
 #include <rbdl/Constraints.h>
 #include "biorbdConfig.h"
@@ -33,6 +34,7 @@ class Segment;
 class SegmentCharacteristics;
 class Mesh;
 class Contacts;
+class KinematicsResults;
 
 ///
 /// \brief This is the core of the musculoskeletal model in biorbd
@@ -138,7 +140,9 @@ public:
     ///
     /// \brief Return the biorbd body identification
     /// \param segmentName The name of the segment
-    /// \return The biorbd body identification
+    /// \return The biorbd body identification (-1 if the segment does not exist)
+    ///
+    /// The names are indexed when the segments are added, so this is a hash lookup
     ///
     int getBodyBiorbdId(
         const utils::String &segmentName) const;
@@ -146,7 +150,9 @@ public:
     ///
     /// \brief Return the rbdl body identification
     /// \param segmentName The name of the segment
-    /// \return The rbdl body identification
+    /// \return The rbdl body identification (std::numeric_limits<unsigned int>::max() if the body does not exist)
+    ///
+    /// Same as GetBodyId, but the segments are found from the name index of the model
     ///
     int getBodyRbdlId(
         const utils::String &segmentName) const;
@@ -255,18 +261,31 @@ public:
     /// \param idx The index of the segment to change
     /// \param characteristics The new characteristics
     ///
-    /// Warning: This function may behave surpringly due to the core of RBDL. The
-    /// new characteristic values will replace everything which is attach in a fixed manner
-    /// (that is no degrees-of-freedom). So if your model has 3 segments, but only the first
-    /// one has dof (and the rest is rigidly attached to the first), then it doesn't matter
-    /// if idx is 0, 1 or 2, because RBDL considers that all these segment are 1 segment.
-    /// It is therefore expected that characteristics is the combination of mass and
-    /// inertia for these 3 segments as well.
+    /// RBDL considers a segment and the segments rigidly attached to it (that is without
+    /// degrees-of-freedom) as one body. That body is rebuilt from the characteristics of all
+    /// these segments, so characteristics are the ones of the segment idx only
     ///
     void updateSegmentCharacteristics(
         size_t idx,
         const SegmentCharacteristics& characteristics);
 
+    ///
+    /// \brief updateSegmentInertia Change the mass, the center of mass and the inertia of the segment idx
+    /// \param idx The index of the segment to change
+    /// \param mass The new mass
+    /// \param com The new position of the center of mass
+    /// \param inertia The new inertia matrix
+    ///
+    /// This is the lightweight version of updateSegmentCharacteristics (the mesh and the other
+    /// characteristics are neither copied nor changed), so it can be called at each evaluation
+    /// when the inertial parameters are identified or swept. The body of RBDL is rebuilt the same way
+    ///
+    void updateSegmentInertia(
+        size_t idx,
+        const utils::Scalar& mass,
+        const utils::Vector3d& com,
+        const utils::Matrix3d& inertia);
+
 
     ///
     /// \brief Get a segment of index idx
@@ -880,6 +899,30 @@ public:
     bool updateKin = true);
 
 
+    // ---- FUSED KINEMATICS ---- //
+
+    ///
+    /// \brief Compute several kinematic quantities from a single update of the kinematics
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities (can be nullptr if no quantity needs it)
+    /// \param QDDot The Generalized Accelerations (can be nullptr if no quantity needs it)
+    /// \param quantities The requested quantities, a combination of KINEMATICS_QUANTITY
+    /// \param results The results to fill
+    /// \param updateKin If the kinematics should be updated (the velocities and accelerations too if they are required)
+    ///
+    /// The positions, velocities and accelerations of the bodies are computed once and all the
+    /// requested quantities are gathered from them in a single loop over the bodies.
+    /// The markers are only filled by Model::evaluate
+    ///
+    void evaluate(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity* QDot,
+        const GeneralizedAcceleration* QDDot,
+        int quantities,
+        KinematicsResults& results,
+        bool updateKin = true);
+
+
     // ---- DYNAMIC INTERFACE ---- //
 
     ///
@@ -1025,6 +1068,23 @@ public:
         Contacts& CS,
         rigidbody::ExternalForceSet& externalForces
     );
+    ///
+    /// \brief Interface for the forward dynamics with contact of RBDL, filling already allocated accelerations
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param Tau The Generalized Torques
+    /// \param CS The Constraint set that will be filled
+    /// \param externalForces External force acting on the system if there are any
+    /// \param QDDot The Generalized Accelerations to fill
+    ///
+    void ForwardDynamicsConstraintsDirect(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedTorque& Tau,
+        Contacts& CS,
+        rigidbody::ExternalForceSet& externalForces,
+        GeneralizedAcceleration& QDDot
+    );
 
     ///
     /// \brief Interface for contacts of the forward dynamics with contact of RBDL
@@ -1074,9 +1134,208 @@ public:
         const GeneralizedCoordinates& Q,
         const GeneralizedVelocity& QDotPre);
 
+#ifndef BIORBD_USE_CASADI_MATH
+    ///
+    /// \brief Analytical derivatives of the inverse dynamics, computed in a single pass over the tree
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param QDDot The Generalized Accelerations
+    /// \param dTau_dQ The derivatives of the Generalized Torques with respect to Q (nbGeneralizedTorque x nbQ)
+    /// \param dTau_dQdot The derivatives of the Generalized Torques with respect to QDot (nbGeneralizedTorque x nbQdot)
+    /// \param dTau_dQddot The derivatives of the Generalized Torques with respect to QDDot (i.e. the mass matrix)
+    /// \return The Generalized Torques
+    ///
+    /// Only models without quaternions are supported
+    ///
+    GeneralizedTorque InverseDynamicsDerivatives(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedAcceleration& QDDot,
+        utils::Matrix& dTau_dQ,
+        utils::Matrix& dTau_dQdot,
+        utils::Matrix& dTau_dQddot);
+
+    ///
+    /// \brief Analytical derivatives of the inverse dynamics, computed in a single pass over the tree
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param QDDot The Generalized Accelerations
+    /// \param externalForces External force acting on the system if there are any
+    /// \param dTau_dQ The derivatives of the Generalized Torques with respect to Q (nbGeneralizedTorque x nbQ)
+    /// \param dTau_dQdot The derivatives of the Generalized Torques with respect to QDot (nbGeneralizedTorque x nbQdot)
+    /// \param dTau_dQddot The derivatives of the Generalized Torques with respect to QDDot (i.e. the mass matrix)
+    /// \param dTau_dFext The derivatives of the Generalized Torques with respect to the external forces
+    /// (nbGeneralizedTorque x 6 times the number of RBDL bodies, the root included), the columns being ordered
+    /// as the spatial vectors of ExternalForceSet
+    /// \return The Generalized Torques
+    ///
+    /// The external forces are differentiated as constant spatial vectors expressed in the global reference frame.
+    /// Their own dependency on Q and QDot (forces in local reference frame, soft contacts) is not accounted for.
+    ///
+    GeneralizedTorque InverseDynamicsDerivatives(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedAcceleration& QDDot,
+        rigidbody::ExternalForceSet& externalForces,
+        utils::Matrix& dTau_dQ,
+        utils::Matrix& dTau_dQdot,
+        utils::Matrix& dTau_dQddot,
+        utils::Matrix& dTau_dFext);
+
+    ///
+    /// \brief Analytical derivatives of the forward dynamics
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param Tau The Generalized Torques
+    /// \param dQddot_dQ The derivatives of the Generalized Accelerations with respect to Q
+    /// \param dQddot_dQdot The derivatives of the Generalized Accelerations with respect to QDot
+    /// \param dQddot_dTau The derivatives of the Generalized Accelerations with respect to Tau (i.e. the inverse of the mass matrix)
+    /// \return The Generalized Accelerations
+    ///
+    /// Only models without quaternions are supported
+    ///
+    GeneralizedAcceleration ForwardDynamicsDerivatives(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedTorque& Tau,
+        utils::Matrix& dQddot_dQ,
+        utils::Matrix& dQddot_dQdot,
+        utils::Matrix& dQddot_dTau);
+
+    ///
+    /// \brief Analytical derivatives of the forward dynamics
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param Tau The Generalized Torques
+    /// \param externalForces External force acting on the system if there are any
+    /// \param dQddot_dQ The derivatives of the Generalized Accelerations with respect to Q
+    /// \param dQddot_dQdot The derivatives of the Generalized Accelerations with respect to QDot
+    /// \param dQddot_dTau The derivatives of the Generalized Accelerations with respect to Tau (i.e. the inverse of the mass matrix)
+    /// \param dQddot_dFext The derivatives of the Generalized Accelerations with respect to the external forces
+    /// (same columns as for InverseDynamicsDerivatives)
+    /// \return The Generalized Accelerations
+    ///
+    /// The kinematics are updated once. The Generalized Accelerations and their derivatives are then
+    /// both computed from the inverse dynamics pass.
+    ///
+    GeneralizedAcceleration ForwardDynamicsDerivatives(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedTorque& Tau,
+        rigidbody::ExternalForceSet& externalForces,
+        utils::Matrix& dQddot_dQ,
+        utils::Matrix& dQddot_dQdot,
+        utils::Matrix& dQddot_dTau,
+        utils::Matrix& dQddot_dFext);
+
+    ///
+    /// \brief Analytical derivatives of the forward dynamics with contact
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param Tau The Generalized Torques
+    /// \param dQddot_dQ The derivatives of the Generalized Accelerations with respect to Q
+    /// \param dQddot_dQdot The derivatives of the Generalized Accelerations with respect to QDot
+    /// \param dQddot_dTau The derivatives of the Generalized Accelerations with respect to Tau
+    /// \return The Generalized Accelerations
+    ///
+    /// Only the rigid contacts are supported, loop constraints are not
+    ///
+    GeneralizedAcceleration ForwardDynamicsConstraintsDirectDerivatives(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedTorque& Tau,
+        utils::Matrix& dQddot_dQ,
+        utils::Matrix& dQddot_dQdot,
+        utils::Matrix& dQddot_dTau);
+
+    ///
+    /// \brief Analytical derivatives of the forward dynamics with contact
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param Tau The Generalized Torques
+    /// \param externalForces External force acting on the system if there are any
+    /// \param dQddot_dQ The derivatives of the Generalized Accelerations with respect to Q
+    /// \param dQddot_dQdot The derivatives of the Generalized Accelerations with respect to QDot
+    /// \param dQddot_dTau The derivatives of the Generalized Accelerations with respect to Tau
+    /// \param dQddot_dFext The derivatives of the Generalized Accelerations with respect to the external forces
+    /// \return The Generalized Accelerations
+    ///
+    GeneralizedAcceleration ForwardDynamicsConstraintsDirectDerivatives(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedTorque& Tau,
+        rigidbody::ExternalForceSet& externalForces,
+        utils::Matrix& dQddot_dQ,
+        utils::Matrix& dQddot_dQdot,
+        utils::Matrix& dQddot_dTau,
+        utils::Matrix& dQddot_dFext);
+#endif
+
 protected:
+#if !defined(SWIG) && !defined(BIORBD_USE_CASADI_MATH)
+    ///
+    /// \brief Internal structure holding the quantities of the recursive Newton-Euler algorithm
+    /// and its derivatives. All the spatial quantities are expressed in the global reference frame.
+    ///
+    class DynamicsDerivativesInternal {
+    public:
+        void resize(size_t nbBodies, unsigned int nbDof) {
+            s.resize(nbBodies);
+            v.resize(nbBodies);
+            a.resize(nbBodies);
+            dVdq.resize(nbBodies);
+            dAdq.resize(nbBodies);
+            dAdv.resize(nbBodies);
+            f.resize(nbBodies);
+            fExt.resize(nbBodies);
+            Ic.resize(nbBodies);
+            Bc.resize(nbBodies);
+            tau = RigidBodyDynamics::Math::VectorNd::Zero(nbDof);
+            dTau_dQ = RigidBodyDynamics::Math::MatrixNd::Zero(nbDof, nbDof);
+            dTau_dQdot = RigidBodyDynamics::Math::MatrixNd::Zero(nbDof, nbDof);
+            massMatrix = RigidBodyDynamics::Math::MatrixNd::Zero(nbDof, nbDof);
+            dTau_dFext = RigidBodyDynamics::Math::MatrixNd::Zero(nbDof, 6 * static_cast<unsigned int>(nbBodies));
+        }
+
+        std::vector<RigidBodyDynamics::Math::SpatialVector> s; ///< Joint motion subspaces
+        std::vector<RigidBodyDynamics::Math::SpatialVector> v; ///< Body velocities
+        std::vector<RigidBodyDynamics::Math::SpatialVector> a; ///< Body accelerations (including gravity)
+        std::vector<RigidBodyDynamics::Math::SpatialVector> dVdq; ///< Derivative of the body velocities with respect to its own joint
+        std::vector<RigidBodyDynamics::Math::SpatialVector> dAdq; ///< Derivative of the body accelerations with respect to its own joint position
+        std::vector<RigidBodyDynamics::Math::SpatialVector> dAdv; ///< Derivative of the body accelerations with respect to its own joint velocity
+        std::vector<RigidBodyDynamics::Math::SpatialVector> f; ///< Forces transmitted by the joints (accumulated over the subtrees)
+        std::vector<RigidBodyDynamics::Math::SpatialVector> fExt; ///< External forces (accumulated over the subtrees)
+        std::vector<RigidBodyDynamics::Math::SpatialMatrix> Ic; ///< Composite inertias
+        std::vector<RigidBodyDynamics::Math::SpatialMatrix> Bc; ///< Composite Coriolis matrices
+        RigidBodyDynamics::Math::VectorNd tau; ///< The Generalized Torques
+        RigidBodyDynamics::Math::MatrixNd dTau_dQ; ///< Derivatives of the torques with respect to Q
+        RigidBodyDynamics::Math::MatrixNd dTau_dQdot; ///< Derivatives of the torques with respect to QDot
+        RigidBodyDynamics::Math::MatrixNd massMatrix; ///< Derivatives of the torques with respect to QDDot
+        RigidBodyDynamics::Math::MatrixNd dTau_dFext; ///< Derivatives of the torques with respect to the external forces
+    };
+
+    ///
+    /// \brief Compute the inverse dynamics and its derivatives
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized Velocities
+    /// \param QDDot The Generalized Accelerations
+    /// \param fExt The external forces (one spatial vector in global reference frame per body)
+    /// \param derivatives The structure to fill
+    /// \param updateKin If the kinematics of the model should be updated at Q
+    ///
+    void computeInverseDynamicsDerivatives(
+        const GeneralizedCoordinates& Q,
+        const GeneralizedVelocity& QDot,
+        const GeneralizedAcceleration& QDDot,
+        const std::vector<RigidBodyDynamics::Math::SpatialVector>& fExt,
+        DynamicsDerivativesInternal& derivatives,
+        bool updateKin = true);
+#endif
+
     std::shared_ptr<std::vector<Segment>>
             m_segments; ///< All the articulations
+    std::shared_ptr<std::unordered_map<std::string, size_t>>
+            m_segmentsIndex; ///< The biorbd index of the segments by name
 
     std::shared_ptr<size_t>
     m_nbRoot; ///< The number of DoF on the root segment
@@ -0,0 +1,83 @@
+#ifndef BIORBD_RIGIDBODY_KALMAN_RECONS_MARKERS_TRIALS_H
+#define BIORBD_RIGIDBODY_KALMAN_RECONS_MARKERS_TRIALS_H
+
+#include <vector>
+#include <memory>
+#include "biorbdConfig.h"
+#include "RigidBody/KalmanRecons.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class Path;
+class ThreadPool;
+template<typename T> class ThreadLocal;
+}
+
+namespace rigidbody
+{
+
+///
+/// \brief Kalman reconstruction of the markers of many independent trials in parallel
+///
+/// The trials are shared among the threads of a pool. Each thread loads its own copy of the model
+/// and each trial is reconstructed by a new filter, so the result of a trial does not depend on
+/// the other trials nor on the number of threads
+///
+class BIORBD_API KalmanReconsMarkersTrials
+{
+public:
+    ///
+    /// \brief Load a model for each thread
+    /// \param path The path of the model
+    /// \param params The Kalman filter parameters, used for all the trials
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    KalmanReconsMarkersTrials(
+        const utils::Path& path,
+        const KalmanParam& params = KalmanParam(),
+        size_t nbThreads = 0);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~KalmanReconsMarkersTrials();
+
+    ///
+    /// \brief Return the number of threads
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Reconstruct the kinematics of each trial
+    /// \param markers The technical markers of each frame of each trial, in a column-major vector
+    /// \param Q The generalized coordinates of each frame of each trial
+    /// \param Qdot The generalized velocities of each frame of each trial (ignored if nullptr)
+    /// \param Qddot The generalized accelerations of each frame of each trial (ignored if nullptr)
+    /// \param removeAxes If the algo should ignore or not the removeAxis defined in the bioMod file
+    ///
+    void reconstructTrials(
+        const std::vector<std::vector<utils::Vector>>& markers,
+        std::vector<std::vector<GeneralizedCoordinates>>& Q,
+        std::vector<std::vector<GeneralizedVelocity>>* Qdot = nullptr,
+        std::vector<std::vector<GeneralizedAcceleration>>* Qddot = nullptr,
+        bool removeAxes = true);
+
+protected:
+#ifndef SWIG
+    std::shared_ptr<KalmanParam> m_params; ///< The parameters of the filters
+    std::shared_ptr<utils::ThreadPool> m_pool; ///< The threads
+    std::shared_ptr<utils::ThreadLocal<Model>> m_models; ///< A model per thread
+#endif
+
+private:
+    KalmanReconsMarkersTrials(const KalmanReconsMarkersTrials&);
+    KalmanReconsMarkersTrials& operator=(const KalmanReconsMarkersTrials&);
+};
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_KALMAN_RECONS_MARKERS_TRIALS_H
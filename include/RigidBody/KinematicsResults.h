@@ -0,0 +1,40 @@
+#ifndef BIORBD_RIGIDBODY_KINEMATICS_RESULTS_H
+#define BIORBD_RIGIDBODY_KINEMATICS_RESULTS_H
+
+#include <vector>
+#include "biorbdConfig.h"
+#include "Utils/Scalar.h"
+#include "Utils/Matrix.h"
+#include "Utils/Vector3d.h"
+#include "Utils/RotoTrans.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace rigidbody
+{
+
+///
+/// \brief The quantities computed by evaluate
+///
+/// Only the quantities requested in the bitmask are updated, the others keep their previous value.
+/// The containers are only resized when their dimensions are wrong, so the same results can be
+/// passed frame after frame without allocating
+///
+class BIORBD_API KinematicsResults
+{
+public:
+    utils::Matrix m_markers; ///< The markers in the global reference frame (3 x nbMarkers)
+    utils::Vector3d m_CoM; ///< The position of the center of mass
+    utils::Vector3d m_CoMdot; ///< The velocity of the center of mass
+    utils::Vector3d m_CoMddot; ///< The acceleration of the center of mass
+    utils::Matrix m_segmentsAngularMomentum; ///< The angular momentum of each body about the center of mass (3 x nbBodies, same order as CalcSegmentsAngularMomentum)
+    utils::Vector3d m_angularMomentum; ///< The angular momentum of the model about the center of mass
+    utils::Scalar m_kineticEnergy; ///< The kinetic energy
+    utils::Scalar m_potentialEnergy; ///< The potential energy
+    std::vector<utils::RotoTrans> m_globalJCS; ///< The joint coordinate system of each segment in the global reference frame
+};
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_KINEMATICS_RESULTS_H
@@ -315,6 +315,76 @@ public:
         bool removeAxis=true,
         bool updateKin = true);
 
+    ///
+    /// \brief Compute all the markers at a given Q in the global reference frame into a matrix
+    /// \param Q The generalized coordinates
+    /// \param positions The matrix (3 x nbMarkers) to fill. It is resized only if its dimensions are wrong
+    /// \param removeAxis If there are axis to remove from the position variables
+    /// \param updateKin If the model should be updated
+    ///
+    /// Contrary to markers(), no NodeSegment is created so filling an already sized matrix does not
+    /// allocate. The column i is the marker i, use markerNames() to get their names.
+    ///
+    void markersInMatrix(
+        const GeneralizedCoordinates &Q,
+        utils::Matrix& positions,
+        bool removeAxis = true,
+        bool updateKin = true);
+
+    ///
+    /// \brief Return all the markers at a given Q in the global reference frame in a matrix
+    /// \param Q The generalized coordinates
+    /// \param removeAxis If there are axis to remove from the position variables
+    /// \param updateKin If the model should be updated
+    /// \return The markers (3 x nbMarkers) in the global reference frame
+    ///
+    utils::Matrix markersInMatrix(
+        const GeneralizedCoordinates &Q,
+        bool removeAxis = true,
+        bool updateKin = true);
+
+    ///
+    /// \brief Compute the technical markers at a given Q in the global reference frame into a matrix
+    /// \param Q The generalized coordinates
+    /// \param positions The matrix (3 x nbTechnicalMarkers) to fill. It is resized only if its dimensions are wrong
+    /// \param removeAxis If there are axis to remove from the position variables
+    /// \param updateKin If the model should be updated
+    ///
+    /// The column i is the marker technicalMarkersIndices()[i]
+    ///
+    void technicalMarkersInMatrix(
+        const GeneralizedCoordinates &Q,
+        utils::Matrix& positions,
+        bool removeAxis = true,
+        bool updateKin = true);
+
+    ///
+    /// \brief Compute the anatomical markers at a given Q in the global reference frame into a matrix
+    /// \param Q The generalized coordinates
+    /// \param positions The matrix (3 x nbAnatomicalMarkers) to fill. It is resized only if its dimensions are wrong
+    /// \param removeAxis If there are axis to remove from the position variables
+    /// \param updateKin If the model should be updated
+    ///
+    /// The column i is the marker anatomicalMarkersIndices()[i]
+    ///
+    void anatomicalMarkersInMatrix(
+        const GeneralizedCoordinates &Q,
+        utils::Matrix& positions,
+        bool removeAxis = true,
+        bool updateKin = true);
+
+    ///
+    /// \brief Return the indices of the technical markers in the marker set
+    /// \return The indices of the technical markers
+    ///
+    const std::vector<size_t>& technicalMarkersIndices();
+
+    ///
+    /// \brief Return the indices of the anatomical markers in the marker set
+    /// \return The indices of the anatomical markers
+    ///
+    const std::vector<size_t>& anatomicalMarkersIndices();
+
     ///
     /// \brief Return the number of markers
     /// \return The number of markers
@@ -419,6 +489,35 @@ protected:
     std::shared_ptr<std::vector<NodeSegment>>
             m_marks; ///< The markers
 
+#ifndef SWIG
+    ///
+    /// \brief Metadata of the markers that is resolved once for the matrix queries
+    ///
+    class MarkersIndex;
+    std::shared_ptr<MarkersIndex> m_markersIndex; ///< The resolved metadata of the markers
+
+    ///
+    /// \brief Return the resolved metadata of the markers, resolving it if the markers changed since
+    /// (every function that modifies the markers discards it)
+    /// \return The metadata of the markers
+    ///
+    MarkersIndex& markersIndex();
+
+    ///
+    /// \brief Compute a subset of the markers into a matrix
+    /// \param Q The generalized coordinates
+    /// \param indices The indices of the markers to compute
+    /// \param positions The matrix to fill
+    /// \param removeAxis If there are axis to remove from the position variables
+    /// \param updateKin If the model should be updated
+    ///
+    void markersInMatrix(
+        const GeneralizedCoordinates &Q,
+        const std::vector<size_t>& indices,
+        utils::Matrix& positions,
+        bool removeAxis,
+        bool updateKin);
+#endif
 };
 
 }
@@ -0,0 +1,148 @@
+#ifndef BIORBD_RIGIDBODY_MARKERS_INVERSE_KINEMATICS_H
+#define BIORBD_RIGIDBODY_MARKERS_INVERSE_KINEMATICS_H
+
+#include <vector>
+#include <memory>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+class Model;
+
+namespace utils
+{
+class Matrix;
+class Vector;
+class ThreadPool;
+}
+
+namespace rigidbody
+{
+class GeneralizedCoordinates;
+
+#ifndef BIORBD_USE_CASADI_MATH
+///
+/// \brief Levenberg-Marquardt inverse kinematics of the technical markers over a whole trial
+///
+/// The body and the local position of each technical marker, the weights and the bounds of
+/// the generalized coordinates are gathered once at construction. Each frame is warm-started
+/// from the solution of the previous frame. The markers with a NaN coordinate are ignored for
+/// that frame and the generalized coordinates are kept within the QRanges of the segments
+/// (the quaternions are not bounded).
+///
+/// The frames of a trial are cut into contiguous blocks, one per thread, that are solved in
+/// parallel. Each thread works on its own copy of the kinematic model
+///
+class BIORBD_API MarkersInverseKinematics
+{
+public:
+    ///
+    /// \brief Prepare the inverse kinematics of a model
+    /// \param model The model, it is copied for each thread so it can be modified afterward
+    /// \param removeAxes If the markers should be projected on the axes
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    MarkersInverseKinematics(
+        Model& model,
+        bool removeAxes = true,
+        size_t nbThreads = 1);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~MarkersInverseKinematics();
+
+    ///
+    /// \brief Return the number of technical markers to track
+    /// \return The number of technical markers
+    ///
+    size_t nbMarkers() const;
+
+    ///
+    /// \brief Return the number of threads
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Set the weight of each technical marker (all 1 by default)
+    /// \param weights The weights, which multiply the distance between the model and the measured markers
+    ///
+    void setWeights(
+        const utils::Vector& weights);
+
+    ///
+    /// \brief Set the maximal number of iterations per frame
+    /// \param maxIterations The maximal number of iterations
+    ///
+    void setMaxIterations(
+        size_t maxIterations);
+
+    ///
+    /// \brief Set the convergence tolerance on the norm of the step
+    /// \param tolerance The tolerance
+    ///
+    void setTolerance(
+        double tolerance);
+
+    ///
+    /// \brief Set if the generalized coordinates are bounded by the QRanges of the segments (true by default)
+    /// \param useQRanges If the bounds are used
+    ///
+    void setUseQRanges(
+        bool useQRanges);
+
+    ///
+    /// \brief Track the technical markers of a frame
+    /// \param markers The measured technical markers (3 x nbMarkers)
+    /// \param Q The initial guess, filled with the solution
+    /// \return If the frame converged
+    ///
+    bool solveFrame(
+        const utils::Matrix& markers,
+        GeneralizedCoordinates& Q);
+
+    ///
+    /// \brief Track the technical markers of each frame of a trial
+    /// \param markers The measured technical markers of each frame (3 x nbMarkers)
+    /// \param Qinit The initial guess of the first frame of each block
+    /// \param Q The solution of each frame
+    /// \return The number of frames that converged
+    ///
+    size_t solveTrial(
+        const std::vector<utils::Matrix>& markers,
+        const GeneralizedCoordinates& Qinit,
+        std::vector<GeneralizedCoordinates>& Q);
+
+protected:
+#ifndef SWIG
+    class Problem;
+    class Workspace;
+
+    ///
+    /// \brief Solve a frame with the workspace of a thread
+    /// \param workspace The workspace of the thread
+    /// \param markers The measured technical markers (3 x nbMarkers)
+    /// \param Q The initial guess, filled with the solution
+    /// \return If the frame converged
+    ///
+    bool solveFrame(
+        Workspace& workspace,
+        const utils::Matrix& markers,
+        GeneralizedCoordinates& Q) const;
+
+    std::shared_ptr<Problem> m_problem; ///< The markers, their weights, the bounds and the settings
+    std::vector<std::shared_ptr<Workspace>> m_workspaces; ///< The model copy and the buffers of each thread
+    std::shared_ptr<utils::ThreadPool> m_pool; ///< The threads
+#endif
+
+private:
+    MarkersInverseKinematics(const MarkersInverseKinematics&);
+    MarkersInverseKinematics& operator=(const MarkersInverseKinematics&);
+};
+#endif
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_MARKERS_INVERSE_KINEMATICS_H
@@ -9,6 +9,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class Vector3d;
 class RotoTrans;
 class Path;
@@ -171,6 +172,13 @@ public:
     ///
     const utils::Path& path() const;
 
+    ///
+    /// \brief Add the memory held by the mesh to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     std::shared_ptr<utils::RotoTrans> m_rotation; ///< The rotation
     std::shared_ptr<std::vector<utils::Vector3d>> m_vertex; ///< The vertex
@@ -0,0 +1,229 @@
+#ifndef BIORBD_RIGIDBODY_MESH_COLLISIONS_H
+#define BIORBD_RIGIDBODY_MESH_COLLISIONS_H
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class String;
+class Vector3d;
+class RotoTrans;
+class ThreadPool;
+template<typename T> class ThreadLocal;
+}
+
+namespace rigidbody
+{
+class Joints;
+class GeneralizedCoordinates;
+class MeshHierarchy;
+
+#ifndef BIORBD_USE_CASADI_MATH
+///
+/// \brief Distance and penetration between the meshes of the segments
+///
+/// A bounding volume hierarchy (a tree of axis aligned boxes in the reference frame of the segment)
+/// is built once for the mesh of each segment that has faces. Afterward, only the transformation of
+/// the segments (as given by allGlobalJCS) is updated for each frame, the hierarchies are never rebuilt.
+///
+/// The distance is the smallest distance between the surfaces of two meshes, it is 0 when they
+/// intersect or when one mesh is inside the other. The penetration is the depth of the deepest vertex
+/// of a mesh inside the other one (the largest of the two directions), it is 0 when they do not
+/// overlap. The inside test assumes the meshes are closed.
+///
+/// The pairs of segments to evaluate are selected with addPair. The broad phase tests the bounding
+/// boxes of all the pairs of meshes, so it can be used to find the pairs worth evaluating.
+///
+/// The frames of a trajectory are shared among the threads of a pool, each thread computing the
+/// kinematics on its own copy of the model
+///
+class BIORBD_API MeshCollisions
+{
+public:
+    ///
+    /// \brief Build the hierarchy of each mesh of a model
+    /// \param model The model, it is copied for each thread (the segments and their meshes are shared)
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    MeshCollisions(
+        Joints& model,
+        size_t nbThreads = 1);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~MeshCollisions();
+
+    ///
+    /// \brief Return the number of threads
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Return the number of segments having a mesh with faces
+    /// \return The number of meshes
+    ///
+    size_t nbMeshes() const;
+
+    ///
+    /// \brief Return if a segment has a mesh with faces
+    /// \param segment The index of the segment
+    /// \return If the segment has a mesh
+    ///
+    bool hasMesh(
+        size_t segment) const;
+
+    ///
+    /// \brief Select a pair of segments to evaluate
+    /// \param segment1 The index of the first segment
+    /// \param segment2 The index of the second segment
+    ///
+    void addPair(
+        size_t segment1,
+        size_t segment2);
+
+    ///
+    /// \brief Select a pair of segments to evaluate
+    /// \param segment1 The name of the first segment
+    /// \param segment2 The name of the second segment
+    ///
+    void addPair(
+        const utils::String& segment1,
+        const utils::String& segment2);
+
+    ///
+    /// \brief Return the number of pairs to evaluate
+    /// \return The number of pairs
+    ///
+    size_t nbPairs() const;
+
+    ///
+    /// \brief Return a pair of segments to evaluate
+    /// \param idx The index of the pair
+    /// \return The indices of the segments
+    ///
+    const std::pair<size_t, size_t>& pair(
+        size_t idx) const;
+
+    ///
+    /// \brief Set the transformation of the segments
+    /// \param jcs The reference frame of each segment in the global reference frame (as given by allGlobalJCS)
+    ///
+    void updateTransforms(
+        const std::vector<utils::RotoTrans>& jcs);
+
+    ///
+    /// \brief Compute the kinematics and set the transformation of the segments
+    /// \param model The model
+    /// \param Q The generalized coordinates
+    ///
+    void updateKinematics(
+        Joints& model,
+        const GeneralizedCoordinates& Q);
+
+    ///
+    /// \brief Return the pairs of segments whose bounding boxes overlap (all the pairs of meshes are tested)
+    /// \param margin The distance under which two boxes are considered overlapping
+    /// \return The indices of the segments of each pair
+    ///
+    std::vector<std::pair<size_t, size_t>> broadPhase(
+        double margin = 0) const;
+
+    ///
+    /// \brief Return the distance between the meshes of two segments
+    /// \param segment1 The index of the first segment
+    /// \param segment2 The index of the second segment
+    /// \param point1 The closest point of the first mesh in the global reference frame (ignored if nullptr)
+    /// \param point2 The closest point of the second mesh in the global reference frame (ignored if nullptr)
+    /// \param maxDistance The distance above which the search stops (maxDistance is returned and the points are not set)
+    /// \return The distance
+    ///
+    double distance(
+        size_t segment1,
+        size_t segment2,
+        utils::Vector3d* point1 = nullptr,
+        utils::Vector3d* point2 = nullptr,
+        double maxDistance = std::numeric_limits<double>::infinity()) const;
+
+    ///
+    /// \brief Return the penetration of the meshes of two segments
+    /// \param segment1 The index of the first segment
+    /// \param segment2 The index of the second segment
+    /// \return The penetration depth
+    ///
+    double penetration(
+        size_t segment1,
+        size_t segment2) const;
+
+    ///
+    /// \brief Evaluate the selected pairs
+    /// \param distances The distance of each pair
+    /// \param penetrations The penetration of each pair (ignored if nullptr)
+    /// \param maxDistance The distance above which the search stops
+    ///
+    void evaluatePairs(
+        std::vector<double>& distances,
+        std::vector<double>* penetrations = nullptr,
+        double maxDistance = std::numeric_limits<double>::infinity()) const;
+
+    ///
+    /// \brief Evaluate the selected pairs at each frame of a trajectory
+    /// \param Q The generalized coordinates of each frame
+    /// \param distances The distance of each pair at each frame
+    /// \param penetrations The penetration of each pair at each frame (ignored if nullptr)
+    /// \param maxDistance The distance above which the search stops
+    ///
+    /// The transformation of the segments set by updateTransforms is not modified
+    ///
+    void evaluateTrajectory(
+        const std::vector<GeneralizedCoordinates>& Q,
+        std::vector<std::vector<double>>& distances,
+        std::vector<std::vector<double>>* penetrations = nullptr,
+        double maxDistance = std::numeric_limits<double>::infinity());
+
+protected:
+#ifndef SWIG
+    std::shared_ptr<std::vector<std::shared_ptr<MeshHierarchy>>> m_hierarchies; ///< The hierarchy of each segment (nullptr if the segment has no mesh)
+    std::shared_ptr<std::vector<utils::RotoTrans>> m_jcs; ///< The transformation of each segment
+    std::shared_ptr<std::vector<std::pair<size_t, size_t>>> m_pairs; ///< The pairs of segments to evaluate
+    std::shared_ptr<utils::ThreadPool> m_pool; ///< The threads
+    std::shared_ptr<utils::ThreadLocal<Joints>> m_models; ///< The copy of the model of each thread
+
+    ///
+    /// \brief Return the hierarchy of a segment, raise an error if it has no mesh
+    /// \param segment The index of the segment
+    /// \return The hierarchy
+    ///
+    const MeshHierarchy& hierarchy(
+        size_t segment) const;
+
+    ///
+    /// \brief Evaluate the selected pairs with a given set of transformations
+    /// \param jcs The transformation of each segment
+    /// \param distances The distance of each pair
+    /// \param penetrations The penetration of each pair (ignored if nullptr)
+    /// \param maxDistance The distance above which the search stops
+    ///
+    void evaluatePairs(
+        const std::vector<utils::RotoTrans>& jcs,
+        double* distances,
+        double* penetrations,
+        double maxDistance) const;
+#endif
+
+private:
+    MeshCollisions(const MeshCollisions&);
+    MeshCollisions& operator=(const MeshCollisions&);
+};
+#endif
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_MESH_COLLISIONS_H
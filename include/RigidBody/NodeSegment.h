@@ -9,6 +9,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class String;
 }
 
@@ -226,6 +227,13 @@ public:
 #endif
 #endif
 
+    ///
+    /// \brief Add the memory held by the marker to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     ///
     /// \brief Set the type of the segment node
@@ -1,11 +1,55 @@
 #ifndef BIORBD_RIGIDBODY_ENUMS_H
 #define BIORBD_RIGIDBODY_ENUMS_H
 
-namespace biorbd
+namespace BIORBD_NAMESPACE
 {
 namespace rigidbody
 {
 
+///
+/// \brief The available solvers of the forward dynamics with constraints
+///
+enum CONSTRAINTS_SOLVER {
+    CONSTRAINTS_SOLVER_DIRECT, ///< Solve the full dense KKT system (default)
+    CONSTRAINTS_SOLVER_RANGE_SPACE_SPARSE, ///< Range-space method using the sparse LTL factorization of the mass matrix
+    CONSTRAINTS_SOLVER_NULL_SPACE ///< Null-space method, efficient when there are many constraints compared to the dof
+};
+
+///
+/// \brief CONSTRAINTS_SOLVER_toStr returns the solver name in a string format
+/// \param solver The solver to convert to string
+/// \return The name of the solver
+///
+inline const char* CONSTRAINTS_SOLVER_toStr(CONSTRAINTS_SOLVER solver)
+{
+    switch (solver) {
+    case CONSTRAINTS_SOLVER_DIRECT:
+        return "Direct";
+    case CONSTRAINTS_SOLVER_RANGE_SPACE_SPARSE:
+        return "RangeSpaceSparse";
+    case CONSTRAINTS_SOLVER_NULL_SPACE:
+        return "NullSpace";
+    default:
+        return "NoSolver";
+    }
+}
+
+///
+/// \brief The quantities that can be requested from evaluate, to be combined as a bitmask
+///
+enum KINEMATICS_QUANTITY {
+    KINEMATICS_MARKERS = 1 << 0, ///< The position of the markers (only filled by Model::evaluate)
+    KINEMATICS_COM = 1 << 1, ///< The position of the center of mass
+    KINEMATICS_COM_DOT = 1 << 2, ///< The velocity of the center of mass (requires QDot)
+    KINEMATICS_COM_DDOT = 1 << 3, ///< The acceleration of the center of mass (requires QDot and QDDot)
+    KINEMATICS_SEGMENTS_ANGULAR_MOMENTUM = 1 << 4, ///< The angular momentum of each body about the center of mass (requires QDot)
+    KINEMATICS_ANGULAR_MOMENTUM = 1 << 5, ///< The angular momentum of the model about the center of mass (requires QDot)
+    KINEMATICS_KINETIC_ENERGY = 1 << 6, ///< The kinetic energy (requires QDot)
+    KINEMATICS_POTENTIAL_ENERGY = 1 << 7, ///< The potential energy
+    KINEMATICS_GLOBAL_JCS = 1 << 8, ///< The joint coordinate system of each segment in the global reference frame
+    KINEMATICS_ALL = (1 << 9) - 1 ///< All the quantities
+};
+
 }
 }
 
@@ -155,8 +155,16 @@ public:
     virtual void clear();
 
 protected:
+    ///
+    /// \brief Return the rbdl body of the parent of each RT, resolving them if RTs were added since
+    /// \return The rbdl body of the parent of each RT
+    ///
+    const std::vector<unsigned int>& RTsBodyId();
+
     std::shared_ptr<std::vector<utils::RotoTransNode>>
             m_RTs; ///< All the RTs
+    std::shared_ptr<std::vector<unsigned int>>
+            m_RTsBodyId; ///< The rbdl body of the parent of each RT, resolved once
 
 };
 
@@ -6,13 +6,17 @@
 #include <rbdl/Joint.h>
 #include "biorbdConfig.h"
 #include "Utils/Node.h"
+#include "Utils/Scalar.h"
 
 namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class RotoTrans;
 class Range;
+class Vector3d;
+class Matrix3d;
 }
 
 namespace rigidbody
@@ -242,18 +246,30 @@ public:
     /// \param model The underlying model to update
     /// \param characteristics The new characteristics
     ///
-    /// Warning: This function may behave surpringly due to the core of RBDL. The
-    /// new characteristic values will replace everything which is attach in a fixed manner
-    /// (that is no degrees-of-freedom). So if your model has 3 segments, but only the first
-    /// one has dof (and the rest is rigidly attached to the first), then it doesn't matter
-    /// if idx is 0, 1 or 2, because RBDL considers that all these segment are 1 segment.
-    /// It is therefore expected that characteristics is the combination of mass and
-    /// inertia for these 3 segments as well.
+    /// RBDL considers a segment and the segments rigidly attached to it (that is without
+    /// degrees-of-freedom) as one body. That body is rebuilt from the characteristics of all these
+    /// segments, so the characteristics are the ones of this segment only
     ///
     void updateCharacteristics(
         rigidbody::Joints& model,
         const SegmentCharacteristics& characteristics);
 
+    ///
+    /// \brief updateInertia Change the mass, the center of mass and the inertia of the segment in place
+    /// \param model The underlying model to update
+    /// \param mass The new mass
+    /// \param com The new position of the center of mass
+    /// \param inertia The new inertia matrix
+    ///
+    /// Contrary to updateCharacteristics, the rest of the characteristics (the length, the mesh, ...)
+    /// is kept and nothing is copied. As for updateCharacteristics, the body of RBDL that holds the segment is rebuilt
+    ///
+    void updateInertia(
+        rigidbody::Joints& model,
+        const utils::Scalar& mass,
+        const utils::Vector3d& com,
+        const utils::Matrix3d& inertia);
+
     ///
     /// \brief Return the segment characteristics
     /// \return The segment characteristics
@@ -266,8 +282,17 @@ public:
     ///
     bool isRotationAQuaternion() const;
 
+    ///
+    /// \brief Add the memory held by the segment to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     std::shared_ptr<int> m_idxInModel; ///< Index in RBDL model
+    std::shared_ptr<int> m_firstDofIndex; ///< Index of the first dof in the generalized coordinates (-1 if no segment up to the root has a dof)
+    std::shared_ptr<int> m_lastDofIndex; ///< Index of the last dof in the generalized coordinates (-1 if no segment up to the root has a dof)
 
     ///
     /// \brief Set the type of the segment
@@ -391,6 +416,16 @@ protected:
     ///
     void setDofCharacteristicsOnLastBody();
 
+    ///
+    /// \brief Set the inertia of the RBDL body that holds the segment
+    /// \param model The joint model
+    ///
+    /// RBDL joins the segments without DoF into the body of their closest parent with a DoF, so
+    /// that body is rebuilt from the characteristics of all these segments, each one in its own frame
+    ///
+    void updateJoinedBody(
+            rigidbody::Joints& model) const;
+
     std::shared_ptr<SegmentCharacteristics>
             m_characteristics;///< Non-used virtual segment; it allows to "save" the data and to avoid the use of multiple intermediate variables
     std::shared_ptr<std::vector<SegmentCharacteristics>>
@@ -11,6 +11,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class Vector3d;
 class Matrix3d;
 }
@@ -126,6 +127,13 @@ public:
     ///
     void setInertia(const utils::Matrix3d& inertia);
 
+    ///
+    /// \brief Add the memory held by the characteristics (and the mesh) to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     std::shared_ptr<utils::Scalar> m_length; ///< Length of the segment
     std::shared_ptr<Mesh> m_mesh; ///< Mesh of the segment
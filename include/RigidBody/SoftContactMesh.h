@@ -0,0 +1,271 @@
+#ifndef BIORBD_RIGIDBODY_SOFT_CONTACT_MESH_H
+#define BIORBD_RIGIDBODY_SOFT_CONTACT_MESH_H
+
+#include <memory>
+#include <vector>
+#include "biorbdConfig.h"
+#include "RigidBody/SoftContactNode.h"
+
+namespace BIORBD_NAMESPACE
+{
+
+namespace rigidbody
+{
+class Mesh;
+class Terrain;
+
+#ifndef BIORBD_USE_CASADI_MATH
+///
+/// \brief Soft contact of the surface of a segment mesh, sampled as many contact points
+///
+/// Each point stands for a patch of the surface and pushes against the terrain proportionally to
+/// the area of that patch and to its penetration (elastic foundation with Hunt-Crossley's damping).
+/// The kinematics of the segment is computed once for all the points and the points that cannot
+/// touch the terrain are dismissed with a bounding sphere. Without a terrain, the points push
+/// against the contact plane
+///
+class BIORBD_API SoftContactMesh : public rigidbody::SoftContactNode
+{
+public:
+    ///
+    /// \brief Construct a mesh contact
+    ///
+    SoftContactMesh();
+
+    ///
+    /// \brief Construct a mesh contact from another mesh contact
+    /// \param other The other mesh contact
+    ///
+    SoftContactMesh(const rigidbody::SoftContactNode& other);
+
+    ///
+    /// \brief Construct a mesh contact
+    /// \param mesh The mesh to sample the contact points from, in the reference frame of the segment
+    /// \param spacing The size of the cells that merge the close vertices into a single point (0 to keep every vertex)
+    /// \param stiffness The stiffness of the contact, per unit of area
+    /// \param damping The damping factor of the contact
+    /// \param muStatic Static friction coefficient
+    /// \param muDynamic Dynamic friction coefficient
+    /// \param muViscous Viscous friction coefficient
+    /// \param name The name of the node
+    /// \param parentName The name of the parent
+    /// \param parentID The index of the parent contact
+    ///
+    SoftContactMesh(
+        const rigidbody::Mesh& mesh,
+        double spacing,
+        const utils::Scalar& stiffness,
+        const utils::Scalar& damping,
+        const utils::Scalar& muStatic,
+        const utils::Scalar& muDynamic,
+        const utils::Scalar& muViscous,
+        const utils::String& name,
+        const utils::String& parentName,
+        int parentID);
+
+    ///
+    /// \brief Deep copy of the mesh contact
+    /// \return A deep copy of the mesh contact
+    ///
+    SoftContactMesh DeepCopy() const;
+
+    ///
+    /// \brief Deep copy of the mesh contact
+    /// \param other The mesh contact to copy
+    ///
+    void DeepCopy(const SoftContactMesh& other);
+
+    ///
+    /// \brief Return the number of contact points
+    /// \return The number of contact points
+    ///
+    size_t nbPoints() const;
+
+    ///
+    /// \brief Return a contact point
+    /// \param idx The index of the point
+    /// \return The contact point in the reference frame of the segment
+    ///
+    const utils::Vector3d& point(size_t idx) const;
+
+    ///
+    /// \brief Return the area of the surface a contact point stands for
+    /// \param idx The index of the point
+    /// \return The area of the point
+    ///
+    double area(size_t idx) const;
+
+    ///
+    /// \brief Return the radius of the sphere around the node that holds all the points
+    /// \return The radius of the bounding sphere
+    ///
+    double boundingRadius() const;
+
+    ///
+    /// \brief Set the terrain the points push against (shared, not copied)
+    /// \param terrain The terrain (nullptr to use the contact plane)
+    ///
+    void setTerrain(const std::shared_ptr<Terrain>& terrain);
+
+    ///
+    /// \brief Return the terrain the points push against
+    /// \return The terrain (nullptr if the contact plane is used)
+    ///
+    const std::shared_ptr<Terrain>& terrain() const;
+
+    ///
+    /// \brief Set a new value for the stiffness
+    /// \param stiffness The new value for the stiffness
+    ///
+    void setStiffness(const utils::Scalar& stiffness);
+
+    ///
+    /// \brief Return the value of the stiffness
+    /// \return The value of the stiffness
+    ///
+    utils::Scalar stiffness() const;
+
+    ///
+    /// \brief Set a new value for the damping
+    /// \param damping The new value for the damping
+    ///
+    void setDamping(const utils::Scalar& damping);
+
+    ///
+    /// \brief Return the value of the damping
+    /// \return The value of the damping
+    ///
+    utils::Scalar damping() const;
+
+    ///
+    /// \brief Set a new value for the muStatic
+    /// \param muStatic The new value for the muStatic
+    ///
+    void setMuStatic(const utils::Scalar& muStatic);
+
+    ///
+    /// \brief Return the value of the muStatic
+    /// \return The value of the muStatic
+    ///
+    utils::Scalar muStatic() const;
+
+    ///
+    /// \brief Set a new value for the muDynamic
+    /// \param muDynamic The new value for the muDynamic
+    ///
+    void setMuDynamic(const utils::Scalar& muDynamic);
+
+    ///
+    /// \brief Return the value of the muDynamic
+    /// \return The value of the muDynamic
+    ///
+    utils::Scalar muDynamic() const;
+
+    ///
+    /// \brief Set a new value for the muViscous
+    /// \param muViscous The new value for the muViscous
+    ///
+    void setMuViscous(const utils::Scalar& muViscous);
+
+    ///
+    /// \brief Return the value of the muViscous
+    /// \return The value of the muViscous
+    ///
+    utils::Scalar muViscous() const;
+
+    ///
+    /// \brief Set a new value for the transitionVelocity
+    /// \param transitionVelocity The new value for the transitionVelocity
+    ///
+    void setTransitionVelocity(const utils::Scalar& transitionVelocity);
+
+    ///
+    /// \brief Return the value of the transitionVelocity
+    /// \return The value of the transitionVelocity
+    ///
+    utils::Scalar transitionVelocity() const;
+
+    ///
+    /// \brief Get the sum of the forces of all the points in a spatial vector at the origin of the world base coordinates
+    /// \param model The model
+    /// \param Q The Generalized Coordinates
+    /// \param QDot The Generalized velocities
+    /// \param updateKin If the kinematics should be updated
+    /// \return The Spatial vector
+    ///
+    virtual utils::SpatialVector computeForceAtOrigin(
+            Joints& model,
+            const GeneralizedCoordinates& Q,
+            const GeneralizedVelocity& QDot,
+            bool updateKin = true);
+
+    ///
+    /// \brief Get the force of a single point that stands for the mean area of the points
+    /// \param x The position of the point in global reference frame
+    /// \param dx The velocity of the point in global reference frame
+    /// \param angularVelocity The angular velocity of the segment (unused, the points have no radius)
+    /// \return The force
+    ///
+    virtual utils::Vector3d computeForce(
+            const utils::Vector3d& x,
+            const utils::Vector3d& dx,
+            const utils::Vector3d& angularVelocity) const;
+
+    ///
+    /// \brief Get the point of the surface the force of a point is applied on
+    /// \param x The position of the point in global reference frame
+    /// \return The application point (x itself if the point is not in contact)
+    ///
+    virtual utils::Vector3d applicationPoint(
+            const utils::Vector3d& x) const;
+
+protected:
+    ///
+    /// \brief Set the type of the contact node
+    ///
+    void setType();
+
+    ///
+    /// \brief Find the penetration of a point in the terrain, or in the contact plane if there is no terrain
+    /// \param x The position of the point in global reference frame
+    /// \param depth The penetration of the point (set only if in contact)
+    /// \param normal The normal of the surface (set only if in contact)
+    /// \return If the point is in contact
+    ///
+    bool penetration(
+            const utils::Vector3d& x,
+            double& depth,
+            utils::Vector3d& normal) const;
+
+    ///
+    /// \brief Get the force of a point in contact
+    /// \param dx The velocity of the point in global reference frame
+    /// \param area The area the point stands for
+    /// \param depth The penetration of the point
+    /// \param normal The normal of the surface
+    /// \return The force
+    ///
+    utils::Vector3d pointForce(
+            const utils::Vector3d& dx,
+            double area,
+            double depth,
+            const utils::Vector3d& normal) const;
+
+    std::shared_ptr<std::vector<utils::Vector3d>> m_points; ///< The contact points in the reference frame of the segment
+    std::shared_ptr<std::vector<double>> m_areas; ///< The area each point stands for
+    std::shared_ptr<double> m_boundingRadius; ///< The radius of the sphere around the node that holds all the points
+    std::shared_ptr<std::shared_ptr<Terrain>> m_terrain; ///< The terrain the points push against
+    std::shared_ptr<utils::Scalar> m_stiffness; ///< The stiffness of the contact, per unit of area
+    std::shared_ptr<utils::Scalar> m_damping; ///< The damping factor of the contact
+
+    std::shared_ptr<utils::Scalar> m_muStatic; ///< Static coefficient of friction (mu)
+    std::shared_ptr<utils::Scalar> m_muDynamic; ///< Dynamic coefficient of friction (mu)
+    std::shared_ptr<utils::Scalar> m_muViscous; ///< Viscous coefficient of friction (mu)
+    std::shared_ptr<utils::Scalar> m_transitionVelocity; ///< Transition velocity factor of the friction
+};
+#endif
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_SOFT_CONTACT_MESH_H
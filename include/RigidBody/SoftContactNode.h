@@ -123,6 +123,24 @@ protected:
     ///
     void setType();
 
+    ///
+    /// \brief Get the norm of the friction force that opposes the sliding of a contact (from Peter Brown 2017)
+    /// \param normalForce The norm of the normal force
+    /// \param tangentVelocityNorm The norm of the tangent velocity of the contact
+    /// \param muStatic Static friction coefficient
+    /// \param muDynamic Dynamic friction coefficient
+    /// \param muViscous Viscous friction coefficient
+    /// \param transitionVelocity The velocity of the transition between the static and the dynamic friction
+    /// \return The norm of the friction force
+    ///
+    static utils::Scalar frictionForce(
+            const utils::Scalar& normalForce,
+            const utils::Scalar& tangentVelocityNorm,
+            const utils::Scalar& muStatic,
+            const utils::Scalar& muDynamic,
+            const utils::Scalar& muViscous,
+            const utils::Scalar& transitionVelocity);
+
     std::shared_ptr<std::pair<utils::Vector3d, utils::Vector3d>> m_contactPlane; ///< The contact plane that interface with the node in global reference frame
 
 };
@@ -10,6 +10,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils {
 class String;
+class Matrix;
 }
 
 namespace rigidbody
@@ -18,6 +19,7 @@ class GeneralizedCoordinates;
 class GeneralizedVelocity;
 class SoftContactNode;
 class NodeSegment;
+class Terrain;
 
 ///
 /// \brief Holder for the biorbd contact set
@@ -68,6 +70,15 @@ public:
     void addSoftContact(
         const SoftContactNode& contact);
 
+#ifndef BIORBD_USE_CASADI_MATH
+    ///
+    /// \brief Set the terrain all the mesh contacts push against (shared, not copied)
+    /// \param terrain The terrain (nullptr to use the contact plane)
+    ///
+    void setTerrain(
+        const std::shared_ptr<Terrain>& terrain);
+#endif
+
     ///
     /// \brief Return a specified contact
     /// \param idx The index of the marker
@@ -98,6 +109,20 @@ public:
         const GeneralizedCoordinates &Q,
         bool updateKin = true);
 
+    ///
+    /// \brief Compute the contacts at a given position Q into a matrix
+    /// \param Q The generalized coordinates
+    /// \param positions The matrix (3 x nbSoftContacts) to fill. It is resized only if its dimensions are wrong
+    /// \param updateKin If the model should be updated
+    ///
+    /// Contrary to softContacts(), no NodeSegment is created so filling an already sized matrix does not
+    /// allocate. The column i is the soft contact i.
+    ///
+    void softContactsInMatrix(
+        const GeneralizedCoordinates &Q,
+        utils::Matrix& positions,
+        bool updateKin = true);
+
     ///
     /// \brief Return the  linear velocity of a contact
     /// \param Q The generalized coordinates
@@ -164,8 +189,22 @@ public:
     std::vector<size_t> segmentSoftContactIdx(
             size_t  idx) const;
 
+    ///
+    /// \brief Return the index of the parent segment of each contact, resolving them if contacts were added since
+    /// \return The segment index of each contact
+    ///
+    const std::vector<size_t>& softContactsSegmentIdx();
+
 protected:
     std::shared_ptr<std::vector<std::shared_ptr<SoftContactNode>>> m_softContacts; ///< The contacts
+    std::shared_ptr<std::vector<unsigned int>> m_softContactsBodyId; ///< RBDL body id of the parent of each contact, resolved once
+    std::shared_ptr<std::vector<size_t>> m_softContactsSegmentIdx; ///< Index of the parent segment of each contact, resolved once
+
+    ///
+    /// \brief Return the RBDL body id of the parent of each contact, resolving them if contacts were added since
+    /// \return The body id of each contact
+    ///
+    const std::vector<unsigned int>& softContactsBodyId();
 
 };
 
@@ -0,0 +1,58 @@
+#ifndef BIORBD_RIGIDBODY_TERRAIN_H
+#define BIORBD_RIGIDBODY_TERRAIN_H
+
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class Vector3d;
+}
+
+namespace rigidbody
+{
+
+#ifndef BIORBD_USE_CASADI_MATH
+///
+/// \brief A surface the soft contacts can push against, given in the global reference frame
+///
+/// The surface is a height field along the global Z axis (there is a single height for each
+/// position in the XY plane). A terrain is not modified once built so it can be shared by many contacts
+///
+class BIORBD_API Terrain
+{
+public:
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~Terrain();
+
+    ///
+    /// \brief Return if a point is under the surface, and how deep
+    /// \param point The point in the global reference frame
+    /// \param depth The distance from the point to the surface along the normal (set only if under the surface)
+    /// \param normal The unit normal of the surface, pointing up (set only if under the surface)
+    /// \return If the point is under the surface
+    ///
+    virtual bool penetration(
+        const utils::Vector3d& point,
+        double& depth,
+        utils::Vector3d& normal) const = 0;
+
+    ///
+    /// \brief Return if a sphere is entirely above the highest point of the surface
+    /// \param center The center of the sphere in the global reference frame
+    /// \param radius The radius of the sphere
+    /// \return If none of the points of the sphere can be in contact
+    ///
+    virtual bool isAbove(
+        const utils::Vector3d& center,
+        double radius) const = 0;
+};
+#endif
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_TERRAIN_H
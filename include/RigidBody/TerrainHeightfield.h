@@ -0,0 +1,106 @@
+#ifndef BIORBD_RIGIDBODY_TERRAIN_HEIGHTFIELD_H
+#define BIORBD_RIGIDBODY_TERRAIN_HEIGHTFIELD_H
+
+#include <memory>
+#include "biorbdConfig.h"
+#include "RigidBody/Terrain.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class Matrix;
+}
+
+namespace rigidbody
+{
+
+#ifndef BIORBD_USE_CASADI_MATH
+///
+/// \brief A terrain given by its height at the nodes of a regular grid of the XY plane
+///
+/// The height between the nodes is interpolated bilinearly. A point queried outside of the grid
+/// is never in contact
+///
+class BIORBD_API TerrainHeightfield : public Terrain
+{
+public:
+    ///
+    /// \brief Construct a height field
+    /// \param originX The X position of the first node
+    /// \param originY The Y position of the first node
+    /// \param spacingX The distance between two nodes along X
+    /// \param spacingY The distance between two nodes along Y
+    /// \param heights The height of each node, the row i and the column j being the node (originX + i*spacingX, originY + j*spacingY)
+    ///
+    TerrainHeightfield(
+        double originX,
+        double originY,
+        double spacingX,
+        double spacingY,
+        const utils::Matrix& heights);
+
+    ///
+    /// \brief Return the height of the surface at a position of the XY plane
+    /// \param x The X position
+    /// \param y The Y position
+    /// \return The height (NaN outside of the grid)
+    ///
+    double height(
+        double x,
+        double y) const;
+
+    ///
+    /// \brief Return if a point is under the surface, and how deep
+    /// \param point The point in the global reference frame
+    /// \param depth The distance from the point to the surface along the normal (set only if under the surface)
+    /// \param normal The unit normal of the surface, pointing up (set only if under the surface)
+    /// \return If the point is under the surface
+    ///
+    virtual bool penetration(
+        const utils::Vector3d& point,
+        double& depth,
+        utils::Vector3d& normal) const;
+
+    ///
+    /// \brief Return if a sphere is entirely above the highest node
+    /// \param center The center of the sphere in the global reference frame
+    /// \param radius The radius of the sphere
+    /// \return If none of the points of the sphere can be in contact
+    ///
+    virtual bool isAbove(
+        const utils::Vector3d& center,
+        double radius) const;
+
+protected:
+    ///
+    /// \brief Find the cell of the grid of a position, and the position in that cell
+    /// \param x The X position
+    /// \param y The Y position
+    /// \param i The row of the first node of the cell
+    /// \param j The column of the first node of the cell
+    /// \param u The position along X in the cell (between 0 and 1)
+    /// \param v The position along Y in the cell (between 0 and 1)
+    /// \return If the position is inside the grid
+    ///
+    bool cell(
+        double x,
+        double y,
+        unsigned int& i,
+        unsigned int& j,
+        double& u,
+        double& v) const;
+
+    std::shared_ptr<utils::Matrix> m_heights; ///< The height of each node
+    double m_originX; ///< The X position of the first node
+    double m_originY; ///< The Y position of the first node
+    double m_spacingX; ///< The distance between two nodes along X
+    double m_spacingY; ///< The distance between two nodes along Y
+    double m_maxHeight; ///< The highest node
+};
+#endif
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_TERRAIN_HEIGHTFIELD_H
@@ -0,0 +1,102 @@
+#ifndef BIORBD_RIGIDBODY_TERRAIN_MESH_H
+#define BIORBD_RIGIDBODY_TERRAIN_MESH_H
+
+#include <vector>
+#include <memory>
+#include "biorbdConfig.h"
+#include "RigidBody/Terrain.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace rigidbody
+{
+class Mesh;
+
+#ifndef BIORBD_USE_CASADI_MATH
+///
+/// \brief A terrain given by a triangle mesh in the global reference frame
+///
+/// The triangles are sorted once in a uniform grid of the XY plane, so a query only tests the few
+/// triangles of the cell of the point. The vertical triangles are ignored and, where triangles are
+/// stacked, the highest one is the surface. A point queried outside of the mesh is never in contact
+///
+class BIORBD_API TerrainMesh : public Terrain
+{
+public:
+    ///
+    /// \brief Construct a triangle terrain
+    /// \param mesh The mesh (the faces with more than 3 vertices are cut in triangles)
+    /// \param cellSize The size of the cells of the grid (0 to use the mean size of the triangles)
+    ///
+    TerrainMesh(
+        const Mesh& mesh,
+        double cellSize = 0);
+
+    ///
+    /// \brief Return the number of triangles
+    /// \return The number of triangles
+    ///
+    size_t nbTriangles() const;
+
+    ///
+    /// \brief Return the height of the surface at a position of the XY plane
+    /// \param x The X position
+    /// \param y The Y position
+    /// \return The height (NaN outside of the mesh)
+    ///
+    double height(
+        double x,
+        double y) const;
+
+    ///
+    /// \brief Return if a point is under the surface, and how deep
+    /// \param point The point in the global reference frame
+    /// \param depth The distance from the point to the surface along the normal (set only if under the surface)
+    /// \param normal The unit normal of the surface, pointing up (set only if under the surface)
+    /// \return If the point is under the surface
+    ///
+    virtual bool penetration(
+        const utils::Vector3d& point,
+        double& depth,
+        utils::Vector3d& normal) const;
+
+    ///
+    /// \brief Return if a sphere is entirely above the highest vertex
+    /// \param center The center of the sphere in the global reference frame
+    /// \param radius The radius of the sphere
+    /// \return If none of the points of the sphere can be in contact
+    ///
+    virtual bool isAbove(
+        const utils::Vector3d& center,
+        double radius) const;
+
+protected:
+    ///
+    /// \brief Find the highest triangle over a position of the XY plane
+    /// \param x The X position
+    /// \param y The Y position
+    /// \param surface The height of the triangle at the position
+    /// \return The index of the triangle (nbTriangles if there is none)
+    ///
+    size_t surface(
+        double x,
+        double y,
+        double& surface) const;
+
+    std::shared_ptr<std::vector<double>> m_triangles; ///< The 3 vertices (x, y, z) of each triangle, one after the other
+    std::shared_ptr<std::vector<double>> m_normals; ///< The unit normal (x, y, z) of each triangle, pointing up
+    std::shared_ptr<std::vector<size_t>> m_cellStart; ///< The index in m_cellTriangles of the first triangle of each cell
+    std::shared_ptr<std::vector<size_t>> m_cellTriangles; ///< The triangles of each cell, one cell after the other
+    double m_originX; ///< The X position of the first cell
+    double m_originY; ///< The Y position of the first cell
+    double m_cellSize; ///< The size of the cells
+    size_t m_nbCellsX; ///< The number of cells along X
+    size_t m_nbCellsY; ///< The number of cells along Y
+    double m_maxHeight; ///< The highest vertex
+};
+#endif
+
+}
+}
+
+#endif // BIORBD_RIGIDBODY_TERRAIN_MESH_H
@@ -9,6 +9,10 @@
 #include "RigidBody/Contacts.h"
 #include "RigidBody/ExternalForceSet.h"
 #include "RigidBody/SoftContactSphere.h"
+#include "RigidBody/SoftContactMesh.h"
+#include "RigidBody/Terrain.h"
+#include "RigidBody/TerrainHeightfield.h"
+#include "RigidBody/TerrainMesh.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
 #include "RigidBody/GeneralizedAcceleration.h"
@@ -16,7 +20,10 @@
 #include "RigidBody/IMU.h"
 #include "RigidBody/IMUs.h"
 #include "RigidBody/Joints.h"
+#include "RigidBody/KinematicsResults.h"
 #include "RigidBody/Markers.h"
+#include "RigidBody/MarkersInverseKinematics.h"
+#include "RigidBody/MeshCollisions.h"
 #include "RigidBody/NodeSegment.h"
 #include "RigidBody/RotoTransNodes.h"
 #include "RigidBody/MeshFace.h"
@@ -25,6 +32,7 @@
     #include "RigidBody/KalmanRecons.h"
     #include "RigidBody/KalmanReconsIMU.h"
     #include "RigidBody/KalmanReconsMarkers.h"
+    #include "RigidBody/KalmanReconsMarkersTrials.h"
 #endif
 
 #endif // BIORBD_RIGIDBODY_ALL_H
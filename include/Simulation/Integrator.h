@@ -0,0 +1,232 @@
+#ifndef BIORBD_SIMULATION_INTEGRATOR_H
+#define BIORBD_SIMULATION_INTEGRATOR_H
+
+#include <memory>
+#include <functional>
+#include "biorbdConfig.h"
+#include "Simulation/SimulationEnums.h"
+#include "Utils/Vector.h"
+#include "RigidBody/GeneralizedTorque.h"
+
+namespace BIORBD_NAMESPACE
+{
+class Model;
+
+namespace rigidbody
+{
+class GeneralizedCoordinates;
+class GeneralizedVelocity;
+}
+
+namespace simulation
+{
+
+///
+/// \brief The controls applied to the model during a time step
+///
+class BIORBD_API Controls
+{
+public:
+    rigidbody::GeneralizedTorque m_tau; ///< The generalized torques added to the muscle torques
+    utils::Vector m_excitations; ///< The excitation of each muscle (ignored if there is no muscle)
+};
+
+///
+/// \brief Function that sets the controls from the time and the state (the controls are zero if none is set)
+///
+typedef std::function<void(double t, const utils::Vector& x, Controls& controls)> Controller;
+
+///
+/// \brief Time integrator of the dynamics of a model
+///
+/// The state x is the concatenation of Q (nbQ), QDot (nbQdot), the muscle activations (nbMuscles)
+/// and the active, fatigued and resting fibers of each muscle with a dynamic fatigue model.
+/// The activations of the muscles without an activation dynamics are held constant.
+/// The generalized accelerations account for the rigid contacts if the model has any.
+/// The quaternions are integrated through computeQdot and normalized after each step.
+///
+/// The integrator uses the model as its workspace: a model (and its integrator) must not be
+/// shared between threads (see Rollouts)
+///
+class BIORBD_API Integrator
+{
+public:
+    ///
+    /// \brief Construct an integrator of a model
+    /// \param model The model to integrate (it must outlive the integrator)
+    /// \param type The integration scheme
+    ///
+    Integrator(
+        Model& model,
+        INTEGRATOR_TYPE type = INTEGRATOR_RK4);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~Integrator();
+
+    ///
+    /// \brief Set the integration scheme
+    /// \param type The integration scheme
+    ///
+    void setType(
+        INTEGRATOR_TYPE type);
+
+    ///
+    /// \brief Return the integration scheme
+    /// \return The integration scheme
+    ///
+    INTEGRATOR_TYPE type() const;
+
+    ///
+    /// \brief Set the time step (the initial time step for the adaptive schemes)
+    /// \param dt The time step
+    ///
+    void setTimeStep(
+        double dt);
+
+    ///
+    /// \brief Return the time step (the last accepted time step for the adaptive schemes)
+    /// \return The time step
+    ///
+    double timeStep() const;
+
+    ///
+    /// \brief Set the tolerances of the adaptive schemes
+    /// \param relative The relative tolerance
+    /// \param absolute The absolute tolerance
+    ///
+    void setTolerances(
+        double relative,
+        double absolute);
+
+    ///
+    /// \brief Set the function that computes the controls
+    /// \param controller The controller
+    ///
+    void setController(
+        const Controller& controller);
+
+    ///
+    /// \brief Return the number of states
+    /// \return The number of states
+    ///
+    size_t nbStates() const;
+
+    ///
+    /// \brief Return a state from the generalized coordinates and velocities
+    /// \param Q The generalized coordinates
+    /// \param QDot The generalized velocities
+    /// \return The state, the muscle activations and fatigue are those currently in the model
+    ///
+    utils::Vector state(
+        const rigidbody::GeneralizedCoordinates& Q,
+        const rigidbody::GeneralizedVelocity& QDot) const;
+
+    ///
+    /// \brief Return the generalized coordinates of a state
+    /// \param x The state
+    /// \return The generalized coordinates
+    ///
+    rigidbody::GeneralizedCoordinates Q(
+        const utils::Vector& x) const;
+
+    ///
+    /// \brief Return the generalized velocities of a state
+    /// \param x The state
+    /// \return The generalized velocities
+    ///
+    rigidbody::GeneralizedVelocity QDot(
+        const utils::Vector& x) const;
+
+    ///
+    /// \brief Return the muscle activations of a state
+    /// \param x The state
+    /// \return The muscle activations
+    ///
+    utils::Vector activations(
+        const utils::Vector& x) const;
+
+    ///
+    /// \brief Return the fatigue of a state
+    /// \param x The state
+    /// \return The active, fatigued and resting fibers of each muscle with a dynamic fatigue model
+    ///
+    utils::Vector fatigue(
+        const utils::Vector& x) const;
+
+    ///
+    /// \brief Compute the time derivative of the state
+    /// \param t The time
+    /// \param x The state
+    /// \param xDot The time derivative to fill
+    ///
+    void derivative(
+        double t,
+        const utils::Vector& x,
+        utils::Vector& xDot);
+
+    ///
+    /// \brief Advance the state by one step
+    /// \param t The time, advanced by the step
+    /// \param x The state to advance
+    /// \param tMax The step is shortened so t does not go past tMax
+    ///
+    void step(
+        double& t,
+        utils::Vector& x,
+        double tMax);
+
+    ///
+    /// \brief Integrate the state from t0 to tf
+    /// \param t0 The initial time
+    /// \param tf The final time
+    /// \param x The initial state, filled with the final state
+    /// \return The number of steps
+    ///
+    size_t integrate(
+        double t0,
+        double tf,
+        utils::Vector& x);
+
+    ///
+    /// \brief Return the number of steps taken since the creation of the integrator
+    /// \return The number of accepted steps
+    ///
+    size_t nbSteps() const;
+
+    ///
+    /// \brief Return the number of steps rejected by the adaptive schemes since the creation of the integrator
+    /// \return The number of rejected steps
+    ///
+    size_t nbRejectedSteps() const;
+
+    ///
+    /// \brief Return the number of steps per second of wall time of the last call to integrate
+    /// \return The number of steps per second
+    ///
+    double stepsPerSecond() const;
+
+protected:
+    ///
+    /// \brief Normalize the quaternions of the state
+    /// \param x The state
+    ///
+    void normalizeQuaternions(
+        utils::Vector& x) const;
+
+    Model& m_model; ///< The model to integrate
+#ifndef SWIG
+    class IntegratorWorkspace;
+    std::shared_ptr<IntegratorWorkspace> m_workspace; ///< The settings and the buffers of the integrator
+#endif
+
+private:
+    Integrator(const Integrator&);
+    Integrator& operator=(const Integrator&);
+};
+
+}
+}
+
+#endif // BIORBD_SIMULATION_INTEGRATOR_H
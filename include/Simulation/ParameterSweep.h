@@ -0,0 +1,206 @@
+#ifndef BIORBD_SIMULATION_PARAMETER_SWEEP_H
+#define BIORBD_SIMULATION_PARAMETER_SWEEP_H
+
+#include <vector>
+#include <memory>
+#include "biorbdConfig.h"
+#include "Simulation/SimulationEnums.h"
+
+namespace BIORBD_NAMESPACE
+{
+class Model;
+
+namespace utils
+{
+class Path;
+class String;
+class Vector;
+class Matrix;
+class ThreadPool;
+}
+
+namespace internal_forces
+{
+namespace muscles
+{
+class State;
+}
+}
+
+namespace simulation
+{
+class SweepParameter;
+class SweepSegment;
+class SweepWorker;
+
+///
+/// \brief Evaluate a quantity of a model for many sets of inertial and muscle parameters in parallel
+///
+/// The parameters to sweep are declared first, then evaluate receives one set of values per column.
+/// Each thread owns a copy of the model, and only the swept parameters of this copy are overwritten
+/// before each sample (the model is neither reloaded nor deep copied). The parameters that are not
+/// swept keep the values of the loaded model
+///
+class BIORBD_API ParameterSweep
+{
+public:
+    ///
+    /// \brief Load a model for each thread
+    /// \param path The path of the model
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    ParameterSweep(
+        const utils::Path& path,
+        size_t nbThreads = 0);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~ParameterSweep();
+
+    ///
+    /// \brief Return the number of threads
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Return the model of a thread
+    /// \param thread The index of the thread
+    /// \return The model
+    ///
+    Model& model(
+        size_t thread = 0);
+
+    ///
+    /// \brief Add an inertial parameter of a segment to the sweep
+    /// \param segment The index of the segment
+    /// \param parameter The parameter (one of the SEGMENT_* values)
+    /// \return The row of the parameter in the matrix of the parameters
+    ///
+    size_t addSegmentParameter(
+        size_t segment,
+        SWEEP_PARAMETER parameter);
+
+    ///
+    /// \brief Add an inertial parameter of a segment to the sweep
+    /// \param segment The name of the segment
+    /// \param parameter The parameter (one of the SEGMENT_* values)
+    /// \return The row of the parameter in the matrix of the parameters
+    ///
+    size_t addSegmentParameter(
+        const utils::String& segment,
+        SWEEP_PARAMETER parameter);
+
+#ifdef MODULE_MUSCLES
+    ///
+    /// \brief Add a parameter of a muscle to the sweep
+    /// \param muscle The index of the muscle (all the muscle groups put together)
+    /// \param parameter The parameter (one of the MUSCLE_* values)
+    /// \return The row of the parameter in the matrix of the parameters
+    ///
+    size_t addMuscleParameter(
+        size_t muscle,
+        SWEEP_PARAMETER parameter);
+#endif
+
+    ///
+    /// \brief Return the number of swept parameters
+    /// \return The number of parameters
+    ///
+    size_t nbParameters() const;
+
+    ///
+    /// \brief Return the values of the swept parameters in the loaded model
+    /// \return The nominal values (nbParameters)
+    ///
+    utils::Vector nominalParameters() const;
+
+    ///
+    /// \brief Return the number of values computed for each sample
+    /// \param quantity The evaluated quantity
+    /// \return The number of rows of the results
+    ///
+    size_t nbResults(
+        SWEEP_QUANTITY quantity) const;
+
+    ///
+    /// \brief Evaluate a quantity for each set of parameters
+    /// \param parameters The values of the parameters (nbParameters x nbSamples)
+    /// \param quantity The quantity to evaluate (all but SWEEP_MUSCLE_FORCES)
+    /// \param Q The generalized coordinates
+    /// \param QDot The generalized velocities (can be nullptr if the quantity does not need it)
+    /// \param QDDot The generalized accelerations (can be nullptr if the quantity does not need it)
+    /// \param Tau The generalized torques subtracted from the inverse dynamics (nullptr for zeros)
+    /// \param results The quantity for each sample (nbResults x nbSamples, resized if needed)
+    ///
+    void evaluate(
+        const utils::Matrix& parameters,
+        SWEEP_QUANTITY quantity,
+        const utils::Vector& Q,
+        const utils::Vector* QDot,
+        const utils::Vector* QDDot,
+        const utils::Vector* Tau,
+        utils::Matrix& results);
+
+#ifdef MODULE_MUSCLES
+    ///
+    /// \brief Evaluate a quantity for each set of parameters
+    /// \param parameters The values of the parameters (nbParameters x nbSamples)
+    /// \param quantity The quantity to evaluate
+    /// \param Q The generalized coordinates
+    /// \param QDot The generalized velocities (can be nullptr if the quantity does not need it)
+    /// \param QDDot The generalized accelerations (can be nullptr if the quantity does not need it)
+    /// \param Tau The generalized torques subtracted from the inverse dynamics (nullptr for zeros)
+    /// \param emg The dynamic state of each muscle (needed by SWEEP_MUSCLE_FORCES)
+    /// \param results The quantity for each sample (nbResults x nbSamples, resized if needed)
+    ///
+    void evaluate(
+        const utils::Matrix& parameters,
+        SWEEP_QUANTITY quantity,
+        const utils::Vector& Q,
+        const utils::Vector* QDot,
+        const utils::Vector* QDDot,
+        const utils::Vector* Tau,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+        utils::Matrix& results);
+#endif
+
+protected:
+#ifndef SWIG
+    std::shared_ptr<utils::ThreadPool> m_pool; ///< The threads
+    std::vector<std::shared_ptr<SweepWorker>> m_workers; ///< A model and its buffers per thread
+    std::vector<std::shared_ptr<SweepParameter>> m_parameters; ///< The swept parameters
+    std::vector<std::shared_ptr<SweepSegment>> m_segments; ///< The segments that have at least one swept parameter
+
+    ///
+    /// \brief Evaluate a quantity for each set of parameters
+    /// \param parameters The values of the parameters (nbParameters x nbSamples)
+    /// \param quantity The quantity to evaluate
+    /// \param Q The generalized coordinates
+    /// \param QDot The generalized velocities
+    /// \param QDDot The generalized accelerations
+    /// \param Tau The generalized torques subtracted from the inverse dynamics
+    /// \param emg The dynamic state of each muscle (can be nullptr if the quantity does not need it)
+    /// \param results The quantity for each sample
+    ///
+    void evaluateSamples(
+        const utils::Matrix& parameters,
+        SWEEP_QUANTITY quantity,
+        const utils::Vector& Q,
+        const utils::Vector* QDot,
+        const utils::Vector* QDDot,
+        const utils::Vector* Tau,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>* emg,
+        utils::Matrix& results);
+#endif
+
+private:
+    ParameterSweep(const ParameterSweep&);
+    ParameterSweep& operator=(const ParameterSweep&);
+};
+
+}
+}
+
+#endif // BIORBD_SIMULATION_PARAMETER_SWEEP_H
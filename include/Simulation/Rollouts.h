@@ -0,0 +1,128 @@
+#ifndef BIORBD_SIMULATION_ROLLOUTS_H
+#define BIORBD_SIMULATION_ROLLOUTS_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include "biorbdConfig.h"
+#include "Simulation/Integrator.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class Path;
+class ThreadPool;
+}
+
+namespace simulation
+{
+
+///
+/// \brief Function that sets the controls of a rollout from its index, the time and the state
+///
+typedef std::function<void(size_t rollout, double t, const utils::Vector& x, Controls& controls)> RolloutController;
+
+///
+/// \brief Integrate many independent initial states of a model in parallel
+///
+/// Each thread owns a copy of the model and an integrator, so the rollouts do not share any workspace
+///
+class BIORBD_API Rollouts
+{
+public:
+    ///
+    /// \brief Load a model for each thread
+    /// \param path The path of the model
+    /// \param type The integration scheme
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    Rollouts(
+        const utils::Path& path,
+        INTEGRATOR_TYPE type = INTEGRATOR_RK4,
+        size_t nbThreads = 0);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~Rollouts();
+
+    ///
+    /// \brief Return the number of threads
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Return the integrator of a thread
+    /// \param thread The index of the thread
+    /// \return The integrator
+    ///
+    Integrator& integrator(
+        size_t thread = 0);
+
+    ///
+    /// \brief Set the time step of all the integrators
+    /// \param dt The time step
+    ///
+    void setTimeStep(
+        double dt);
+
+    ///
+    /// \brief Set the tolerances of all the integrators
+    /// \param relative The relative tolerance
+    /// \param absolute The absolute tolerance
+    ///
+    void setTolerances(
+        double relative,
+        double absolute);
+
+    ///
+    /// \brief Set the function that computes the controls of the rollouts
+    /// \param controller The controller
+    ///
+    void setController(
+        const RolloutController& controller);
+
+    ///
+    /// \brief Integrate each state from t0 to tf
+    /// \param t0 The initial time
+    /// \param tf The final time
+    /// \param states The initial states, filled with the final states
+    ///
+    void run(
+        double t0,
+        double tf,
+        std::vector<utils::Vector>& states);
+
+    ///
+    /// \brief Return the total number of steps of the last run
+    /// \return The number of steps
+    ///
+    size_t nbSteps() const;
+
+    ///
+    /// \brief Return the total number of steps per second of wall time of the last run
+    /// \return The number of steps per second
+    ///
+    double stepsPerSecond() const;
+
+protected:
+#ifndef SWIG
+    std::shared_ptr<utils::ThreadPool> m_pool; ///< The threads
+    std::vector<std::shared_ptr<Model>> m_models; ///< A model per thread
+    std::vector<std::shared_ptr<Integrator>> m_integrators; ///< An integrator per thread
+    RolloutController m_controller; ///< The controller of the rollouts
+    size_t m_nbSteps; ///< The total number of steps of the last run
+    double m_stepsPerSecond; ///< The steps per second of the last run
+#endif
+
+private:
+    Rollouts(const Rollouts&);
+    Rollouts& operator=(const Rollouts&);
+};
+
+}
+}
+
+#endif // BIORBD_SIMULATION_ROLLOUTS_H
@@ -0,0 +1,276 @@
+#ifndef BIORBD_SIMULATION_SCENE_H
+#define BIORBD_SIMULATION_SCENE_H
+
+#include <vector>
+#include <memory>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+class Model;
+
+namespace utils
+{
+class Path;
+class Vector;
+class Matrix;
+class ThreadPool;
+}
+
+namespace rigidbody
+{
+class KinematicsResults;
+}
+
+#ifdef MODULE_MUSCLES
+namespace internal_forces
+{
+namespace muscles
+{
+class State;
+}
+}
+#endif
+
+namespace simulation
+{
+class SceneSubject;
+
+///
+/// \brief Several independent models (people, objects, ...) evaluated as a whole
+///
+/// The subjects do not share any body, so each of them is a kinematic tree of its own and the
+/// subjects are evaluated concurrently on a thread pool. The generalized coordinates,
+/// velocities, accelerations and torques of the scene are the ones of the subjects put one after
+/// the other, in the order they were added. The markers, the muscles and the contacts follow the
+/// same layout
+///
+class BIORBD_API Scene
+{
+public:
+    ///
+    /// \brief Construct an empty scene
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    Scene(
+        size_t nbThreads = 0);
+
+    ///
+    /// \brief Construct a scene from several bioMod files
+    /// \param paths The path of the model of each subject
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    Scene(
+        const std::vector<utils::Path>& paths,
+        size_t nbThreads = 0);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~Scene();
+
+    ///
+    /// \brief Load a subject and add it at the end of the scene
+    /// \param path The path of the model of the subject
+    /// \return The index of the subject
+    ///
+    size_t addSubject(
+        const utils::Path& path);
+
+    ///
+    /// \brief Add a subject at the end of the scene
+    /// \param model The model of the subject (it is shared, not copied)
+    /// \return The index of the subject
+    ///
+    /// The subjects are evaluated concurrently and each evaluation updates the kinematics stored in
+    /// the model, so a model cannot be the one of two subjects and must not be used elsewhere while
+    /// the scene is evaluated. The shallow copies of a model share its data, so passing a copy of the
+    /// model of another subject throws as well: load the model again for each subject
+    ///
+    size_t addSubject(
+        const std::shared_ptr<Model>& model);
+
+    ///
+    /// \brief Return the number of subjects
+    /// \return The number of subjects
+    ///
+    size_t nbSubjects() const;
+
+    ///
+    /// \brief Return the model of a subject
+    /// \param idx The index of the subject
+    /// \return The model of the subject
+    ///
+    Model& subject(
+        size_t idx);
+
+    ///
+    /// \brief Return the number of threads
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Return the number of generalized coordinates of the scene
+    /// \return The number of generalized coordinates
+    ///
+    size_t nbQ() const;
+
+    ///
+    /// \brief Return the number of generalized velocities (and accelerations) of the scene
+    /// \return The number of generalized velocities
+    ///
+    size_t nbQdot() const;
+
+    ///
+    /// \brief Return the number of generalized torques of the scene
+    /// \return The number of generalized torques
+    ///
+    size_t nbGeneralizedTorque() const;
+
+    ///
+    /// \brief Return the number of markers of the scene
+    /// \return The number of markers
+    ///
+    size_t nbMarkers() const;
+
+    ///
+    /// \brief Return the number of contacts of the scene
+    /// \return The number of contacts
+    ///
+    size_t nbContacts() const;
+
+#ifdef MODULE_MUSCLES
+    ///
+    /// \brief Return the number of muscles of the scene
+    /// \return The number of muscles
+    ///
+    size_t nbMuscles() const;
+#endif
+
+    ///
+    /// \brief Return the index of the first generalized coordinate of a subject in the scene
+    /// \param idx The index of the subject
+    /// \return The index of the first generalized coordinate
+    ///
+    size_t firstQIndex(
+        size_t idx) const;
+
+    ///
+    /// \brief Return the index of the first generalized velocity (or torque) of a subject in the scene
+    /// \param idx The index of the subject
+    /// \return The index of the first generalized velocity
+    ///
+    size_t firstQdotIndex(
+        size_t idx) const;
+
+    ///
+    /// \brief Compute the kinematics of each subject
+    /// \param Q The generalized coordinates of the scene
+    /// \param QDot The generalized velocities of the scene (can be nullptr if no quantity needs it)
+    /// \param QDDot The generalized accelerations of the scene (can be nullptr if no quantity needs it)
+    /// \param quantities The requested quantities, a combination of KINEMATICS_QUANTITY
+    /// \param results The results of each subject (resized to the number of subjects)
+    ///
+    void evaluate(
+        const utils::Vector& Q,
+        const utils::Vector* QDot,
+        const utils::Vector* QDDot,
+        int quantities,
+        std::vector<rigidbody::KinematicsResults>& results);
+
+    ///
+    /// \brief Compute the position of all the markers of the scene
+    /// \param Q The generalized coordinates of the scene
+    /// \param positions The position of the markers (3 x nbMarkers, resized if needed)
+    /// \param removeAxis If there are axis to remove from the position of the markers
+    ///
+    void markers(
+        const utils::Vector& Q,
+        utils::Matrix& positions,
+        bool removeAxis = true);
+
+    ///
+    /// \brief Compute the forward dynamics of the scene
+    /// \param Q The generalized coordinates of the scene
+    /// \param QDot The generalized velocities of the scene
+    /// \param Tau The generalized torques of the scene
+    /// \param QDDot The generalized accelerations of the scene (output, resized if needed)
+    ///
+    void ForwardDynamics(
+        const utils::Vector& Q,
+        const utils::Vector& QDot,
+        const utils::Vector& Tau,
+        utils::Vector& QDDot);
+
+    ///
+    /// \brief Compute the forward dynamics of the scene with the contacts of each subject
+    /// \param Q The generalized coordinates of the scene
+    /// \param QDot The generalized velocities of the scene
+    /// \param Tau The generalized torques of the scene
+    /// \param QDDot The generalized accelerations of the scene (output, resized if needed)
+    /// \param contactForces The forces of the contacts of the scene (output, resized if needed, can be nullptr)
+    ///
+    void ForwardDynamicsConstraintsDirect(
+        const utils::Vector& Q,
+        const utils::Vector& QDot,
+        const utils::Vector& Tau,
+        utils::Vector& QDDot,
+        utils::Vector* contactForces = nullptr);
+
+    ///
+    /// \brief Compute the inverse dynamics of the scene
+    /// \param Q The generalized coordinates of the scene
+    /// \param QDot The generalized velocities of the scene
+    /// \param QDDot The generalized accelerations of the scene
+    /// \param Tau The generalized torques of the scene (output, resized if needed)
+    ///
+    void InverseDynamics(
+        const utils::Vector& Q,
+        const utils::Vector& QDot,
+        const utils::Vector& QDDot,
+        utils::Vector& Tau);
+
+#ifdef MODULE_MUSCLES
+    ///
+    /// \brief Compute the forward dynamics of the scene driven by the muscles (see Model::muscleDrivenForwardDynamics)
+    /// \param Q The generalized coordinates of the scene
+    /// \param QDot The generalized velocities of the scene
+    /// \param emg The dynamic state of each muscle of the scene
+    /// \param QDDot The generalized accelerations of the scene (output, resized if needed)
+    /// \param residualTau The generalized torques of the scene added to the internal forces (can be nullptr)
+    ///
+    void muscleDrivenForwardDynamics(
+        const utils::Vector& Q,
+        const utils::Vector& QDot,
+        const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+        utils::Vector& QDDot,
+        const utils::Vector* residualTau = nullptr);
+#endif
+
+protected:
+#ifndef SWIG
+    std::shared_ptr<utils::ThreadPool> m_pool; ///< The threads
+    std::vector<std::shared_ptr<SceneSubject>> m_subjects; ///< The subjects and their buffers
+
+    ///
+    /// \brief Check the size of a vector of the scene
+    /// \param vector The vector to check
+    /// \param size The expected size
+    /// \param name The name of the vector for the error message
+    ///
+    void checkSize(
+        const utils::Vector& vector,
+        size_t size,
+        const char* name) const;
+#endif
+
+private:
+    Scene(const Scene&);
+    Scene& operator=(const Scene&);
+};
+
+}
+}
+
+#endif // BIORBD_SIMULATION_SCENE_H
@@ -0,0 +1,132 @@
+#ifndef BIORBD_SIMULATION_ENUMS_H
+#define BIORBD_SIMULATION_ENUMS_H
+
+namespace BIORBD_NAMESPACE
+{
+namespace simulation
+{
+
+///
+/// \brief The available time integrators
+///
+enum INTEGRATOR_TYPE {
+    INTEGRATOR_RK4, ///< Fixed step Runge-Kutta of order 4
+    INTEGRATOR_SEMI_IMPLICIT_EULER, ///< Fixed step symplectic Euler (the velocities are updated first)
+    INTEGRATOR_RK45, ///< Adaptive step Dormand-Prince of order 5(4)
+    NO_INTEGRATOR_TYPE
+};
+
+///
+/// \brief INTEGRATOR_TYPE_toStr returns the type name in a string format
+/// \param type The type to convert to string
+/// \return The name of the type
+///
+inline const char* INTEGRATOR_TYPE_toStr(INTEGRATOR_TYPE type)
+{
+    switch (type) {
+    case INTEGRATOR_RK4:
+        return "RK4";
+    case INTEGRATOR_SEMI_IMPLICIT_EULER:
+        return "SemiImplicitEuler";
+    case INTEGRATOR_RK45:
+        return "RK45";
+    default:
+        return "NoType";
+    }
+}
+
+///
+/// \brief The parameters of a model that can be swept
+///
+enum SWEEP_PARAMETER {
+    SEGMENT_MASS, ///< The mass of a segment
+    SEGMENT_COM_X, ///< The X coordinate of the center of mass of a segment
+    SEGMENT_COM_Y, ///< The Y coordinate of the center of mass of a segment
+    SEGMENT_COM_Z, ///< The Z coordinate of the center of mass of a segment
+    SEGMENT_INERTIA_XX, ///< The XX moment of inertia of a segment
+    SEGMENT_INERTIA_YY, ///< The YY moment of inertia of a segment
+    SEGMENT_INERTIA_ZZ, ///< The ZZ moment of inertia of a segment
+    SEGMENT_INERTIA_XY, ///< The XY product of inertia of a segment (the matrix is kept symmetric)
+    SEGMENT_INERTIA_XZ, ///< The XZ product of inertia of a segment (the matrix is kept symmetric)
+    SEGMENT_INERTIA_YZ, ///< The YZ product of inertia of a segment (the matrix is kept symmetric)
+    MUSCLE_FORCE_ISO_MAX, ///< The maximal isometric force of a muscle
+    MUSCLE_OPTIMAL_LENGTH, ///< The optimal length of a muscle
+    MUSCLE_TENDON_SLACK_LENGTH, ///< The tendon slack length of a muscle
+    MUSCLE_PENNATION_ANGLE, ///< The angle of pennation of a muscle
+    NO_SWEEP_PARAMETER
+};
+
+///
+/// \brief SWEEP_PARAMETER_toStr returns the parameter name in a string format
+/// \param parameter The parameter to convert to string
+/// \return The name of the parameter
+///
+inline const char* SWEEP_PARAMETER_toStr(SWEEP_PARAMETER parameter)
+{
+    switch (parameter) {
+    case SEGMENT_MASS:
+        return "SegmentMass";
+    case SEGMENT_COM_X:
+        return "SegmentCoMX";
+    case SEGMENT_COM_Y:
+        return "SegmentCoMY";
+    case SEGMENT_COM_Z:
+        return "SegmentCoMZ";
+    case SEGMENT_INERTIA_XX:
+        return "SegmentInertiaXX";
+    case SEGMENT_INERTIA_YY:
+        return "SegmentInertiaYY";
+    case SEGMENT_INERTIA_ZZ:
+        return "SegmentInertiaZZ";
+    case SEGMENT_INERTIA_XY:
+        return "SegmentInertiaXY";
+    case SEGMENT_INERTIA_XZ:
+        return "SegmentInertiaXZ";
+    case SEGMENT_INERTIA_YZ:
+        return "SegmentInertiaYZ";
+    case MUSCLE_FORCE_ISO_MAX:
+        return "MuscleForceIsoMax";
+    case MUSCLE_OPTIMAL_LENGTH:
+        return "MuscleOptimalLength";
+    case MUSCLE_TENDON_SLACK_LENGTH:
+        return "MuscleTendonSlackLength";
+    case MUSCLE_PENNATION_ANGLE:
+        return "MusclePennationAngle";
+    default:
+        return "NoParameter";
+    }
+}
+
+///
+/// \brief The quantities that can be evaluated for each sample of a sweep
+///
+enum SWEEP_QUANTITY {
+    SWEEP_INVERSE_DYNAMICS_RESIDUALS, ///< The inverse dynamics minus the given generalized torques (nbGeneralizedTorque)
+    SWEEP_MUSCLE_FORCES, ///< The force of each muscle (nbMuscles)
+    SWEEP_CENTER_OF_MASS, ///< The position of the center of mass (3)
+    NO_SWEEP_QUANTITY
+};
+
+///
+/// \brief SWEEP_QUANTITY_toStr returns the quantity name in a string format
+/// \param quantity The quantity to convert to string
+/// \return The name of the quantity
+///
+inline const char* SWEEP_QUANTITY_toStr(SWEEP_QUANTITY quantity)
+{
+    switch (quantity) {
+    case SWEEP_INVERSE_DYNAMICS_RESIDUALS:
+        return "InverseDynamicsResiduals";
+    case SWEEP_MUSCLE_FORCES:
+        return "MuscleForces";
+    case SWEEP_CENTER_OF_MASS:
+        return "CenterOfMass";
+    default:
+        return "NoQuantity";
+    }
+}
+
+}
+}
+
+#endif // BIORBD_SIMULATION_ENUMS_H
@@ -0,0 +1,116 @@
+#ifndef BIORBD_SIMULATION_TRAJECTORY_DYNAMICS_H
+#define BIORBD_SIMULATION_TRAJECTORY_DYNAMICS_H
+
+#include <vector>
+#include <memory>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+class Model;
+
+namespace utils
+{
+class Path;
+class String;
+class Matrix;
+class ThreadPool;
+}
+
+namespace simulation
+{
+
+///
+/// \brief Compute the dynamics of every frame of a trajectory in parallel
+///
+/// The frames are the columns of the matrices. Each thread owns a copy of the model, so the frames
+/// do not share the kinematics and the workspaces of RBDL
+///
+class BIORBD_API TrajectoryDynamics
+{
+public:
+    ///
+    /// \brief Load a model for each thread
+    /// \param path The path of the model
+    /// \param nbThreads The number of threads (0 to use all the hardware threads)
+    ///
+    TrajectoryDynamics(
+        const utils::Path& path,
+        size_t nbThreads = 0);
+
+    ///
+    /// \brief Destroy the class properly
+    ///
+    virtual ~TrajectoryDynamics();
+
+    ///
+    /// \brief Return the number of threads
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Return the model of a thread
+    /// \param thread The index of the thread
+    /// \return The model
+    ///
+    Model& model(
+        size_t thread = 0);
+
+    ///
+    /// \brief Compute the inverse dynamics of each frame
+    /// \param Q The generalized coordinates (nbQ x nbFrames)
+    /// \param QDot The generalized velocities (nbQdot x nbFrames)
+    /// \param QDDot The generalized accelerations (nbQddot x nbFrames)
+    /// \param Tau The generalized torques of each frame (nbGeneralizedTorque x nbFrames, resized if needed)
+    ///
+    void InverseDynamics(
+        const utils::Matrix& Q,
+        const utils::Matrix& QDot,
+        const utils::Matrix& QDDot,
+        utils::Matrix& Tau);
+
+    ///
+    /// \brief Compute the forward dynamics of each frame
+    /// \param Q The generalized coordinates (nbQ x nbFrames)
+    /// \param QDot The generalized velocities (nbQdot x nbFrames)
+    /// \param Tau The generalized torques (nbGeneralizedTorque x nbFrames)
+    /// \param QDDot The generalized accelerations of each frame (nbQddot x nbFrames, resized if needed)
+    ///
+    void ForwardDynamics(
+        const utils::Matrix& Q,
+        const utils::Matrix& QDot,
+        const utils::Matrix& Tau,
+        utils::Matrix& QDDot);
+
+protected:
+#ifndef SWIG
+    ///
+    /// \brief Check the dimensions of the inputs and return the number of frames
+    /// \param first The first input (nbQ rows)
+    /// \param second The second input (nbQdot rows)
+    /// \param third The third input
+    /// \param nbRowsThird The number of rows of the third input
+    /// \param nameThird The name of the third input
+    /// \return The number of frames
+    ///
+    size_t checkFrames(
+        const utils::Matrix& first,
+        const utils::Matrix& second,
+        const utils::Matrix& third,
+        size_t nbRowsThird,
+        const utils::String& nameThird) const;
+
+    std::shared_ptr<utils::ThreadPool> m_pool; ///< The threads
+    std::vector<std::shared_ptr<Model>> m_models; ///< A model per thread
+#endif
+
+private:
+    TrajectoryDynamics(const TrajectoryDynamics&);
+    TrajectoryDynamics& operator=(const TrajectoryDynamics&);
+};
+
+}
+}
+
+#endif // BIORBD_SIMULATION_TRAJECTORY_DYNAMICS_H
@@ -0,0 +1,11 @@
+#ifndef BIORBD_SIMULATION_ALL_H
+#define BIORBD_SIMULATION_ALL_H
+
+#include "Simulation/SimulationEnums.h"
+#include "Simulation/Integrator.h"
+#include "Simulation/Rollouts.h"
+#include "Simulation/Scene.h"
+#include "Simulation/ParameterSweep.h"
+#include "Simulation/TrajectoryDynamics.h"
+
+#endif // BIORBD_SIMULATION_ALL_H
@@ -0,0 +1,115 @@
+#ifndef BIORBD_UTILS_ARENA_H
+#define BIORBD_UTILS_ARENA_H
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class ArenaBlock;
+
+///
+/// \brief Contiguous storage for many small objects held by std::shared_ptr
+///
+/// The objects are constructed one after the other in blocks of memory. Each pointer returned by
+/// make shares the ownership of the whole block of its object, so the pointers behave as the ones of
+/// std::make_shared (their copies share the object) while a single allocation holds many objects.
+/// A block is freed, and the destructors of its objects are called, once no pointer to any of its
+/// objects remains. A new block is started when an object does not fit in the current one.
+///
+/// It is meant to gather the members of a class that are created and destroyed together
+///
+class BIORBD_API Arena
+{
+public:
+    ///
+    /// \brief Create an arena
+    /// \param blockSize The size of the blocks in bytes (an object larger than that gets a block of its own)
+    ///
+    Arena(
+        size_t blockSize = 256);
+
+    ///
+    /// \brief Release the arena (the blocks live as long as pointers to their objects do)
+    ///
+    virtual ~Arena();
+
+    ///
+    /// \brief Construct an object in the arena
+    /// \param args The arguments of the constructor of the object
+    /// \return The pointer to the object
+    ///
+    template<typename T, typename... Args>
+    std::shared_ptr<T> make(
+        Args&&... args)
+    {
+        void* memory(allocate(sizeof(T), alignof(T)));
+        T* object(new (memory) T(std::forward<Args>(args)...));
+        if (!std::is_trivially_destructible<T>::value) {
+            addDestructor(object, &destroy<T>);
+        }
+        return std::shared_ptr<T>(m_block, object);
+    }
+
+    ///
+    /// \brief Return the number of blocks allocated by the arena
+    /// \return The number of blocks
+    ///
+    size_t nbBlocks() const;
+
+    ///
+    /// \brief Return the number of bytes used by the objects of the arena (padding included)
+    /// \return The number of bytes
+    ///
+    size_t bytes() const;
+
+protected:
+    std::shared_ptr<ArenaBlock> m_block; ///< The block being filled
+    size_t m_blockSize; ///< The size of the blocks
+    size_t m_nbBlocks; ///< The number of blocks allocated
+    size_t m_bytes; ///< The number of bytes used
+
+    ///
+    /// \brief Reserve memory in the current block, starting a new one if needed
+    /// \param size The size of the object
+    /// \param alignment The alignment of the object
+    /// \return The address of the memory
+    ///
+    void* allocate(
+        size_t size,
+        size_t alignment);
+
+    ///
+    /// \brief Register the destructor of an object, called when its block is freed
+    /// \param object The object
+    /// \param destructor The function that destroys the object
+    ///
+    void addDestructor(
+        void* object,
+        void (*destructor)(void*));
+
+    ///
+    /// \brief Call the destructor of an object
+    /// \param object The object
+    ///
+    template<typename T>
+    static void destroy(
+        void* object)
+    {
+        static_cast<T*>(object)->~T();
+    }
+
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+};
+
+}
+}
+
+#endif // BIORBD_UTILS_ARENA_H
@@ -0,0 +1,43 @@
+#ifndef BIORBD_UTILS_DIFFERENTIATION_H
+#define BIORBD_UTILS_DIFFERENTIATION_H
+
+#include <functional>
+#include "biorbdConfig.h"
+#include "Utils/Matrix.h"
+#include "Utils/Vector.h"
+
+#ifndef BIORBD_USE_CASADI_MATH
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+
+///
+/// \brief Jacobians of vector functions approximated by finite differences
+///
+class BIORBD_API Differentiation
+{
+public:
+    ///
+    /// \brief Approximate the Jacobian of any function by central finite differences
+    /// \param f The function
+    /// \param x The point where the Jacobian is computed
+    /// \param step The step on each input
+    /// \param value The value of the function at x (output, optional)
+    /// \return The Jacobian (size of f x size of x)
+    ///
+    /// The function is evaluated 2 * size of x times (once more if the value is requested)
+    ///
+    static Matrix finiteDifferences(
+        const std::function<Vector(const Vector&)>& f,
+        const Vector& x,
+        double step = 1e-6,
+        Vector* value = nullptr);
+
+};
+
+}
+}
+#endif
+
+#endif // BIORBD_UTILS_DIFFERENTIATION_H
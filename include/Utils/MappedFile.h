@@ -0,0 +1,124 @@
+#ifndef BIORBD_UTILS_MAPPED_FILE_H
+#define BIORBD_UTILS_MAPPED_FILE_H
+
+#include <memory>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class Path;
+class MappedFileHandle;
+
+///
+/// \brief Read-only file mapped in memory with a cursor to parse it
+///
+/// The pages of the file are loaded by the system when they are read, so a file can be parsed
+/// sequentially without being loaded at once. The words skip the c-like comments (// and / *).
+/// Copies share the mapping and the cursor
+///
+class BIORBD_API MappedFile
+{
+public:
+    ///
+    /// \brief Map a file
+    /// \param path The path of the file
+    ///
+    MappedFile(
+        const Path& path);
+
+    ///
+    /// \brief Unmap the file when the last copy is destroyed
+    ///
+    virtual ~MappedFile();
+
+    ///
+    /// \brief Return the size of the file
+    /// \return The size of the file in bytes
+    ///
+    size_t size() const;
+
+    ///
+    /// \brief Return the position of the cursor
+    /// \return The position of the cursor in bytes
+    ///
+    size_t position() const;
+
+    ///
+    /// \brief Move the cursor
+    /// \param position The new position of the cursor in bytes
+    ///
+    void setPosition(
+        size_t position);
+
+    ///
+    /// \brief Return if the cursor reached the end of the file
+    /// \return If the cursor reached the end of the file
+    ///
+    bool eof() const;
+
+    ///
+    /// \brief Read the next word, skipping the spaces and the comments
+    /// \param begin The first character of the word (output)
+    /// \param end One past the last character of the word (output)
+    /// \return False if the end of the file was reached
+    ///
+    bool readWord(
+        const char*& begin,
+        const char*& end);
+
+    ///
+    /// \brief Read the next word and compare it to a tag
+    /// \param tag The expected word (case insensitive)
+    /// \return If the next word is the tag
+    ///
+    bool readTag(
+        const char* tag);
+
+    ///
+    /// \brief Move the cursor after the next occurence of a word
+    /// \param tag The word to find (case insensitive)
+    /// \return False if the word was not found
+    ///
+    bool reachTag(
+        const char* tag);
+
+    ///
+    /// \brief Read the next word as a number
+    /// \param value The number (output)
+    /// \return False if the end of the file was reached
+    ///
+    bool readNumber(
+        double& value);
+
+    ///
+    /// \brief Read the rest of the current line and move the cursor to the next line
+    /// \param begin The first character of the line (output)
+    /// \param end One past the last character of the line, without the end of line (output)
+    /// \return False if the end of the file was reached
+    ///
+    bool readLine(
+        const char*& begin,
+        const char*& end);
+
+    ///
+    /// \brief Convert some characters to a number
+    /// \param begin The first character
+    /// \param end One past the last character
+    /// \return The number, or the evaluation of the text if it is an equation (0 for an empty text)
+    ///
+    static double toNumber(
+        const char* begin,
+        const char* end);
+
+protected:
+    std::shared_ptr<MappedFileHandle> m_handle; ///< The mapping of the file
+    std::shared_ptr<size_t> m_position; ///< The position of the cursor
+
+};
+
+}
+}
+
+#endif // BIORBD_UTILS_MAPPED_FILE_H
@@ -0,0 +1,111 @@
+#ifndef BIORBD_UTILS_MEMORY_FOOTPRINT_H
+#define BIORBD_UTILS_MEMORY_FOOTPRINT_H
+
+#include <memory>
+#include <set>
+#include <vector>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class String;
+
+///
+/// \brief Heap memory held by a set of objects through their std::shared_ptr members
+///
+/// An object shared by several elements (shallow copies) is counted once, and the blocks are
+/// identified by the owner of the pointers so the objects of a same Arena share one block. The number of bytes
+/// is the size of the objects, of the control blocks of the std::shared_ptr and of the buffers of the
+/// containers; the bookkeeping of the system allocator is not included
+///
+class BIORBD_API MemoryFootprint
+{
+public:
+    ///
+    /// \brief Construct an empty footprint
+    ///
+    MemoryFootprint();
+
+    ///
+    /// \brief Return the number of heap blocks
+    /// \return The number of heap blocks
+    ///
+    size_t nbBlocks() const;
+
+    ///
+    /// \brief Return the number of bytes
+    /// \return The number of bytes
+    ///
+    size_t bytes() const;
+
+    ///
+    /// \brief Add an object held by a std::shared_ptr
+    /// \param object The object
+    /// \return If the object was not counted yet (the memory it holds should then be added)
+    ///
+    template<typename T>
+    bool add(
+        const std::shared_ptr<T>& object)
+    {
+        if (!object) {
+            return false;
+        }
+        return addObject(object.get(), std::weak_ptr<const void>(object), sizeof(T));
+    }
+
+    ///
+    /// \brief Add a vector held by a std::shared_ptr and its buffer
+    /// \param vector The vector
+    /// \return If the vector was not counted yet
+    ///
+    template<typename T>
+    bool add(
+        const std::shared_ptr<std::vector<T>>& vector)
+    {
+        if (!vector || !addObject(vector.get(), std::weak_ptr<const void>(vector), sizeof(std::vector<T>))) {
+            return false;
+        }
+        addHeap(vector->capacity() * sizeof(T));
+        return true;
+    }
+
+    ///
+    /// \brief Add a string held by a std::shared_ptr and its buffer
+    /// \param text The string
+    /// \return If the string was not counted yet
+    ///
+    bool add(
+        const std::shared_ptr<String>& text);
+
+    ///
+    /// \brief Add a buffer owned by an object that was already added (the data of a container)
+    /// \param bytes The size of the buffer (nothing is added if it is 0)
+    ///
+    void addHeap(
+        size_t bytes);
+
+protected:
+    std::set<const void*> m_objects; ///< The objects already counted
+    std::set<std::weak_ptr<const void>, std::owner_less<std::weak_ptr<const void>>> m_owners; ///< The blocks already counted
+    size_t m_nbBlocks; ///< The number of heap blocks
+    size_t m_bytes; ///< The number of bytes
+
+    ///
+    /// \brief Add an object, and its block if it was not counted yet
+    /// \param object The address of the object
+    /// \param owner The owner of the object
+    /// \param size The size of the object
+    /// \return If the object was not counted yet
+    ///
+    bool addObject(
+        const void* object,
+        const std::weak_ptr<const void>& owner,
+        size_t size);
+};
+
+}
+}
+
+#endif // BIORBD_UTILS_MEMORY_FOOTPRINT_H
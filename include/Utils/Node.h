@@ -9,6 +9,7 @@ namespace BIORBD_NAMESPACE
 {
 namespace utils
 {
+class MemoryFootprint;
 class String;
 
 ///
@@ -84,6 +85,13 @@ public:
     ///
     NODE_TYPE typeOfNode() const;
 
+    ///
+    /// \brief Add the memory held by the node to a footprint
+    /// \param footprint The footprint to fill
+    ///
+    virtual void memoryFootprint(
+        utils::MemoryFootprint& footprint) const;
+
 protected:
     ///
     /// \brief To set the type
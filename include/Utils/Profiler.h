@@ -0,0 +1,148 @@
+#ifndef BIORBD_UTILS_PROFILER_H
+#define BIORBD_UTILS_PROFILER_H
+
+#include <memory>
+#include <vector>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class String;
+class Path;
+
+///
+/// \brief A zone that was closed by the profiler
+///
+class BIORBD_API ProfilerEvent
+{
+public:
+    const char* m_name; ///< Name of the zone (must outlive the profiler, usually a string literal)
+    long long m_start; ///< Start time of the zone in nanoseconds since the profiler epoch
+    long long m_duration; ///< Duration of the zone in nanoseconds
+    long long m_childrenDuration; ///< Time spent in the nested zones in nanoseconds
+    unsigned int m_depth; ///< Nesting level of the zone (0 for the outermost zones)
+    unsigned int m_threadId; ///< Index of the thread that recorded the zone
+};
+
+///
+/// \brief Hierarchical profiler of the code
+///
+/// Zones are opened and closed in a scoped manner (see ProfilerZone and
+/// the BIORBD_PROFILE_ZONE macro). Each thread records in its own buffer, whose
+/// lock is only contended while the zones are read, and the first zone of a thread
+/// registers its buffer. A thread keeps up to maxEvents zones, the summary still
+/// counts the ones that are not kept.
+/// The instrumentation of the library is compiled only if USE_PROFILER is set
+/// in CMake, the profiler itself is always available
+///
+class BIORBD_API Profiler
+{
+public:
+    ///
+    /// \brief Open a zone on the current thread
+    /// \param name The name of the zone (the pointer is kept, it must outlive the profiler)
+    ///
+    static void beginZone(
+        const char* name);
+
+    ///
+    /// \brief Close the last opened zone of the current thread
+    ///
+    static void endZone();
+
+    ///
+    /// \brief Enable or disable the recording at run-time (enabled by default)
+    /// \param enabled If the zones should be recorded
+    ///
+    static void setEnabled(
+        bool enabled);
+
+    ///
+    /// \brief Return if the recording is enabled
+    /// \return If the recording is enabled
+    ///
+    static bool isEnabled();
+
+    ///
+    /// \brief Set the maximum number of zones kept per thread (1000000 by default)
+    /// \param maxEvents The maximum number of zones
+    ///
+    static void setMaxEvents(
+        size_t maxEvents);
+
+    ///
+    /// \brief Return the maximum number of zones kept per thread
+    /// \return The maximum number of zones
+    ///
+    static size_t maxEvents();
+
+    ///
+    /// \brief Discard all the recorded zones of all the threads
+    ///
+    /// Warning: Must not be called while zones are opened
+    ///
+    static void clear();
+
+    ///
+    /// \brief Return the recorded zones of all the threads (the opened ones are not closed yet)
+    /// \return The recorded zones
+    ///
+    static std::vector<ProfilerEvent> events();
+
+    ///
+    /// \brief Write the recorded zones in the Chrome trace event format (chrome://tracing or Perfetto)
+    /// \param path The path of the json file to write
+    ///
+    static void exportChromeTrace(
+        const Path& path);
+
+    ///
+    /// \brief Return a table of the total, self and mean time spent per zone, the zones that were not kept included
+    /// \return The summary table, sorted by decreasing total time
+    ///
+    static String summary();
+};
+
+///
+/// \brief Scoped zone of the profiler, the zone is closed when the object is destroyed
+///
+class BIORBD_API ProfilerZone
+{
+public:
+    ///
+    /// \brief Open a zone
+    /// \param name The name of the zone (the pointer is kept, it must outlive the profiler)
+    ///
+    ProfilerZone(
+        const char* name);
+
+    ///
+    /// \brief Close the zone
+    ///
+    /// It does not throw, unlike Profiler::endZone: if no zone is opened anymore, it only asserts
+    ///
+    ~ProfilerZone();
+
+protected:
+    bool m_isOpened; ///< If the zone was recorded when opened
+
+private:
+    ProfilerZone(const ProfilerZone&);
+    ProfilerZone& operator=(const ProfilerZone&);
+};
+
+}
+}
+
+#ifdef USE_PROFILER
+#define BIORBD_PROFILE_CONCATENATE_IMPL(a, b) a##b
+#define BIORBD_PROFILE_CONCATENATE(a, b) BIORBD_PROFILE_CONCATENATE_IMPL(a, b)
+#define BIORBD_PROFILE_ZONE(name) \
+    BIORBD_NAMESPACE::utils::ProfilerZone BIORBD_PROFILE_CONCATENATE(biorbdProfilerZone, __LINE__)(name)
+#else
+#define BIORBD_PROFILE_ZONE(name)
+#endif
+
+#endif // BIORBD_UTILS_PROFILER_H
@@ -0,0 +1,142 @@
+#ifndef BIORBD_UTILS_THREAD_POOL_H
+#define BIORBD_UTILS_THREAD_POOL_H
+
+#include <memory>
+#include <functional>
+#include <vector>
+#include "biorbdConfig.h"
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class ThreadPoolWorkers;
+
+///
+/// \brief Pool of threads that run independent tasks in parallel
+///
+/// The threads are created once and wait for work between the calls to parallelFor.
+/// The calling thread takes part in the work, so a pool of n threads creates n-1 threads.
+/// Tasks must not call parallelFor of the same pool, which throws instead of deadlocking.
+///
+/// The tasks are split in contiguous ranges, one per thread. Each thread runs its own range from
+/// the front, by chunks, and a thread that runs out of work steals the second half of the range
+/// of another thread, so uneven tasks are balanced without a shared counter. In deterministic mode
+/// there is no stealing: the thread running a task only depends on the number of tasks and of
+/// threads, so the per-thread results (accumulations, workspaces) are reproducible
+///
+class BIORBD_API ThreadPool
+{
+public:
+    ///
+    /// \brief Create the threads of the pool
+    /// \param nbThreads The number of threads, including the calling one (0 to use all the hardware threads)
+    ///
+    ThreadPool(
+        size_t nbThreads = 0);
+
+    ///
+    /// \brief Wait for the threads to finish and destroy them
+    ///
+    virtual ~ThreadPool();
+
+    ///
+    /// \brief Return the number of threads of the pool, including the calling one
+    /// \return The number of threads
+    ///
+    size_t nbThreads() const;
+
+    ///
+    /// \brief Run the tasks 0 to nbTasks-1 in parallel and return when all of them are done
+    /// \param nbTasks The number of tasks
+    /// \param task The function to call for each task with the index of the task and the index of the thread running it (in [0, nbThreads()[)
+    ///
+    /// If a task throws, the remaining tasks are skipped and the first exception is thrown again by parallelFor
+    ///
+    void parallelFor(
+        size_t nbTasks,
+        const std::function<void(size_t task, size_t thread)>& task);
+
+    ///
+    /// \brief Set the number of tasks a thread takes from its range at once (1 by default)
+    /// \param chunkSize The number of tasks (larger chunks reduce the overhead of very short tasks)
+    ///
+    void setChunkSize(
+        size_t chunkSize);
+
+    ///
+    /// \brief Return the number of tasks a thread takes from its range at once
+    /// \return The number of tasks
+    ///
+    size_t chunkSize() const;
+
+    ///
+    /// \brief Set if the tasks are statically assigned to the threads (false by default)
+    /// \param deterministic If the threads run their own range only, without stealing
+    ///
+    void setDeterministic(
+        bool deterministic);
+
+    ///
+    /// \brief Return if the tasks are statically assigned to the threads
+    /// \return If the tasks are statically assigned to the threads
+    ///
+    bool deterministic() const;
+
+protected:
+    std::shared_ptr<ThreadPoolWorkers> m_workers; ///< The threads and their synchronization
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+///
+/// \brief An object for each thread of a pool (a model, buffers...), so the tasks do not share mutable state
+///
+template<typename T>
+class ThreadLocal
+{
+public:
+    ///
+    /// \brief Create the object of each thread
+    /// \param pool The pool whose threads use the objects
+    /// \param create The function that creates the object of a thread from the index of the thread
+    ///
+    ThreadLocal(
+        const ThreadPool& pool,
+        const std::function<std::shared_ptr<T>(size_t thread)>& create)
+    {
+        for (size_t i=0; i<pool.nbThreads(); ++i) {
+            m_objects.push_back(create(i));
+        }
+    }
+
+    ///
+    /// \brief Return the number of objects (the number of threads of the pool)
+    /// \return The number of objects
+    ///
+    size_t size() const
+    {
+        return m_objects.size();
+    }
+
+    ///
+    /// \brief Return the object of a thread
+    /// \param thread The index of the thread, as given to the tasks of parallelFor
+    /// \return The object of the thread
+    ///
+    T& operator[](
+        size_t thread)
+    {
+        return *m_objects[thread];
+    }
+
+protected:
+    std::vector<std::shared_ptr<T>> m_objects; ///< The object of each thread
+};
+
+}
+}
+
+#endif // BIORBD_UTILS_THREAD_POOL_H
@@ -20,6 +20,7 @@ enum NODE_TYPE {
     VIA_POINT,
     SOFT_CONTACT,
     SOFT_CONTACT_SPHERE,
+    SOFT_CONTACT_MESH,
     NO_NODE_TYPE
 };
 
@@ -52,6 +53,8 @@ inline const char* NODE_TYPE_toStr(
         return "SoftContact";
     case SOFT_CONTACT_SPHERE:
         return "SoftContactSphere";
+    case SOFT_CONTACT_MESH:
+        return "SoftContactMesh";
     default:
         return "NoType";
     }
@@ -1,15 +1,20 @@
 #ifndef BIORBD_UTILS_ALL_H
 #define BIORBD_UTILS_ALL_H
 
+#include "Utils/Arena.h"
 #include "Utils/Benchmark.h"
+#include "Utils/Differentiation.h"
 #include "Utils/Equation.h"
 #include "Utils/Error.h"
 #include "Utils/IfStream.h"
+#include "Utils/MappedFile.h"
 #include "Utils/Matrix.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Node.h"
 #include "Utils/Scalar.h"
 #include "Utils/Vector3d.h"
 #include "Utils/Path.h"
+#include "Utils/Profiler.h"
 #include "Utils/Quaternion.h"
 #include "Utils/Range.h"
 #include "Utils/Rotation.h"
@@ -17,6 +22,7 @@
 #include "Utils/RotoTransNode.h"
 #include "Utils/SpatialVector.h"
 #include "Utils/String.h"
+#include "Utils/ThreadPool.h"
 #include "Utils/Timer.h"
 #include "Utils/UtilsEnum.h"
 #include "Utils/Vector.h"
@@ -7,6 +7,7 @@
 #include "BiorbdModel.h"
 #include "ModelReader.h"
 #include "ModelWriter.h"
+#include "ReducedModel.h"
 
 #include "Utils/all.h"
 #include "RigidBody/all.h"
@@ -30,6 +31,10 @@
 #include "InternalForces/Ligaments/all.h"
 #endif
 
+#ifdef MODULE_SIMULATION
+#include "Simulation/all.h"
+#endif
+
 
 #ifdef BIORBD_USE_CASADI_MATH
 #include "Utils/CasadiExpand.h"
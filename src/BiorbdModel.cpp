@@ -3,16 +3,38 @@
 
 #include <rbdl/Model.h>
 #include <rbdl/Kinematics.h>
+#include <rbdl/Dynamics.h>
 #include "ModelReader.h"
 #include "RigidBody/ExternalForceSet.h"
 #include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
+#include "RigidBody/GeneralizedTorque.h"
+#include "RigidBody/KinematicsResults.h"
 #include "RigidBody/NodeSegment.h"
+#include "RigidBody/Segment.h"
+#include "RigidBody/IMU.h"
+#ifdef MODULE_MUSCLES
+#include "InternalForces/Muscles/MuscleGroup.h"
+#endif
 
+#include "Utils/Profiler.h"
+#include "Utils/Error.h"
 #include "Utils/String.h"
 
 
 using namespace BIORBD_NAMESPACE;
 
+#ifdef MODULE_MUSCLES
+class Model::ForwardDynamicsWorkspace
+{
+public:
+    utils::Vector m_muscleForces; ///< The force of each muscle
+    rigidbody::GeneralizedTorque m_tau; ///< The accumulated generalized torques
+    std::vector<RigidBodyDynamics::Math::SpatialVector> m_fExt; ///< The external forces in the RBDL format
+};
+#endif
+
 utils::String getVersion()
 {
     return BIORBD_VERSION;
@@ -20,12 +42,18 @@ utils::String getVersion()
 
 Model::Model() :
     m_path(std::make_shared<utils::Path>())
+#ifdef MODULE_MUSCLES
+    , m_forwardDynamicsWorkspace(std::make_shared<ForwardDynamicsWorkspace>())
+#endif
 {
 
 }
 
 Model::Model(const utils::Path &path) :
     m_path(std::make_shared<utils::Path>(path))
+#ifdef MODULE_MUSCLES
+    , m_forwardDynamicsWorkspace(std::make_shared<ForwardDynamicsWorkspace>())
+#endif
 {
     Reader::readModelFile(*m_path, this);
 }
@@ -35,9 +63,195 @@ utils::Path Model::path() const
     return *m_path;
 }
 
+std::map<utils::String, utils::MemoryFootprint> Model::memoryFootprint() const
+{
+    std::map<utils::String, utils::MemoryFootprint> footprints;
+
+    utils::MemoryFootprint& segments(footprints["segments"]);
+    segments.add(m_segments);
+    for (auto& segment : *m_segments) {
+        segment.memoryFootprint(segments);
+    }
+
+    utils::MemoryFootprint& markers(footprints["markers"]);
+    markers.add(m_marks);
+    for (auto& marker : *m_marks) {
+        marker.memoryFootprint(markers);
+    }
+
+    utils::MemoryFootprint& imus(footprints["imus"]);
+    imus.add(m_IMUs);
+    imus.add(m_IMUsSegmentIdx);
+    for (auto& imu : *m_IMUs) {
+        imu.memoryFootprint(imus);
+    }
+
+    utils::MemoryFootprint& rts(footprints["rts"]);
+    rts.add(m_RTs);
+    rts.add(m_RTsBodyId);
+    for (auto& rt : *m_RTs) {
+        rt.memoryFootprint(rts);
+    }
+
+    utils::MemoryFootprint& contacts(footprints["contacts"]);
+    contacts.add(m_rigidContacts);
+    for (auto& contact : *m_rigidContacts) {
+        contact.memoryFootprint(contacts);
+    }
+
+#ifdef MODULE_MUSCLES
+    utils::MemoryFootprint& muscles(footprints["muscles"]);
+    muscles.add(internal_forces::muscles::Muscles::m_mus);
+    for (auto& group : *internal_forces::muscles::Muscles::m_mus) {
+        group.memoryFootprint(muscles);
+    }
+#endif
+    return footprints;
+}
+
 rigidbody::ExternalForceSet Model::externalForceSet(
     bool useLinearForces,
     bool useSoftContacts
 ) {
     return rigidbody::ExternalForceSet(*this, useLinearForces, useSoftContacts);
-}
\ No newline at end of file
+}
+void Model::evaluate(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity* QDot,
+    const rigidbody::GeneralizedAcceleration* QDDot,
+    int quantities,
+    rigidbody::KinematicsResults& results,
+    bool removeAxis,
+    bool updateKin)
+{
+    rigidbody::Joints::evaluate(Q, QDot, QDDot, quantities, results, updateKin);
+    if (quantities & rigidbody::KINEMATICS_MARKERS) {
+        // The kinematics was updated by the joints
+        markersInMatrix(Q, results.m_markers, removeAxis, false);
+    }
+}
+
+#ifdef MODULE_MUSCLES
+rigidbody::GeneralizedAcceleration Model::muscleDrivenForwardDynamics(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    const rigidbody::GeneralizedTorque* residualTau)
+{
+    rigidbody::GeneralizedAcceleration QDDot(*this);
+    muscleDrivenForwardDynamics(Q, QDot, emg, residualTau, nullptr, false, QDDot);
+    return QDDot;
+}
+
+rigidbody::GeneralizedAcceleration Model::muscleDrivenForwardDynamics(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    rigidbody::ExternalForceSet& externalForces,
+    const rigidbody::GeneralizedTorque* residualTau)
+{
+    rigidbody::GeneralizedAcceleration QDDot(*this);
+    muscleDrivenForwardDynamics(Q, QDot, emg, residualTau, &externalForces, false, QDDot);
+    return QDDot;
+}
+
+rigidbody::GeneralizedAcceleration Model::muscleDrivenForwardDynamicsConstraintsDirect(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    const rigidbody::GeneralizedTorque* residualTau)
+{
+    rigidbody::GeneralizedAcceleration QDDot(*this);
+    muscleDrivenForwardDynamics(Q, QDot, emg, residualTau, nullptr, true, QDDot);
+    return QDDot;
+}
+
+rigidbody::GeneralizedAcceleration Model::muscleDrivenForwardDynamicsConstraintsDirect(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    rigidbody::ExternalForceSet& externalForces,
+    const rigidbody::GeneralizedTorque* residualTau)
+{
+    rigidbody::GeneralizedAcceleration QDDot(*this);
+    muscleDrivenForwardDynamics(Q, QDot, emg, residualTau, &externalForces, true, QDDot);
+    return QDDot;
+}
+
+void Model::muscleDrivenForwardDynamics(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    const rigidbody::GeneralizedTorque* residualTau,
+    rigidbody::ExternalForceSet* externalForces,
+    bool useConstraints,
+    rigidbody::GeneralizedAcceleration& QDDot)
+{
+    BIORBD_PROFILE_ZONE("Model::muscleDrivenForwardDynamics");
+    utils::Error::check(emg.size() == nbMuscles(),
+                        "The number of muscle states must be equal to the number of muscles");
+    checkGeneralizedDimensions(&Q, &QDot, nullptr, residualTau);
+    ForwardDynamicsWorkspace& workspace(*m_forwardDynamicsWorkspace);
+    if (static_cast<size_t>(QDDot.size()) != nbQddot()) {
+        QDDot = rigidbody::GeneralizedAcceleration(*this);
+    }
+
+    // The only kinematics update, all the internal forces are computed from it
+#ifdef BIORBD_USE_CASADI_MATH
+    bool updateKin = true;
+#else
+    UpdateKinematicsCustom(&Q, &QDot);
+    bool updateKin = false;
+#endif
+
+    rigidbody::GeneralizedTorque& tau(workspace.m_tau);
+    if (residualTau) {
+        tau = *residualTau;
+    } else {
+        if (static_cast<size_t>(tau.size()) != nbGeneralizedTorque()) {
+            tau = rigidbody::GeneralizedTorque(*this);
+        }
+        tau.setZero();
+    }
+
+    {
+        BIORBD_PROFILE_ZONE("Model::muscleDrivenForwardDynamics::muscles");
+        updateMuscles(Q, QDot, updateKin);
+        computeMuscleForces(emg, workspace.m_muscleForces);
+        accumulateMuscularJointTorque(workspace.m_muscleForces, tau);
+    }
+
+#ifdef MODULE_LIGAMENTS
+    if (nbLigaments()) {
+        BIORBD_PROFILE_ZONE("Model::muscleDrivenForwardDynamics::ligaments");
+        updateLigaments(Q, QDot, updateKin);
+        computeLigamentForces();
+        accumulateLigamentsJointTorque(m_engine->m_force, tau);
+    }
+#endif
+
+#ifdef MODULE_PASSIVE_TORQUES
+    if (nbPassiveTorques()) {
+        BIORBD_PROFILE_ZONE("Model::muscleDrivenForwardDynamics::passiveTorques");
+        accumulatePassiveJointTorque(Q, QDot, tau);
+    }
+#endif
+
+    {
+        BIORBD_PROFILE_ZONE("Model::muscleDrivenForwardDynamics::externalForces");
+        if (externalForces) {
+            workspace.m_fExt = externalForces->computeRbdlSpatialVectors(Q, QDot, updateKin);
+        } else {
+            // The capacity of the buffer is reused
+            workspace.m_fExt.assign(mBodies.size(), RigidBodyDynamics::Math::SpatialVector::Zero());
+        }
+    }
+
+    BIORBD_PROFILE_ZONE("Model::muscleDrivenForwardDynamics::dynamics");
+    if (useConstraints) {
+        getConstraints().solveForwardDynamics(*this, Q, QDot, tau, workspace.m_fExt, QDDot, updateKin);
+    } else {
+        RigidBodyDynamics::ForwardDynamics(*this, Q, QDot, tau, QDDot, &workspace.m_fExt);
+    }
+}
+#endif
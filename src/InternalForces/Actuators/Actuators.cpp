@@ -2,6 +2,7 @@
 #include "InternalForces/Actuators/Actuators.h"
 
 #include <vector>
+#include <algorithm>
 #include "Utils/Error.h"
 #include "RigidBody/GeneralizedTorque.h"
 #include "RigidBody/GeneralizedCoordinates.h"
@@ -23,7 +24,9 @@ using namespace BIORBD_NAMESPACE;
 internal_forces::actuator::Actuators::Actuators() :
     m_all(std::make_shared<std::vector<std::pair<std::shared_ptr<internal_forces::actuator::Actuator>, std::shared_ptr<internal_forces::actuator::Actuator>>>>()),
     m_isDofSet(std::make_shared<std::vector<bool>>(1)),
-    m_isClose(std::make_shared<bool>(false))
+    m_isClose(std::make_shared<bool>(false)),
+    m_concentricTable(std::make_shared<std::vector<internal_forces::actuator::Actuators::ActuatorTableEntry>>()),
+    m_eccentricTable(std::make_shared<std::vector<internal_forces::actuator::Actuators::ActuatorTableEntry>>())
 {
     (*m_isDofSet)[0] = false;
 }
@@ -32,7 +35,9 @@ internal_forces::actuator::Actuators::Actuators(
     const internal_forces::actuator::Actuators& other) :
     m_all(other.m_all),
     m_isDofSet(other.m_isDofSet),
-    m_isClose(other.m_isClose)
+    m_isClose(other.m_isClose),
+    m_concentricTable(other.m_concentricTable),
+    m_eccentricTable(other.m_eccentricTable)
 {
 
 }
@@ -104,6 +109,9 @@ void internal_forces::actuator::Actuators::DeepCopy(const internal_forces::actua
         (*m_isDofSet)[i] = (*other.m_isDofSet)[i];
     }
     *m_isClose = *other.m_isClose;
+    if (*m_isClose) {
+        compileActuatorTables();
+    }
 }
 
 void internal_forces::actuator::Actuators::addActuator(const internal_forces::actuator::Actuator
@@ -208,9 +216,36 @@ void internal_forces::actuator::Actuators::closeActuator()
                                     "All DoF must have their actuators set "
                                     "before closing the model");
 
+    compileActuatorTables();
     *m_isClose = true;
 }
 
+void internal_forces::actuator::Actuators::compileActuatorTables()
+{
+    m_concentricTable->clear();
+    m_eccentricTable->clear();
+    for (size_t i=0; i<m_all->size(); ++i) {
+        ActuatorTableEntry concentric;
+        concentric.m_type = (*m_all)[i].first->type();
+        concentric.m_dofIdx = static_cast<unsigned int>(i);
+        concentric.m_actuator = (*m_all)[i].first;
+        m_concentricTable->push_back(concentric);
+
+        ActuatorTableEntry eccentric;
+        eccentric.m_type = (*m_all)[i].second->type();
+        eccentric.m_dofIdx = static_cast<unsigned int>(i);
+        eccentric.m_actuator = (*m_all)[i].second;
+        m_eccentricTable->push_back(eccentric);
+    }
+
+    // Group the actuators of the same type so they are evaluated one after the other
+    auto byType = [](const ActuatorTableEntry& a, const ActuatorTableEntry& b) {
+        return a.m_type < b.m_type;
+    };
+    std::stable_sort(m_concentricTable->begin(), m_concentricTable->end(), byType);
+    std::stable_sort(m_eccentricTable->begin(), m_eccentricTable->end(), byType);
+}
+
 const std::pair<std::shared_ptr<internal_forces::actuator::Actuator>,
       std::shared_ptr<internal_forces::actuator::Actuator>>&
       internal_forces::actuator::Actuators::actuator(size_t dof)
@@ -264,73 +299,16 @@ internal_forces::actuator::Actuators::torqueMax(
     utils::Error::check(*m_isClose,
                                 "Close the actuator model before calling torqueMax");
 
-    // Assuming that this is also a Joints type (via BiorbdModel)
-    const rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
-
     std::pair<rigidbody::GeneralizedTorque, rigidbody::GeneralizedTorque>
     maxGeneralizedTorque_all =
-        std::make_pair(rigidbody::GeneralizedTorque(model),
-                       rigidbody::GeneralizedTorque(model));
-
-    for (unsigned int i=0; i<static_cast<unsigned int>(model.nbDof()); ++i) {
-        std::pair<std::shared_ptr<Actuator>, std::shared_ptr<Actuator>>
-                GeneralizedTorque_tp(actuator(i));
-        for (unsigned p=0; p<2; ++p) {
-            if (p==0) // First
-                if (std::dynamic_pointer_cast<ActuatorGauss3p> (GeneralizedTorque_tp.first)) {
-                    maxGeneralizedTorque_all.first[i] = std::static_pointer_cast<ActuatorGauss3p>
-                                                        (GeneralizedTorque_tp.first)->torqueMax(Q,
-                                                                Qdot);
-                } else if (std::dynamic_pointer_cast<ActuatorConstant>
-                           (GeneralizedTorque_tp.first)) {
-                    maxGeneralizedTorque_all.first[i] = std::static_pointer_cast<ActuatorConstant>
-                                                        (GeneralizedTorque_tp.first)->torqueMax();
-                } else if (std::dynamic_pointer_cast<ActuatorLinear>
-                           (GeneralizedTorque_tp.first)) {
-                    maxGeneralizedTorque_all.first[i] = std::static_pointer_cast<ActuatorLinear>
-                                                        (GeneralizedTorque_tp.first)->torqueMax(
-                                                            Q);
-                } else if (std::dynamic_pointer_cast<ActuatorGauss6p>
-                           (GeneralizedTorque_tp.first)) {
-                    maxGeneralizedTorque_all.first[i] = std::static_pointer_cast<ActuatorGauss6p>
-                                                        (GeneralizedTorque_tp.first)->torqueMax(Q,
-                                                                Qdot);
-                } else if (std::dynamic_pointer_cast<ActuatorSigmoidGauss3p>
-                           (GeneralizedTorque_tp.first)) {
-                    maxGeneralizedTorque_all.first[i] =
-                        std::static_pointer_cast<ActuatorSigmoidGauss3p>
-                        (GeneralizedTorque_tp.first)->torqueMax(Q, Qdot);
-                } else {
-                    utils::Error::raise("Wrong type (should never get here because of previous safety)");
-                }
-            else // Second
-                if (std::dynamic_pointer_cast<ActuatorGauss3p> (GeneralizedTorque_tp.second)) {
-                    maxGeneralizedTorque_all.second[i] = std::static_pointer_cast<ActuatorGauss3p>
-                                                         (GeneralizedTorque_tp.second)->torqueMax(
-                                                                 Q, Qdot);
-                } else if (std::dynamic_pointer_cast<ActuatorConstant>
-                           (GeneralizedTorque_tp.second)) {
-                    maxGeneralizedTorque_all.second[i] = std::static_pointer_cast<ActuatorConstant>
-                                                         (GeneralizedTorque_tp.second)->torqueMax();
-                } else if (std::dynamic_pointer_cast<ActuatorLinear>
-                           (GeneralizedTorque_tp.second)) {
-                    maxGeneralizedTorque_all.second[i] = std::static_pointer_cast<ActuatorLinear>
-                                                         (GeneralizedTorque_tp.second)->torqueMax(
-                                                                 Q);
-                } else if (std::dynamic_pointer_cast<ActuatorGauss6p>
-                           (GeneralizedTorque_tp.second)) {
-                    maxGeneralizedTorque_all.second[i] = std::static_pointer_cast<ActuatorGauss6p>
-                                                         (GeneralizedTorque_tp.second)->torqueMax(
-                                                                 Q, Qdot);
-                } else if (std::dynamic_pointer_cast<ActuatorSigmoidGauss3p>
-                           (GeneralizedTorque_tp.second)) {
-                    maxGeneralizedTorque_all.second[i] =
-                        std::static_pointer_cast<ActuatorSigmoidGauss3p>
-                        (GeneralizedTorque_tp.second)->torqueMax(Q, Qdot);
-                } else {
-                    utils::Error::raise("Wrong type (should never get here because of previous safety)");
-                }
-        }
+        std::make_pair(rigidbody::GeneralizedTorque(nbActuators()),
+                       rigidbody::GeneralizedTorque(nbActuators()));
+
+    for (const ActuatorTableEntry& entry : *m_concentricTable) {
+        maxGeneralizedTorque_all.first[entry.m_dofIdx] = torqueMaxFromTable(entry, Q, Qdot);
+    }
+    for (const ActuatorTableEntry& entry : *m_eccentricTable) {
+        maxGeneralizedTorque_all.second[entry.m_dofIdx] = torqueMaxFromTable(entry, Q, Qdot);
     }
 
     return maxGeneralizedTorque_all;
@@ -345,10 +323,6 @@ rigidbody::GeneralizedTorque internal_forces::actuator::Actuators::torqueMax(
     utils::Error::check(*m_isClose,
                                 "Close the actuator model before calling torqueMax");
 
-    // Assuming that this is also a Joints type (via BiorbdModel)
-    const rigidbody::Joints &model =
-        dynamic_cast<rigidbody::Joints &>(*this);
-
     // Set qdot to be positive if concentric and negative if excentric
     rigidbody::GeneralizedVelocity QdotResigned(Qdot);
     for (unsigned int i=0; i<static_cast<unsigned int>(Qdot.size()); ++i) {
@@ -363,24 +337,35 @@ rigidbody::GeneralizedTorque internal_forces::actuator::Actuators::torqueMax(
 #endif
     }
 
-    rigidbody::GeneralizedTorque maxGeneralizedTorque_all(model);
+    rigidbody::GeneralizedTorque maxGeneralizedTorque_all(nbActuators());
 
-    for (unsigned int i=0; i< static_cast<unsigned int>(model.nbDof()); ++i) {
 #ifdef BIORBD_USE_CASADI_MATH
+    rigidbody::GeneralizedTorque maxGeneralizedTorque_eccentric(nbActuators());
+    for (const ActuatorTableEntry& entry : *m_concentricTable) {
+        maxGeneralizedTorque_all[entry.m_dofIdx] = torqueMaxFromTable(entry, Q, QdotResigned);
+    }
+    for (const ActuatorTableEntry& entry : *m_eccentricTable) {
+        maxGeneralizedTorque_eccentric[entry.m_dofIdx] = torqueMaxFromTable(entry, Q, QdotResigned);
+    }
+    for (unsigned int i=0; i< static_cast<unsigned int>(nbActuators()); ++i) {
         maxGeneralizedTorque_all[i] = IF_ELSE_NAMESPACE::if_else(
                                           IF_ELSE_NAMESPACE::ge(activation(i, 0), 0),
-                                          getTorqueMaxDirection(actuator(i).first, Q, QdotResigned),
-                                          getTorqueMaxDirection(actuator(i).second, Q, QdotResigned));
+                                          maxGeneralizedTorque_all[i],
+                                          maxGeneralizedTorque_eccentric[i]);
+    }
 #else
-        if (activation[i] >= 0) { // First
-            maxGeneralizedTorque_all[i] = getTorqueMaxDirection(actuator(i).first, Q,
-                                          QdotResigned);
-        } else {
-            maxGeneralizedTorque_all[i] = getTorqueMaxDirection(actuator(i).second, Q,
-                                          QdotResigned);
+    // Only the actuator of the direction requested by the activation is evaluated
+    for (const ActuatorTableEntry& entry : *m_concentricTable) {
+        if (activation[entry.m_dofIdx] >= 0) {
+            maxGeneralizedTorque_all[entry.m_dofIdx] = torqueMaxFromTable(entry, Q, QdotResigned);
         }
-#endif
     }
+    for (const ActuatorTableEntry& entry : *m_eccentricTable) {
+        if (activation[entry.m_dofIdx] < 0) {
+            maxGeneralizedTorque_all[entry.m_dofIdx] = torqueMaxFromTable(entry, Q, QdotResigned);
+        }
+    }
+#endif
 
     return maxGeneralizedTorque_all;
 }
@@ -390,19 +375,31 @@ utils::Scalar internal_forces::actuator::Actuators::getTorqueMaxDirection(
     const rigidbody::GeneralizedCoordinates& Q,
     const rigidbody::GeneralizedVelocity& Qdot) const
 {
-    if (std::dynamic_pointer_cast<ActuatorGauss3p> (actuator)) {
-        return std::static_pointer_cast<ActuatorGauss3p> (actuator)->torqueMax(Q, Qdot);
-    } else if (std::dynamic_pointer_cast<ActuatorConstant> (actuator)) {
-        return std::static_pointer_cast<ActuatorConstant> (actuator)->torqueMax();
-    } else if (std::dynamic_pointer_cast<ActuatorLinear> (actuator)) {
-        return std::static_pointer_cast<ActuatorLinear> (actuator)->torqueMax(Q);
-    } else if (std::dynamic_pointer_cast<ActuatorGauss6p> (actuator)) {
-        return std::static_pointer_cast<ActuatorGauss6p> (actuator)->torqueMax(Q, Qdot);
-    } else if (std::dynamic_pointer_cast<ActuatorSigmoidGauss3p> (actuator)) {
-        return std::static_pointer_cast<ActuatorSigmoidGauss3p> (actuator)->torqueMax(Q,
-                Qdot);
-    } else {
+    ActuatorTableEntry entry;
+    entry.m_type = actuator->type();
+    entry.m_dofIdx = static_cast<unsigned int>(actuator->index());
+    entry.m_actuator = actuator;
+    return torqueMaxFromTable(entry, Q, Qdot);
+}
+
+utils::Scalar internal_forces::actuator::Actuators::torqueMaxFromTable(
+    const ActuatorTableEntry& entry,
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& Qdot) const
+{
+    // The type is known from the table, so the actuator can be statically cast
+    switch (entry.m_type) {
+    case internal_forces::actuator::TYPE::GAUSS3P:
+        return static_cast<ActuatorGauss3p*>(entry.m_actuator.get())->torqueMax(Q, Qdot);
+    case internal_forces::actuator::TYPE::CONSTANT:
+        return static_cast<ActuatorConstant*>(entry.m_actuator.get())->torqueMax();
+    case internal_forces::actuator::TYPE::LINEAR:
+        return static_cast<ActuatorLinear*>(entry.m_actuator.get())->torqueMax(Q);
+    case internal_forces::actuator::TYPE::GAUSS6P:
+        return static_cast<ActuatorGauss6p*>(entry.m_actuator.get())->torqueMax(Q, Qdot);
+    case internal_forces::actuator::TYPE::SIGMOIDGAUSS3P:
+        return static_cast<ActuatorSigmoidGauss3p*>(entry.m_actuator.get())->torqueMax(Q, Qdot);
+    default:
         utils::Error::raise("Wrong type (should never get here because of previous safety)");
     }
-
 }
@@ -2,6 +2,7 @@
 #include "InternalForces/Compound.h"
 
 #include "Utils/String.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Vector3d.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "InternalForces/PathModifiers.h"
@@ -88,3 +89,13 @@ const utils::Scalar& internal_forces::Compound::force()
 {
     return *m_force;
 }
+
+void internal_forces::Compound::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_name);
+    if (footprint.add(m_pathChanger)) {
+        m_pathChanger->memoryFootprint(footprint);
+    }
+    footprint.add(m_force);
+}
@@ -3,6 +3,8 @@
 #include <rbdl/Model.h>
 #include <rbdl/Kinematics.h>
 #include "Utils/Error.h"
+#include "Utils/Arena.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Matrix.h"
 #include "Utils/RotoTrans.h"
 #include "RigidBody/NodeSegment.h"
@@ -17,47 +19,33 @@
 using namespace BIORBD_NAMESPACE;
 
 internal_forces::Geometry::Geometry() :
-    m_origin(std::make_shared<utils::Vector3d>()),
-    m_insertion(std::make_shared<utils::Vector3d>()),
-    m_originInGlobal(std::make_shared<utils::Vector3d>
-                     (utils::Vector3d::Zero())),
-    m_insertionInGlobal(std::make_shared<utils::Vector3d>
-                        (utils::Vector3d::Zero())),
-    m_pointsInGlobal(std::make_shared<std::vector<utils::Vector3d>>()),
-    m_pointsInLocal(std::make_shared<std::vector<utils::Vector3d>>()),
-    m_jacobian(std::make_shared<utils::Matrix>()),
-    m_G(std::make_shared<utils::Matrix>()),
-    m_jacobianLength(std::make_shared<utils::Matrix>()),
-    m_length(std::make_shared<utils::Scalar>(0)),
-    m_velocity(std::make_shared<utils::Scalar>(0)),
-    m_isGeometryComputed(std::make_shared<bool>(false)),
-    m_isVelocityComputed(std::make_shared<bool>(false)),
-    m_posAndJacoWereForced(std::make_shared<bool>(false))
+    internal_forces::Geometry(utils::Vector3d(), utils::Vector3d())
 {
 
 }
 
 internal_forces::Geometry::Geometry(
     const utils::Vector3d &origin,
-    const utils::Vector3d &insertion) :
-    m_origin(std::make_shared<utils::Vector3d>(origin)),
-    m_insertion(std::make_shared<utils::Vector3d>(insertion)),
-    m_originInGlobal(std::make_shared<utils::Vector3d>
-                     (utils::Vector3d::Zero())),
-    m_insertionInGlobal(std::make_shared<utils::Vector3d>
-                        (utils::Vector3d::Zero())),
-    m_pointsInGlobal(std::make_shared<std::vector<utils::Vector3d>>()),
-    m_pointsInLocal(std::make_shared<std::vector<utils::Vector3d>>()),
-    m_jacobian(std::make_shared<utils::Matrix>()),
-    m_G(std::make_shared<utils::Matrix>()),
-    m_jacobianLength(std::make_shared<utils::Matrix>()),
-    m_length(std::make_shared<utils::Scalar>(0)),
-    m_velocity(std::make_shared<utils::Scalar>(0)),
-    m_isGeometryComputed(std::make_shared<bool>(false)),
-    m_isVelocityComputed(std::make_shared<bool>(false)),
-    m_posAndJacoWereForced(std::make_shared<bool>(false))
-{
-
+    const utils::Vector3d &insertion)
+{
+    // The geometry is updated as a whole at each kinematics update, keep its members together
+    utils::Arena arena(1024);
+    m_origin = arena.make<utils::Vector3d>(origin);
+    m_insertion = arena.make<utils::Vector3d>(insertion);
+    m_originInGlobal = arena.make<utils::Vector3d>(utils::Vector3d::Zero());
+    m_insertionInGlobal = arena.make<utils::Vector3d>(utils::Vector3d::Zero());
+    m_pointsInGlobal = arena.make<std::vector<utils::Vector3d>>();
+    m_pointsInLocal = arena.make<std::vector<utils::Vector3d>>();
+    m_pathBodyId = arena.make<std::vector<unsigned int>>();
+    m_pointsBodyId = arena.make<std::vector<unsigned int>>();
+    m_jacobian = arena.make<utils::Matrix>();
+    m_G = arena.make<utils::Matrix>();
+    m_jacobianLength = arena.make<utils::Matrix>();
+    m_length = arena.make<utils::Scalar>(0);
+    m_velocity = arena.make<utils::Scalar>(0);
+    m_isGeometryComputed = arena.make<bool>(false);
+    m_isVelocityComputed = arena.make<bool>(false);
+    m_posAndJacoWereForced = arena.make<bool>(false);
 }
 
 internal_forces::Geometry internal_forces::Geometry::DeepCopy() const
@@ -81,6 +69,8 @@ void internal_forces::Geometry::DeepCopy(const internal_forces::Geometry &other)
     for (size_t i=0; i<other.m_pointsInLocal->size(); ++i) {
         (*m_pointsInLocal)[i] = (*other.m_pointsInLocal)[i].DeepCopy();
     }
+    *m_pathBodyId = *other.m_pathBodyId;
+    *m_pointsBodyId = *other.m_pointsBodyId;
     *m_jacobian = *other.m_jacobian;
     *m_G = *other.m_G;
     *m_jacobianLength = *other.m_jacobianLength;
@@ -179,6 +169,7 @@ void internal_forces::Geometry::setOrigin(
 {
     if (dynamic_cast<const rigidbody::NodeSegment*>(&position)) {
         *m_origin = position;
+        m_pathBodyId->clear();
     } else {
         // Preserve the Node information
         m_origin->RigidBodyDynamics::Math::Vector3d::operator=(position);
@@ -194,6 +185,7 @@ void internal_forces::Geometry::setInsertionInLocal(
 {
     if (dynamic_cast<const rigidbody::NodeSegment*>(&position)) {
         *m_insertion = position;
+        m_pathBodyId->clear();
     } else {
         // Preserve the Node information
         m_insertion->RigidBodyDynamics::Math::Vector3d::operator=(position);
@@ -300,10 +292,14 @@ const utils::Vector3d &internal_forces::Geometry::originInGlobal(
     rigidbody::Joints &model,
     const rigidbody::GeneralizedCoordinates &Q)
 {
+    if (m_pathBodyId->size() < 2) {
+        resolveBodyId(model);
+    }
+
     // Return the position of the marker in function of the given position
     m_originInGlobal->block(0,0,3,
                             1) = RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q,
-                                    model.GetBodyId(m_origin->parent().c_str()), *m_origin,false);
+                                    (*m_pathBodyId)[0], *m_origin,false);
     return *m_originInGlobal;
 }
 
@@ -311,9 +307,13 @@ const utils::Vector3d &internal_forces::Geometry::insertionInGlobal(
     rigidbody::Joints &model,
     const rigidbody::GeneralizedCoordinates &Q)
 {
+    if (m_pathBodyId->size() < 2) {
+        resolveBodyId(model);
+    }
+
     // Return the position of the marker in function of the given position
     m_insertionInGlobal->block(0,0,3,1) = RigidBodyDynamics::CalcBodyToBaseCoordinates(
-                model, Q, model.GetBodyId(m_insertion->parent().c_str()), *m_insertion,false);
+                model, Q, (*m_pathBodyId)[1], *m_insertion,false);
     return *m_insertionInGlobal;
 }
 
@@ -334,6 +334,11 @@ void internal_forces::Geometry::setPointsInGlobal(
     // Output varible (reset to zero)
     m_pointsInLocal->clear();
     m_pointsInGlobal->clear();
+    m_pointsBodyId->clear();
+    if (m_pathBodyId->size() != 2 + (pathModifiers ? pathModifiers->nbObjects() : 0)) {
+        resolveBodyId(model, pathModifiers);
+    }
+    const std::vector<unsigned int>& pathBodyId(*m_pathBodyId);
 
     // Do not apply on wrapping objects
     if (pathModifiers->nbWraps()!=0) {
@@ -366,13 +371,17 @@ void internal_forces::Geometry::setPointsInGlobal(
         m_pointsInLocal->push_back(originInLocal());
         m_pointsInLocal->push_back(
             utils::Vector3d(RigidBodyDynamics::CalcBodyToBaseCoordinates(
-                                        model, Q, model.GetBodyId(w.parent().c_str()),po_wrap, false),
+                                        model, Q, pathBodyId[2],po_wrap, false),
                                     "wrap_o", w.parent()));
         m_pointsInLocal->push_back(
             utils::Vector3d(RigidBodyDynamics::CalcBodyToBaseCoordinates(
-                                        model, Q, model.GetBodyId(w.parent().c_str()),pi_wrap, false),
+                                        model, Q, pathBodyId[2],pi_wrap, false),
                                     "wrap_i", w.parent()));
         m_pointsInLocal->push_back(insertionInLocal());
+        m_pointsBodyId->push_back(pathBodyId[0]);
+        m_pointsBodyId->push_back(pathBodyId[2]);
+        m_pointsBodyId->push_back(pathBodyId[2]);
+        m_pointsBodyId->push_back(pathBodyId[1]);
 
         // Store the points in global
         m_pointsInGlobal->push_back(po_mus);
@@ -386,22 +395,26 @@ void internal_forces::Geometry::setPointsInGlobal(
              && pathModifiers->object(0).typeOfNode() == utils::NODE_TYPE::VIA_POINT) {
         m_pointsInLocal->push_back(originInLocal());
         m_pointsInGlobal->push_back(originInGlobal(model, Q));
+        m_pointsBodyId->push_back(pathBodyId[0]);
         for (size_t i=0; i<pathModifiers->nbObjects(); ++i) {
             const internal_forces::ViaPoint& node(static_cast<internal_forces::ViaPoint&>
                                                   (pathModifiers->object(i)));
             m_pointsInLocal->push_back(node);
             m_pointsInGlobal->push_back(RigidBodyDynamics::CalcBodyToBaseCoordinates(model,
-                                        Q,
-                                        model.GetBodyId(node.parent().c_str()), node, false));
+                                        Q, pathBodyId[2 + i], node, false));
+            m_pointsBodyId->push_back(pathBodyId[2 + i]);
         }
         m_pointsInLocal->push_back(insertionInLocal());
         m_pointsInGlobal->push_back(insertionInGlobal(model,Q));
+        m_pointsBodyId->push_back(pathBodyId[1]);
 
     } else if (pathModifiers->nbObjects()==0) {
         m_pointsInLocal->push_back(originInLocal());
         m_pointsInLocal->push_back(insertionInLocal());
         m_pointsInGlobal->push_back(originInGlobal(model, Q));
         m_pointsInGlobal->push_back(insertionInGlobal(model,Q));
+        m_pointsBodyId->push_back(pathBodyId[0]);
+        m_pointsBodyId->push_back(pathBodyId[1]);
     } else {
         utils::Error::raise("Length for this type of object was not implemented");
     }
@@ -470,13 +483,27 @@ void internal_forces::Geometry::jacobian(
 {
     for (size_t i=0; i<m_pointsInLocal->size(); ++i) {
         m_G->setZero();
-        RigidBodyDynamics::CalcPointJacobian(model, Q,
-                                             model.GetBodyId((*m_pointsInLocal)[i].parent().c_str()),
+        RigidBodyDynamics::CalcPointJacobian(model, Q, (*m_pointsBodyId)[i],
                                              (*m_pointsInLocal)[i], *m_G, false); // False for speed
         m_jacobian->block(3* static_cast<unsigned int>(i),0,3,model.dof_count) = *m_G;
     }
 }
 
+void internal_forces::Geometry::resolveBodyId(
+    rigidbody::Joints &model,
+    internal_forces::PathModifiers *pathModifiers)
+{
+    m_pathBodyId->clear();
+    m_pathBodyId->push_back(static_cast<unsigned int>(model.getBodyRbdlId(m_origin->parent())));
+    m_pathBodyId->push_back(static_cast<unsigned int>(model.getBodyRbdlId(m_insertion->parent())));
+    if (pathModifiers != nullptr) {
+        for (size_t i=0; i<pathModifiers->nbObjects(); ++i) {
+            m_pathBodyId->push_back(static_cast<unsigned int>(
+                                        model.getBodyRbdlId(pathModifiers->object(i).parent())));
+        }
+    }
+}
+
 void internal_forces::Geometry::computeJacobianLength()
 {
     *m_jacobianLength = utils::Matrix::Zero(1, m_jacobian->cols());
@@ -490,3 +517,33 @@ void internal_forces::Geometry::computeJacobianLength()
                              ( p[i+1] - p[i] ).norm();
     }
 }
+
+void internal_forces::Geometry::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    // The points are nodes, each of them holds its name
+    for (auto point : {m_origin, m_insertion, m_originInGlobal, m_insertionInGlobal}) {
+        if (footprint.add(point)) {
+            point->memoryFootprint(footprint);
+        }
+    }
+    for (auto points : {m_pointsInGlobal, m_pointsInLocal}) {
+        if (footprint.add(points)) {
+            for (auto& point : *points) {
+                point.memoryFootprint(footprint);
+            }
+        }
+    }
+    footprint.add(m_pathBodyId);
+    footprint.add(m_pointsBodyId);
+    for (auto matrix : {m_jacobian, m_G, m_jacobianLength}) {
+        if (footprint.add(matrix)) {
+            footprint.addHeap(static_cast<size_t>(matrix->rows() * matrix->cols()) * sizeof(utils::Scalar));
+        }
+    }
+    footprint.add(m_length);
+    footprint.add(m_velocity);
+    footprint.add(m_isGeometryComputed);
+    footprint.add(m_isVelocityComputed);
+    footprint.add(m_posAndJacoWereForced);
+}
@@ -2,11 +2,13 @@
 
 #include "Utils/Error.h"
 #include "Utils/Matrix.h"
+#include "Utils/Profiler.h"
 #include "RigidBody/Joints.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
 #include "RigidBody/GeneralizedTorque.h"
 #include "InternalForces/Ligaments/Ligament.h"
+#include "InternalForces/Ligaments/LigamentCharacteristics.h"
 #include "InternalForces/Ligaments/Ligaments.h"
 #include "InternalForces/Ligaments/LigamentConstant.h"
 #include "InternalForces/Ligaments/LigamentSpringLinear.h"
@@ -15,13 +17,16 @@
 using namespace BIORBD_NAMESPACE;
 
 internal_forces::ligaments::Ligaments::Ligaments() :
-    m_ligaments(std::make_shared<std::vector<std::shared_ptr<internal_forces::ligaments::Ligament>>>())
+    m_ligaments(std::make_shared<std::vector<std::shared_ptr<internal_forces::ligaments::Ligament>>>()),
+    m_engine(std::make_shared<internal_forces::ligaments::Ligaments::LigamentsEngine>())
 {
+    compileLigamentsEngine();
 
 }
 
 internal_forces::ligaments::Ligaments::Ligaments(const internal_forces::ligaments::Ligaments &other) :
-    m_ligaments(other.m_ligaments)
+    m_ligaments(other.m_ligaments),
+    m_engine(other.m_engine)
 {
 
 }
@@ -45,18 +50,21 @@ void internal_forces::ligaments::Ligaments::DeepCopy(
 {
     m_ligaments->resize(other.m_ligaments->size());
     for (size_t i=0; i<other.m_ligaments->size(); ++i) {
-        if ((*other.m_ligaments)[i]->type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_CONSTANT) {
-            (*m_ligaments)[i] = std::make_shared<internal_forces::ligaments::LigamentConstant>((*other.m_ligaments)[i]);
-            return;
-        } else if ((*other.m_ligaments)[i]->type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_SPRING_LINEAR) {
-            (*m_ligaments)[i] = std::make_shared<internal_forces::ligaments::LigamentSpringLinear>((*other.m_ligaments)[i]);
-            return;
-        } else if ((*other.m_ligaments)[i]->type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_SPRING_SECOND_ORDER) {
-            (*m_ligaments)[i] = std::make_shared<internal_forces::ligaments::LigamentSpringSecondOrder>((*other.m_ligaments)[i]);
-            return;
+        const internal_forces::ligaments::Ligament& ligament(*(*other.m_ligaments)[i]);
+        if (ligament.type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_CONSTANT) {
+            (*m_ligaments)[i] = std::make_shared<internal_forces::ligaments::LigamentConstant>(
+                dynamic_cast<const internal_forces::ligaments::LigamentConstant&>(ligament).DeepCopy());
+        } else if (ligament.type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_SPRING_LINEAR) {
+            (*m_ligaments)[i] = std::make_shared<internal_forces::ligaments::LigamentSpringLinear>(
+                dynamic_cast<const internal_forces::ligaments::LigamentSpringLinear&>(ligament).DeepCopy());
+        } else if (ligament.type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_SPRING_SECOND_ORDER) {
+            (*m_ligaments)[i] = std::make_shared<internal_forces::ligaments::LigamentSpringSecondOrder>(
+                dynamic_cast<const internal_forces::ligaments::LigamentSpringSecondOrder&>(ligament).DeepCopy());
+        } else {
+            utils::Error::raise("DeepCopy failed");
         }
     }
-    *m_ligaments = *other.m_ligaments;
+    compileLigamentsEngine();
 }
 
 internal_forces::ligaments::Ligament& internal_forces::ligaments::Ligaments::ligament(size_t idx)
@@ -86,7 +94,140 @@ void internal_forces::ligaments::Ligaments::addLigament(
     } else {
         utils::Error::raise("Ligament type not found");
     }
-    return;
+    compileLigamentsEngine();
+}
+
+void internal_forces::ligaments::Ligaments::compileLigamentsEngine()
+{
+    LigamentsEngine& engine = *m_engine;
+    engine.m_order.clear();
+    engine.m_nbConstant = 0;
+    engine.m_nbSpringLinear = 0;
+    engine.m_nbSpringSecondOrder = 0;
+
+    // Group the ligaments by type so each spring law runs on a contiguous segment
+    for (size_t i=0; i<m_ligaments->size(); ++i) {
+        if ((*m_ligaments)[i]->type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_CONSTANT) {
+            engine.m_order.push_back(i);
+            ++engine.m_nbConstant;
+        }
+    }
+    for (size_t i=0; i<m_ligaments->size(); ++i) {
+        if ((*m_ligaments)[i]->type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_SPRING_LINEAR) {
+            engine.m_order.push_back(i);
+            ++engine.m_nbSpringLinear;
+        }
+    }
+    for (size_t i=0; i<m_ligaments->size(); ++i) {
+        if ((*m_ligaments)[i]->type() == internal_forces::ligaments::LIGAMENT_TYPE::LIGAMENT_SPRING_SECOND_ORDER) {
+            engine.m_order.push_back(i);
+            ++engine.m_nbSpringSecondOrder;
+        }
+    }
+    utils::Error::check(engine.m_order.size() == m_ligaments->size(), "Ligament type not found");
+
+    size_t nbLig(m_ligaments->size());
+    engine.m_length = utils::Vector(nbLig);
+    engine.m_velocity = utils::Vector(nbLig);
+    engine.m_slackLength = utils::Vector(nbLig);
+    engine.m_stiffness = utils::Vector(nbLig);
+    engine.m_epsilon = utils::Vector(nbLig);
+    engine.m_dampingParam = utils::Vector(nbLig);
+    engine.m_maxShorteningSpeed = utils::Vector(nbLig);
+    engine.m_Fl = utils::Vector(nbLig);
+    engine.m_damping = utils::Vector(nbLig);
+    engine.m_force = utils::Vector(nbLig);
+}
+
+void internal_forces::ligaments::Ligaments::computeLigamentForces()
+{
+    BIORBD_PROFILE_ZONE("Ligaments::computeLigamentForces");
+    LigamentsEngine& engine = *m_engine;
+
+#ifdef BIORBD_USE_CASADI_MATH
+    // The symbolic laws are kept in the ligaments so the if_else expressions are built once
+    for (size_t i=0; i<engine.m_order.size(); ++i) {
+        engine.m_force(static_cast<unsigned int>(engine.m_order[i])) =
+            (*m_ligaments)[engine.m_order[i]]->force();
+    }
+#else
+    const Eigen::Index nbConstant(static_cast<Eigen::Index>(engine.m_nbConstant));
+    const Eigen::Index nbLinear(static_cast<Eigen::Index>(engine.m_nbSpringLinear));
+    const Eigen::Index nbSecondOrder(static_cast<Eigen::Index>(engine.m_nbSpringSecondOrder));
+
+    // Gather the geometry and the parameters. The parameters are read at each call since
+    // they can be modified through the ligaments themselves
+    for (size_t i=0; i<engine.m_order.size(); ++i) {
+        const Ligament& ligament(*(*m_ligaments)[engine.m_order[i]]);
+        const LigamentCharacteristics& characteristics(*ligament.m_characteristics);
+        engine.m_length[i] = ligament.position().length();
+        engine.m_velocity[i] = ligament.position().velocity();
+        engine.m_slackLength[i] = characteristics.ligamentSlackLength();
+        engine.m_dampingParam[i] = characteristics.dampingParam();
+        engine.m_maxShorteningSpeed[i] = characteristics.maxShorteningSpeed();
+    }
+    for (Eigen::Index i=0; i<nbConstant; ++i) {
+        engine.m_stiffness[i] = *static_cast<const LigamentConstant&>(
+                                    *(*m_ligaments)[engine.m_order[static_cast<size_t>(i)]]).m_force;
+    }
+    for (Eigen::Index i=nbConstant; i<nbConstant + nbLinear; ++i) {
+        engine.m_stiffness[i] = *static_cast<const LigamentSpringLinear&>(
+                                    *(*m_ligaments)[engine.m_order[static_cast<size_t>(i)]]).m_stiffness;
+    }
+    for (Eigen::Index i=nbConstant + nbLinear; i<nbConstant + nbLinear + nbSecondOrder; ++i) {
+        const LigamentSpringSecondOrder& ligament(static_cast<const LigamentSpringSecondOrder&>(
+                    *(*m_ligaments)[engine.m_order[static_cast<size_t>(i)]]));
+        engine.m_stiffness[i] = *ligament.m_stiffness;
+        engine.m_epsilon[i] = *ligament.m_epsilon;
+    }
+
+    // Force-length part of each law
+    engine.m_Fl.segment(0, nbConstant) = engine.m_stiffness.segment(0, nbConstant);
+    {
+        Eigen::ArrayXd d(engine.m_length.segment(nbConstant, nbLinear).array()
+                         - engine.m_slackLength.segment(nbConstant, nbLinear).array());
+        engine.m_Fl.segment(nbConstant, nbLinear) = (d > 0).select(
+                    engine.m_stiffness.segment(nbConstant, nbLinear).array() * d, 0.0).matrix();
+    }
+    {
+        const Eigen::Index first(nbConstant + nbLinear);
+        Eigen::ArrayXd d(engine.m_length.segment(first, nbSecondOrder).array()
+                         - engine.m_slackLength.segment(first, nbSecondOrder).array());
+        Eigen::ArrayXd eps(engine.m_epsilon.segment(first, nbSecondOrder).array());
+        engine.m_Fl.segment(first, nbSecondOrder) =
+            (engine.m_stiffness.segment(first, nbSecondOrder).array() / 2
+             * (d + (d * d + eps * eps).sqrt())).matrix();
+    }
+
+    // Damping is common to all the laws
+    engine.m_damping = (engine.m_velocity.array() > 0).select(
+                           engine.m_velocity.array() / engine.m_maxShorteningSpeed.array()
+                           * engine.m_dampingParam.array(), 0.0).matrix();
+
+    // Scatter back so the ligaments report the same values as if they were evaluated one by one
+    for (size_t i=0; i<engine.m_order.size(); ++i) {
+        Ligament& ligament(*(*m_ligaments)[engine.m_order[i]]);
+        *ligament.m_Fl = engine.m_Fl[i];
+        *ligament.m_damping = engine.m_damping[i];
+        *ligament.m_force = engine.m_Fl[i] + engine.m_damping[i];
+        engine.m_force[engine.m_order[i]] = *ligament.m_force;
+    }
+#endif
+}
+
+void internal_forces::ligaments::Ligaments::accumulateLigamentsJointTorque(
+    const utils::Vector& F,
+    rigidbody::GeneralizedTorque& tau)
+{
+    // Virtual power: each ligament contributes -J^T * F to the joints
+    for (size_t j=0; j<nbLigaments(); ++j) {
+        const utils::Matrix& jacoLength((*m_ligaments)[j]->position().jacobianLength());
+#ifdef BIORBD_USE_CASADI_MATH
+        tau = rigidbody::GeneralizedTorque(tau - jacoLength.transpose() * F(static_cast<unsigned int>(j)));
+#else
+        tau.noalias() -= jacoLength.row(0).transpose() * F[static_cast<Eigen::Index>(j)];
+#endif
+    }
 }
 
 std::vector<utils::String> internal_forces::ligaments::Ligaments::ligamentNames() const
@@ -104,11 +245,14 @@ rigidbody::GeneralizedTorque
 internal_forces::ligaments::Ligaments::ligamentsJointTorque(
     const utils::Vector &F)
 {
-    // Get the Jacobian matrix and get the forces of each muscle
-    const utils::Matrix& jaco(ligamentsLengthJacobian());
+    // Assuming that this is also a Joints type (via BiorbdModel)
+    const rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
 
     // Compute the reaction of the forces on the bodies
-    return rigidbody::GeneralizedTorque( -jaco.transpose() * F );
+    rigidbody::GeneralizedTorque tau(model);
+    tau.setZero();
+    accumulateLigamentsJointTorque(F, tau);
+    return tau;
 }
 
 // From ligament Force and kinematics
@@ -130,40 +274,41 @@ internal_forces::ligaments::Ligaments::ligamentsJointTorque(
     const rigidbody::GeneralizedCoordinates& Q,
     const rigidbody::GeneralizedVelocity& QDot)
 {
-    return ligamentsJointTorque(ligamentForces(Q, QDot));
+    // Assuming that this is also a Joints type (via BiorbdModel)
+    const rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+
+    // One kinematics update for all the ligaments, then the forces are used in place
+    updateLigaments(Q, QDot, true);
+    computeLigamentForces();
+
+    rigidbody::GeneralizedTorque tau(model);
+    tau.setZero();
+    accumulateLigamentsJointTorque(m_engine->m_force, tau);
+    return tau;
 }
 
 utils::Vector internal_forces::ligaments::Ligaments::ligamentForces(
     const rigidbody::GeneralizedCoordinates& Q,
     const rigidbody::GeneralizedVelocity& QDot)
 {
-    // Assuming that this is also a Joints type (via BiorbdModel)
-    rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
-    // Output variable
-    utils::Vector forces(nbLigaments());
-    for (size_t j=0; j<nbLigaments(); ++j) {
-        forces(static_cast<unsigned int>(j)) = ((*m_ligaments)[j]->force(model,Q, QDot));
-    }
-
+    // One kinematics update for all the ligaments
+    updateLigaments(Q, QDot, true);
+    computeLigamentForces();
 
     // The forces
-    return forces;
+    return m_engine->m_force;
 }
 
 utils::Vector internal_forces::ligaments::Ligaments::ligamentForces(
     const rigidbody::GeneralizedCoordinates& Q
         )
 {
-    // Assuming that this is also a Joints type (via BiorbdModel)
-    rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
-    // Output variable
-    utils::Vector forces(nbLigaments());
-    for (size_t j=0; j<nbLigaments(); ++j) {
-        forces(static_cast<unsigned int>(j)) = ((*m_ligaments)[j]->force(model,Q));
-    }
+    // One kinematics update for all the ligaments
+    updateLigaments(Q, true);
+    computeLigamentForces();
 
     // The forces
-    return forces;
+    return m_engine->m_force;
 }
 
 utils::Matrix internal_forces::ligaments::Ligaments::ligamentsLengthJacobian()
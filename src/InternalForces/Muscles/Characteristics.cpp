@@ -1,24 +1,17 @@
 #define BIORBD_API_EXPORTS
 #include "InternalForces/Muscles/Characteristics.h"
 
+#include "Utils/Arena.h"
+#include "Utils/MemoryFootprint.h"
 #include "InternalForces/Muscles/State.h"
 #include "InternalForces/Muscles/FatigueParameters.h"
 
 using namespace BIORBD_NAMESPACE;
 
 internal_forces::muscles::Characteristics::Characteristics() :
-    m_optimalLength(std::make_shared<utils::Scalar>(0)),
-    m_fIsoMax(std::make_shared<utils::Scalar>(0)),
-    m_PCSA(std::make_shared<utils::Scalar>(0)),
-    m_tendonSlackLength(std::make_shared<utils::Scalar>(0)),
-    m_pennationAngle(std::make_shared<utils::Scalar>(0)),
-    m_stateMax(std::make_shared<internal_forces::muscles::State>(internal_forces::muscles::State(1, 1))),
-    m_minActivation(std::make_shared<utils::Scalar>(0.01)),
-    m_torqueActivation(std::make_shared<utils::Scalar>(0.01)),
-    m_torqueDeactivation(std::make_shared<utils::Scalar>(0.04)),
-    m_fatigueParameters(std::make_shared<internal_forces::muscles::FatigueParameters>
-                        (internal_forces::muscles::FatigueParameters())),
-    m_useDamping(std::make_shared<bool>(false))
+    internal_forces::muscles::Characteristics(
+        0, 0, 0, 0, 0, internal_forces::muscles::State(1, 1),
+        internal_forces::muscles::FatigueParameters(), false, 0.01, 0.04, 0.01)
 {
 
 }
@@ -51,22 +44,21 @@ internal_forces::muscles::Characteristics::Characteristics(
     bool useDamping,
     const utils::Scalar& torqueAct,
     const utils::Scalar& torqueDeact,
-    const utils::Scalar& minAct):
-    m_optimalLength(std::make_shared<utils::Scalar>(optLength)),
-    m_fIsoMax(std::make_shared<utils::Scalar>(fmax)),
-    m_PCSA(std::make_shared<utils::Scalar>(PCSA)),
-    m_tendonSlackLength(std::make_shared<utils::Scalar>(tendonSlackLength)),
-    m_pennationAngle(std::make_shared<utils::Scalar>(pennAngle)),
-    m_stateMax(std::make_shared<internal_forces::muscles::State>(emgMax)),
-    m_minActivation(std::make_shared<utils::Scalar>(minAct)),
-    m_torqueActivation(std::make_shared<utils::Scalar>(torqueAct)),
-    m_torqueDeactivation(std::make_shared<utils::Scalar>(torqueDeact)),
-    m_fatigueParameters(std::make_shared<internal_forces::muscles::FatigueParameters>
-                        (fatigueParameters)),
-    m_useDamping(std::make_shared<bool>(useDamping))
-
-{
-
+    const utils::Scalar& minAct)
+{
+    // The parameters of a muscle are read together, keep them next to each other
+    utils::Arena arena;
+    m_optimalLength = arena.make<utils::Scalar>(optLength);
+    m_fIsoMax = arena.make<utils::Scalar>(fmax);
+    m_PCSA = arena.make<utils::Scalar>(PCSA);
+    m_tendonSlackLength = arena.make<utils::Scalar>(tendonSlackLength);
+    m_pennationAngle = arena.make<utils::Scalar>(pennAngle);
+    m_stateMax = arena.make<internal_forces::muscles::State>(emgMax);
+    m_minActivation = arena.make<utils::Scalar>(minAct);
+    m_torqueActivation = arena.make<utils::Scalar>(torqueAct);
+    m_torqueDeactivation = arena.make<utils::Scalar>(torqueDeact);
+    m_fatigueParameters = arena.make<internal_forces::muscles::FatigueParameters>(fatigueParameters);
+    m_useDamping = arena.make<bool>(useDamping);
 }
 
 internal_forces::muscles::Characteristics::~Characteristics()
@@ -218,3 +210,23 @@ bool internal_forces::muscles::Characteristics::useDamping() const
 {
     return *m_useDamping;
 }
+
+void internal_forces::muscles::Characteristics::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_optimalLength);
+    footprint.add(m_fIsoMax);
+    footprint.add(m_PCSA);
+    footprint.add(m_tendonSlackLength);
+    footprint.add(m_pennationAngle);
+    if (footprint.add(m_stateMax)) {
+        m_stateMax->memoryFootprint(footprint);
+    }
+    footprint.add(m_minActivation);
+    footprint.add(m_torqueActivation);
+    footprint.add(m_torqueDeactivation);
+    if (footprint.add(m_fatigueParameters)) {
+        m_fatigueParameters->memoryFootprint(footprint);
+    }
+    footprint.add(m_useDamping);
+}
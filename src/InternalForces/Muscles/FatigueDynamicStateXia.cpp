@@ -7,6 +7,10 @@
 #include "InternalForces/Muscles/FatigueParameters.h"
 #include "InternalForces/Muscles/StateDynamics.h"
 
+#ifdef USE_SMOOTH_IF_ELSE
+#include "Utils/CasadiExpand.h"
+#endif
+
 using namespace BIORBD_NAMESPACE;
 
 internal_forces::muscles::FatigueDynamicStateXia::FatigueDynamicStateXia(
@@ -43,13 +47,17 @@ void internal_forces::muscles::FatigueDynamicStateXia::timeDerivativeState(
     const internal_forces::muscles::StateDynamics &emg,
     const internal_forces::muscles::Characteristics &characteristics)
 {
-#ifdef BIORBD_USE_CASADI_MATH
-    utils::Error::raise("timeDerivativeState for FatigueDynamicStateXia"
-                                " is not implemented yet");
-#else
     // Getting the command
     utils::Scalar targetCommand(emg.activation());
     utils::Scalar command(0);
+#ifdef BIORBD_USE_CASADI_MATH
+    utils::Scalar diff(targetCommand - *m_activeFibers);
+    command = IF_ELSE_NAMESPACE::if_else(
+                  IF_ELSE_NAMESPACE::gt(diff, 0),
+                  characteristics.fatigueParameters().developFactor() * IF_ELSE_NAMESPACE::if_else(
+                      IF_ELSE_NAMESPACE::gt(*m_restingFibers, diff), diff, *m_restingFibers),
+                  characteristics.fatigueParameters().recoveryFactor() * diff);
+#else
     if (*m_activeFibers < targetCommand) {
         if (*m_restingFibers > targetCommand - *m_activeFibers) {
             command = characteristics.fatigueParameters().developFactor()*
@@ -61,6 +69,7 @@ void internal_forces::muscles::FatigueDynamicStateXia::timeDerivativeState(
         command = characteristics.fatigueParameters().recoveryFactor()*
                   (targetCommand - *m_activeFibers);
     }
+#endif
 
     // Applying the command to the fibers
     *m_activeFibersDot = command - characteristics.fatigueParameters().fatigueRate()
@@ -71,6 +80,7 @@ void internal_forces::muscles::FatigueDynamicStateXia::timeDerivativeState(
                            *m_activeFibers -
                            characteristics.fatigueParameters().recoveryRate()* *m_fatiguedFibers;
 
+#ifndef BIORBD_USE_CASADI_MATH
     utils::Error::check(
         fabs(*m_activeFibersDot + *m_restingFibersDot + *m_fatiguedFibersDot) <= 1e-7,
         "Sum of time derivates of fatigue states must be equal to 0");
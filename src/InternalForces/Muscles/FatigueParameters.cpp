@@ -1,5 +1,6 @@
 #define BIORBD_API_EXPORTS
 #include "InternalForces/Muscles/FatigueParameters.h"
+#include "Utils/MemoryFootprint.h"
 
 using namespace BIORBD_NAMESPACE;
 
@@ -76,3 +77,12 @@ internal_forces::muscles::FatigueParameters::recoveryFactor() const
 {
     return *m_recoveryFactor;
 }
+
+void internal_forces::muscles::FatigueParameters::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_fatigueRate);
+    footprint.add(m_recoveryRate);
+    footprint.add(m_developFactor);
+    footprint.add(m_recoveryFactor);
+}
@@ -1,6 +1,8 @@
 #define BIORBD_API_EXPORTS
 
 #include "Utils/Error.h"
+#include "Utils/Arena.h"
+#include "Utils/MemoryFootprint.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
 #include "InternalForces/Muscles/Characteristics.h"
@@ -14,22 +16,9 @@
 
 using namespace BIORBD_NAMESPACE;
 internal_forces::muscles::HillType::HillType() :
-    internal_forces::muscles::Muscle(),
-    m_damping(std::make_shared<utils::Scalar>()),
-    m_FlCE(std::make_shared<utils::Scalar>()),
-    m_FlPE(std::make_shared<utils::Scalar>()),
-    m_FvCE(std::make_shared<utils::Scalar>()),
-    m_cste_FlCE_1(std::make_shared<utils::Scalar>(0.15)),
-    m_cste_FlCE_2(std::make_shared<utils::Scalar>(0.45)),
-    m_cste_FvCE_1(std::make_shared<utils::Scalar>(1)),
-    m_cste_FvCE_2(std::make_shared<utils::Scalar>(-.33/2 * *m_cste_FvCE_1/
-                  (1+*m_cste_FvCE_1))),
-    m_cste_FlPE_1(std::make_shared<utils::Scalar>(10.0)),
-    m_cste_FlPE_2(std::make_shared<utils::Scalar>(5.0)),
-    m_cste_eccentricForceMultiplier(std::make_shared<utils::Scalar>(1.8)),
-    m_cste_damping(std::make_shared<utils::Scalar>(0.1)),
-    m_cste_maxShorteningSpeed(std::make_shared<utils::Scalar>(10.0))
+    internal_forces::muscles::Muscle()
 {
+    initializeParameters();
     setType();
 }
 
@@ -37,22 +26,9 @@ internal_forces::muscles::HillType::HillType(
     const utils::String &name,
     const internal_forces::muscles::MuscleGeometry &geometry,
     const internal_forces::muscles::Characteristics &characteristics) :
-    internal_forces::muscles::Muscle(name,geometry,characteristics),
-    m_damping(std::make_shared<utils::Scalar>()),
-    m_FlCE(std::make_shared<utils::Scalar>()),
-    m_FlPE(std::make_shared<utils::Scalar>()),
-    m_FvCE(std::make_shared<utils::Scalar>()),
-    m_cste_FlCE_1(std::make_shared<utils::Scalar>(0.15)),
-    m_cste_FlCE_2(std::make_shared<utils::Scalar>(0.45)),
-    m_cste_FvCE_1(std::make_shared<utils::Scalar>(1)),
-    m_cste_FvCE_2(std::make_shared<utils::Scalar>(-.33/2 * *m_cste_FvCE_1/
-                  (1+*m_cste_FvCE_1))),
-    m_cste_FlPE_1(std::make_shared<utils::Scalar>(10.0)),
-    m_cste_FlPE_2(std::make_shared<utils::Scalar>(5.0)),
-    m_cste_eccentricForceMultiplier(std::make_shared<utils::Scalar>(1.8)),
-    m_cste_damping(std::make_shared<utils::Scalar>(0.1)),
-    m_cste_maxShorteningSpeed(std::make_shared<utils::Scalar>(10.0))
+    internal_forces::muscles::Muscle(name,geometry,characteristics)
 {
+    initializeParameters();
     setType();
 }
 
@@ -61,22 +37,9 @@ internal_forces::muscles::HillType::HillType(
     const internal_forces::muscles::MuscleGeometry &geometry,
     const internal_forces::muscles::Characteristics &characteristics,
     const internal_forces::muscles::State& emg) :
-    internal_forces::muscles::Muscle(name,geometry,characteristics, emg),
-    m_damping(std::make_shared<utils::Scalar>()),
-    m_FlCE(std::make_shared<utils::Scalar>()),
-    m_FlPE(std::make_shared<utils::Scalar>()),
-    m_FvCE(std::make_shared<utils::Scalar>()),
-    m_cste_FlCE_1(std::make_shared<utils::Scalar>(0.15)),
-    m_cste_FlCE_2(std::make_shared<utils::Scalar>(0.45)),
-    m_cste_FvCE_1(std::make_shared<utils::Scalar>(1)),
-    m_cste_FvCE_2(std::make_shared<utils::Scalar>(-.33/2 * *m_cste_FvCE_1/
-                  (1+*m_cste_FvCE_1))),
-    m_cste_FlPE_1(std::make_shared<utils::Scalar>(10.0)),
-    m_cste_FlPE_2(std::make_shared<utils::Scalar>(5.0)),
-    m_cste_eccentricForceMultiplier(std::make_shared<utils::Scalar>(1.8)),
-    m_cste_damping(std::make_shared<utils::Scalar>(0.1)),
-    m_cste_maxShorteningSpeed(std::make_shared<utils::Scalar>(10.0))
+    internal_forces::muscles::Muscle(name,geometry,characteristics, emg)
 {
+    initializeParameters();
     setType();
 }
 
@@ -85,22 +48,9 @@ internal_forces::muscles::HillType::HillType(
     const internal_forces::muscles::MuscleGeometry &geometry,
     const internal_forces::muscles::Characteristics &characteristics,
     const internal_forces::PathModifiers &pathModifiers) :
-    internal_forces::muscles::Muscle(name,geometry,characteristics,pathModifiers),
-    m_damping(std::make_shared<utils::Scalar>()),
-    m_FlCE(std::make_shared<utils::Scalar>()),
-    m_FlPE(std::make_shared<utils::Scalar>()),
-    m_FvCE(std::make_shared<utils::Scalar>()),
-    m_cste_FlCE_1(std::make_shared<utils::Scalar>(0.15)),
-    m_cste_FlCE_2(std::make_shared<utils::Scalar>(0.45)),
-    m_cste_FvCE_1(std::make_shared<utils::Scalar>(1)),
-    m_cste_FvCE_2(std::make_shared<utils::Scalar>(-.33/2 * *m_cste_FvCE_1/
-                  (1+*m_cste_FvCE_1))),
-    m_cste_FlPE_1(std::make_shared<utils::Scalar>(10.0)),
-    m_cste_FlPE_2(std::make_shared<utils::Scalar>(5.0)),
-    m_cste_eccentricForceMultiplier(std::make_shared<utils::Scalar>(1.8)),
-    m_cste_damping(std::make_shared<utils::Scalar>(0.1)),
-    m_cste_maxShorteningSpeed(std::make_shared<utils::Scalar>(10.0))
+    internal_forces::muscles::Muscle(name,geometry,characteristics,pathModifiers)
 {
+    initializeParameters();
     setType();
 }
 internal_forces::muscles::HillType::HillType(
@@ -109,25 +59,31 @@ internal_forces::muscles::HillType::HillType(
     const internal_forces::muscles::Characteristics& characteristics,
     const internal_forces::PathModifiers &pathModifiers,
     const internal_forces::muscles::State& state) :
-    internal_forces::muscles::Muscle(name,geometry,characteristics,pathModifiers,state),
-    m_damping(std::make_shared<utils::Scalar>()),
-    m_FlCE(std::make_shared<utils::Scalar>()),
-    m_FlPE(std::make_shared<utils::Scalar>()),
-    m_FvCE(std::make_shared<utils::Scalar>()),
-    m_cste_FlCE_1(std::make_shared<utils::Scalar>(0.15)),
-    m_cste_FlCE_2(std::make_shared<utils::Scalar>(0.45)),
-    m_cste_FvCE_1(std::make_shared<utils::Scalar>(1)),
-    m_cste_FvCE_2(std::make_shared<utils::Scalar>(-.33/2 * *m_cste_FvCE_1/
-                  (1+*m_cste_FvCE_1))),
-    m_cste_FlPE_1(std::make_shared<utils::Scalar>(10.0)),
-    m_cste_FlPE_2(std::make_shared<utils::Scalar>(5.0)),
-    m_cste_eccentricForceMultiplier(std::make_shared<utils::Scalar>(1.8)),
-    m_cste_damping(std::make_shared<utils::Scalar>(0.1)),
-    m_cste_maxShorteningSpeed(std::make_shared<utils::Scalar>(10.0))
+    internal_forces::muscles::Muscle(name,geometry,characteristics,pathModifiers,state)
 {
+    initializeParameters();
     setType();
 }
 
+void internal_forces::muscles::HillType::initializeParameters()
+{
+    // The parameters are created and freed together, so they share a single allocation
+    utils::Arena arena;
+    m_damping = arena.make<utils::Scalar>();
+    m_FlCE = arena.make<utils::Scalar>();
+    m_FlPE = arena.make<utils::Scalar>();
+    m_FvCE = arena.make<utils::Scalar>();
+    m_cste_FlCE_1 = arena.make<utils::Scalar>(0.15);
+    m_cste_FlCE_2 = arena.make<utils::Scalar>(0.45);
+    m_cste_FvCE_1 = arena.make<utils::Scalar>(1);
+    m_cste_FvCE_2 = arena.make<utils::Scalar>(-.33/2 * *m_cste_FvCE_1/(1+*m_cste_FvCE_1));
+    m_cste_FlPE_1 = arena.make<utils::Scalar>(10.0);
+    m_cste_FlPE_2 = arena.make<utils::Scalar>(5.0);
+    m_cste_eccentricForceMultiplier = arena.make<utils::Scalar>(1.8);
+    m_cste_damping = arena.make<utils::Scalar>(0.1);
+    m_cste_maxShorteningSpeed = arena.make<utils::Scalar>(10.0);
+}
+
 internal_forces::muscles::HillType::HillType(const internal_forces::muscles::Muscle &other) :
     internal_forces::muscles::Muscle (other)
 {
@@ -364,3 +320,22 @@ void internal_forces::muscles::HillType::normalizeEmg(
 {
     emg.normalizeExcitation(characteristics().stateMax());
 }
+
+void internal_forces::muscles::HillType::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    internal_forces::muscles::Muscle::memoryFootprint(footprint);
+    footprint.add(m_damping);
+    footprint.add(m_FlCE);
+    footprint.add(m_FlPE);
+    footprint.add(m_FvCE);
+    footprint.add(m_cste_FlCE_1);
+    footprint.add(m_cste_FlCE_2);
+    footprint.add(m_cste_FvCE_1);
+    footprint.add(m_cste_FvCE_2);
+    footprint.add(m_cste_FlPE_1);
+    footprint.add(m_cste_FlPE_2);
+    footprint.add(m_cste_eccentricForceMultiplier);
+    footprint.add(m_cste_damping);
+    footprint.add(m_cste_maxShorteningSpeed);
+}
@@ -1,6 +1,7 @@
 #define BIORBD_API_EXPORTS
 
 #include "Utils/Error.h"
+#include "Utils/MemoryFootprint.h"
 #include "RigidBody/Joints.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
@@ -258,6 +259,24 @@ void internal_forces::muscles::Muscle::setForceIsoMax(
     m_characteristics->setForceIsoMax(forceMax);
 }
 
+void internal_forces::muscles::Muscle::setOptimalLength(
+    const utils::Scalar& optimalLength)
+{
+    m_characteristics->setOptimalLength(optimalLength);
+}
+
+void internal_forces::muscles::Muscle::setTendonSlackLength(
+    const utils::Scalar& tendonSlackLength)
+{
+    m_characteristics->setTendonSlackLength(tendonSlackLength);
+}
+
+void internal_forces::muscles::Muscle::setPennationAngle(
+    const utils::Scalar& pennationAngle)
+{
+    m_characteristics->setPennationAngle(pennationAngle);
+}
+
 void internal_forces::muscles::Muscle::setCharacteristics(
     const internal_forces::muscles::Characteristics &characteristics)
 {
@@ -297,3 +316,20 @@ internal_forces::muscles::State& internal_forces::muscles::Muscle::state()
 {
     return *m_state;
 }
+
+void internal_forces::muscles::Muscle::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    internal_forces::Compound::memoryFootprint(footprint);
+    footprint.add(m_type);
+    if (footprint.add(m_position)) {
+        m_position->memoryFootprint(footprint);
+    }
+    if (footprint.add(m_characteristics)) {
+        m_characteristics->memoryFootprint(footprint);
+    }
+    if (footprint.add(m_state)) {
+        m_state->memoryFootprint(footprint);
+    }
+    footprint.add(m_muscleLength);
+}
@@ -3,6 +3,7 @@
 #include <rbdl/Model.h>
 #include <rbdl/Kinematics.h>
 #include "Utils/Error.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Matrix.h"
 #include "Utils/RotoTrans.h"
 #include "RigidBody/NodeSegment.h"
@@ -206,3 +207,11 @@ const utils::Scalar& internal_forces::muscles::MuscleGeometry::length(
     *m_muscleLength = (*m_muscleTendonLength - characteristics->tendonSlackLength())/std::cos(characteristics->pennationAngle());
     return *m_muscleLength;
 }
+
+void internal_forces::muscles::MuscleGeometry::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    internal_forces::Geometry::memoryFootprint(footprint);
+    footprint.add(m_muscleLength);
+    footprint.add(m_muscleTendonLength);
+}
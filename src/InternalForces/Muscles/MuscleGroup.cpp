@@ -2,6 +2,7 @@
 #include "InternalForces/Muscles/MuscleGroup.h"
 
 #include "Utils/Error.h"
+#include "Utils/MemoryFootprint.h"
 #include "InternalForces/Muscles/IdealizedActuator.h"
 #include "InternalForces/Muscles/HillType.h"
 #include "InternalForces/Muscles/HillThelenType.h"
@@ -397,3 +398,17 @@ const utils::String &internal_forces::muscles::MuscleGroup::insertion() const
 {
     return *m_insertName;
 }
+
+void internal_forces::muscles::MuscleGroup::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_mus);
+    for (auto& muscle : *m_mus) {
+        if (footprint.add(muscle)) {
+            muscle->memoryFootprint(footprint);
+        }
+    }
+    footprint.add(m_name);
+    footprint.add(m_originName);
+    footprint.add(m_insertName);
+}
@@ -3,6 +3,7 @@
 
 #include "Utils/Error.h"
 #include "Utils/Matrix.h"
+#include "Utils/Profiler.h"
 #include "RigidBody/Joints.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
@@ -10,17 +11,65 @@
 #include "InternalForces/Muscles/Muscle.h"
 #include "InternalForces/Muscles/MuscleGroup.h"
 #include "InternalForces/Muscles/StateDynamics.h"
+#include "InternalForces/Muscles/StateDynamicsBuchanan.h"
+#include "InternalForces/Muscles/Characteristics.h"
+#include "InternalForces/Muscles/FatigueParameters.h"
+
+#ifdef USE_SMOOTH_IF_ELSE
+#include "Utils/CasadiExpand.h"
+#endif
 
 using namespace BIORBD_NAMESPACE;
 
+class internal_forces::muscles::Muscles::MusclesParameters
+{
+public:
+    MusclesParameters() :
+        m_isDynamic(true)
+#ifndef BIORBD_USE_CASADI_MATH
+        , m_hasDeGroote(false),
+        m_hasBuchanan(false)
+#endif
+    {
+
+    }
+
+    std::vector<internal_forces::muscles::STATE_TYPE> m_stateType; ///< The state type of each muscle
+    bool m_isDynamic; ///< If all the muscles have a dynamic state
+    utils::Vector m_torqueActivation; ///< The activation time constant of each muscle
+    utils::Vector m_torqueDeactivation; ///< The deactivation time constant of each muscle
+    utils::Vector m_minActivation; ///< The minimal activation of each muscle
+    utils::Vector m_excitationMax; ///< The maximal excitation of each muscle
+    utils::Vector m_shapeFactor; ///< The shape factor of each Buchanan muscle (0 otherwise)
+    utils::Vector m_buchananDenominator; ///< exp(shapeFactor) - 1 for each Buchanan muscle (1 otherwise)
+    utils::Vector m_fatigueRate; ///< The fatigue rate of each muscle
+    utils::Vector m_recoveryRate; ///< The recovery rate of each muscle
+    utils::Vector m_developFactor; ///< The develop factor of each muscle
+    utils::Vector m_recoveryFactor; ///< The recovery factor of each muscle
+#ifndef BIORBD_USE_CASADI_MATH
+    Eigen::Array<bool, Eigen::Dynamic, 1> m_isDeGroote; ///< If each muscle follows the DeGroote dynamics
+    Eigen::Array<bool, Eigen::Dynamic, 1> m_isBuchanan; ///< If each muscle follows the Buchanan dynamics
+    bool m_hasDeGroote; ///< If any muscle follows the DeGroote dynamics
+    bool m_hasBuchanan; ///< If any muscle follows the Buchanan dynamics
+    utils::Vector m_excitation; ///< Workspace for the bounded excitations
+    utils::Vector m_activation; ///< Workspace for the bounded activations
+    utils::Vector m_numerator; ///< Workspace for the difference between excitations and activations
+    utils::Vector m_factor; ///< Workspace for the activation dependent factor of the time constants
+#endif
+};
+
 internal_forces::muscles::Muscles::Muscles() :
-    m_mus(std::make_shared<std::vector<internal_forces::muscles::MuscleGroup>>())
+    m_mus(std::make_shared<std::vector<internal_forces::muscles::MuscleGroup>>()),
+    m_musIndex(std::make_shared<std::unordered_map<std::string, size_t>>()),
+    m_musclesParameters(std::make_shared<MusclesParameters>())
 {
 
 }
 
 internal_forces::muscles::Muscles::Muscles(const internal_forces::muscles::Muscles &other) :
-    m_mus(other.m_mus)
+    m_mus(other.m_mus),
+    m_musIndex(other.m_musIndex),
+    m_musclesParameters(other.m_musclesParameters)
 {
 
 }
@@ -44,6 +93,9 @@ void internal_forces::muscles::Muscles::DeepCopy(const internal_forces::muscles:
     for (size_t i=0; i<other.m_mus->size(); ++i) {
         (*m_mus)[i] = (*other.m_mus)[i];
     }
+    *m_musIndex = *other.m_musIndex;
+    // The parameters are packed again from the copied muscles
+    *m_musclesParameters = MusclesParameters();
 }
 
 
@@ -57,17 +109,26 @@ void internal_forces::muscles::Muscles::addMuscleGroup(
                                     "Muscle group already defined");
     }
 
+    (*m_musIndex)[name] = m_mus->size();
     m_mus->push_back(internal_forces::muscles::MuscleGroup(name, originName, insertionName));
 }
 
 int internal_forces::muscles::Muscles::getMuscleGroupId(const utils::String
         &name) const
 {
-    for (size_t i=0; i<m_mus->size(); ++i)
-        if (!name.compare((*m_mus)[i].name())) {
-            return static_cast<int>(i);
-        }
-    return -1;
+    std::unordered_map<std::string, size_t>::const_iterator it(m_musIndex->find(name));
+    if (it != m_musIndex->end() && it->second < m_mus->size()
+            && !name.compare((*m_mus)[it->second].name())) {
+        return static_cast<int>(it->second);
+    }
+
+    // The groups may have been renamed since they were indexed
+    m_musIndex->clear();
+    for (size_t i=0; i<m_mus->size(); ++i) {
+        (*m_musIndex)[(*m_mus)[i].name()] = i;
+    }
+    it = m_musIndex->find(name);
+    return it == m_musIndex->end() ? -1 : static_cast<int>(it->second);
 }
 
 const std::vector<std::shared_ptr<internal_forces::muscles::Muscle>>
@@ -85,7 +146,7 @@ const std::vector<std::shared_ptr<internal_forces::muscles::Muscle>>
 const internal_forces::muscles::Muscle &internal_forces::muscles::Muscles::muscle(
     size_t idx) const
 {
-    for (auto g : muscleGroups()) {
+    for (const auto& g : muscleGroups()) {
         if (idx >= g.nbMuscles()) {
             idx -= g.nbMuscles();
         } else {
@@ -146,11 +207,33 @@ rigidbody::GeneralizedTorque
 internal_forces::muscles::Muscles::muscularJointTorque(
     const utils::Vector &F)
 {
-    // Get the Jacobian matrix and get the forces of each muscle
-    const utils::Matrix& jaco(musclesLengthJacobian());
+    // Assuming that this is also a Joints type (via BiorbdModel)
+    const rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
 
-    // Compute the reaction of the forces on the bodies
-    return rigidbody::GeneralizedTorque( -jaco.transpose() * F );
+    // Compute the reaction of the forces on the bodies, without assembling the length jacobian
+    rigidbody::GeneralizedTorque tau(model);
+    tau.setZero();
+    accumulateMuscularJointTorque(F, tau);
+    return tau;
+}
+
+void internal_forces::muscles::Muscles::accumulateMuscularJointTorque(
+    const utils::Vector& F,
+    rigidbody::GeneralizedTorque& tau)
+{
+    // Virtual power: each muscle contributes -J^T * F to the joints
+    unsigned int cmpMus(0);
+    for (const auto& group : *m_mus) {
+        for (size_t j=0; j<group.nbMuscles(); ++j) {
+            const utils::Matrix& jacoLength(group.muscle(j).position().jacobianLength());
+#ifdef BIORBD_USE_CASADI_MATH
+            tau = rigidbody::GeneralizedTorque(tau - jacoLength.transpose() * F(cmpMus));
+#else
+            tau.noalias() -= jacoLength.row(0).transpose() * F[static_cast<Eigen::Index>(cmpMus)];
+#endif
+            ++cmpMus;
+        }
+    }
 }
 
 // From Muscular Force
@@ -203,11 +286,241 @@ utils::Vector internal_forces::muscles::Muscles::activationDot(
     return activationDot;
 }
 
+void internal_forces::muscles::Muscles::activationsDot(
+    const utils::Vector& excitations,
+    const utils::Vector& activations,
+    utils::Vector& activationsDot,
+    bool alreadyNormalized)
+{
+    MusclesParameters& param(musclesParameters());
+    unsigned int nbMuscles(static_cast<unsigned int>(param.m_stateType.size()));
+    if (excitations.size() != nbMuscles || activations.size() != nbMuscles) {
+        utils::Error::raise("The excitations and the activations must have the size of the number of muscles");
+    }
+    if (!param.m_isDynamic) {
+        utils::Error::raise("activationsDot needs all the muscles to be dynamic muscles");
+    }
+    if (activationsDot.size() != nbMuscles) {
+        activationsDot.resize(nbMuscles);
+    }
+
+#ifdef BIORBD_USE_CASADI_MATH
+    for (unsigned int i=0; i<nbMuscles; ++i) {
+        // Same bounds as the double path
+        utils::Scalar excitation(IF_ELSE_NAMESPACE::if_else(
+                                     IF_ELSE_NAMESPACE::lt(excitations(i), 0), 0, excitations(i)));
+        utils::Scalar activation(IF_ELSE_NAMESPACE::if_else(
+                                     IF_ELSE_NAMESPACE::lt(activations(i), 0), 0, activations(i)));
+        activation = IF_ELSE_NAMESPACE::if_else(
+                         IF_ELSE_NAMESPACE::gt(activation, 1), 1, activation);
+        utils::Scalar factor;
+        if (param.m_stateType[i] == internal_forces::muscles::STATE_TYPE::DE_GROOTE) {
+            utils::Scalar diff(excitation - activation);
+            utils::Scalar f(0.5 * tanh(0.1 * diff));
+            factor = 0.5 + 1.5 * activation;
+            activationsDot(i) = ((f + 0.5) / (param.m_torqueActivation(i) * factor)
+                                 + (0.5 - f) * factor / param.m_torqueDeactivation(i)) * diff;
+            continue;
+        }
+        if (param.m_stateType[i] == internal_forces::muscles::STATE_TYPE::BUCHANAN) {
+            activation = (exp(param.m_shapeFactor(i) * excitation) - 1) / param.m_buchananDenominator(i);
+        }
+        activation = IF_ELSE_NAMESPACE::if_else(
+                         IF_ELSE_NAMESPACE::lt(activation, param.m_minActivation(i)),
+                         param.m_minActivation(i), activation);
+        excitation = IF_ELSE_NAMESPACE::if_else(
+                         IF_ELSE_NAMESPACE::lt(excitation, param.m_minActivation(i)),
+                         param.m_minActivation(i), excitation);
+        if (!alreadyNormalized) {
+            excitation = excitation / param.m_excitationMax(i);
+        }
+        utils::Scalar num(excitation - activation);
+        factor = 0.5 + 1.5 * activation;
+        activationsDot(i) = num / IF_ELSE_NAMESPACE::if_else(
+                                IF_ELSE_NAMESPACE::gt(num, 0),
+                                param.m_torqueActivation(i) * factor,
+                                param.m_torqueDeactivation(i) / factor);
+    }
+#else
+    // Same bounds as the setters of the states, without the warnings
+    param.m_excitation.array() = excitations.array().max(0);
+    param.m_activation.array() = activations.array().max(0).min(1);
+    if (param.m_hasBuchanan) {
+        // The activation of the Buchanan muscles only depends on their excitation
+        param.m_activation.array() = param.m_isBuchanan.select(
+                                         ((param.m_shapeFactor.array() * param.m_excitation.array()).exp() - 1)
+                                         / param.m_buchananDenominator.array(),
+                                         param.m_activation.array());
+    }
+
+    // First order dynamics (see StateDynamics::timeDerivativeActivation)
+    param.m_numerator.array() = param.m_excitation.array().max(param.m_minActivation.array());
+    if (!alreadyNormalized) {
+        param.m_numerator.array() /= param.m_excitationMax.array();
+    }
+    param.m_factor.array() = 0.5 + 1.5 * param.m_activation.array().max(param.m_minActivation.array());
+    param.m_numerator.array() -= param.m_activation.array().max(param.m_minActivation.array());
+    activationsDot.array() = param.m_numerator.array() / (param.m_numerator.array() > 0).select(
+                                 param.m_torqueActivation.array() * param.m_factor.array(),
+                                 param.m_torqueDeactivation.array() / param.m_factor.array());
+
+    if (param.m_hasDeGroote) {
+        // Smooth dynamics (see StateDynamicsDeGroote::timeDerivativeActivation), on the unbounded states
+        param.m_numerator.array() = param.m_excitation.array() - param.m_activation.array();
+        param.m_factor.array() = 0.5 + 1.5 * param.m_activation.array();
+        param.m_excitation.array() = 0.5 * (0.1 * param.m_numerator.array()).tanh();
+        activationsDot.array() = param.m_isDeGroote.select(
+                                     ((param.m_excitation.array() + 0.5)
+                                      / (param.m_torqueActivation.array() * param.m_factor.array())
+                                      + (0.5 - param.m_excitation.array()) * param.m_factor.array()
+                                      / param.m_torqueDeactivation.array()) * param.m_numerator.array(),
+                                     activationsDot.array());
+    }
+#endif
+}
+
+void internal_forces::muscles::Muscles::fatigueStatesDot(
+    const utils::Vector& activations,
+    const utils::Vector& activeFibers,
+    const utils::Vector& fatiguedFibers,
+    const utils::Vector& restingFibers,
+    utils::Vector& activeFibersDot,
+    utils::Vector& fatiguedFibersDot,
+    utils::Vector& restingFibersDot)
+{
+    MusclesParameters& param(musclesParameters());
+    unsigned int nbMuscles(static_cast<unsigned int>(param.m_stateType.size()));
+    if (activations.size() != nbMuscles || activeFibers.size() != nbMuscles
+            || fatiguedFibers.size() != nbMuscles || restingFibers.size() != nbMuscles) {
+        utils::Error::raise("The activations and the fatigue states must have the size of the number of muscles");
+    }
+    if (activeFibersDot.size() != nbMuscles) {
+        activeFibersDot.resize(nbMuscles);
+    }
+    if (fatiguedFibersDot.size() != nbMuscles) {
+        fatiguedFibersDot.resize(nbMuscles);
+    }
+    if (restingFibersDot.size() != nbMuscles) {
+        restingFibersDot.resize(nbMuscles);
+    }
+
+    // The command is stored in the resting fibers derivative until it is applied
+#ifdef BIORBD_USE_CASADI_MATH
+    for (unsigned int i=0; i<nbMuscles; ++i) {
+        utils::Scalar diff(activations(i) - activeFibers(i));
+        restingFibersDot(i) = IF_ELSE_NAMESPACE::if_else(
+                                  IF_ELSE_NAMESPACE::gt(diff, 0),
+                                  param.m_developFactor(i) * IF_ELSE_NAMESPACE::if_else(
+                                      IF_ELSE_NAMESPACE::lt(restingFibers(i), diff), restingFibers(i), diff),
+                                  param.m_recoveryFactor(i) * diff);
+    }
+#else
+    activeFibersDot.array() = activations.array() - activeFibers.array();
+    restingFibersDot.array() = (activeFibersDot.array() > 0).select(
+                                   param.m_developFactor.array() * activeFibersDot.array().min(restingFibers.array()),
+                                   param.m_recoveryFactor.array() * activeFibersDot.array());
+#endif
+
+    // Applying the command to the fibers
+    fatiguedFibersDot.array() = param.m_fatigueRate.array() * activeFibers.array()
+                                - param.m_recoveryRate.array() * fatiguedFibers.array();
+    activeFibersDot.array() = restingFibersDot.array()
+                              - param.m_fatigueRate.array() * activeFibers.array();
+    restingFibersDot.array() = param.m_recoveryRate.array() * fatiguedFibers.array()
+                               - restingFibersDot.array();
+}
+
+void internal_forces::muscles::Muscles::updateMusclesParameters()
+{
+    MusclesParameters& param(*m_musclesParameters);
+    unsigned int nbMuscles(static_cast<unsigned int>(nbMuscleTotal()));
+    param = MusclesParameters();
+    param.m_isDynamic = true;
+    param.m_torqueActivation.resize(nbMuscles);
+    param.m_torqueDeactivation.resize(nbMuscles);
+    param.m_minActivation.resize(nbMuscles);
+    param.m_excitationMax.resize(nbMuscles);
+    param.m_shapeFactor.resize(nbMuscles);
+    param.m_buchananDenominator.resize(nbMuscles);
+    param.m_fatigueRate.resize(nbMuscles);
+    param.m_recoveryRate.resize(nbMuscles);
+    param.m_developFactor.resize(nbMuscles);
+    param.m_recoveryFactor.resize(nbMuscles);
+
+    unsigned int cmp(0);
+    for (const auto& group : *m_mus) {
+        for (size_t j=0; j<group.nbMuscles(); ++j) {
+            const internal_forces::muscles::Muscle& mus(group.muscle(j));
+            const internal_forces::muscles::Characteristics& characteristics(mus.characteristics());
+            internal_forces::muscles::STATE_TYPE type(mus.state().type());
+            param.m_stateType.push_back(type);
+            param.m_isDynamic = param.m_isDynamic
+                                && dynamic_cast<const internal_forces::muscles::StateDynamics*>(&mus.state());
+
+            param.m_torqueActivation(cmp) = characteristics.torqueActivation();
+            param.m_torqueDeactivation(cmp) = characteristics.torqueDeactivation();
+            param.m_minActivation(cmp) = characteristics.minActivation();
+            param.m_excitationMax(cmp) = characteristics.stateMax().excitation();
+            param.m_shapeFactor(cmp) = 0;
+            param.m_buchananDenominator(cmp) = 1;
+            if (type == internal_forces::muscles::STATE_TYPE::BUCHANAN) {
+                param.m_shapeFactor(cmp) =
+                    dynamic_cast<const internal_forces::muscles::StateDynamicsBuchanan&>(mus.state()).shapeFactor();
+                param.m_buchananDenominator(cmp) = exp(param.m_shapeFactor(cmp)) - 1;
+            }
+
+            const internal_forces::muscles::FatigueParameters& fatigue(characteristics.fatigueParameters());
+            param.m_fatigueRate(cmp) = fatigue.fatigueRate();
+            param.m_recoveryRate(cmp) = fatigue.recoveryRate();
+            param.m_developFactor(cmp) = fatigue.developFactor();
+            param.m_recoveryFactor(cmp) = fatigue.recoveryFactor();
+            ++cmp;
+        }
+    }
+
+#ifndef BIORBD_USE_CASADI_MATH
+    param.m_isDeGroote.resize(nbMuscles);
+    param.m_isBuchanan.resize(nbMuscles);
+    for (unsigned int i=0; i<nbMuscles; ++i) {
+        param.m_isDeGroote(i) = param.m_stateType[i] == internal_forces::muscles::STATE_TYPE::DE_GROOTE;
+        param.m_isBuchanan(i) = param.m_stateType[i] == internal_forces::muscles::STATE_TYPE::BUCHANAN;
+    }
+    param.m_hasDeGroote = param.m_isDeGroote.any();
+    param.m_hasBuchanan = param.m_isBuchanan.any();
+    param.m_excitation.resize(nbMuscles);
+    param.m_activation.resize(nbMuscles);
+    param.m_numerator.resize(nbMuscles);
+    param.m_factor.resize(nbMuscles);
+#endif
+}
+
+internal_forces::muscles::Muscles::MusclesParameters&
+internal_forces::muscles::Muscles::musclesParameters()
+{
+    if (m_musclesParameters->m_stateType.size() != nbMuscleTotal()) {
+        updateMusclesParameters();
+    }
+    return *m_musclesParameters;
+}
+
 utils::Vector internal_forces::muscles::Muscles::muscleForces(
     const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg)
 {
     // Output variable
     utils::Vector forces(nbMuscleTotal());
+    computeMuscleForces(emg, forces);
+
+    // The forces
+    return forces;
+}
+
+void internal_forces::muscles::Muscles::computeMuscleForces(
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    utils::Vector& forces)
+{
+    if (static_cast<size_t>(forces.size()) != nbMuscleTotal()) {
+        forces.resize(static_cast<unsigned int>(nbMuscleTotal()));
+    }
 
     size_t cmpMus(0);
     for (size_t i=0; i<m_mus->size(); ++i) { // muscle group
@@ -216,9 +529,6 @@ utils::Vector internal_forces::muscles::Muscles::muscleForces(
             ++cmpMus;
         }
     }
-
-    // The forces
-    return forces;
 }
 
 utils::Vector internal_forces::muscles::Muscles::muscleForces(
@@ -282,6 +592,7 @@ void internal_forces::muscles::Muscles::updateMuscles(
     const rigidbody::GeneralizedVelocity& QDot,
     bool updateKin)
 {
+    BIORBD_PROFILE_ZONE("Muscles::updateMuscles");
     // Assuming that this is also a Joints type (via BiorbdModel)
     rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
 
@@ -311,6 +622,7 @@ void internal_forces::muscles::Muscles::updateMuscles(
     const rigidbody::GeneralizedCoordinates& Q,
     bool updateKin)
 {
+    BIORBD_PROFILE_ZONE("Muscles::updateMuscles");
     // Assuming that this is also a Joints type (via BiorbdModel)
     rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>
                                        (*this);
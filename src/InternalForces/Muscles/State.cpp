@@ -2,6 +2,7 @@
 #include "InternalForces/Muscles/State.h"
 
 #include "Utils/Error.h"
+#include "Utils/MemoryFootprint.h"
 
 using namespace BIORBD_NAMESPACE;
 internal_forces::muscles::State::State(
@@ -139,3 +140,12 @@ void internal_forces::muscles::State::setType()
 {
     *m_stateType = internal_forces::muscles::STATE_TYPE::SIMPLE_STATE;
 }
+
+void internal_forces::muscles::State::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_stateType);
+    footprint.add(m_excitation);
+    footprint.add(m_excitationNorm);
+    footprint.add(m_activation);
+}
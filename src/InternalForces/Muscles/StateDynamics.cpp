@@ -2,6 +2,7 @@
 #include "InternalForces/Muscles/StateDynamics.h"
 
 #include "Utils/Error.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/String.h"
 #include "InternalForces/Muscles/Characteristics.h"
 
@@ -173,3 +174,12 @@ void internal_forces::muscles::StateDynamics::setType()
 {
     *m_stateType = internal_forces::muscles::STATE_TYPE::DYNAMIC;
 }
+
+void internal_forces::muscles::StateDynamics::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    internal_forces::muscles::State::memoryFootprint(footprint);
+    footprint.add(m_previousExcitation);
+    footprint.add(m_previousActivation);
+    footprint.add(m_activationDot);
+}
@@ -1,6 +1,7 @@
 #define BIORBD_API_EXPORTS
 
 #include <vector>
+#include <algorithm>
 #include "Utils/Error.h"
 #include "RigidBody/GeneralizedTorque.h"
 #include "RigidBody/GeneralizedCoordinates.h"
@@ -16,7 +17,8 @@ using namespace BIORBD_NAMESPACE;
 
 internal_forces::passive_torques::PassiveTorques::PassiveTorques() :
     m_pas(std::make_shared<std::vector<std::shared_ptr<internal_forces::passive_torques::PassiveTorque>>>()),
-    m_isDofSet(std::make_shared<std::vector<bool>>(true))
+    m_isDofSet(std::make_shared<std::vector<bool>>(true)),
+    m_passiveTorqueTable(std::make_shared<std::vector<internal_forces::passive_torques::PassiveTorques::PassiveTorqueTableEntry>>())
 {
     (*m_isDofSet)[0] = false;
 }
@@ -24,7 +26,8 @@ internal_forces::passive_torques::PassiveTorques::PassiveTorques() :
 internal_forces::passive_torques::PassiveTorques::PassiveTorques(
     const internal_forces::passive_torques::PassiveTorques& other) :
     m_pas(other.m_pas),
-    m_isDofSet(other.m_isDofSet)
+    m_isDofSet(other.m_isDofSet),
+    m_passiveTorqueTable(other.m_passiveTorqueTable)
 {
 
 }
@@ -39,21 +42,21 @@ void internal_forces::passive_torques::PassiveTorques::DeepCopy(
 {
     m_pas->resize(other.m_pas->size());
     for (size_t i=0; i<other.m_pas->size(); ++i) {
-        if ((*other.m_pas)[i]->type() == internal_forces::passive_torques::TORQUE_TYPE::TORQUE_CONSTANT) {
+        if (!(*other.m_pas)[i]) {
+            (*m_pas)[i] = nullptr;
+        } else if ((*other.m_pas)[i]->type() == internal_forces::passive_torques::TORQUE_TYPE::TORQUE_CONSTANT) {
             (*m_pas)[i] = std::make_shared<internal_forces::passive_torques::PassiveTorqueConstant>
                     (static_cast<const internal_forces::passive_torques::PassiveTorqueConstant&>(*(*other.m_pas)[i]));
-            return;
         } else if ((*other.m_pas)[i]->type() == internal_forces::passive_torques::TORQUE_TYPE::TORQUE_LINEAR) {
             (*m_pas)[i] = std::make_shared<internal_forces::passive_torques::PassiveTorqueLinear>
                     (static_cast<const internal_forces::passive_torques::PassiveTorqueLinear&>(*(*other.m_pas)[i]));
-            return;
         } else if ((*other.m_pas)[i]->type() == internal_forces::passive_torques::TORQUE_TYPE::TORQUE_EXPONENTIAL) {
             (*m_pas)[i] = std::make_shared<internal_forces::passive_torques::PassiveTorqueExponential>
                     (static_cast<const internal_forces::passive_torques::PassiveTorqueExponential&>(*(*other.m_pas)[i]));
-            return;
         }
     }
     *m_isDofSet = *other.m_isDofSet;
+    compilePassiveTorqueTable();
 }
 
 
@@ -79,22 +82,38 @@ void internal_forces::passive_torques::PassiveTorques::addPassiveTorque(
     if (other.type() == internal_forces::passive_torques::TORQUE_TYPE::TORQUE_CONSTANT) {
         (*m_pas)[idx] = std::make_shared<internal_forces::passive_torques::PassiveTorqueConstant>
                 (static_cast<const internal_forces::passive_torques::PassiveTorqueConstant&>(other));
-        (*m_isDofSet)[idx] = true;
-        return;
     } else if (other.type() == internal_forces::passive_torques::TORQUE_TYPE::TORQUE_LINEAR) {
         (*m_pas)[idx] = std::make_shared<internal_forces::passive_torques::PassiveTorqueLinear>
                 (static_cast<const internal_forces::passive_torques::PassiveTorqueLinear&>(other));
-        (*m_isDofSet)[idx] = true;
-        return;
     } else if (other.type() == internal_forces::passive_torques::TORQUE_TYPE::TORQUE_EXPONENTIAL) {
         (*m_pas)[idx] = std::make_shared<internal_forces::passive_torques::PassiveTorqueExponential>
                 (static_cast<const internal_forces::passive_torques::PassiveTorqueExponential&>(other));
-        (*m_isDofSet)[idx] = true;
-        return;
     } else {
         utils::Error::raise("Passive Torque type not found");
     }
-    return;
+    (*m_isDofSet)[idx] = true;
+    compilePassiveTorqueTable();
+}
+
+void internal_forces::passive_torques::PassiveTorques::compilePassiveTorqueTable()
+{
+    m_passiveTorqueTable->clear();
+    for (size_t i=0; i<m_pas->size(); ++i) {
+        if (i >= m_isDofSet->size() || !(*m_isDofSet)[i]) {
+            continue;
+        }
+        PassiveTorqueTableEntry entry;
+        entry.m_type = (*m_pas)[i]->type();
+        entry.m_dofIdx = static_cast<unsigned int>(i);
+        entry.m_passiveTorque = (*m_pas)[i];
+        m_passiveTorqueTable->push_back(entry);
+    }
+
+    // Group the passive torques of the same type so they are evaluated one after the other
+    std::stable_sort(m_passiveTorqueTable->begin(), m_passiveTorqueTable->end(),
+                     [](const PassiveTorqueTableEntry& a, const PassiveTorqueTableEntry& b) {
+        return a.m_type < b.m_type;
+    });
 }
 
 const std::shared_ptr<internal_forces::passive_torques::PassiveTorque>&
@@ -116,26 +135,35 @@ rigidbody::GeneralizedTorque internal_forces::passive_torques::PassiveTorques::p
     // Assuming that this is also a Joints type (via BiorbdModel)
     const rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
     rigidbody::GeneralizedTorque GeneralizedTorque_all = rigidbody::GeneralizedTorque(model);
+    GeneralizedTorque_all.setZero();
+    accumulatePassiveJointTorque(Q, Qdot, GeneralizedTorque_all);
+    return GeneralizedTorque_all;
+}
 
-    // If there are less actuators declared than dof, the vector must be enlarged
-    if (model.nbDof() >= m_pas->size()) {
-        m_pas->resize(model.nbDof() + 1);
-        m_isDofSet->resize(model.nbDof() + 1, false);
-    }
-
-    for (unsigned int i=0; i<model.nbDof(); ++i) {
-        if (!(*m_isDofSet)[i]) {
-            GeneralizedTorque_all[i] = 0;
-        } else if (std::dynamic_pointer_cast<PassiveTorqueConstant> ((*m_pas)[i])) {
-            GeneralizedTorque_all[i] = std::static_pointer_cast<PassiveTorqueConstant>((*m_pas)[i])->passiveTorque();
-        } else if (std::dynamic_pointer_cast<PassiveTorqueLinear> ((*m_pas)[i])) {
-            GeneralizedTorque_all[i] = std::static_pointer_cast<PassiveTorqueLinear>((*m_pas)[i])->passiveTorque(Q);
-        } else if (std::dynamic_pointer_cast<PassiveTorqueExponential> ((*m_pas)[i])) {
-            GeneralizedTorque_all[i] = std::static_pointer_cast<PassiveTorqueExponential>((*m_pas)[i])->passiveTorque(Q, Qdot);
-        } else {
+void internal_forces::passive_torques::PassiveTorques::accumulatePassiveJointTorque(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity &Qdot,
+    rigidbody::GeneralizedTorque& tau)
+{
+    // The type is known from the table, so the passive torques can be statically cast.
+    // There is at most one passive torque per DoF
+    for (const PassiveTorqueTableEntry& entry : *m_passiveTorqueTable) {
+        switch (entry.m_type) {
+        case internal_forces::passive_torques::TORQUE_TYPE::TORQUE_CONSTANT:
+            tau[entry.m_dofIdx] = tau[entry.m_dofIdx] +
+                    static_cast<PassiveTorqueConstant*>(entry.m_passiveTorque.get())->passiveTorque();
+            break;
+        case internal_forces::passive_torques::TORQUE_TYPE::TORQUE_LINEAR:
+            tau[entry.m_dofIdx] = tau[entry.m_dofIdx] +
+                    static_cast<PassiveTorqueLinear*>(entry.m_passiveTorque.get())->passiveTorque(Q);
+            break;
+        case internal_forces::passive_torques::TORQUE_TYPE::TORQUE_EXPONENTIAL:
+            tau[entry.m_dofIdx] = tau[entry.m_dofIdx] +
+                    static_cast<PassiveTorqueExponential*>(entry.m_passiveTorque.get())->passiveTorque(Q, Qdot);
+            break;
+        default:
             utils::Error::raise("Wrong type (should never get here because of previous safety)");
         }
     }
-    return GeneralizedTorque_all;
 }
 
@@ -2,6 +2,7 @@
 #include "InternalForces/PathModifiers.h"
 
 #include "Utils/Error.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Vector3d.h"
 #include "InternalForces/ViaPoint.h"
 #include "InternalForces/WrappingSphere.h"
@@ -101,6 +102,16 @@ const utils::Vector3d& internal_forces::PathModifiers::object(
     return *(*m_obj)[idx];
 }
 
-
-
-
+void internal_forces::PathModifiers::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_obj);
+    for (auto& obj : *m_obj) {
+        if (footprint.add(obj)) {
+            obj->memoryFootprint(footprint);
+        }
+    }
+    footprint.add(m_nbWraps);
+    footprint.add(m_nbVia);
+    footprint.add(m_totalObjects);
+}
@@ -2,10 +2,15 @@
 #include "ModelReader.h"
 
 #include <limits.h>
+#include <cctype>
+#include <cstring>
 
 #include "BiorbdModel.h"
 #include "Utils/Error.h"
 #include "Utils/IfStream.h"
+#include "Utils/MappedFile.h"
+#include "Utils/Matrix.h"
+#include "Utils/Profiler.h"
 #include "Utils/String.h"
 #include "Utils/Equation.h"
 #include "Utils/Vector.h"
@@ -20,6 +25,7 @@
 #include "RigidBody/MeshFace.h"
 #include "RigidBody/NodeSegment.h"
 #include "RigidBody/SoftContactSphere.h"
+#include "RigidBody/SoftContactMesh.h"
 
 #ifdef MODULE_ACTUATORS
     #include "InternalForces/Actuators/ActuatorConstant.h"
@@ -77,6 +83,7 @@ void Reader::readModelFile(
     const utils::Path &path,
     Model *model)
 {
+    BIORBD_PROFILE_ZONE("Reader::readModelFile");
     // Open file
     if (!path.isFileReadable())
         utils::Error::raise("File " + path.absolutePath() + " could not be open");
@@ -641,6 +648,7 @@ void Reader::readModelFile(
                 double muStatic(-1);
                 double muDynamic(-1);
                 double muViscous(-1);
+                double spacing(0);
 
                 while(file.read(property_tag)
                         && property_tag.tolower().compare("endsoftcontact")) {
@@ -660,12 +668,14 @@ void Reader::readModelFile(
                         file.read(stiffness, variable);
                     } else if (!property_tag.tolower().compare("damping")) {
                         file.read(damping, variable);
-                    } else if (!property_tag.tolower().compare("muStatic")) {
+                    } else if (!property_tag.tolower().compare("mustatic")) {
                         file.read(muStatic, variable);
-                    } else if (!property_tag.tolower().compare("muDynamic")) {
+                    } else if (!property_tag.tolower().compare("mudynamic")) {
                         file.read(muDynamic, variable);
-                    } else if (!property_tag.tolower().compare("muViscous")) {
+                    } else if (!property_tag.tolower().compare("muviscous")) {
                         file.read(muViscous, variable);
+                    } else if (!property_tag.tolower().compare("spacing")) {
+                        file.read(spacing, variable);
                     }
                 }
 
@@ -673,8 +683,29 @@ void Reader::readModelFile(
                     model->addSoftContact(rigidbody::SoftContactSphere(
                         pos, radius, stiffness, damping, muStatic, muDynamic, muViscous, name, parent_str, static_cast<int>(parent_int))
                     );
+                } else if (!contactType.tolower().compare("mesh")){
+#ifdef BIORBD_USE_CASADI_MATH
+                    utils::Error::raise("Mesh soft contacts are not available with CasADi");
+#else
+                    // The points are sampled from the mesh of the parent, which must be declared first
+                    int segmentIdx(model->getBodyBiorbdId(parent_str));
+                    utils::Error::check(segmentIdx >= 0, "The parent of a mesh soft contact must be a segment");
+                    rigidbody::SoftContactMesh contact(
+                        model->mesh(static_cast<size_t>(segmentIdx)),
+                        spacing, stiffness, damping, 0.8, 0.7, 0.5, name, parent_str, static_cast<int>(parent_int));
+                    if (muStatic >= 0) {
+                        contact.setMuStatic(muStatic);
+                    }
+                    if (muDynamic >= 0) {
+                        contact.setMuDynamic(muDynamic);
+                    }
+                    if (muViscous >= 0) {
+                        contact.setMuViscous(muViscous);
+                    }
+                    model->addSoftContact(contact);
+#endif
                 } else {
-                    utils::Error::raise("The 'type' should be 'sphere'.");
+                    utils::Error::raise("The 'type' should be 'sphere' or 'mesh'.");
                 }
 
             } else if (!main_tag.tolower().compare("actuator")) {
@@ -1397,57 +1428,14 @@ std::vector<rigidbody::GeneralizedCoordinates>
 Reader::readQDataFile(
     const utils::Path &path)
 {
-    // Open file
-    // std::cout << "Loading kin file: " << path << std::endl;
-#ifdef _WIN32
-    utils::IfStream file(
-        utils::Path::toWindowsFormat(
-            path.absolutePath()).c_str(), std::ios::in);
-#else
-    utils::IfStream file(
-        path.absolutePath().c_str(), std::ios::in);
-#endif
-
-    // Read file
-    utils::String tp;
-
-    // Determine the file version
-    file.readSpecificTag("version", tp);
-    size_t version(static_cast<size_t>(atoi(tp.c_str())));
-    utils::Error::check(version == 1, "Version not implemented yet");
-
-    // Determine the number of markers
-    file.readSpecificTag("nddl", tp);
-    size_t NDDL(static_cast<size_t>(atoi(tp.c_str())));
-
-    // Determine the number of nodes
-    file.readSpecificTag("nbintervals", tp);
-    size_t nbIntervals(static_cast<size_t>(atoi(tp.c_str())));
-
+    DataFileStream file(path, "nddl");
     std::vector<rigidbody::GeneralizedCoordinates> kinematics;
-    // Scroll down until the definition of a marker
-    for (size_t j=0; j<nbIntervals+1; j++) {
-        while (tp.compare("T")) {
-            bool check = file.read(tp);
-            utils::Error::check(check,
-                                        "Kin file error, wrong size of NDDL or intervals?");
-        }
-
-        double time;
-        file.read(time);
-        rigidbody::GeneralizedCoordinates position(NDDL);
-        for (size_t i=0; i<NDDL; i++) {
-            file.read(position(static_cast<unsigned int>(i)));
-        }
-
+    kinematics.reserve(file.nbFrames());
+    double time;
+    rigidbody::GeneralizedCoordinates position(static_cast<unsigned int>(file.nbVariables()));
+    while (file.next(time, position)) {
         kinematics.push_back(position);
-        // reinitialise for the next iteration
-        tp = "";
     }
-
-    // Close file
-    // std::cout << "Kin file successfully loaded" << std::endl;
-    file.close();
     return kinematics;
 }
 
@@ -1455,57 +1443,14 @@ std::vector<utils::Vector>
 Reader::readActivationDataFile(
     const utils::Path &path)
 {
-    // Open file
-    // std::cout << "Loading kin file: " << path << std::endl;
-#ifdef _WIN32
-    utils::IfStream file(
-        utils::Path::toWindowsFormat(
-            path.absolutePath()).c_str(), std::ios::in);
-#else
-    utils::IfStream file(
-        path.absolutePath().c_str(), std::ios::in);
-#endif
-
-    // Read file
-    utils::String tp;
-
-    // Determine the file version
-    file.readSpecificTag("version", tp);
-    size_t version(static_cast<size_t>(atoi(tp.c_str())));
-    utils::Error::check(version == 1, "Version not implemented yet");
-
-    // Determine the number of markers
-    file.readSpecificTag("nbmuscles", tp);
-    size_t nMus(static_cast<size_t>(atoi(tp.c_str())));
-
-    // Determine the number of nodes
-    file.readSpecificTag("nbintervals", tp);
-    size_t nbIntervals(static_cast<size_t>(atoi(tp.c_str())));
-
+    DataFileStream file(path, "nbmuscles");
     std::vector<utils::Vector> activations;
-    // Scroll down until the definition of a marker
-    for (size_t j=0; j<nbIntervals+1; j++) {
-        while (tp.compare("T")) {
-            bool check = file.read(tp);
-            utils::Error::check(check,
-                                        "Kin file error, wrong size of number of muscles or intervals?");
-        }
-
-        double time;
-        file.read(time);
-        utils::Vector activation_tp(nMus);
-        for (size_t i=0; i<nMus; i++) {
-            file.read(activation_tp(static_cast<unsigned int>(i)));
-        }
-
+    activations.reserve(file.nbFrames());
+    double time;
+    utils::Vector activation_tp(static_cast<unsigned int>(file.nbVariables()));
+    while (file.next(time, activation_tp)) {
         activations.push_back(activation_tp);
-        // reinitialize for the next iteration
-        tp = "";
     }
-
-    // Close file
-    // std::cout << "Activation file successfully loaded" << std::endl;
-    file.close();
     return activations;
 }
 
@@ -1513,121 +1458,162 @@ std::vector<utils::Vector>
 Reader::readTorqueDataFile(
     const utils::Path &path)
 {
-    // Open file
-    // std::cout << "Loading kin file: " << path << std::endl;
-#ifdef _WIN32
-    utils::IfStream file(
-        utils::Path::toWindowsFormat(
-            path.absolutePath()).c_str(), std::ios::in);
-#else
-    utils::IfStream file(
-        path.absolutePath().c_str(), std::ios::in);
-#endif
-
-    //Read file
-    utils::String tp;
-
-    // Determine the file version
-    file.readSpecificTag("version", tp);
-    size_t version(static_cast<size_t>(atoi(tp.c_str())));
-    utils::Error::check(version == 1, "Version not implemented yet");
-
-    // Determine the number of GeneralizedTorque
-    file.readSpecificTag("nGeneralizedTorque", tp); //
-    size_t nGeneralizedTorque(static_cast<size_t>(atoi(tp.c_str())));
-
-    // Determine the number of nodes
-    file.readSpecificTag("nbintervals", tp);
-    size_t nbIntervals(static_cast<size_t>(atoi(tp.c_str())));
-
+    DataFileStream file(path, "nGeneralizedTorque");
     std::vector<utils::Vector> torque;
-    // Scroll down until the definition of a torque
-    for (size_t j=0; j<nbIntervals+1; j++) {
-        while (tp.compare("T")) {
-            bool check = file.read(tp);
-            utils::Error::check(check,
-                                        "Kin file error, wrong size of NGeneralizedTorque or intervals?"); //
-        }
-
-        // Read the first line which represents the timestamp
-        double time;
-        file.read(time);
-
-        // Read the vector of GeneralizedTorque associated to the timestamp
-        utils::Vector torque_tp(nGeneralizedTorque);
-        for (size_t i=0; i<nGeneralizedTorque; i++) {
-            file.read(torque_tp(static_cast<unsigned int>(i)));
-        }
-
+    torque.reserve(file.nbFrames());
+    double time;
+    utils::Vector torque_tp(static_cast<unsigned int>(file.nbVariables()));
+    while (file.next(time, torque_tp)) {
         torque.push_back(torque_tp);
-        // reinitialise for the next iteration
-        tp = "";
     }
-
-    // Close file
-    file.close();
     return torque;
-
 }
 
 std::vector<utils::Vector>
 Reader::readGroundReactionForceDataFile(
     const utils::Path &path)
 {
-    // Open file
-    // std::cout << "Loading ground reaction force file: " << path << std::endl;
-#ifdef _WIN32
-    utils::IfStream file(
-        utils::Path::toWindowsFormat(
-            path.absolutePath()).c_str(), std::ios::in);
-#else
-    utils::IfStream file(
-        path.absolutePath().c_str(), std::ios::in);
-#endif
+    DataFileStream file(path, "ngrf");
+    std::vector<utils::Vector> grf;
+    grf.reserve(file.nbFrames());
+    double time;
+    utils::Vector grf_tp(static_cast<unsigned int>(file.nbVariables()));
+    while (file.next(time, grf_tp)) {
+        grf.push_back(grf_tp);
+    }
+    return grf;
+}
 
-    // Read file
-    utils::String tp;
+void Reader::readDataFile(
+    const utils::Path &path,
+    const utils::String &sizeTag,
+    utils::Matrix &data,
+    utils::Vector &time)
+{
+    DataFileStream file(path, sizeTag);
+    unsigned int nbVariables(static_cast<unsigned int>(file.nbVariables()));
+    unsigned int nbFrames(static_cast<unsigned int>(file.nbFrames()));
+    data.resize(nbVariables, nbFrames);
+    time.resize(nbFrames);
+
+    // Parse in place, straight into the columns of the matrix
+    utils::MappedFile& mapped(*file.m_file);
+    for (unsigned int j=0; j<nbFrames; ++j) {
+        utils::Error::check(mapped.reachTag("T"),
+                                    "Data file error, wrong size of " + sizeTag + " or intervals?");
+        double value;
+        utils::Error::check(mapped.readNumber(value), "Data file error, missing time");
+        time(j) = value;
+        for (unsigned int i=0; i<nbVariables; ++i) {
+            utils::Error::check(mapped.readNumber(value),
+                                        "Data file error, wrong size of " + sizeTag + " or intervals?");
+            data(i, j) = value;
+        }
+    }
+}
 
-    // Determine the file version
-    file.readSpecificTag("version", tp);
-    size_t version(static_cast<size_t>(atoi(tp.c_str())));
-    utils::Error::check(version == 1, "Version not implemented yet");
+void Reader::readQDataFile(
+    const utils::Path &path,
+    utils::Matrix &Q,
+    utils::Vector &time)
+{
+    readDataFile(path, "nddl", Q, time);
+}
 
-    // Determine the number of grf (ground reaction force)
-    file.readSpecificTag("ngrf", tp); //
-    size_t NGRF(static_cast<size_t>(atoi(tp.c_str())));
+void Reader::readActivationDataFile(
+    const utils::Path &path,
+    utils::Matrix &activations,
+    utils::Vector &time)
+{
+    readDataFile(path, "nbmuscles", activations, time);
+}
 
-    // Determine the number of nodes
-    file.readSpecificTag("nbintervals", tp);
-    size_t nbIntervals(static_cast<size_t>(atoi(tp.c_str())));
+void Reader::readTorqueDataFile(
+    const utils::Path &path,
+    utils::Matrix &torque,
+    utils::Vector &time)
+{
+    readDataFile(path, "nGeneralizedTorque", torque, time);
+}
 
-    std::vector<utils::Vector> grf;
-    // Scroll down until the definition of a torque
-    for (size_t j=0; j<nbIntervals+1; j++) {
-        while (tp.compare("T")) {
-            bool check = file.read(tp);
-            utils::Error::check(check, "Grf file error, wrong size of NR or intervals?");
-        }
+void Reader::readGroundReactionForceDataFile(
+    const utils::Path &path,
+    utils::Matrix &grf,
+    utils::Vector &time)
+{
+    readDataFile(path, "ngrf", grf, time);
+}
 
-        // Read the first line that represents the timestamp
-        double time;
-        file.read(time);
+void Reader::readViconForceFile(
+    const utils::Path &path,
+    std::vector<utils::Matrix> &data,
+    std::vector<size_t> &frequency)
+{
+    utils::MappedFile file(path);
+    data.clear();
+    frequency.clear();
 
-        // Read the vector of GeneralizedTorque associated to the timestamp
-        utils::Vector grf_tp(NGRF);
-        for (size_t i=0; i<NGRF; i++) {
-            file.read(grf_tp(static_cast<unsigned int>(i)));
+    std::vector<double> values;
+    while (file.reachTag("devices")) {
+        // Get the acquisition frequency
+        double frequency1pf;
+        utils::Error::check(file.readNumber(frequency1pf), "Force file error, missing frequency");
+
+        // Skip the end of the line and the header
+        const char* begin;
+        const char* end;
+        for (size_t i=0; i<4; ++i) {
+            file.readLine(begin, end);
         }
 
-        grf.push_back(grf_tp);
-        // reinitialize for the next iteration
-        tp = "";
-    }
+        // Transcribe the values until an empty line (the end of the platform)
+        values.clear();
+        while (file.readLine(begin, end)) {
+            const char* field(begin);
+            while (field < end && std::isspace(static_cast<unsigned char>(*field))) {
+                ++field;
+            }
+            if (field == end) {
+                break;
+            }
 
-    // Close file
-    file.close();
-    return grf;
+            // Fields are comma separated (2 times, 3 cop, 3 forces, 3 moments)
+            size_t nbFields(0);
+            double line[11];
+            while (true) {
+                const char* comma(static_cast<const char*>(std::memchr(field, ',', static_cast<size_t>(end - field))));
+                const char* fieldEnd(comma ? comma : end);
+                utils::Error::check(nbFields < 11, "Wrong number of element in a line in the force file");
+                line[nbFields++] = utils::MappedFile::toNumber(field, fieldEnd);
+                if (!comma) {
+                    break;
+                }
+                field = comma + 1;
+            }
+            utils::Error::check(nbFields == 11, "Wrong number of element in a line in the force file");
+
+            values.push_back(line[0]); // Frame stamp (the subframe is not interesting)
+            for (unsigned int i=0; i<3; ++i) {
+                values.push_back(line[i+2]/1000); // Center of pressure from mm to m
+            }
+            for (unsigned int i=0; i<3; ++i) {
+                values.push_back(line[i+5]); // Force
+            }
+            for (unsigned int i=0; i<3; ++i) {
+                values.push_back(line[i+8]/1000); // Moment from Nmm to Nm
+            }
+        }
 
+        unsigned int nbFrames(static_cast<unsigned int>(values.size() / 10));
+        utils::Matrix platform(10, nbFrames);
+        for (unsigned int j=0; j<nbFrames; ++j) {
+            for (unsigned int i=0; i<10; ++i) {
+                platform(i, j) = values[10*j + i];
+            }
+        }
+        data.push_back(platform);
+        frequency.push_back(static_cast<size_t>(frequency1pf));
+    }
 }
 
 void Reader::readViconForceFile(
@@ -1641,87 +1627,25 @@ void Reader::readViconForceFile(
     std::vector<std::vector<utils::Vector3d>>&
     cop)  // Center of pressure (x,y,z) * number of pf
 {
-    // Open file
-    // std::cout << "Loading force file: " << path << std::endl;
-#ifdef _WIN32
-    utils::IfStream file(
-        utils::Path::toWindowsFormat(
-            path.absolutePath()).c_str(), std::ios::in);
-#else
-    utils::IfStream file(
-        path.absolutePath().c_str(), std::ios::in);
-#endif
+    std::vector<utils::Matrix> data;
+    readViconForceFile(path, data, frequency);
 
     frame.clear();
     force.clear();
     moment.clear();
     cop.clear();
-
-    // Read file
-    utils::String tp;
-
-
-    while(!file.eof()) {
-        // Put everything in temporary per platform (Mettre tout en temporaire par plate-forme)
+    for (const auto& platform : data) {
         std::vector<size_t> frame1pf;
         std::vector<utils::Vector3d> force1fp;
         std::vector<utils::Vector3d> moment1fp;
         std::vector<utils::Vector3d> cop1fp;
-
-        // Get the acquisition frequency
-        file.readSpecificTag("devices", tp);
-        size_t frequency1pf(static_cast<size_t>(atoi(tp.c_str())));
-
-        // Skip the header
-        for (size_t i=0; i<4; ++i) {
-            file.getline(tp);
+        for (unsigned int j=0; j<platform.cols(); ++j) {
+            frame1pf.push_back(static_cast<size_t>(platform(0, j)));
+            cop1fp.push_back(utils::Vector3d(platform(1, j), platform(2, j), platform(3, j)));
+            force1fp.push_back(utils::Vector3d(platform(4, j), platform(5, j), platform(6, j)));
+            moment1fp.push_back(utils::Vector3d(platform(7, j), platform(8, j), platform(9, j)));
         }
-
-        // Transcribe the values
-        while(!file.eof()) { // return false if it fails
-            file.getline(tp); // take the entire line
-            // If line is empty, it's because we are done with the forces on this platform
-            if (!tp.compare("")) {
-                break;
-            }
-
-            // Otherwise, we save the line
-            // now we'll use a stringstream to separate the fields out of the line (comma separated)
-            std::stringstream ss( tp );
-            utils::String field;
-            std::vector<double> data;
-            data.clear();
-            while (getline( ss, field, ',' )) {
-                // for each field we wish to convert it to a double
-                // (since we require that the CSV contains nothing but floating-point values)
-                std::stringstream fs( field );
-                double f = 0.0;  // (default value is 0.0)
-                fs >> f;
-
-                // add the newly-converted field to the end of the record
-                data.push_back( f );
-            }
-            // Make sure that the line has the right number of elements(2 times, 3 cop, 3 forces, 3 moments)
-            utils::Error::check(data.size()==11, "Wrong number of element in a line in the force file");
-
-            // Fill in the fields
-            frame1pf.push_back(static_cast<size_t>(data[0]));  // Frame stamp
-            //        size_t subFrame = static_cast<size_t>(data[1]); // Subframes (not interesting)
-            utils::Vector3d cop_tp(0, 0, 0); // Center of pressure
-            utils::Vector3d for_tp(0, 0, 0); // Force
-            utils::Vector3d M_tp(0, 0, 0);   // Moment
-            for (unsigned int i=0; i<3; ++i) {
-                cop_tp[i] = data[i+2]/1000; // from mm to m
-                for_tp[i] = data[i+5];
-                M_tp[i] = data[i+8]/1000; // from Nmm to Nm
-            }
-            cop1fp.push_back(cop_tp);
-            force1fp.push_back(for_tp);
-            moment1fp.push_back(M_tp);
-        }
-        // Push back of the values
         frame.push_back(frame1pf);
-        frequency.push_back(frequency1pf);
         force.push_back(force1fp);
         moment.push_back(moment1fp);
         cop.push_back(cop1fp);
@@ -2389,3 +2313,75 @@ std::vector<std::vector<utils::Vector3d>>
 
     return readViconMarkerFile(path, MarkersInFile, nFramesToGet);
 }
+
+DataFileStream::DataFileStream(
+    const utils::Path &path,
+    const utils::String &sizeTag) :
+    m_file(std::make_shared<utils::MappedFile>(path)),
+    m_nbVariables(std::make_shared<size_t>(0)),
+    m_nbFrames(std::make_shared<size_t>(0)),
+    m_frame(std::make_shared<size_t>(0)),
+    m_firstFramePosition(std::make_shared<size_t>(0))
+{
+    double value;
+
+    // Determine the file version
+    utils::Error::check(m_file->reachTag("version") && m_file->readNumber(value),
+                                "version parameter could not be found in Data file..");
+    utils::Error::check(value == 1, "Version not implemented yet");
+
+    // Determine the number of variables
+    utils::Error::check(m_file->reachTag(sizeTag.c_str()) && m_file->readNumber(value),
+                                sizeTag + " parameter could not be found in Data file..");
+    *m_nbVariables = static_cast<size_t>(value);
+
+    // Determine the number of nodes (there is nbIntervals+1 values)
+    utils::Error::check(m_file->reachTag("nbintervals") && m_file->readNumber(value),
+                                "nbintervals parameter could not be found in Data file..");
+    *m_nbFrames = static_cast<size_t>(value) + 1;
+    *m_firstFramePosition = m_file->position();
+}
+
+size_t DataFileStream::nbVariables() const
+{
+    return *m_nbVariables;
+}
+
+size_t DataFileStream::nbFrames() const
+{
+    return *m_nbFrames;
+}
+
+size_t DataFileStream::frame() const
+{
+    return *m_frame;
+}
+
+bool DataFileStream::next(
+    double &time,
+    utils::Vector &values)
+{
+    if (*m_frame >= *m_nbFrames) {
+        return false;
+    }
+    utils::Error::check(m_file->reachTag("T"),
+                                "Data file error, wrong size of variables or intervals?");
+    utils::Error::check(m_file->readNumber(time), "Data file error, missing time");
+    if (static_cast<size_t>(values.size()) != *m_nbVariables) {
+        values.resize(static_cast<unsigned int>(*m_nbVariables));
+    }
+    double value;
+    for (unsigned int i=0; i<*m_nbVariables; ++i) {
+        utils::Error::check(m_file->readNumber(value),
+                                    "Data file error, wrong size of variables or intervals?");
+        values(i) = value;
+    }
+    ++*m_frame;
+    return true;
+}
+
+void DataFileStream::rewind()
+{
+    m_file->setPosition(*m_firstFramePosition);
+    *m_frame = 0;
+}
@@ -0,0 +1,382 @@
+#define BIORBD_API_EXPORTS
+#include "ReducedModel.h"
+
+#include <set>
+#include <cctype>
+#include <string>
+
+#include "Utils/Error.h"
+#include "Utils/String.h"
+#include "Utils/Vector.h"
+#include "Utils/Vector3d.h"
+#include "Utils/Matrix3d.h"
+#include "Utils/Range.h"
+#include "Utils/Rotation.h"
+#include "Utils/RotoTrans.h"
+#include "Utils/RotoTransNode.h"
+#include "RigidBody/Segment.h"
+#include "RigidBody/SegmentCharacteristics.h"
+#include "RigidBody/NodeSegment.h"
+#include "RigidBody/IMU.h"
+
+#ifdef MODULE_MUSCLES
+#include "InternalForces/PathModifiers.h"
+#include "InternalForces/ViaPoint.h"
+#include "InternalForces/WrappingHalfCylinder.h"
+#include "InternalForces/WrappingSphere.h"
+#include "InternalForces/Muscles/Muscle.h"
+#include "InternalForces/Muscles/MuscleGroup.h"
+#include "InternalForces/Muscles/MuscleGeometry.h"
+#include "InternalForces/Muscles/Characteristics.h"
+#include "InternalForces/Muscles/FatigueModel.h"
+#include "InternalForces/Muscles/FatigueState.h"
+#include "InternalForces/Muscles/StateDynamicsBuchanan.h"
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+#ifndef BIORBD_USE_CASADI_MATH
+#ifdef MODULE_MUSCLES
+static bool isFatigable(
+    internal_forces::muscles::MUSCLE_TYPE type)
+{
+    return type == internal_forces::muscles::MUSCLE_TYPE::HILL_THELEN_FATIGABLE
+           || type == internal_forces::muscles::MUSCLE_TYPE::HILL_DE_GROOTE_FATIGABLE;
+}
+#endif
+
+ReducedModel::ReducedModel(
+    Model& model,
+    const std::vector<size_t>& lockedDofs,
+    const std::vector<double>& lockedValues,
+    const std::vector<utils::String>& prunedSegments,
+    bool keepMusclesWithoutDof) :
+    Model(),
+    m_lockedQ(std::make_shared<std::vector<double>>(model.nbQ(), 0)),
+    m_dofIndices(std::make_shared<std::vector<size_t>>()),
+    m_markerIndices(std::make_shared<std::vector<size_t>>()),
+    m_contactIndices(std::make_shared<std::vector<size_t>>())
+#ifdef MODULE_MUSCLES
+    , m_muscleIndices(std::make_shared<std::vector<size_t>>())
+#endif
+{
+    utils::Error::check(model.nbQuat() == 0,
+                        "Models with quaternions cannot be reduced");
+    utils::Error::check(model.nbLoopConstraints() == 0,
+                        "Models with loop constraints cannot be reduced");
+    utils::Error::check(model.nbSoftContacts() == 0,
+                        "Models with soft contacts cannot be reduced");
+#ifdef MODULE_ACTUATORS
+    utils::Error::check(model.nbActuators() == 0,
+                        "Models with actuators cannot be reduced");
+#endif
+#ifdef MODULE_PASSIVE_TORQUES
+    utils::Error::check(model.nbPassiveTorques() == 0,
+                        "Models with passive torques cannot be reduced");
+#endif
+#ifdef MODULE_LIGAMENTS
+    utils::Error::check(model.nbLigaments() == 0,
+                        "Models with ligaments cannot be reduced");
+#endif
+    utils::Error::check(lockedDofs.size() == lockedValues.size(),
+                        "There must be one value per locked DoF");
+
+    std::vector<bool> isLocked(model.nbQ(), false);
+    for (size_t i=0; i<lockedDofs.size(); ++i) {
+        utils::Error::check(lockedDofs[i] < model.nbQ(),
+                            "The index of a locked DoF is out of range");
+        utils::Error::check(!isLocked[lockedDofs[i]], "A DoF is locked twice");
+        isLocked[lockedDofs[i]] = true;
+        (*m_lockedQ)[lockedDofs[i]] = lockedValues[i];
+    }
+    std::set<std::string> pruned;
+    for (size_t i=0; i<prunedSegments.size(); ++i) {
+        utils::Error::check(model.getBodyBiorbdId(prunedSegments[i]) >= 0,
+                            "The pruned segment " + prunedSegments[i] + " does not exist");
+        pruned.insert(prunedSegments[i]);
+    }
+
+    // Rebuild the kinematic tree. The segment that moves each kept segment is kept along,
+    // so the muscles that cannot change length anymore can be found afterward
+    gravity = model.gravity;
+    std::vector<bool> isKept(model.nbSegment(), false);
+    std::vector<int> movingSegment(model.nbSegment(), -1);
+    size_t dof(0);
+    for (size_t s=0; s<model.nbSegment(); ++s) {
+        const rigidbody::Segment& segment(model.segment(s));
+        int parent(model.getBodyBiorbdId(segment.parent()));
+        isKept[s] = pruned.find(segment.name()) == pruned.end()
+                    && (parent < 0 || isKept[static_cast<size_t>(parent)]);
+        if (!isKept[s]) {
+            dof += segment.nbDof();
+            continue;
+        }
+        movingSegment[s] = parent < 0 ? -1 : movingSegment[static_cast<size_t>(parent)];
+
+        utils::String pieceParent(segment.parent());
+        utils::String seqT("");
+        utils::String seqR("");
+        std::vector<utils::Range> QRanges;
+        std::vector<utils::Range> QDotRanges;
+        std::vector<utils::Range> QDDotRanges;
+        size_t nbParts(0);
+
+        // The translations commute, so the locked ones are all folded in the reference frame
+        utils::Vector3d lockedTranslation(0, 0, 0);
+        for (size_t i=0; i<segment.nbDof(); ++i, ++dof) {
+            if (isLocked[dof]) {
+                if (i < segment.nbDofTrans()) {
+                    lockedTranslation[segment.seqT()[i] - 'x'] = (*m_lockedQ)[dof];
+                }
+                continue;
+            }
+            if (i < segment.nbDofTrans()) {
+                seqT += segment.seqT()[i];
+            }
+            QRanges.push_back(segment.QRanges()[i].DeepCopy());
+            QDotRanges.push_back(segment.QDotRanges()[i].DeepCopy());
+            QDDotRanges.push_back(segment.QDDotRanges()[i].DeepCopy());
+        }
+        dof -= segment.nbDof();
+        utils::RotoTrans pieceRT(segment.localJCS() * utils::RotoTrans(utils::Rotation(), lockedTranslation));
+
+        // The rotations do not commute: the DoF before a locked rotation are moved to a massless part
+        size_t nbFreeBefore(0);
+        for (size_t i=0; i<segment.nbDof(); ++i, ++dof) {
+            if (!isLocked[dof]) {
+                m_dofIndices->push_back(dof);
+                if (i >= segment.nbDofTrans()) {
+                    seqR += segment.seqR()[i - segment.nbDofTrans()];
+                }
+                ++nbFreeBefore;
+                continue;
+            }
+            if (i < segment.nbDofTrans()) {
+                continue;
+            }
+            if (nbFreeBefore) {
+                utils::String partName(utils::String(segment.name()) + "_part" + nbParts++);
+                std::vector<utils::Range> partQRanges(QRanges.begin(), QRanges.begin() + nbFreeBefore);
+                std::vector<utils::Range> partQDotRanges(QDotRanges.begin(), QDotRanges.begin() + nbFreeBefore);
+                std::vector<utils::Range> partQDDotRanges(QDDotRanges.begin(), QDDotRanges.begin() + nbFreeBefore);
+                AddSegment(partName, pieceParent, seqT, seqR,
+                           partQRanges, partQDotRanges, partQDDotRanges,
+                           rigidbody::SegmentCharacteristics(0, utils::Vector3d(0, 0, 0), utils::Matrix3d::Zero()),
+                           pieceRT);
+                QRanges.erase(QRanges.begin(), QRanges.begin() + nbFreeBefore);
+                QDotRanges.erase(QDotRanges.begin(), QDotRanges.begin() + nbFreeBefore);
+                QDDotRanges.erase(QDDotRanges.begin(), QDDotRanges.begin() + nbFreeBefore);
+                pieceParent = partName;
+                pieceRT = utils::RotoTrans();
+                seqT = "";
+                seqR = "";
+                nbFreeBefore = 0;
+            }
+            utils::Vector angle(1);
+            angle[0] = (*m_lockedQ)[dof];
+            pieceRT = pieceRT * utils::RotoTrans(angle, utils::Vector3d(0, 0, 0),
+                                                 utils::String(std::string(1, segment.seqR()[i - segment.nbDofTrans()])));
+        }
+        AddSegment(segment.name(), pieceParent, seqT, seqR,
+                   QRanges, QDotRanges, QDDotRanges,
+                   segment.characteristics().DeepCopy(), pieceRT);
+        if (nbParts || nbFreeBefore) {
+            movingSegment[s] = static_cast<int>(s);
+        }
+    }
+
+    // Whatever is attached to a kept segment is kept
+    for (size_t i=0; i<model.nbMarkers(); ++i) {
+        const rigidbody::NodeSegment& marker(model.marker(i));
+        int parent(model.getBodyBiorbdId(marker.parent()));
+        if (parent >= 0 && !isKept[static_cast<size_t>(parent)]) {
+            continue;
+        }
+        addMarker(marker, marker.utils::Node::name(), marker.parent(),
+                  marker.isTechnical(), marker.isAnatomical(), marker.axesToRemoveAsString(),
+                  static_cast<int>(GetBodyId(marker.parent().c_str())));
+        m_markerIndices->push_back(i);
+    }
+    for (size_t i=0; i<model.nbIMUs(); ++i) {
+        const rigidbody::IMU& imu(model.IMU()[i]);
+        int parent(model.getBodyBiorbdId(imu.parent()));
+        if (parent < 0 || isKept[static_cast<size_t>(parent)]) {
+            addIMU(imu.DeepCopy(), imu.isTechnical(), imu.isAnatomical());
+        }
+    }
+    for (size_t i=0; i<model.nbRTs(); ++i) {
+        const utils::RotoTransNode& rt(model.RTs()[i]);
+        int parent(model.getBodyBiorbdId(rt.parent()));
+        if (parent < 0 || isKept[static_cast<size_t>(parent)]) {
+            addRT(rt.DeepCopy());
+        }
+    }
+
+    // The contacts are declared axis by axis in RBDL, so their order is read back from the names
+    size_t row(0);
+    for (size_t i=0; i<model.rigidContacts().size(); ++i) {
+        const rigidbody::NodeSegment& contact(model.rigidContacts()[i]);
+        size_t nbAxes(contact.availableAxesIndices().size());
+        utils::String axes("");
+        for (size_t j=0; j<nbAxes; ++j) {
+            utils::String name(model.contactName(row + j));
+            utils::Error::check(name.length() == contact.utils::Node::name().length() + 2,
+                                "Contacts defined by a normal cannot be reduced");
+            axes += static_cast<char>(std::tolower(name[name.length() - 1]));
+        }
+        int parent(model.getBodyBiorbdId(contact.parent()));
+        if (parent < 0 || isKept[static_cast<size_t>(parent)]) {
+            AddConstraint(GetBodyId(contact.parent().c_str()), contact, axes,
+                          contact.utils::Node::name(), contact.parent());
+            for (size_t j=0; j<nbAxes; ++j) {
+                m_contactIndices->push_back(row + j);
+            }
+        }
+        row += nbAxes;
+    }
+
+#ifdef MODULE_MUSCLES
+    size_t muscleIdx(0);
+    for (size_t g=0; g<model.nbMuscleGroups(); ++g) {
+        internal_forces::muscles::MuscleGroup& group(model.muscleGroup(g));
+        int groupIdx(-1);
+        for (size_t m=0; m<group.nbMuscles(); ++m, ++muscleIdx) {
+            internal_forces::muscles::Muscle& muscle(group.muscle(m));
+            const internal_forces::PathModifiers& pathModifiers(muscle.pathModifier());
+
+            // All the points must be on kept segments and at least two of them must move with
+            // different DoF for the muscle to produce any torque
+            std::vector<utils::String> parents;
+            parents.push_back(muscle.position().originInLocal().parent());
+            parents.push_back(muscle.position().insertionInLocal().parent());
+            for (size_t i=0; i<pathModifiers.nbObjects(); ++i) {
+                parents.push_back(pathModifiers.object(i).parent());
+            }
+            bool isMuscleKept(true);
+            bool canMove(false);
+            int firstMovingSegment(-2);
+            for (size_t i=0; i<parents.size(); ++i) {
+                int parent(model.getBodyBiorbdId(parents[i]));
+                if (parent >= 0 && !isKept[static_cast<size_t>(parent)]) {
+                    isMuscleKept = false;
+                    break;
+                }
+                int moving(parent < 0 ? -1 : movingSegment[static_cast<size_t>(parent)]);
+                if (firstMovingSegment == -2) {
+                    firstMovingSegment = moving;
+                } else if (moving != firstMovingSegment) {
+                    canMove = true;
+                }
+            }
+            if (!isMuscleKept || (!canMove && !keepMusclesWithoutDof)) {
+                continue;
+            }
+
+            if (groupIdx < 0) {
+                addMuscleGroup(group.name(), group.origin(), group.insertion());
+                groupIdx = static_cast<int>(nbMuscleGroups() - 1);
+            }
+            internal_forces::muscles::MuscleGroup& newGroup(muscleGroup(static_cast<size_t>(groupIdx)));
+            internal_forces::muscles::MuscleGeometry geometry(
+                muscle.position().originInLocal().DeepCopy(),
+                muscle.position().insertionInLocal().DeepCopy());
+            internal_forces::muscles::STATE_FATIGUE_TYPE fatigueType(
+                internal_forces::muscles::STATE_FATIGUE_TYPE::NO_FATIGUE_STATE_TYPE);
+            if (isFatigable(muscle.type())) {
+                fatigueType = dynamic_cast<const internal_forces::muscles::FatigueModel&>(muscle).fatigueState().getType();
+            }
+            newGroup.addMuscle(muscle.name(), muscle.type(), geometry,
+                               muscle.characteristics().DeepCopy(), internal_forces::PathModifiers(),
+                               muscle.state().type(), fatigueType);
+
+            internal_forces::muscles::Muscle& newMuscle(newGroup.muscle(newGroup.nbMuscles() - 1));
+            for (size_t i=0; i<pathModifiers.nbObjects(); ++i) {
+                const utils::Vector3d& object(pathModifiers.object(i));
+                if (object.typeOfNode() == utils::NODE_TYPE::VIA_POINT) {
+                    internal_forces::ViaPoint copy(
+                        static_cast<const internal_forces::ViaPoint&>(object).DeepCopy());
+                    newMuscle.addPathObject(copy);
+                } else if (object.typeOfNode() == utils::NODE_TYPE::WRAPPING_HALF_CYLINDER) {
+                    internal_forces::WrappingHalfCylinder copy(
+                        static_cast<const internal_forces::WrappingHalfCylinder&>(object).DeepCopy());
+                    newMuscle.addPathObject(copy);
+                } else if (object.typeOfNode() == utils::NODE_TYPE::WRAPPING_SPHERE) {
+                    internal_forces::WrappingSphere copy(
+                        static_cast<const internal_forces::WrappingSphere&>(object).DeepCopy());
+                    newMuscle.addPathObject(copy);
+                } else {
+                    utils::Error::raise("Wrapping type not found");
+                }
+            }
+            if (muscle.state().type() == internal_forces::muscles::STATE_TYPE::BUCHANAN) {
+                static_cast<internal_forces::muscles::StateDynamicsBuchanan&>(newMuscle.state()).shapeFactor(
+                    static_cast<const internal_forces::muscles::StateDynamicsBuchanan&>(muscle.state()).shapeFactor());
+            }
+            m_muscleIndices->push_back(muscleIdx);
+        }
+    }
+#endif
+}
+
+size_t ReducedModel::nbQFull() const
+{
+    return m_lockedQ->size();
+}
+
+const std::vector<size_t>& ReducedModel::dofIndices() const
+{
+    return *m_dofIndices;
+}
+
+const std::vector<size_t>& ReducedModel::markerIndices() const
+{
+    return *m_markerIndices;
+}
+
+const std::vector<size_t>& ReducedModel::contactIndices() const
+{
+    return *m_contactIndices;
+}
+
+#ifdef MODULE_MUSCLES
+const std::vector<size_t>& ReducedModel::muscleIndices() const
+{
+    return *m_muscleIndices;
+}
+#endif
+
+utils::Vector ReducedModel::reduce(
+    const utils::Vector& full) const
+{
+    utils::Error::check(static_cast<size_t>(full.size()) == m_lockedQ->size(),
+                        "Wrong size for the vector of the full model");
+    utils::Vector reduced(static_cast<unsigned int>(m_dofIndices->size()));
+    for (size_t i=0; i<m_dofIndices->size(); ++i) {
+        reduced[static_cast<unsigned int>(i)] = full[static_cast<unsigned int>((*m_dofIndices)[i])];
+    }
+    return reduced;
+}
+
+utils::Vector ReducedModel::expandQ(
+    const utils::Vector& reducedQ) const
+{
+    // The free DoF are null in m_lockedQ
+    utils::Vector full(expand(reducedQ));
+    for (size_t i=0; i<m_lockedQ->size(); ++i) {
+        full[static_cast<unsigned int>(i)] += (*m_lockedQ)[i];
+    }
+    return full;
+}
+
+utils::Vector ReducedModel::expand(
+    const utils::Vector& reduced) const
+{
+    utils::Error::check(static_cast<size_t>(reduced.size()) == m_dofIndices->size(),
+                        "Wrong size for the vector of the reduced model");
+    utils::Vector full(utils::Vector::Zero(static_cast<unsigned int>(m_lockedQ->size())));
+    for (size_t i=0; i<m_dofIndices->size(); ++i) {
+        full[static_cast<unsigned int>((*m_dofIndices)[i])] = reduced[static_cast<unsigned int>(i)];
+    }
+    return full;
+}
+#endif
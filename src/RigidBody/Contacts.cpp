@@ -2,6 +2,7 @@
 #include "RigidBody/Contacts.h"
 
 #include <rbdl/Kinematics.h>
+#include <rbdl/Dynamics.h>
 #include "BiorbdModel.h"
 #include "Utils/String.h"
 #include "Utils/Error.h"
@@ -23,12 +24,135 @@
 
 using namespace BIORBD_NAMESPACE;
 
+///
+/// \brief Memo of the factorization of the constrained system at the last state, so only the right-hand
+/// side changes with Tau
+///
+/// It is an exact reuse of the last factorization, not a warm start: any change of Q, QDot or of the
+/// external forces factorizes the system again
+///
+/// With H the mass matrix, C the nonlinear effects, G the constraints jacobian and gamma the
+/// constraints bias, QDDot0 = H^-1 (Tau - C), force = (G H^-1 G^T)^-1 (gamma - G QDDot0)
+/// and QDDot = QDDot0 + H^-1 G^T force
+///
+class rigidbody::Contacts::ConstraintsFactorization
+{
+public:
+    ConstraintsFactorization() :
+        m_isFactorized(false)
+    {
+    }
+
+    bool m_isFactorized; ///< If the factorization corresponds to m_Q, m_QDot and m_fExt
+#ifndef BIORBD_USE_CASADI_MATH
+    RigidBodyDynamics::Math::VectorNd m_Q; ///< The generalized coordinates of the factorization
+    RigidBodyDynamics::Math::VectorNd m_QDot; ///< The generalized velocities of the factorization
+    std::vector<RigidBodyDynamics::Math::SpatialVector> m_fExt; ///< The external forces of the factorization
+    Eigen::LLT<RigidBodyDynamics::Math::MatrixNd> m_HFactorization; ///< The factorized mass matrix
+    RigidBodyDynamics::Math::MatrixNd m_G; ///< The constraints jacobian
+    RigidBodyDynamics::Math::MatrixNd m_HinvGT; ///< H^-1 G^T
+    Eigen::LDLT<RigidBodyDynamics::Math::MatrixNd> m_schurFactorization; ///< The factorized G H^-1 G^T
+    RigidBodyDynamics::Math::VectorNd m_C; ///< The nonlinear effects
+    RigidBodyDynamics::Math::VectorNd m_gamma; ///< The constraints bias
+    RigidBodyDynamics::Math::VectorNd m_QDDot0; ///< Workspace of the unconstrained accelerations
+    RigidBodyDynamics::Math::VectorNd m_rhs; ///< Workspace of the right-hand side of the forces
+
+    ///
+    /// \brief Return if the factorization was computed at the same state
+    /// \param Q The generalized coordinates
+    /// \param QDot The generalized velocities
+    /// \param fExt The external forces
+    /// \param nbConstraints The current number of constraints
+    /// \return If the factorization can be reused
+    ///
+    bool isFactorizedAt(
+        const RigidBodyDynamics::Math::VectorNd& Q,
+        const RigidBodyDynamics::Math::VectorNd& QDot,
+        const std::vector<RigidBodyDynamics::Math::SpatialVector>& fExt,
+        size_t nbConstraints) const
+    {
+        return m_isFactorized
+               && static_cast<size_t>(m_G.rows()) == nbConstraints
+               && m_Q.size() == Q.size() && m_Q == Q
+               && m_QDot.size() == QDot.size() && m_QDot == QDot
+               && m_fExt == fExt;
+    }
+
+    ///
+    /// \brief Factorize the constrained system at a state
+    /// \param model The model
+    /// \param Q The generalized coordinates
+    /// \param QDot The generalized velocities
+    /// \param Tau The generalized torques
+    /// \param fExt The external forces
+    /// \param CS The constraint set, its system variables are computed at the state
+    /// \param updateKin If the kinematics of the model should be updated
+    ///
+    void factorize(
+        rigidbody::Joints& model,
+        const RigidBodyDynamics::Math::VectorNd& Q,
+        const RigidBodyDynamics::Math::VectorNd& QDot,
+        const RigidBodyDynamics::Math::VectorNd& Tau,
+        std::vector<RigidBodyDynamics::Math::SpatialVector>& fExt,
+        RigidBodyDynamics::ConstraintSet& CS,
+        bool updateKin)
+    {
+        RigidBodyDynamics::CalcConstrainedSystemVariables(model, Q, QDot, Tau, CS, updateKin, &fExt);
+        m_Q = Q;
+        m_QDot = QDot;
+        m_fExt = fExt;
+        m_C = CS.C;
+        m_G = CS.G;
+        m_gamma = CS.gamma;
+
+        m_HFactorization.compute(CS.H);
+        m_HinvGT = m_HFactorization.solve(m_G.transpose());
+        m_schurFactorization.compute(m_G * m_HinvGT);
+        m_isFactorized = true;
+    }
+
+    ///
+    /// \brief Solve the factorized system for a new Tau
+    /// \param Tau The generalized torques
+    /// \param QDDot The generalized accelerations to fill
+    /// \param force The forces of the constraints to fill
+    ///
+    void solve(
+        const RigidBodyDynamics::Math::VectorNd& Tau,
+        RigidBodyDynamics::Math::VectorNd& QDDot,
+        RigidBodyDynamics::Math::VectorNd& force)
+    {
+        m_QDDot0 = Tau - m_C;
+        m_HFactorization.solveInPlace(m_QDDot0);
+        m_rhs = m_gamma;
+        m_rhs.noalias() -= m_G * m_QDDot0;
+        force = m_schurFactorization.solve(m_rhs);
+        QDDot = m_QDDot0;
+        QDDot.noalias() += m_HinvGT * force;
+    }
+#endif
+};
+
+///
+/// \brief Outputs of RBDL when computing the forces of a loop constraint, kept so their memory is reused
+///
+class rigidbody::Contacts::LoopConstraintsWorkspace
+{
+public:
+    std::vector<unsigned int> m_bodyIds; ///< The body ids of the constraint
+    std::vector<RigidBodyDynamics::Math::SpatialTransform> m_bodyFrames; ///< The frames of the constraint
+    std::vector<RigidBodyDynamics::Math::SpatialVector> m_forces; ///< The forces of the constraint
+};
+
 rigidbody::Contacts::Contacts() :
     RigidBodyDynamics::ConstraintSet (),
     m_nbreConstraint(std::make_shared<size_t>(0)),
     m_isBinded(std::make_shared<bool>(false)),
     m_rigidContacts(std::make_shared<std::vector<rigidbody::NodeSegment>>()),
-    m_nbLoopConstraint(std::make_shared<size_t>(0))
+    m_nbLoopConstraint(std::make_shared<size_t>(0)),
+    m_loopConstraintsWorkspace(std::make_shared<LoopConstraintsWorkspace>()),
+    m_solver(std::make_shared<rigidbody::CONSTRAINTS_SOLVER>(rigidbody::CONSTRAINTS_SOLVER_DIRECT)),
+    m_factorization(std::make_shared<std::shared_ptr<ConstraintsFactorization>>())
 {
 
 }
@@ -48,6 +172,12 @@ void rigidbody::Contacts::DeepCopy(const rigidbody::Contacts
     *m_nbreConstraint = *other.m_nbreConstraint;
     *m_isBinded = *other.m_isBinded;
     *m_rigidContacts = *other.m_rigidContacts;
+    *m_solver = *other.m_solver;
+    if (*other.m_factorization) {
+        *m_factorization = std::make_shared<ConstraintsFactorization>();
+    } else {
+        *m_factorization = nullptr;
+    }
 }
 
 size_t rigidbody::Contacts::AddConstraint(
@@ -59,6 +189,7 @@ size_t rigidbody::Contacts::AddConstraint(
 )
 {
     ++*m_nbreConstraint;
+    resetFactorization();
 
     // Check world_normal points to what axis
     utils::String axis = "";
@@ -93,6 +224,7 @@ size_t rigidbody::Contacts::AddConstraint(
     const utils::String& parentName)
 {
     size_t ret(0);
+    resetFactorization();
     for (size_t i=0; i<axis.length(); ++i) {
         ++*m_nbreConstraint;
         if      (axis.tolower()[i] == 'x'){
@@ -135,6 +267,7 @@ size_t rigidbody::Contacts::AddLoopConstraint(
 {
     ++*m_nbreConstraint;
     ++*m_nbLoopConstraint;
+    resetFactorization();
     return RigidBodyDynamics::ConstraintSet::AddLoopConstraint(
         static_cast<unsigned int>(body_id_predecessor), static_cast<unsigned int>(body_id_successor),
                RigidBodyDynamics::Math::SpatialTransform(X_predecessor.rot(),
@@ -160,43 +293,57 @@ std::vector< utils::SpatialVector > rigidbody::Contacts::calcLoopConstraintForce
     const rigidbody::GeneralizedTorque &Tau,
     rigidbody::ExternalForceSet &externalForces
 )
+{
+    rigidbody::GeneralizedAcceleration QDDot(dynamic_cast<rigidbody::Joints &>(*this));
+    utils::Vector constraintsForces;
+    std::vector< utils::SpatialVector > output;
+    calcConstrainedDynamics(Q, Qdot, Tau, externalForces, QDDot, constraintsForces, output);
+    return output;
+}
+
+void rigidbody::Contacts::calcConstrainedDynamics(
+    const rigidbody::GeneralizedCoordinates &Q,
+    const rigidbody::GeneralizedVelocity &Qdot,
+    const rigidbody::GeneralizedTorque &Tau,
+    rigidbody::ExternalForceSet &externalForces,
+    rigidbody::GeneralizedAcceleration& QDDot,
+    utils::Vector& constraintsForces,
+    std::vector< utils::SpatialVector >& loopConstraintForces
+)
 {
     // all in the world frame
     bool resolveAllInRootFrame = true;
 
-    // outputs
-    std::vector< unsigned int > constraintBodyIdsOutput;
-    std::vector< RigidBodyDynamics::Math::SpatialVector > updatedConstraintForcesOutput;
-    std::vector< RigidBodyDynamics::Math::SpatialTransform > updatedConstraintBodyFramesOutput;
-
     // retrieve the model and the contacts
-    rigidbody::Contacts CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
+    rigidbody::Contacts& CS = getConstraints();
     rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
-    model.ForwardDynamicsConstraintsDirect(Q, Qdot, Tau, CS, externalForces);
+    model.ForwardDynamicsConstraintsDirect(Q, Qdot, Tau, CS, externalForces, QDDot);
 
-    std::vector< utils::SpatialVector > output;
+    constraintsForces = CS.force;
+
+    // The kinematics is up to date from the forward dynamics, so it is not computed again
+    LoopConstraintsWorkspace& workspace(*m_loopConstraintsWorkspace);
+    loopConstraintForces.resize(*m_nbLoopConstraint);
     for (int i=0; i<static_cast<int>(*m_nbLoopConstraint); i++) {
-        constraintBodyIdsOutput.clear();
-        updatedConstraintBodyFramesOutput.clear();
-        updatedConstraintForcesOutput.clear();
+        workspace.m_bodyIds.clear();
+        workspace.m_bodyFrames.clear();
+        workspace.m_forces.clear();
 
         CS.calcForces(
                     i,
                     model,
                     Q,
                     Qdot,
-                    constraintBodyIdsOutput,
-                    updatedConstraintBodyFramesOutput,
-                    updatedConstraintForcesOutput,
+                    workspace.m_bodyIds,
+                    workspace.m_bodyFrames,
+                    workspace.m_forces,
                     resolveAllInRootFrame,
                     false
                     );
 
         // save all the forces in the global reference frame applied on the predecessor segment
-        output.push_back(updatedConstraintForcesOutput[0]);
+        loopConstraintForces[i] = utils::SpatialVector(workspace.m_forces[0]);
     }
-    return output;
-
 }
 
 
@@ -205,6 +352,94 @@ rigidbody::Contacts::~Contacts()
 
 }
 
+void rigidbody::Contacts::setConstraintsSolver(
+    rigidbody::CONSTRAINTS_SOLVER solver)
+{
+#ifdef BIORBD_USE_CASADI_MATH
+    utils::Error::check(solver == rigidbody::CONSTRAINTS_SOLVER_DIRECT,
+                        utils::String("Only the direct solver is available with CasADi, not the ")
+                        + rigidbody::CONSTRAINTS_SOLVER_toStr(solver) + " solver");
+#endif
+    *m_solver = solver;
+}
+
+rigidbody::CONSTRAINTS_SOLVER rigidbody::Contacts::constraintsSolver() const
+{
+    return *m_solver;
+}
+
+void rigidbody::Contacts::setFactorizationReuse(
+    bool reuse)
+{
+#ifdef BIORBD_USE_CASADI_MATH
+    utils::Error::check(!reuse, "The factorization cannot be reused with CasADi");
+#endif
+    if (reuse) {
+        if (!*m_factorization) {
+            *m_factorization = std::make_shared<ConstraintsFactorization>();
+        }
+    } else {
+        *m_factorization = nullptr;
+    }
+}
+
+bool rigidbody::Contacts::factorizationReuse() const
+{
+    return *m_factorization != nullptr;
+}
+
+void rigidbody::Contacts::resetFactorization()
+{
+    if (*m_factorization) {
+        (*m_factorization)->m_isFactorized = false;
+    }
+}
+
+void rigidbody::Contacts::solveForwardDynamics(
+    rigidbody::Joints& model,
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedTorque& Tau,
+    std::vector<RigidBodyDynamics::Math::SpatialVector>& fExt,
+    rigidbody::GeneralizedAcceleration& QDDot,
+    bool updateKin)
+{
+#ifndef BIORBD_USE_CASADI_MATH
+    // When the factorization is kept, it is built on a miss and the system is solved with it.
+    // A hit skips RBDL, so the kinematics are updated here as the solvers would have done it
+    ConstraintsFactorization* factorization(m_factorization->get());
+    if (factorization) {
+        if (!factorization->isFactorizedAt(Q, QDot, fExt, size())) {
+            factorization->factorize(model, Q, QDot, Tau, fExt, *this, updateKin);
+        } else if (updateKin) {
+            model.UpdateKinematicsCustom(&Q, &QDot, nullptr);
+        }
+        factorization->solve(Tau, QDDot, force);
+        return;
+    }
+#endif
+
+    switch (*m_solver) {
+    case rigidbody::CONSTRAINTS_SOLVER_DIRECT:
+        RigidBodyDynamics::ForwardDynamicsConstraintsDirect(
+            model, Q, QDot, Tau, *this, QDDot, updateKin, &fExt);
+        break;
+#ifndef BIORBD_USE_CASADI_MATH
+    case rigidbody::CONSTRAINTS_SOLVER_RANGE_SPACE_SPARSE:
+        RigidBodyDynamics::ForwardDynamicsConstraintsRangeSpaceSparse(
+            model, Q, QDot, Tau, *this, QDDot, updateKin, &fExt);
+        break;
+    case rigidbody::CONSTRAINTS_SOLVER_NULL_SPACE:
+        RigidBodyDynamics::ForwardDynamicsConstraintsNullSpace(
+            model, Q, QDot, Tau, *this, QDDot, updateKin, &fExt);
+        break;
+#endif
+    default:
+        utils::Error::raise(utils::String("The ") + rigidbody::CONSTRAINTS_SOLVER_toStr(*m_solver)
+                            + " solver is not available");
+    }
+}
+
 rigidbody::Contacts &rigidbody::Contacts::getConstraints()
 {
     if (!*m_isBinded) {
@@ -12,6 +12,7 @@
 #include "RigidBody/SoftContactNode.h"
 
 #include "Utils/Error.h"
+#include "Utils/Profiler.h"
 #include "Utils/SpatialVector.h"
 #include "Utils/String.h"
 #include "Utils/Vector3d.h"
@@ -142,6 +143,7 @@ std::vector<utils::SpatialVector> rigidbody::ExternalForceSet::computeSpatialVec
     bool updateKin    
 ) 
 {
+    BIORBD_PROFILE_ZONE("ExternalForceSet::computeSpatialVectors");
 #ifdef BIORBD_USE_CASADI_MATH
     updateKin = true;
 #endif
@@ -292,9 +294,10 @@ void rigidbody::ExternalForceSet::combineSoftContactForces(
     // Do not waste time computing forces on empty vector
     if (m_model.nbSoftContacts() == 0) return;
     
+    const std::vector<size_t>& segmentIdx(m_model.softContactsSegmentIdx());
     for (size_t j = 0; j < m_model.nbSoftContacts(); j++) {
         rigidbody::SoftContactNode& contact(m_model.softContact(j));
-        const rigidbody::Segment& segment(m_model.segment(contact.parent()));
+        const rigidbody::Segment& segment(m_model.segment(segmentIdx[j]));
         size_t dofIndex = segment.getLastDofIndexInGeneralizedCoordinates(m_model) + 1;
 
         // Add the force to the force vector (do not subtract 1 because 0 is the base)
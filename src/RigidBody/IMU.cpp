@@ -2,6 +2,7 @@
 #include "RigidBody/IMU.h"
 
 #include "Utils/String.h"
+#include "Utils/MemoryFootprint.h"
 
 using namespace BIORBD_NAMESPACE;
 
@@ -74,3 +75,11 @@ bool rigidbody::IMU::isTechnical() const
 {
     return *m_technical;
 }
+
+void rigidbody::IMU::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    utils::Node::memoryFootprint(footprint);
+    footprint.add(m_technical);
+    footprint.add(m_anatomical);
+}
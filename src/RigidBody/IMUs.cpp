@@ -14,7 +14,8 @@
 using namespace BIORBD_NAMESPACE;
 
 rigidbody::IMUs::IMUs() :
-    m_IMUs(std::make_shared<std::vector<rigidbody::IMU>>())
+    m_IMUs(std::make_shared<std::vector<rigidbody::IMU>>()),
+    m_IMUsSegmentIdx(std::make_shared<std::vector<size_t>>())
 {
     //ctor
 }
@@ -22,6 +23,7 @@ rigidbody::IMUs::IMUs() :
 rigidbody::IMUs::IMUs(const rigidbody::IMUs &other)
 {
     m_IMUs = other.m_IMUs;
+    m_IMUsSegmentIdx = other.m_IMUsSegmentIdx;
 }
 
 rigidbody::IMUs::~IMUs()
@@ -42,6 +44,7 @@ void rigidbody::IMUs::DeepCopy(const rigidbody::IMUs &other)
     for (size_t i=0; i<other.m_IMUs->size(); ++i) {
         (*m_IMUs)[i] = (*other.m_IMUs)[i].DeepCopy();
     }
+    m_IMUsSegmentIdx->clear();
 }
 
 void rigidbody::IMUs::addIMU(
@@ -119,11 +122,43 @@ rigidbody::IMU rigidbody::IMUs::IMU(
         model.UpdateKinematicsCustom (&Q);
     }
 
-    rigidbody::IMU node = IMU(idx);
-    size_t id = static_cast<size_t>(model.getBodyBiorbdId(
-                          node.parent()));
+    return model.globalJCS(IMUsSegmentIdx()[idx]) * IMU(idx);
+}
+
+const std::vector<size_t>& rigidbody::IMUs::IMUsSegmentIdx()
+{
+    if (m_IMUsSegmentIdx->size() != nbIMUs()) {
+        rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+        m_IMUsSegmentIdx->clear();
+        for (size_t i=0; i<nbIMUs(); ++i) {
+            m_IMUsSegmentIdx->push_back(static_cast<size_t>(model.getBodyBiorbdId(IMU(i).parent())));
+        }
+    }
+    return *m_IMUsSegmentIdx;
+}
+
+void rigidbody::IMUs::IMUInMatrix(
+    const rigidbody::GeneralizedCoordinates &Q,
+    utils::Matrix& rotoTrans,
+    bool updateKin)
+{
+    rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+#ifdef BIORBD_USE_CASADI_MATH
+    updateKin = true;
+#endif
+    if (updateKin) {
+        model.UpdateKinematicsCustom (&Q);
+    }
 
-    return model.globalJCS(id) * node;
+    const std::vector<size_t>& segmentIdx(IMUsSegmentIdx());
+    if (static_cast<size_t>(rotoTrans.rows()) != 4
+            || static_cast<size_t>(rotoTrans.cols()) != 4 * nbIMUs()) {
+        rotoTrans = utils::Matrix(4, 4 * nbIMUs());
+    }
+    for (size_t i=0; i<nbIMUs(); ++i) {
+        rotoTrans.block(0, static_cast<unsigned int>(4 * i), 4, 4) =
+            model.globalJCS(segmentIdx[i]) * (*m_IMUs)[i];
+    }
 }
 
 // Get the technical IMUs
@@ -234,7 +269,7 @@ std::vector<utils::Matrix> rigidbody::IMUs::IMUJacobian(
             continue;
         }
 
-        size_t id = static_cast<size_t>(model.GetBodyId(node.parent().c_str()));
+        size_t id(model.segment(IMUsSegmentIdx()[idx]).id());
         utils::Matrix G_tp(utils::Matrix::Zero(9,model.dof_count));
 
         // Calculate the Jacobian of this Tag
@@ -8,6 +8,7 @@
 #include "Utils/Error.h"
 #include "Utils/Matrix.h"
 #include "Utils/Matrix3d.h"
+#include "Utils/Profiler.h"
 #include "Utils/Quaternion.h"
 #include "Utils/RotoTrans.h"
 #include "Utils/Rotation.h"
@@ -20,6 +21,7 @@
 #include "RigidBody/GeneralizedVelocity.h"
 #include "RigidBody/GeneralizedAcceleration.h"
 #include "RigidBody/GeneralizedTorque.h"
+#include "RigidBody/KinematicsResults.h"
 #include "RigidBody/Segment.h"
 #include "RigidBody/Markers.h"
 #include "RigidBody/NodeSegment.h"
@@ -35,6 +37,7 @@ using namespace BIORBD_NAMESPACE;
 rigidbody::Joints::Joints() :
     RigidBodyDynamics::Model(),
     m_segments(std::make_shared<std::vector<rigidbody::Segment>>()),
+    m_segmentsIndex(std::make_shared<std::unordered_map<std::string, size_t>>()),
     m_nbRoot(std::make_shared<size_t>(0)),
     m_nbDof(std::make_shared<size_t>(0)),
     m_nbQ(std::make_shared<size_t>(0)),
@@ -51,6 +54,7 @@ rigidbody::Joints::Joints() :
 rigidbody::Joints::Joints(const rigidbody::Joints &other) :
     RigidBodyDynamics::Model(other),
     m_segments(other.m_segments),
+    m_segmentsIndex(other.m_segmentsIndex),
     m_nbRoot(other.m_nbRoot),
     m_nbDof(other.m_nbDof),
     m_nbQ(other.m_nbQ),
@@ -82,6 +86,7 @@ void rigidbody::Joints::DeepCopy(const rigidbody::Joints &other)
     for (size_t i=0; i<other.m_segments->size(); ++i) {
         (*m_segments)[i] = (*other.m_segments)[i].DeepCopy();
     }
+    *m_segmentsIndex = *other.m_segmentsIndex;
     *m_nbRoot = *other.m_nbRoot;
     *m_nbDof = *other.m_nbDof;
     *m_nbQ = *other.m_nbQ;
@@ -172,6 +177,7 @@ size_t rigidbody::Joints::AddSegment(
 
     *m_totalMass +=
         characteristics.mMass; // Add the segment mass to the total body mass
+    (*m_segmentsIndex)[segmentName] = m_segments->size();
     m_segments->push_back(tp);
     return 0;
 }
@@ -198,6 +204,7 @@ size_t rigidbody::Joints::AddSegment(
 
     *m_totalMass +=
         characteristics.mMass; // Add the segment mass to the total body mass
+    (*m_segmentsIndex)[segmentName] = m_segments->size();
     m_segments->push_back(tp);
     return 0;
 }
@@ -219,9 +226,22 @@ void rigidbody::Joints::updateSegmentCharacteristics(
 {
     utils::Error::check(idx < m_segments->size(),
                                 "Asked for a wrong segment (out of range)");
+    *m_totalMass += characteristics.mMass - (*m_segments)[idx].characteristics().mMass;
     (*m_segments)[idx].updateCharacteristics(*this, characteristics);
 }
 
+void rigidbody::Joints::updateSegmentInertia(
+    size_t idx,
+    const utils::Scalar& mass,
+    const utils::Vector3d& com,
+    const utils::Matrix3d& inertia)
+{
+    utils::Error::check(idx < m_segments->size(),
+                                "Asked for a wrong segment (out of range)");
+    *m_totalMass += mass - (*m_segments)[idx].characteristics().mMass;
+    (*m_segments)[idx].updateInertia(*this, mass, com, inertia);
+}
+
 const rigidbody::Segment& rigidbody::Joints::segment(
     size_t idx) const
 {
@@ -249,27 +269,37 @@ size_t rigidbody::Joints::nbSegment() const
 int rigidbody::Joints::getBodyBiorbdId(
         const utils::String &segmentName) const
 {
-    for (size_t i=0; i<m_segments->size(); ++i)
-        if (!(*m_segments)[i].name().compare(segmentName)) {
-            return static_cast<int>(i);
-        }
-    return -1;
+    std::unordered_map<std::string, size_t>::const_iterator it(
+        m_segmentsIndex->find(segmentName));
+    if (it == m_segmentsIndex->end()) {
+        return -1;
+    }
+    return static_cast<int>(it->second);
 }
 
 
 int rigidbody::Joints::getBodyRbdlId(
         const utils::String &segmentName) const
 {
-    return GetBodyId(segmentName.c_str());
+    std::unordered_map<std::string, size_t>::const_iterator it(
+        m_segmentsIndex->find(segmentName));
+    if (it == m_segmentsIndex->end()) {
+        // Not a segment, it can still be a body of rbdl (e.g. ROOT)
+        return static_cast<int>(GetBodyId(segmentName.c_str()));
+    }
+    return static_cast<int>((*m_segments)[it->second].id());
 }
 
 int rigidbody::Joints::getBodyRbdlIdToBiorbdId(
         const int idx) const
 {
-    // Assuming that this is also a joint type (via BiorbdModel)
-    const rigidbody::Joints &model = dynamic_cast<const rigidbody::Joints &>(*this);
-    std::string bodyName = model.GetBodyName(idx);
-    return model.getBodyBiorbdId(bodyName);
+    // Only the last body of a segment carries its name
+    for (size_t i=0; i<m_segments->size(); ++i) {
+        if (static_cast<int>((*m_segments)[i].id()) == idx) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
 }
 
 size_t rigidbody::Joints::getBodyBiorbdIdToRbdlId(
@@ -488,7 +518,7 @@ rigidbody::NodeSegment rigidbody::Joints::projectPoint(
         true, 
         true, 
         axesToRemove, 
-        static_cast<int>(GetBodyId(segmentName.c_str()))
+        static_cast<int>(segment(static_cast<size_t>(segmentIdx)).id())
     );
 
     // Project and then reset in global
@@ -529,7 +559,7 @@ utils::Matrix rigidbody::Joints::projectPointJacobian(
         utils::Matrix G_tp(marks.markersJacobian(Q, node.parent(),
                                    utils::Vector3d(0,0,0), updateKin));
         utils::Matrix JCor(utils::Matrix::Zero(9, static_cast<unsigned int>(nbQ())));
-        CalcMatRotJacobian(Q, GetBodyId(node.parent().c_str()),
+        CalcMatRotJacobian(Q, static_cast<unsigned int>(getBodyRbdlId(node.parent())),
                            utils::Matrix3d::Identity(), JCor, updateKin);
         for (size_t n=0; n<3; ++n)
             if (node.isAxisKept(n)) {
@@ -631,8 +661,7 @@ utils::Vector3d rigidbody::Joints::segmentAngularVelocity(
     updateKin = true;
 #endif
 
-    const utils::String& segmentName(segment(idx).name());
-    size_t id(static_cast<size_t>(this->GetBodyId(segmentName.c_str())));
+    size_t id(segment(idx).id());
 
     // Calculate the velocity of the point
     return RigidBodyDynamics::CalcPointVelocity6D(
@@ -819,7 +848,7 @@ utils::Vector3d rigidbody::Joints::CoMdot(
     for (const auto& segment : *m_segments) {
         Jac.setZero();
         RigidBodyDynamics::CalcPointJacobian(
-            *this, Q, GetBodyId(segment.name().c_str()),
+            *this, Q, static_cast<unsigned int>(segment.id()),
             segment.characteristics().mCenterOfMass, Jac, updateKin);
         com_dot += ((Jac*Qdot) * segment.characteristics().mMass);
         updateKin = false;
@@ -863,10 +892,10 @@ utils::Matrix rigidbody::Joints::CoMJacobian(
 
     // CoMdot = sum(mass_seg * Jacobian * qdot)/mass total
     utils::Matrix Jac(utils::Matrix::Zero(3,this->dof_count));
-    for (auto segment : *m_segments) {
+    for (const auto& segment : *m_segments) {
         Jac.setZero();
         RigidBodyDynamics::CalcPointJacobian(
-            *this, Q, GetBodyId(segment.name().c_str()),
+            *this, Q, static_cast<unsigned int>(segment.id()),
             segment.characteristics().mCenterOfMass, Jac, updateKin);
         JacTotal += segment.characteristics().mMass*Jac;
         updateKin = false;
@@ -1293,7 +1322,9 @@ utils::Scalar rigidbody::Joints::Lagrangian(
         const rigidbody::GeneralizedVelocity &QDot,
         bool updateKin)
 {
-    return RigidBodyDynamics::Utils::CalcKineticEnergy(*this, Q, QDot, updateKin) - RigidBodyDynamics::Utils::CalcPotentialEnergy(*this, Q, updateKin);
+    // The kinematics updated by the kinetic energy is reused by the potential energy
+    utils::Scalar kinetic(RigidBodyDynamics::Utils::CalcKineticEnergy(*this, Q, QDot, updateKin));
+    return kinetic - RigidBodyDynamics::Utils::CalcPotentialEnergy(*this, Q, false);
 }
 
 
@@ -1302,7 +1333,129 @@ utils::Scalar rigidbody::Joints::TotalEnergy(
         const rigidbody::GeneralizedVelocity &QDot,
         bool updateKin)
 {
-    return RigidBodyDynamics::Utils::CalcKineticEnergy(*this, Q, QDot, updateKin) + RigidBodyDynamics::Utils::CalcPotentialEnergy(*this, Q, updateKin);;
+    // The kinematics updated by the kinetic energy is reused by the potential energy
+    utils::Scalar kinetic(RigidBodyDynamics::Utils::CalcKineticEnergy(*this, Q, QDot, updateKin));
+    return kinetic + RigidBodyDynamics::Utils::CalcPotentialEnergy(*this, Q, false);
+}
+
+void rigidbody::Joints::evaluate(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity* QDot,
+    const rigidbody::GeneralizedAcceleration* QDDot,
+    int quantities,
+    rigidbody::KinematicsResults& results,
+    bool updateKin)
+{
+    BIORBD_PROFILE_ZONE("Joints::evaluate");
+#ifdef BIORBD_USE_CASADI_MATH
+    updateKin = true;
+#endif
+    bool needCoMdot(quantities & KINEMATICS_COM_DOT);
+    bool needCoMddot(quantities & KINEMATICS_COM_DDOT);
+    bool needMomentum(quantities & (KINEMATICS_SEGMENTS_ANGULAR_MOMENTUM | KINEMATICS_ANGULAR_MOMENTUM));
+    bool needKinetic(quantities & KINEMATICS_KINETIC_ENERGY);
+    bool needCoM(needCoMdot || needCoMddot || needMomentum
+                 || (quantities & (KINEMATICS_COM | KINEMATICS_POTENTIAL_ENERGY)));
+    bool needVelocity(needCoMdot || needCoMddot || needMomentum || needKinetic);
+    utils::Error::check(!needVelocity || QDot,
+                        "The generalized velocities are required for the requested quantities");
+    utils::Error::check(!needCoMddot || QDDot,
+                        "The generalized accelerations are required for the requested quantities");
+
+    if (updateKin) {
+        UpdateKinematicsCustom(&Q, needVelocity ? QDot : nullptr, needCoMddot ? QDDot : nullptr);
+    }
+
+    // Gather everything from the bodies in one loop
+    utils::Scalar mass(0);
+    utils::Scalar kinetic(0);
+    RigidBodyDynamics::Math::Vector3d com(0, 0, 0);
+    RigidBodyDynamics::Math::Vector3d comDot(0, 0, 0);
+    RigidBodyDynamics::Math::Vector3d comDdot(0, 0, 0);
+    RigidBodyDynamics::Math::SpatialVector momentum(RigidBodyDynamics::Math::SpatialVector::Zero());
+    unsigned int nbBodies(static_cast<unsigned int>(mBodies.size() - 1));
+    if ((quantities & KINEMATICS_SEGMENTS_ANGULAR_MOMENTUM)
+            && (static_cast<unsigned int>(results.m_segmentsAngularMomentum.rows()) != 3
+                || static_cast<unsigned int>(results.m_segmentsAngularMomentum.cols()) != nbBodies)) {
+        results.m_segmentsAngularMomentum = utils::Matrix(3, nbBodies);
+    }
+    if (needCoM || needKinetic) {
+        for (size_t i = 1; i < mBodies.size(); ++i) {
+            const RigidBodyDynamics::Math::Vector3d& localCoM(mBodies[i].mCenterOfMass);
+            RigidBodyDynamics::Math::Matrix3d toGlobal(X_base[i].E.transpose());
+            const utils::Scalar& bodyMass(mBodies[i].mMass);
+            mass += bodyMass;
+            com += bodyMass * (X_base[i].r + toGlobal * localCoM);
+            if (!needVelocity) {
+                continue;
+            }
+
+            // Velocity and acceleration of the center of mass of the body, in the body frame
+            RigidBodyDynamics::Math::Vector3d omega(v[i][0], v[i][1], v[i][2]);
+            RigidBodyDynamics::Math::Vector3d pointVelocity(
+                RigidBodyDynamics::Math::Vector3d(v[i][3], v[i][4], v[i][5]) + omega.cross(localCoM));
+            if (needCoMdot) {
+                comDot += bodyMass * (toGlobal * pointVelocity);
+            }
+            if (needCoMddot) {
+                RigidBodyDynamics::Math::Vector3d alpha(a[i][0], a[i][1], a[i][2]);
+                comDdot += bodyMass * (toGlobal * (
+                                           RigidBodyDynamics::Math::Vector3d(a[i][3], a[i][4], a[i][5])
+                                           + alpha.cross(localCoM) + omega.cross(pointVelocity)));
+            }
+            if (needMomentum || needKinetic) {
+                RigidBodyDynamics::Math::SpatialVector h(I[i].toMatrix() * v[i]);
+                if (needKinetic) {
+                    kinetic += 0.5 * v[i].dot(h);
+                }
+                if (needMomentum) {
+                    // The momentum of the body about the origin, in the global reference frame
+                    h = X_base[i].applyTranspose(h);
+                    hc[i] = h;
+                    momentum += h;
+                }
+            }
+        }
+        com = com / mass;
+    }
+
+    if (quantities & KINEMATICS_COM) {
+        results.m_CoM = com;
+    }
+    if (needCoMdot) {
+        results.m_CoMdot = comDot / mass;
+    }
+    if (needCoMddot) {
+        results.m_CoMddot = comDdot / mass;
+    }
+    if (needKinetic) {
+        results.m_kineticEnergy = kinetic;
+    }
+    if (quantities & KINEMATICS_POTENTIAL_ENERGY) {
+        results.m_potentialEnergy = -mass * com.dot(gravity);
+    }
+    if (needMomentum) {
+        // Move the momenta from the origin to the center of mass
+        RigidBodyDynamics::Math::SpatialTransform toCoM(RigidBodyDynamics::Math::Xtrans(com));
+        if (quantities & KINEMATICS_SEGMENTS_ANGULAR_MOMENTUM) {
+            for (unsigned int i = 0; i < nbBodies; ++i) {
+                RigidBodyDynamics::Math::SpatialVector h(toCoM.applyAdjoint(hc[i + 1]));
+                results.m_segmentsAngularMomentum.block(0, i, 3, 1) =
+                    RigidBodyDynamics::Math::Vector3d(h[0], h[1], h[2]);
+            }
+        }
+        if (quantities & KINEMATICS_ANGULAR_MOMENTUM) {
+            momentum = toCoM.applyAdjoint(momentum);
+            results.m_angularMomentum = utils::Vector3d(momentum[0], momentum[1], momentum[2]);
+        }
+    }
+
+    if (quantities & KINEMATICS_GLOBAL_JCS) {
+        results.m_globalJCS.resize(m_segments->size());
+        for (size_t i = 0; i < m_segments->size(); ++i) {
+            results.m_globalJCS[i] = globalJCS(i);
+        }
+    }
 }
 
 rigidbody::GeneralizedTorque rigidbody::Joints::InverseDynamics(
@@ -1379,23 +1532,84 @@ rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsFreeFloatin
                         "Size of QDDotJ must be equal to number of QDDot - number of root coordinates.");
     
     utils::Error::check(this->nbRoot() > 0, "Must have a least one degree of freedom on root.");
+    checkGeneralizedDimensions(&Q, &QDot);
+
+    // Only the root block of the mass matrix and the root nonlinear effects (for a zero root
+    // acceleration) are needed. They are gathered from one recursive Newton-Euler pass where the
+    // composite inertias are accumulated along with the forces, instead of a full CRBA and RNEA.
+    const unsigned int nbRoot(static_cast<unsigned int>(this->nbRoot()));
+    auto axis = [this](unsigned int body, unsigned int dof) -> RigidBodyDynamics::Math::SpatialVector {
+        if (mJoints[body].mDoFCount == 1) {
+            return S[body];
+        }
+        return multdof3_S[body].block(0, dof, 6, 1);
+    };
+
+    // Forward pass: kinematics and forces of the bodies with the root not accelerating
+    RigidBodyDynamics::Math::SpatialVector gravityAcceleration(
+        0, 0, 0, -gravity[0], -gravity[1], -gravity[2]);
+    for (unsigned int i = 1; i < static_cast<unsigned int>(mBodies.size()); ++i) {
+        const unsigned int parent(lambda[i]);
+        const unsigned int q_index(mJoints[i].q_index);
+        RigidBodyDynamics::jcalc(*this, i, Q, QDot);
+        X_lambda[i] = X_J[i] * X_T[i];
+        if (parent != 0) {
+            X_base[i] = X_lambda[i] * X_base[parent];
+            v[i] = X_lambda[i].apply(v[parent]) + v_J[i];
+        } else {
+            X_base[i] = X_lambda[i];
+            v[i] = v_J[i];
+        }
+        c[i] = c_J[i] + RigidBodyDynamics::Math::crossm(v[i], v_J[i]);
+        a[i] = X_lambda[i].apply(parent != 0 ? a[parent] : gravityAcceleration) + c[i];
+        if (q_index >= nbRoot) {
+            for (unsigned int k = 0; k < mJoints[i].mDoFCount; ++k) {
+                a[i] += axis(i, k) * QJointsDDot[q_index - nbRoot + k];
+            }
+        }
+        Ic[i] = I[i];
+        f[i] = I[i] * a[i] + RigidBodyDynamics::Math::crossf(v[i], I[i] * v[i]);
+    }
 
-    rigidbody::GeneralizedAcceleration QDDot(this->nbQddot());
-    rigidbody::GeneralizedAcceleration QRootDDot;
-    rigidbody::GeneralizedTorque MassMatrixNlEffects;
-
-    utils::Matrix massMatrixRoot = this->massMatrix(Q).block(0, 0, static_cast<unsigned int>(this->nbRoot()), static_cast<unsigned int>(this->nbRoot()));
-
-    QDDot.block(0, 0, static_cast<unsigned int>(this->nbRoot()), 1) = utils::Vector(this->nbRoot()).setZero();
-    QDDot.block(static_cast<unsigned int>(this->nbRoot()), 0, static_cast<unsigned int>(this->nbQddot()-this->nbRoot()), 1) = QJointsDDot;
-
-    MassMatrixNlEffects = InverseDynamics(Q, QDot, QDDot);
+    // Backward pass: accumulate the forces and the composite inertias, and project them on the
+    // root dofs once the subtree of a root body is complete
+    utils::Matrix massMatrixRoot(nbRoot, nbRoot);
+    utils::Vector nlEffectsRoot(nbRoot);
+    massMatrixRoot.setZero();
+    for (unsigned int i = static_cast<unsigned int>(mBodies.size()) - 1; i > 0; --i) {
+        const unsigned int parent(lambda[i]);
+        const unsigned int q_index(mJoints[i].q_index);
+        if (q_index < nbRoot) {
+            for (unsigned int k = 0; k < mJoints[i].mDoFCount; ++k) {
+                RigidBodyDynamics::Math::SpatialVector s(axis(i, k));
+                nlEffectsRoot[q_index + k] = s.dot(f[i]);
+                RigidBodyDynamics::Math::SpatialVector F(Ic[i] * s);
+                for (unsigned int l = 0; l < mJoints[i].mDoFCount; ++l) {
+                    massMatrixRoot(q_index + l, q_index + k) = axis(i, l).dot(F);
+                }
+                for (unsigned int j = i; lambda[j] != 0; ) {
+                    F = X_lambda[j].applyTranspose(F);
+                    j = lambda[j];
+                    const unsigned int q_index_j(mJoints[j].q_index);
+                    for (unsigned int l = 0; l < mJoints[j].mDoFCount; ++l) {
+                        massMatrixRoot(q_index_j + l, q_index + k) = axis(j, l).dot(F);
+                        massMatrixRoot(q_index + k, q_index_j + l) = massMatrixRoot(q_index_j + l, q_index + k);
+                    }
+                }
+            }
+        }
+        if (parent != 0) {
+            f[parent] += X_lambda[i].applyTranspose(f[i]);
+            Ic[parent] = Ic[parent] + X_lambda[i].applyTranspose(Ic[i]);
+        }
+    }
 
+    rigidbody::GeneralizedAcceleration QRootDDot;
 #ifdef BIORBD_USE_CASADI_MATH
     auto linsol = casadi::Linsol("linsol", "symbolicqr", massMatrixRoot.sparsity());
-    QRootDDot = linsol.solve(massMatrixRoot, -MassMatrixNlEffects.block(0, 0, static_cast<unsigned int>(this->nbRoot()), 1));
+    QRootDDot = linsol.solve(massMatrixRoot, -nlEffectsRoot);
 #else
-    QRootDDot = massMatrixRoot.llt().solve(-MassMatrixNlEffects.block(0, 0, static_cast<unsigned int>(this->nbRoot()), 1));
+    QRootDDot = massMatrixRoot.llt().solve(-nlEffectsRoot);
 #endif
 
     return QRootDDot;
@@ -1408,7 +1622,7 @@ rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraints
     const rigidbody::GeneralizedTorque& Tau
 )
 {
-    rigidbody::Contacts CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
+    rigidbody::Contacts& CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
     return ForwardDynamicsConstraintsDirect(Q, QDot, Tau, CS);
 }
 rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraintsDirect(
@@ -1418,7 +1632,7 @@ rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraints
     rigidbody::ExternalForceSet& externalForces
 )
 {
-    rigidbody::Contacts CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
+    rigidbody::Contacts& CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
     return this->ForwardDynamicsConstraintsDirect(Q, QDot, Tau, CS, externalForces);
 }
 rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraintsDirect(
@@ -1439,6 +1653,20 @@ rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraints
     rigidbody::ExternalForceSet& externalForces
 )
 {
+    rigidbody::GeneralizedAcceleration QDDot(*this);
+    ForwardDynamicsConstraintsDirect(Q, QDot, Tau, CS, externalForces, QDDot);
+    return QDDot;
+}
+void rigidbody::Joints::ForwardDynamicsConstraintsDirect(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedTorque& Tau,
+    rigidbody::Contacts& CS,
+    rigidbody::ExternalForceSet& externalForces,
+    rigidbody::GeneralizedAcceleration& QDDot
+)
+{
+    BIORBD_PROFILE_ZONE("Joints::ForwardDynamicsConstraintsDirect");
 #ifdef BIORBD_USE_CASADI_MATH
     bool updateKin = true;
 #else
@@ -1446,10 +1674,12 @@ rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraints
     bool updateKin = false;  // Put this in parameters??
 #endif
 
-    rigidbody::GeneralizedAcceleration QDDot(*this);
+    if (static_cast<size_t>(QDDot.size()) != nbQddot()) {
+        QDDot = rigidbody::GeneralizedAcceleration(*this);
+    }
     auto fExt = externalForces.computeRbdlSpatialVectors(Q, QDot, true);
-    RigidBodyDynamics::ForwardDynamicsConstraintsDirect(*this, Q, QDot, Tau, CS, QDDot, updateKin, &fExt);
-    return QDDot;
+    BIORBD_PROFILE_ZONE("Contacts::solveForwardDynamics");
+    CS.solveForwardDynamics(*this, Q, QDot, Tau, fExt, QDDot, updateKin);
 }
 
 utils::Vector rigidbody::Joints::ContactForcesFromForwardDynamicsConstraintsDirect(
@@ -1468,7 +1698,7 @@ utils::Vector rigidbody::Joints::ContactForcesFromForwardDynamicsConstraintsDire
     rigidbody::ExternalForceSet& externalForces
 )
 {
-    rigidbody::Contacts CS = dynamic_cast<rigidbody::Contacts*> (this)->getConstraints();
+    rigidbody::Contacts& CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
     this->ForwardDynamicsConstraintsDirect(Q, QDot, Tau, CS, externalForces);
     return CS.getForce();
 }
@@ -1478,18 +1708,325 @@ rigidbody::GeneralizedVelocity rigidbody::Joints::ComputeConstraintImpulsesDirec
     const rigidbody::GeneralizedVelocity& QDotPre
 )
 {
-    rigidbody::Contacts CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
+    rigidbody::Contacts& CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
     if (CS.nbContacts() == 0) {
         return QDotPre;
     } else {
-        CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
-
         rigidbody::GeneralizedVelocity QDotPost(*this);
         RigidBodyDynamics::ComputeConstraintImpulsesDirect(*this, Q, QDotPre, CS, QDotPost);
         return QDotPost;
     }
 }
 
+#ifndef BIORBD_USE_CASADI_MATH
+rigidbody::GeneralizedTorque rigidbody::Joints::InverseDynamicsDerivatives(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedAcceleration& QDDot,
+    utils::Matrix& dTau_dQ,
+    utils::Matrix& dTau_dQdot,
+    utils::Matrix& dTau_dQddot)
+{
+    rigidbody::ExternalForceSet forceSet(static_cast<BIORBD_NAMESPACE::Model&>(*this));
+    utils::Matrix dTau_dFext;
+    return InverseDynamicsDerivatives(Q, QDot, QDDot, forceSet, dTau_dQ, dTau_dQdot, dTau_dQddot, dTau_dFext);
+}
+
+rigidbody::GeneralizedTorque rigidbody::Joints::InverseDynamicsDerivatives(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedAcceleration& QDDot,
+    rigidbody::ExternalForceSet& externalForces,
+    utils::Matrix& dTau_dQ,
+    utils::Matrix& dTau_dQdot,
+    utils::Matrix& dTau_dQddot,
+    utils::Matrix& dTau_dFext)
+{
+    // The external forces update the kinematics, which the derivatives then reuse
+    DynamicsDerivativesInternal derivatives;
+    computeInverseDynamicsDerivatives(
+                Q, QDot, QDDot, externalForces.computeRbdlSpatialVectors(Q, QDot), derivatives, false);
+
+    dTau_dQ = derivatives.dTau_dQ;
+    dTau_dQdot = derivatives.dTau_dQdot;
+    dTau_dQddot = derivatives.massMatrix;
+    dTau_dFext = derivatives.dTau_dFext;
+    return derivatives.tau;
+}
+
+rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsDerivatives(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedTorque& Tau,
+    utils::Matrix& dQddot_dQ,
+    utils::Matrix& dQddot_dQdot,
+    utils::Matrix& dQddot_dTau)
+{
+    rigidbody::ExternalForceSet forceSet(static_cast<BIORBD_NAMESPACE::Model&>(*this));
+    utils::Matrix dQddot_dFext;
+    return ForwardDynamicsDerivatives(Q, QDot, Tau, forceSet, dQddot_dQ, dQddot_dQdot, dQddot_dTau, dQddot_dFext);
+}
+
+rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsDerivatives(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedTorque& Tau,
+    rigidbody::ExternalForceSet& externalForces,
+    utils::Matrix& dQddot_dQ,
+    utils::Matrix& dQddot_dQdot,
+    utils::Matrix& dQddot_dTau,
+    utils::Matrix& dQddot_dFext)
+{
+    auto fExt = externalForces.computeRbdlSpatialVectors(Q, QDot, true);
+
+    // The inverse dynamics at zero acceleration give the mass matrix and the nonlinear effects, so
+    // QDDot = M^-1 (Tau - C) is solved without updating the kinematics again
+    rigidbody::GeneralizedAcceleration QDDot(*this);
+    QDDot.setZero();
+    DynamicsDerivativesInternal derivatives;
+    computeInverseDynamicsDerivatives(Q, QDot, QDDot, fExt, derivatives, false);
+    auto llt = derivatives.massMatrix.llt();
+    QDDot = llt.solve(Tau - derivatives.tau);
+
+    // The derivatives of QDDot are those of the inverse dynamics evaluated at QDDot, premultiplied by -M^-1
+    computeInverseDynamicsDerivatives(Q, QDot, QDDot, fExt, derivatives, false);
+
+    dQddot_dQ = -llt.solve(derivatives.dTau_dQ);
+    dQddot_dQdot = -llt.solve(derivatives.dTau_dQdot);
+    dQddot_dTau = llt.solve(RigidBodyDynamics::Math::MatrixNd::Identity(
+                                derivatives.massMatrix.rows(), derivatives.massMatrix.cols()));
+    dQddot_dFext = -llt.solve(derivatives.dTau_dFext);
+    return QDDot;
+}
+
+rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraintsDirectDerivatives(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedTorque& Tau,
+    utils::Matrix& dQddot_dQ,
+    utils::Matrix& dQddot_dQdot,
+    utils::Matrix& dQddot_dTau)
+{
+    rigidbody::ExternalForceSet forceSet(static_cast<BIORBD_NAMESPACE::Model&>(*this));
+    utils::Matrix dQddot_dFext;
+    return ForwardDynamicsConstraintsDirectDerivatives(
+                Q, QDot, Tau, forceSet, dQddot_dQ, dQddot_dQdot, dQddot_dTau, dQddot_dFext);
+}
+
+rigidbody::GeneralizedAcceleration rigidbody::Joints::ForwardDynamicsConstraintsDirectDerivatives(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedTorque& Tau,
+    rigidbody::ExternalForceSet& externalForces,
+    utils::Matrix& dQddot_dQ,
+    utils::Matrix& dQddot_dQdot,
+    utils::Matrix& dQddot_dTau,
+    utils::Matrix& dQddot_dFext)
+{
+    rigidbody::Contacts& CS = dynamic_cast<rigidbody::Contacts*>(this)->getConstraints();
+    utils::Error::check(CS.nbLoopConstraints() == 0,
+                        "Derivatives of the forward dynamics with loop constraints are not implemented yet");
+
+    // Solve the constrained dynamics to get the contact forces
+    rigidbody::GeneralizedAcceleration QDDot(*this);
+    auto fExt = externalForces.computeRbdlSpatialVectors(Q, QDot, true);
+    RigidBodyDynamics::ForwardDynamicsConstraintsDirect(*this, Q, QDot, Tau, CS, QDDot, false, &fExt);
+
+    // Express the contacts as external forces, applied at a point in the global reference frame
+    const unsigned int nbDof(static_cast<unsigned int>(nbGeneralizedTorque()));
+    const unsigned int nbConstraints(static_cast<unsigned int>(CS.force.size()));
+    std::vector<unsigned int> contactBodies(nbConstraints);
+    std::vector<RigidBodyDynamics::Math::Vector3d> contactPoints(nbConstraints);
+    std::vector<RigidBodyDynamics::Math::Vector3d> contactNormals(nbConstraints);
+    auto fExtWithContacts(fExt);
+    for (size_t i=0; i<CS.contactConstraints.size(); ++i) {
+        unsigned int bodyId(CS.contactConstraints[i]->getBodyIds()[0]);
+        RigidBodyDynamics::Math::Vector3d point(RigidBodyDynamics::CalcBodyToBaseCoordinates(
+                *this, Q, bodyId, CS.contactConstraints[i]->getBodyFrames()[0].r, false));
+        if (IsFixedBodyId(bodyId)) {
+            bodyId = mFixedBodies[bodyId - fixed_body_discriminator].mMovableParent;
+        }
+
+        for (unsigned int j=0; j<CS.contactConstraints[i]->getConstraintSize(); ++j) {
+            unsigned int row(CS.contactConstraints[i]->getConstraintIndex() + j);
+            contactBodies[row] = bodyId;
+            contactPoints[row] = point;
+            contactNormals[row] = CS.contactConstraints[i]->getConstraintNormalVectors()[j];
+
+            RigidBodyDynamics::Math::Vector3d force(contactNormals[row] * CS.force[row]);
+            fExtWithContacts[bodyId] += RigidBodyDynamics::Math::SpatialVector(
+                                            point.cross(force)[0], point.cross(force)[1], point.cross(force)[2],
+                                            force[0], force[1], force[2]);
+        }
+    }
+
+    DynamicsDerivativesInternal derivatives;
+    computeInverseDynamicsDerivatives(Q, QDot, QDDot, fExtWithContacts, derivatives, false);
+
+    // Derivatives of the KKT system [M -G^T; G 0] [QDDot; lambda] = [Tau - C; gamma]
+    RigidBodyDynamics::Math::MatrixNd kkt(
+                RigidBodyDynamics::Math::MatrixNd::Zero(nbDof + nbConstraints, nbDof + nbConstraints));
+    kkt.block(0, 0, nbDof, nbDof) = derivatives.massMatrix;
+    RigidBodyDynamics::Math::MatrixNd rhsQ(
+                RigidBodyDynamics::Math::MatrixNd::Zero(nbDof + nbConstraints, nbDof));
+    RigidBodyDynamics::Math::MatrixNd rhsQdot(
+                RigidBodyDynamics::Math::MatrixNd::Zero(nbDof + nbConstraints, nbDof));
+    RigidBodyDynamics::Math::MatrixNd rhsTau(
+                RigidBodyDynamics::Math::MatrixNd::Zero(nbDof + nbConstraints, nbDof));
+    RigidBodyDynamics::Math::MatrixNd rhsFext(
+                RigidBodyDynamics::Math::MatrixNd::Zero(nbDof + nbConstraints, derivatives.dTau_dFext.cols()));
+    rhsQ.block(0, 0, nbDof, nbDof) = derivatives.dTau_dQ;
+    rhsQdot.block(0, 0, nbDof, nbDof) = derivatives.dTau_dQdot;
+    rhsTau.block(0, 0, nbDof, nbDof).setIdentity();
+    rhsFext.block(0, 0, nbDof, derivatives.dTau_dFext.cols()) = derivatives.dTau_dFext;
+
+    for (unsigned int k=0; k<nbConstraints; ++k) {
+        const unsigned int body(contactBodies[k]);
+        const RigidBodyDynamics::Math::Vector3d& p(contactPoints[k]);
+        const RigidBodyDynamics::Math::Vector3d& n(contactNormals[k]);
+        const RigidBodyDynamics::Math::Vector3d force(n * CS.force[k]);
+        const RigidBodyDynamics::Math::SpatialVector& v(derivatives.v[body]);
+        const RigidBodyDynamics::Math::SpatialVector& a(derivatives.a[body]);
+        const RigidBodyDynamics::Math::Vector3d omega(v.head<3>());
+        const RigidBodyDynamics::Math::Vector3d alpha(a.head<3>());
+        const RigidBodyDynamics::Math::Vector3d pointVelocity(v.tail<3>() + omega.cross(p));
+
+        for (unsigned int j = body; j != 0; j = lambda[j]) {
+            const unsigned int qj(mJoints[j].q_index);
+            const RigidBodyDynamics::Math::SpatialVector& s(derivatives.s[j]);
+            const RigidBodyDynamics::Math::Vector3d dp(
+                        s.tail<3>() + RigidBodyDynamics::Math::Vector3d(s.head<3>()).cross(p));
+
+            // Constraint jacobian
+            kkt(nbDof + k, qj) = n.dot(dp);
+            kkt(qj, nbDof + k) = -n.dot(dp);
+
+            // The application point of the contact force moves with the body
+            const RigidBodyDynamics::Math::Vector3d dMoment(dp.cross(force));
+            for (unsigned int i = body; i != 0; i = lambda[i]) {
+                rhsQ(mJoints[i].q_index, qj) -= derivatives.s[i].head<3>().dot(dMoment);
+            }
+
+            // Derivatives of the contact point acceleration projected on the normal
+            const RigidBodyDynamics::Math::SpatialVector dV(
+                        RigidBodyDynamics::Math::crossm(s, v) + derivatives.dVdq[j]);
+            const RigidBodyDynamics::Math::SpatialVector dA(
+                        RigidBodyDynamics::Math::crossm(s, a) + derivatives.dAdq[j]
+                        + RigidBodyDynamics::Math::crossm(derivatives.dVdq[j], v));
+            const RigidBodyDynamics::Math::Vector3d dOmega(dV.head<3>());
+            const RigidBodyDynamics::Math::Vector3d dPointVelocity(
+                        dV.tail<3>() + dOmega.cross(p) + omega.cross(dp));
+            rhsQ(nbDof + k, qj) = n.dot(
+                        dA.tail<3>() + RigidBodyDynamics::Math::Vector3d(dA.head<3>()).cross(p)
+                        + alpha.cross(dp) + dOmega.cross(pointVelocity) + omega.cross(dPointVelocity));
+
+            const RigidBodyDynamics::Math::SpatialVector dAdv(
+                        RigidBodyDynamics::Math::crossm(s, v) + derivatives.dAdv[j]);
+            rhsQdot(nbDof + k, qj) = n.dot(
+                        dAdv.tail<3>() + RigidBodyDynamics::Math::Vector3d(dAdv.head<3>()).cross(p)
+                        + RigidBodyDynamics::Math::Vector3d(s.head<3>()).cross(pointVelocity) + omega.cross(dp));
+        }
+    }
+
+    auto kktSolver = kkt.colPivHouseholderQr();
+    dQddot_dQ = -kktSolver.solve(rhsQ).block(0, 0, nbDof, nbDof);
+    dQddot_dQdot = -kktSolver.solve(rhsQdot).block(0, 0, nbDof, nbDof);
+    dQddot_dTau = kktSolver.solve(rhsTau).block(0, 0, nbDof, nbDof);
+    dQddot_dFext = -kktSolver.solve(rhsFext).block(0, 0, nbDof, derivatives.dTau_dFext.cols());
+    return QDDot;
+}
+
+void rigidbody::Joints::computeInverseDynamicsDerivatives(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot,
+    const rigidbody::GeneralizedAcceleration& QDDot,
+    const std::vector<RigidBodyDynamics::Math::SpatialVector>& fExt,
+    DynamicsDerivativesInternal& d,
+    bool updateKin)
+{
+    utils::Error::check(*m_nRotAQuat == 0,
+                        "Derivatives of the dynamics are not implemented for models with quaternions");
+    utils::Error::check(fExt.size() == mBodies.size(),
+                        "The external forces must have one spatial vector per body");
+    checkGeneralizedDimensions(&Q, &QDot, &QDDot);
+    if (updateKin) {
+        UpdateKinematicsCustom(&Q, nullptr, nullptr);
+    }
+
+    const size_t nbBodies(mBodies.size());
+    d.resize(nbBodies, static_cast<unsigned int>(nbGeneralizedTorque()));
+
+    // Forward pass: velocities, accelerations and their derivatives with respect to the joint of each body
+    d.v[0].setZero();
+    d.a[0] = RigidBodyDynamics::Math::SpatialVector(0, 0, 0, -gravity[0], -gravity[1], -gravity[2]);
+    for (size_t i = 1; i < nbBodies; ++i) {
+        const unsigned int q_index(mJoints[i].q_index);
+        const unsigned int parent(lambda[i]);
+
+        d.s[i] = X_base[i].inverse().apply(S[i]);
+        d.v[i] = d.v[parent] + d.s[i] * QDot[q_index];
+        d.dVdq[i] = RigidBodyDynamics::Math::crossm(d.v[parent], d.s[i]);
+        RigidBodyDynamics::Math::SpatialVector sDot(RigidBodyDynamics::Math::crossm(d.v[i], d.s[i]));
+        d.a[i] = d.a[parent] + d.s[i] * QDDot[q_index] + sDot * QDot[q_index];
+        d.dAdq[i] = RigidBodyDynamics::Math::crossm(d.a[parent], d.s[i])
+                    + RigidBodyDynamics::Math::crossm(d.v[parent], d.dVdq[i]);
+        d.dAdv[i] = sDot + d.dVdq[i];
+
+        RigidBodyDynamics::Math::SpatialMatrix X(X_base[i].toMatrix());
+        d.Ic[i] = X.transpose() * I[i].toMatrix() * X;
+        RigidBodyDynamics::Math::SpatialVector h(d.Ic[i] * d.v[i]);
+        d.f[i] = d.Ic[i] * d.a[i] + RigidBodyDynamics::Math::crossf(d.v[i], h) - fExt[i];
+        d.fExt[i] = fExt[i];
+
+        // Derivative of the momentum rate with respect to the body velocity
+        RigidBodyDynamics::Math::SpatialMatrix H(RigidBodyDynamics::Math::SpatialMatrix::Zero());
+        H.block<3, 3>(0, 0) = -RigidBodyDynamics::Math::VectorCrossMatrix(h.head<3>());
+        H.block<3, 3>(0, 3) = -RigidBodyDynamics::Math::VectorCrossMatrix(h.tail<3>());
+        H.block<3, 3>(3, 0) = -RigidBodyDynamics::Math::VectorCrossMatrix(h.tail<3>());
+        d.Bc[i] = RigidBodyDynamics::Math::crossf(d.v[i]) * d.Ic[i]
+                  - d.Ic[i] * RigidBodyDynamics::Math::crossm(d.v[i]) + H;
+    }
+
+    // Backward pass: accumulate the composite quantities and fill the derivatives
+    for (size_t i = nbBodies - 1; i > 0; --i) {
+        const unsigned int qi(mJoints[i].q_index);
+        const RigidBodyDynamics::Math::SpatialVector& si(d.s[i]);
+        d.tau[qi] = si.dot(d.f[i]);
+
+        RigidBodyDynamics::Math::SpatialVector dFdq(
+                    d.Ic[i] * d.dAdq[i] + d.Bc[i] * d.dVdq[i]
+                    + RigidBodyDynamics::Math::crossf(si, d.f[i] + d.fExt[i]));
+        RigidBodyDynamics::Math::SpatialVector dFdv(d.Ic[i] * d.dAdv[i] + d.Bc[i] * si);
+        RigidBodyDynamics::Math::SpatialVector dFda(d.Ic[i] * si);
+
+        for (unsigned int j = static_cast<unsigned int>(i); j != 0; j = lambda[j]) {
+            const unsigned int qj(mJoints[j].q_index);
+            const RigidBodyDynamics::Math::SpatialVector& sj(d.s[j]);
+            d.dTau_dQ(qi, qj) = si.dot(d.Ic[i] * d.dAdq[j] + d.Bc[i] * d.dVdq[j]
+                                       + RigidBodyDynamics::Math::crossf(sj, d.fExt[i]));
+            d.dTau_dQdot(qi, qj) = si.dot(d.Ic[i] * d.dAdv[j] + d.Bc[i] * sj);
+            d.massMatrix(qi, qj) = si.dot(d.Ic[i] * sj);
+            if (j != i) {
+                d.dTau_dQ(qj, qi) = sj.dot(dFdq);
+                d.dTau_dQdot(qj, qi) = sj.dot(dFdv);
+                d.massMatrix(qj, qi) = sj.dot(dFda);
+            }
+
+            // An external force on body i acts on every joint between i and the root
+            d.dTau_dFext.block(qj, 6 * static_cast<unsigned int>(i), 1, 6) = -sj.transpose();
+        }
+
+        const unsigned int parent(lambda[i]);
+        if (parent != 0) {
+            d.Ic[parent] += d.Ic[i];
+            d.Bc[parent] += d.Bc[i];
+            d.f[parent] += d.f[i];
+            d.fExt[parent] += d.fExt[i];
+        }
+    }
+}
+#endif
+
 utils::Matrix3d rigidbody::Joints::bodyInertia (
         const rigidbody::GeneralizedCoordinates &q,
         bool updateKin)
@@ -1552,26 +2089,12 @@ size_t rigidbody::Joints::getDofIndex(
     const utils::String& segmentName,
     const utils::String& dofName)
 {
-    size_t idx = 0;
-
-    size_t iB = 0;
-    bool found = false;
-    while (1) {
-        utils::Error::check(iB!=m_segments->size(), "Segment not found");
-
-        if (segmentName.compare(  (*m_segments)[iB].name() )   ) {
-            idx +=  (*m_segments)[iB].nbDof();
-        } else {
-            idx += (*m_segments)[iB].getDofIdx(dofName);
-            found = true;
-            break;
-        }
-
-        ++iB;
-    }
+    int iB(getBodyBiorbdId(segmentName));
+    utils::Error::check(iB != -1, "Segment not found");
 
-    utils::Error::check(found, "Dof not found");
-    return idx;
+    const rigidbody::Segment& seg((*m_segments)[static_cast<size_t>(iB)]);
+    size_t idx(seg.getDofIdx(dofName));
+    return seg.getFirstDofIndexInGeneralizedCoordinates(*this) + idx;
 }
 
 void rigidbody::Joints::UpdateKinematicsCustom(
@@ -1579,6 +2102,7 @@ void rigidbody::Joints::UpdateKinematicsCustom(
     const rigidbody::GeneralizedVelocity *Qdot,
     const rigidbody::GeneralizedAcceleration *Qddot)
 {
+    BIORBD_PROFILE_ZONE("Joints::UpdateKinematicsCustom");
     checkGeneralizedDimensions(Q, Qdot, Qddot);
     RigidBodyDynamics::UpdateKinematicsCustom(*this, Q, Qdot, Qddot);
 }
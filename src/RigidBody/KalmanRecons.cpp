@@ -3,6 +3,7 @@
 
 #include "BiorbdModel.h"
 #include "Utils/Matrix.h"
+#include "Utils/Profiler.h"
 #include "Utils/Vector.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
@@ -66,6 +67,7 @@ void rigidbody::KalmanRecons::iteration(
     const utils::Matrix &Hessian,
     const std::vector<size_t> &occlusion)
 {
+    BIORBD_PROFILE_ZONE("KalmanRecons::iteration");
     // Prediction
     const utils::Vector& xkm(*m_A * *m_xp);
     const utils::Matrix& Pkm(*m_A * *m_Pp * m_A->transpose() + *m_Q);
@@ -6,6 +6,7 @@
 #include "BiorbdModel.h"
 #include "Utils/Error.h"
 #include "Utils/Matrix.h"
+#include "Utils/Profiler.h"
 #include "Utils/Rotation.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
@@ -90,6 +91,7 @@ void rigidbody::KalmanReconsIMU::reconstructFrame(
     rigidbody::GeneralizedVelocity *Qdot,
     rigidbody::GeneralizedAcceleration *Qddot)
 {
+    BIORBD_PROFILE_ZONE("KalmanReconsIMU::reconstructFrame");
     // An iteration of the Kalman filter
     if (*m_firstIteration) {
         *m_firstIteration = false;
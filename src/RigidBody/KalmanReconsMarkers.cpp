@@ -6,6 +6,7 @@
 #include "BiorbdModel.h"
 #include "Utils/Error.h"
 #include "Utils/Matrix.h"
+#include "Utils/Profiler.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
 #include "RigidBody/GeneralizedAcceleration.h"
@@ -123,6 +124,7 @@ void rigidbody::KalmanReconsMarkers::reconstructFrame(
     rigidbody::GeneralizedAcceleration *Qddot,
     bool removeAxes)
 {
+    BIORBD_PROFILE_ZONE("KalmanReconsMarkers::reconstructFrame");
     // An iteration of the Kalman filter
     if (*m_firstIteration) {
         *m_firstIteration = false;
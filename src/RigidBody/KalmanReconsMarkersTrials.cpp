@@ -0,0 +1,78 @@
+#define BIORBD_API_EXPORTS
+#include "RigidBody/KalmanReconsMarkersTrials.h"
+
+#include "BiorbdModel.h"
+#include "Utils/Path.h"
+#include "Utils/ThreadPool.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
+#include "RigidBody/KalmanReconsMarkers.h"
+
+using namespace BIORBD_NAMESPACE;
+
+rigidbody::KalmanReconsMarkersTrials::KalmanReconsMarkersTrials(
+    const utils::Path& path,
+    const rigidbody::KalmanParam& params,
+    size_t nbThreads) :
+    m_params(std::make_shared<rigidbody::KalmanParam>(params)),
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads))
+{
+    m_models = std::make_shared<utils::ThreadLocal<Model>>(*m_pool, [&path](size_t) {
+        return std::make_shared<Model>(path);
+    });
+}
+
+rigidbody::KalmanReconsMarkersTrials::~KalmanReconsMarkersTrials()
+{
+
+}
+
+size_t rigidbody::KalmanReconsMarkersTrials::nbThreads() const
+{
+    return m_pool->nbThreads();
+}
+
+void rigidbody::KalmanReconsMarkersTrials::reconstructTrials(
+    const std::vector<std::vector<utils::Vector>>& markers,
+    std::vector<std::vector<rigidbody::GeneralizedCoordinates>>& Q,
+    std::vector<std::vector<rigidbody::GeneralizedVelocity>>* Qdot,
+    std::vector<std::vector<rigidbody::GeneralizedAcceleration>>* Qddot,
+    bool removeAxes)
+{
+    Model& model((*m_models)[0]);
+    Q.assign(markers.size(), std::vector<rigidbody::GeneralizedCoordinates>());
+    if (Qdot) {
+        Qdot->assign(markers.size(), std::vector<rigidbody::GeneralizedVelocity>());
+    }
+    if (Qddot) {
+        Qddot->assign(markers.size(), std::vector<rigidbody::GeneralizedAcceleration>());
+    }
+    for (size_t i=0; i<markers.size(); ++i) {
+        Q[i].assign(markers[i].size(), rigidbody::GeneralizedCoordinates(model));
+        if (Qdot) {
+            (*Qdot)[i].assign(markers[i].size(), rigidbody::GeneralizedVelocity(model));
+        }
+        if (Qddot) {
+            (*Qddot)[i].assign(markers[i].size(), rigidbody::GeneralizedAcceleration(model));
+        }
+    }
+
+    // The trials are independent, a thread runs the frames of a trial one after the other
+    m_pool->parallelFor(markers.size(), [&](size_t trial, size_t thread) {
+        Model& threadModel((*m_models)[thread]);
+        rigidbody::KalmanReconsMarkers kalman(threadModel, *m_params);
+        rigidbody::GeneralizedVelocity QdotFrame(threadModel);
+        rigidbody::GeneralizedAcceleration QddotFrame(threadModel);
+        for (size_t frame=0; frame<markers[trial].size(); ++frame) {
+            kalman.reconstructFrame(threadModel, markers[trial][frame], &Q[trial][frame],
+                                    &QdotFrame, &QddotFrame, removeAxes);
+            if (Qdot) {
+                (*Qdot)[trial][frame] = QdotFrame;
+            }
+            if (Qddot) {
+                (*Qddot)[trial][frame] = QddotFrame;
+            }
+        }
+    });
+}
@@ -5,6 +5,7 @@
 #include <rbdl/Kinematics.h>
 #include "Utils/String.h"
 #include "Utils/Matrix.h"
+#include "Utils/Vector3d.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
 #include "RigidBody/GeneralizedAcceleration.h"
@@ -14,14 +15,33 @@
 
 using namespace BIORBD_NAMESPACE;
 
+class rigidbody::Markers::MarkersIndex
+{
+public:
+    MarkersIndex() :
+        m_isResolved(false)
+    {
+    }
+
+    bool m_isResolved; ///< If the metadata corresponds to the current markers
+    std::vector<size_t> m_all; ///< Indices of all the markers
+    std::vector<size_t> m_technical; ///< Indices of the technical markers
+    std::vector<size_t> m_anatomical; ///< Indices of the anatomical markers
+    std::vector<unsigned int> m_bodyId; ///< RBDL body id of the parent of each marker
+    std::vector<utils::Vector3d> m_position; ///< Position of each marker in its parent reference frame
+    std::vector<utils::Vector3d> m_positionAxesRemoved; ///< Same as m_position, with the axes removed
+};
+
 rigidbody::Markers::Markers() :
-    m_marks(std::make_shared<std::vector<rigidbody::NodeSegment>>())
+    m_marks(std::make_shared<std::vector<rigidbody::NodeSegment>>()),
+    m_markersIndex(std::make_shared<rigidbody::Markers::MarkersIndex>())
 {
     //ctor
 }
 
 rigidbody::Markers::Markers(const rigidbody::Markers &other) :
-    m_marks(other.m_marks)
+    m_marks(other.m_marks),
+    m_markersIndex(other.m_markersIndex)
 {
 
 }
@@ -45,6 +65,7 @@ void rigidbody::Markers::DeepCopy(
     for (size_t i=0; i<other.m_marks->size(); ++i) {
         (*m_marks)[i] = (*other.m_marks)[i].DeepCopy();
     }
+    *m_markersIndex = rigidbody::Markers::MarkersIndex();
 }
 
 // Add a new marker to the markers pool
@@ -60,6 +81,111 @@ void rigidbody::Markers::addMarker(
     rigidbody::NodeSegment tp(pos, name, parentName, technical, anatomical,
                                       axesToRemove, id);
     m_marks->push_back(tp);
+    *m_markersIndex = rigidbody::Markers::MarkersIndex();
+}
+
+rigidbody::Markers::MarkersIndex& rigidbody::Markers::markersIndex()
+{
+    MarkersIndex& index(*m_markersIndex);
+    if (index.m_isResolved) {
+        return index;
+    }
+
+    // Assuming that this is also a joint type (via BiorbdModel)
+    rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+    index = MarkersIndex();
+    for (size_t i=0; i<nbMarkers(); ++i) {
+        const rigidbody::NodeSegment& node(marker(i));
+        index.m_all.push_back(i);
+        if (node.isTechnical()) {
+            index.m_technical.push_back(i);
+        }
+        if (node.isAnatomical()) {
+            index.m_anatomical.push_back(i);
+        }
+        index.m_bodyId.push_back(static_cast<unsigned int>(model.getBodyRbdlId(node.parent())));
+        index.m_position.push_back(node);
+        index.m_positionAxesRemoved.push_back(node.removeAxes());
+    }
+    index.m_isResolved = true;
+    return index;
+}
+
+void rigidbody::Markers::markersInMatrix(
+    const rigidbody::GeneralizedCoordinates &Q,
+    const std::vector<size_t>& indices,
+    utils::Matrix& positions,
+    bool removeAxis,
+    bool updateKin)
+{
+    // Assuming that this is also a joint type (via BiorbdModel)
+    rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+#ifdef BIORBD_USE_CASADI_MATH
+    updateKin = true;
+#endif
+    if (updateKin) {
+        model.UpdateKinematicsCustom(&Q);
+    }
+
+    const MarkersIndex& index(markersIndex());
+    const std::vector<utils::Vector3d>& local(
+        removeAxis ? index.m_positionAxesRemoved : index.m_position);
+    if (static_cast<size_t>(positions.rows()) != 3
+            || static_cast<size_t>(positions.cols()) != indices.size()) {
+        positions = utils::Matrix(3, indices.size());
+    }
+    for (size_t i=0; i<indices.size(); ++i) {
+        positions.block(0, static_cast<unsigned int>(i), 3, 1) =
+            RigidBodyDynamics::CalcBodyToBaseCoordinates(
+                model, Q, index.m_bodyId[indices[i]], local[indices[i]], false);
+    }
+}
+
+void rigidbody::Markers::markersInMatrix(
+    const rigidbody::GeneralizedCoordinates &Q,
+    utils::Matrix& positions,
+    bool removeAxis,
+    bool updateKin)
+{
+    markersInMatrix(Q, markersIndex().m_all, positions, removeAxis, updateKin);
+}
+
+utils::Matrix rigidbody::Markers::markersInMatrix(
+    const rigidbody::GeneralizedCoordinates &Q,
+    bool removeAxis,
+    bool updateKin)
+{
+    utils::Matrix positions(3, nbMarkers());
+    markersInMatrix(Q, positions, removeAxis, updateKin);
+    return positions;
+}
+
+void rigidbody::Markers::technicalMarkersInMatrix(
+    const rigidbody::GeneralizedCoordinates &Q,
+    utils::Matrix& positions,
+    bool removeAxis,
+    bool updateKin)
+{
+    markersInMatrix(Q, markersIndex().m_technical, positions, removeAxis, updateKin);
+}
+
+void rigidbody::Markers::anatomicalMarkersInMatrix(
+    const rigidbody::GeneralizedCoordinates &Q,
+    utils::Matrix& positions,
+    bool removeAxis,
+    bool updateKin)
+{
+    markersInMatrix(Q, markersIndex().m_anatomical, positions, removeAxis, updateKin);
+}
+
+const std::vector<size_t>& rigidbody::Markers::technicalMarkersIndices()
+{
+    return markersIndex().m_technical;
+}
+
+const std::vector<size_t>& rigidbody::Markers::anatomicalMarkersIndices()
+{
+    return markersIndex().m_anatomical;
 }
 
 const rigidbody::NodeSegment &rigidbody::Markers::marker(
@@ -94,7 +220,7 @@ rigidbody::NodeSegment rigidbody::Markers::marker(
     updateKin = true;
 #endif
 
-    unsigned int id = model.GetBodyId(n.parent().c_str());
+    unsigned int id(static_cast<unsigned int>(model.getBodyRbdlId(n.parent())));
     if (removeAxis) {
         return rigidbody::NodeSegment(
                    RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q, id, n.removeAxes(),
@@ -118,12 +244,10 @@ rigidbody::NodeSegment rigidbody::Markers::marker(
     updateKin = true;
 #endif
 
-    const rigidbody::NodeSegment& node(marker(idx));
-
     // Retrieve the position of the marker in the local reference
     const rigidbody::NodeSegment& pos = marker(idx, removeAxis);
 
-    unsigned int id = model.GetBodyId(node.parent().c_str());
+    unsigned int id(markersIndex().m_bodyId[idx]);
     return rigidbody::NodeSegment(
                RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q, id, pos, updateKin));
 }
@@ -181,13 +305,11 @@ rigidbody::NodeSegment rigidbody::Markers::markerVelocity(
     updateKin = true;
 #endif
 
-    const rigidbody::NodeSegment& node(marker(idx));
-
     // Retrieve the position of the marker in the local reference
     const rigidbody::NodeSegment& pos(marker(idx, removeAxis));
 
     // Calculate the velocity of the point
-    unsigned int id(model.GetBodyId(node.parent().c_str()));
+    unsigned int id(markersIndex().m_bodyId[idx]);
     return rigidbody::NodeSegment(RigidBodyDynamics::CalcPointVelocity(
             model, Q, Qdot, id, pos, updateKin));
 }
@@ -206,13 +328,11 @@ rigidbody::NodeSegment rigidbody::Markers::markerAngularVelocity(
     updateKin = true;
 #endif
 
-    const rigidbody::NodeSegment& node(marker(idx));
-
     // Retrieve the position of the marker in the local reference
     const rigidbody::NodeSegment& pos(marker(idx, removeAxis));
 
     // Calculate the velocity of the point
-    unsigned int id(model.GetBodyId(node.parent().c_str()));
+    unsigned int id(markersIndex().m_bodyId[idx]);
     return rigidbody::NodeSegment(
                 RigidBodyDynamics::CalcPointVelocity6D(model, Q, Qdot, id, pos, updateKin).block(0, 0, 3, 1)
             );
@@ -267,13 +387,11 @@ rigidbody::NodeSegment rigidbody::Markers::markerAcceleration(
     updateKin = true;
 #endif
 
-    const rigidbody::NodeSegment& node(marker(idx));
-
     // Retrieve the position of the marker in the local reference
     const rigidbody::NodeSegment& pos(marker(idx, removeAxis));
 
     // Calculate the acceleration of the point
-    unsigned int id(model.GetBodyId(node.parent().c_str()));
+    unsigned int id(markersIndex().m_bodyId[idx]);
     return rigidbody::NodeSegment(RigidBodyDynamics::CalcPointAcceleration(
             model, Q, Qdot, Qddot, id, pos,
             updateKin));
@@ -440,7 +558,7 @@ utils::Matrix rigidbody::Markers::markersJacobian(
     utils::Matrix G(utils::Matrix::Zero(3, static_cast<unsigned int>(model.nbQ())));;
 
     // Calculate the Jacobien of this Tag
-    unsigned int id = model.GetBodyId(parentName.c_str());
+    unsigned int id(static_cast<unsigned int>(model.getBodyRbdlId(parentName)));
     RigidBodyDynamics::CalcPointJacobian(model, Q, id, p, G, updateKin);
 
     return G;
@@ -457,28 +575,28 @@ bool rigidbody::Markers::inverseKinematics(
                                        (*this);
     model.UpdateKinematicsCustom(&Q); // also assert for dimensions
 
-    // Find the technical markers only (body_point)
-    std::vector<rigidbody::NodeSegment> body_point(
-        technicalMarkers(removeAxes));
+    // The technical markers (body_point) and their body number (body_id) come from the cached index
+    const MarkersIndex& index(markersIndex());
+    const std::vector<utils::Vector3d>& positions(
+        removeAxes ? index.m_positionAxesRemoved : index.m_position);
     std::vector<RigidBodyDynamics::Math::Vector3d> body_pointEigen;
-    for (size_t i=0; i<body_point.size(); ++i) {
-        body_pointEigen.push_back(body_point[i]);
+    std::vector<unsigned int> body_id;
+    body_pointEigen.reserve(index.m_technical.size());
+    body_id.reserve(index.m_technical.size());
+    for (size_t idx : index.m_technical) {
+        body_pointEigen.push_back(positions[idx]);
+        body_id.push_back(index.m_bodyId[idx]);
     }
 
     std::vector<RigidBodyDynamics::Math::Vector3d> markersInRbdl;
+    markersInRbdl.reserve(markers.size());
     for (size_t i = 0; i<markers.size(); ++i) {
         markersInRbdl.push_back(markers[i]);
     }
 
-    // Associate the body number to each technical marker (body_id)
-    std::vector<unsigned int> body_id;
-    for (size_t i=0; i<body_point.size(); ++i) {
-        body_id.push_back( static_cast<size_t>((*(body_point.begin()+i)).parentId()) );
-    }
-
     // Call the base function
     return RigidBodyDynamics::InverseKinematics(
-               dynamic_cast<rigidbody::Joints &>(*this),
+               model,
                Qinit, body_id, body_pointEigen, markersInRbdl, Q);
 }
 #endif
@@ -510,7 +628,7 @@ std::vector<utils::Matrix> rigidbody::Markers::markersJacobian(
         utils::Matrix G_tp(utils::Matrix::Zero(3, static_cast<unsigned int>(model.nbQ())));
 
         // Calculate the Jacobian of this Tag
-        unsigned int id = model.GetBodyId(node.parent().c_str());
+        unsigned int id(markersIndex().m_bodyId[idx]);
         RigidBodyDynamics::CalcPointJacobian(model, Q, id, pos, G_tp, updateKin);
 #ifndef BIORBD_USE_CASADI_MATH
         updateKin = false;
@@ -0,0 +1,333 @@
+#define BIORBD_API_EXPORTS
+#include "RigidBody/MarkersInverseKinematics.h"
+
+#ifndef BIORBD_USE_CASADI_MATH
+#include <cmath>
+#include <limits>
+#include <rbdl/rbdl.h>
+#include "BiorbdModel.h"
+#include "Utils/Error.h"
+#include "Utils/Matrix.h"
+#include "Utils/Range.h"
+#include "Utils/ThreadPool.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/NodeSegment.h"
+#include "RigidBody/Segment.h"
+
+using namespace BIORBD_NAMESPACE;
+
+///
+/// \brief What is shared by the threads: the markers, their weights, the bounds and the settings
+///
+class rigidbody::MarkersInverseKinematics::Problem
+{
+public:
+    std::vector<unsigned int> m_bodyId; ///< RBDL body id of the parent of each technical marker
+    std::vector<RigidBodyDynamics::Math::Vector3d> m_position; ///< Position of each technical marker in its parent reference frame
+    std::vector<double> m_weights; ///< Weight of each technical marker
+    RigidBodyDynamics::Math::VectorNd m_lowerBounds; ///< Lower bound of each generalized coordinate
+    RigidBodyDynamics::Math::VectorNd m_upperBounds; ///< Upper bound of each generalized coordinate
+    std::vector<std::pair<unsigned int, unsigned int>> m_quaternions; ///< Index in Q of the vector part and of the scalar part of each quaternion
+    size_t m_nbQ; ///< Number of generalized coordinates
+    size_t m_nbQdot; ///< Number of generalized velocities
+    size_t m_maxIterations; ///< Maximal number of iterations per frame
+    double m_tolerance; ///< Convergence tolerance on the norm of the step
+    bool m_useQRanges; ///< If the generalized coordinates are bounded
+};
+
+///
+/// \brief The kinematic model and the buffers of a thread
+///
+class rigidbody::MarkersInverseKinematics::Workspace
+{
+public:
+    RigidBodyDynamics::Model m_model; ///< The copy of the kinematic model
+    std::vector<double> m_weights; ///< Weight of each marker for the current frame
+    RigidBodyDynamics::Math::VectorNd m_residuals; ///< Weighted residuals
+    RigidBodyDynamics::Math::MatrixNd m_jacobian; ///< Weighted jacobian of the residuals
+    RigidBodyDynamics::Math::MatrixNd m_pointJacobian; ///< Jacobian of one marker
+    RigidBodyDynamics::Math::MatrixNd m_normal; ///< Normal matrix J^T J
+    RigidBodyDynamics::Math::MatrixNd m_damped; ///< Damped normal matrix
+    RigidBodyDynamics::Math::VectorNd m_gradient; ///< Gradient J^T r
+    RigidBodyDynamics::Math::VectorNd m_step; ///< Step on the generalized velocities
+    RigidBodyDynamics::Math::VectorNd m_Q; ///< Current generalized coordinates
+    RigidBodyDynamics::Math::VectorNd m_QNew; ///< Trial generalized coordinates
+};
+
+namespace
+{
+///
+/// \brief Compute the weighted residuals (and their jacobian) of the markers of a frame
+/// \return The sum of the squared residuals
+///
+double evaluateResiduals(
+    const std::vector<unsigned int>& bodyId,
+    const std::vector<RigidBodyDynamics::Math::Vector3d>& position,
+    const std::vector<double>& weights,
+    const utils::Matrix& markers,
+    const RigidBodyDynamics::Math::VectorNd& Q,
+    RigidBodyDynamics::Model& model,
+    RigidBodyDynamics::Math::VectorNd& residuals,
+    RigidBodyDynamics::Math::MatrixNd* jacobian,
+    RigidBodyDynamics::Math::MatrixNd& pointJacobian)
+{
+    RigidBodyDynamics::UpdateKinematicsCustom(model, &Q, nullptr, nullptr);
+    for (unsigned int i=0; i<bodyId.size(); ++i) {
+        if (weights[i] == 0) {
+            residuals.segment(3*i, 3).setZero();
+            if (jacobian) {
+                jacobian->block(3*i, 0, 3, jacobian->cols()).setZero();
+            }
+            continue;
+        }
+        residuals.segment(3*i, 3) = weights[i] * (
+                RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q, bodyId[i], position[i], false)
+                - RigidBodyDynamics::Math::Vector3d(markers.block(0, i, 3, 1)));
+        if (jacobian) {
+            pointJacobian.setZero();
+            RigidBodyDynamics::CalcPointJacobian(model, Q, bodyId[i], position[i], pointJacobian, false);
+            jacobian->block(3*i, 0, 3, jacobian->cols()) = weights[i] * pointJacobian;
+        }
+    }
+    return residuals.squaredNorm();
+}
+}
+
+rigidbody::MarkersInverseKinematics::MarkersInverseKinematics(
+    Model& model,
+    bool removeAxes,
+    size_t nbThreads) :
+    m_problem(std::make_shared<Problem>()),
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads))
+{
+    Problem& problem(*m_problem);
+    problem.m_nbQ = model.nbQ();
+    problem.m_nbQdot = model.nbQdot();
+    problem.m_maxIterations = 50;
+    problem.m_tolerance = 1e-10;
+    problem.m_useQRanges = true;
+
+    // The marker-to-body maps
+    std::vector<rigidbody::NodeSegment> markers(model.technicalMarkers(removeAxes));
+    for (const auto& marker : markers) {
+        problem.m_bodyId.push_back(static_cast<unsigned int>(marker.parentId()));
+        problem.m_position.push_back(marker);
+    }
+    problem.m_weights.assign(markers.size(), 1);
+
+    // The bounds, in the same order as the dof of the segments (the quaternions are not bounded)
+    double inf(std::numeric_limits<double>::infinity());
+    problem.m_lowerBounds = RigidBodyDynamics::Math::VectorNd::Constant(
+                                static_cast<unsigned int>(problem.m_nbQ), -inf);
+    problem.m_upperBounds = RigidBodyDynamics::Math::VectorNd::Constant(
+                                static_cast<unsigned int>(problem.m_nbQ), inf);
+    size_t cmpDof(0);
+    for (size_t i=0; i<model.nbSegment(); ++i) {
+        const rigidbody::Segment& segment(model.segment(i));
+        const std::vector<utils::Range>& ranges(segment.QRanges());
+        size_t nbBounded(segment.isRotationAQuaternion() ? segment.nbDofTrans() : segment.nbDof());
+        for (size_t j=0; j<nbBounded && j<ranges.size(); ++j) {
+            problem.m_lowerBounds[static_cast<unsigned int>(cmpDof + j)] = ranges[j].min();
+            problem.m_upperBounds[static_cast<unsigned int>(cmpDof + j)] = ranges[j].max();
+        }
+        cmpDof += segment.nbDof();
+    }
+
+    // RBDL stores the scalar part of the quaternions after all the other coordinates
+    for (unsigned int j=1; j<model.mJoints.size(); ++j) {
+        if (model.mJoints[j].mJointType == RigidBodyDynamics::JointTypeSpherical) {
+            problem.m_quaternions.push_back(std::make_pair(model.mJoints[j].q_index, model.multdof3_w_index[j]));
+        }
+    }
+
+    unsigned int nbResiduals(static_cast<unsigned int>(3 * problem.m_bodyId.size()));
+    unsigned int nbQ(static_cast<unsigned int>(problem.m_nbQ));
+    unsigned int nbQdot(static_cast<unsigned int>(problem.m_nbQdot));
+    for (size_t i=0; i<m_pool->nbThreads(); ++i) {
+        std::shared_ptr<Workspace> workspace(std::make_shared<Workspace>());
+        workspace->m_model = model;
+        workspace->m_residuals = RigidBodyDynamics::Math::VectorNd::Zero(nbResiduals);
+        workspace->m_jacobian = RigidBodyDynamics::Math::MatrixNd::Zero(nbResiduals, nbQdot);
+        workspace->m_pointJacobian = RigidBodyDynamics::Math::MatrixNd::Zero(3, nbQdot);
+        workspace->m_normal = RigidBodyDynamics::Math::MatrixNd::Zero(nbQdot, nbQdot);
+        workspace->m_damped = RigidBodyDynamics::Math::MatrixNd::Zero(nbQdot, nbQdot);
+        workspace->m_gradient = RigidBodyDynamics::Math::VectorNd::Zero(nbQdot);
+        workspace->m_step = RigidBodyDynamics::Math::VectorNd::Zero(nbQdot);
+        workspace->m_Q = RigidBodyDynamics::Math::VectorNd::Zero(nbQ);
+        workspace->m_QNew = RigidBodyDynamics::Math::VectorNd::Zero(nbQ);
+        m_workspaces.push_back(workspace);
+    }
+}
+
+rigidbody::MarkersInverseKinematics::~MarkersInverseKinematics()
+{
+
+}
+
+size_t rigidbody::MarkersInverseKinematics::nbMarkers() const
+{
+    return m_problem->m_bodyId.size();
+}
+
+size_t rigidbody::MarkersInverseKinematics::nbThreads() const
+{
+    return m_pool->nbThreads();
+}
+
+void rigidbody::MarkersInverseKinematics::setWeights(
+    const utils::Vector& weights)
+{
+    utils::Error::check(static_cast<size_t>(weights.size()) == nbMarkers(),
+                                "The number of weights must match the number of technical markers");
+    for (unsigned int i=0; i<weights.size(); ++i) {
+        utils::Error::check(weights[i] >= 0, "The weights must be positive");
+        m_problem->m_weights[i] = weights[i];
+    }
+}
+
+void rigidbody::MarkersInverseKinematics::setMaxIterations(
+    size_t maxIterations)
+{
+    m_problem->m_maxIterations = maxIterations;
+}
+
+void rigidbody::MarkersInverseKinematics::setTolerance(
+    double tolerance)
+{
+    m_problem->m_tolerance = tolerance;
+}
+
+void rigidbody::MarkersInverseKinematics::setUseQRanges(
+    bool useQRanges)
+{
+    m_problem->m_useQRanges = useQRanges;
+}
+
+bool rigidbody::MarkersInverseKinematics::solveFrame(
+    const utils::Matrix& markers,
+    rigidbody::GeneralizedCoordinates& Q)
+{
+    return solveFrame(*m_workspaces[0], markers, Q);
+}
+
+size_t rigidbody::MarkersInverseKinematics::solveTrial(
+    const std::vector<utils::Matrix>& markers,
+    const rigidbody::GeneralizedCoordinates& Qinit,
+    std::vector<rigidbody::GeneralizedCoordinates>& Q)
+{
+    Q.resize(markers.size());
+    std::vector<char> converged(markers.size(), 0);
+
+    // Contiguous blocks, so the warm start of each frame is the previous frame
+    size_t nbBlocks(std::min(m_pool->nbThreads(), markers.size()));
+    m_pool->parallelFor(nbBlocks, [&](size_t block, size_t thread) {
+        size_t first(block * markers.size() / nbBlocks);
+        size_t last((block + 1) * markers.size() / nbBlocks);
+        for (size_t i=first; i<last; ++i) {
+            Q[i] = i == first ? Qinit : Q[i-1];
+            converged[i] = solveFrame(*m_workspaces[thread], markers[i], Q[i]);
+        }
+    });
+
+    size_t nbConverged(0);
+    for (char c : converged) {
+        nbConverged += static_cast<size_t>(c);
+    }
+    return nbConverged;
+}
+
+bool rigidbody::MarkersInverseKinematics::solveFrame(
+    rigidbody::MarkersInverseKinematics::Workspace& workspace,
+    const utils::Matrix& markers,
+    rigidbody::GeneralizedCoordinates& Q) const
+{
+    const Problem& problem(*m_problem);
+    utils::Error::check(static_cast<size_t>(markers.cols()) == nbMarkers() && markers.rows() == 3,
+                                "The markers must be a 3 x nbTechnicalMarkers matrix");
+    utils::Error::check(static_cast<size_t>(Q.size()) == problem.m_nbQ, "Wrong size for Q");
+
+    // The occluded markers are ignored
+    workspace.m_weights = problem.m_weights;
+    bool hasMarker(false);
+    for (unsigned int i=0; i<markers.cols(); ++i) {
+        if (!markers.block(0, i, 3, 1).allFinite()) {
+            workspace.m_weights[i] = 0;
+        }
+        hasMarker |= workspace.m_weights[i] > 0;
+    }
+    if (!hasMarker) {
+        return false;
+    }
+
+    workspace.m_Q = Q;
+    if (problem.m_useQRanges) {
+        workspace.m_Q = workspace.m_Q.cwiseMax(problem.m_lowerBounds).cwiseMin(problem.m_upperBounds);
+    }
+    double cost(evaluateResiduals(problem.m_bodyId, problem.m_position, workspace.m_weights, markers,
+                                  workspace.m_Q, workspace.m_model, workspace.m_residuals, &workspace.m_jacobian,
+                                  workspace.m_pointJacobian));
+    double damping(1e-3);
+    bool isConverged(false);
+    for (size_t iteration=0; iteration<problem.m_maxIterations && !isConverged; ++iteration) {
+        workspace.m_normal.noalias() = workspace.m_jacobian.transpose() * workspace.m_jacobian;
+        workspace.m_gradient.noalias() = workspace.m_jacobian.transpose() * workspace.m_residuals;
+
+        bool isImproved(false);
+        while (!isImproved && damping < 1e10) {
+            // Marquardt scaling, the dof that no marker sees keep a small damping
+            workspace.m_damped = workspace.m_normal;
+            for (unsigned int i=0; i<workspace.m_damped.rows(); ++i) {
+                workspace.m_damped(i, i) += damping * std::max(workspace.m_normal(i, i), 1e-8);
+            }
+            workspace.m_step = -workspace.m_damped.ldlt().solve(workspace.m_gradient);
+
+            workspace.m_QNew = workspace.m_Q;
+            workspace.m_QNew.head(problem.m_nbQdot) += workspace.m_step;
+            for (const auto& quaternion : problem.m_quaternions) {
+                // The step of a quaternion is a rotation vector in the frame of the segment
+                RigidBodyDynamics::Math::Vector3d vec(workspace.m_Q.segment(quaternion.first, 3));
+                double w(workspace.m_Q[quaternion.second]);
+                RigidBodyDynamics::Math::Vector3d rotation(workspace.m_step.segment(quaternion.first, 3));
+                double angle(rotation.norm());
+                RigidBodyDynamics::Math::Vector3d deltaVec(
+                    angle > 1e-12 ? RigidBodyDynamics::Math::Vector3d(rotation * std::sin(angle / 2) / angle)
+                    : RigidBodyDynamics::Math::Vector3d(rotation / 2));
+                double deltaW(std::cos(angle / 2));
+                RigidBodyDynamics::Math::Vector3d newVec(w * deltaVec + deltaW * vec + vec.cross(deltaVec));
+                double newW(w * deltaW - vec.dot(deltaVec));
+                double norm(std::sqrt(newVec.squaredNorm() + newW * newW));
+                workspace.m_QNew.segment(quaternion.first, 3) = newVec / norm;
+                workspace.m_QNew[quaternion.second] = newW / norm;
+            }
+            if (problem.m_useQRanges) {
+                workspace.m_QNew = workspace.m_QNew.cwiseMax(problem.m_lowerBounds).cwiseMin(problem.m_upperBounds);
+            }
+
+            double newCost(evaluateResiduals(problem.m_bodyId, problem.m_position, workspace.m_weights, markers,
+                                             workspace.m_QNew, workspace.m_model, workspace.m_residuals, nullptr,
+                                             workspace.m_pointJacobian));
+            if (newCost < cost) {
+                isImproved = true;
+                isConverged = (workspace.m_QNew - workspace.m_Q).norm() < problem.m_tolerance * (1 + workspace.m_Q.norm());
+                workspace.m_Q.swap(workspace.m_QNew);
+                cost = newCost;
+                damping = std::max(damping / 10, 1e-12);
+            } else {
+                damping *= 10;
+            }
+        }
+        if (!isImproved) {
+            // No step can reduce the residuals anymore, this is a (possibly bounded) minimum
+            isConverged = true;
+            break;
+        }
+        if (!isConverged) {
+            evaluateResiduals(problem.m_bodyId, problem.m_position, workspace.m_weights, markers,
+                              workspace.m_Q, workspace.m_model, workspace.m_residuals, &workspace.m_jacobian,
+                              workspace.m_pointJacobian);
+        }
+    }
+    Q = workspace.m_Q;
+    return isConverged;
+}
+#endif
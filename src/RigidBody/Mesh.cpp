@@ -2,6 +2,7 @@
 #include "RigidBody/Mesh.h"
 
 #include "Utils/Path.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Vector3d.h"
 #include "Utils/RotoTrans.h"
 #include "RigidBody/MeshFace.h"
@@ -157,3 +158,18 @@ const utils::Path &rigidbody::Mesh::path() const
 {
     return *m_pathFile;
 }
+
+void rigidbody::Mesh::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_rotation);
+    if (footprint.add(m_vertex)) {
+        for (auto& vertex : *m_vertex) {
+            vertex.memoryFootprint(footprint);
+        }
+    }
+    footprint.add(m_faces);
+    footprint.add(m_pathFile);
+    footprint.add(m_patchColor);
+    footprint.add(m_scale);
+}
@@ -0,0 +1,849 @@
+#define BIORBD_API_EXPORTS
+#include "RigidBody/MeshCollisions.h"
+
+#ifndef BIORBD_USE_CASADI_MATH
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <rbdl/rbdl_math.h>
+#include "Utils/Error.h"
+#include "Utils/String.h"
+#include "Utils/Vector3d.h"
+#include "Utils/RotoTrans.h"
+#include "Utils/ThreadPool.h"
+#include "RigidBody/Joints.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/Mesh.h"
+#include "RigidBody/MeshFace.h"
+
+using namespace BIORBD_NAMESPACE;
+
+namespace BIORBD_NAMESPACE
+{
+namespace rigidbody
+{
+///
+/// \brief A bounding volume hierarchy over the triangles of a mesh, in the reference frame of its segment
+///
+class MeshHierarchy
+{
+public:
+    ///
+    /// \brief A box of the hierarchy, a leaf holds a range of triangles
+    ///
+    class Node
+    {
+    public:
+        RigidBodyDynamics::Math::Vector3d m_center; ///< Center of the box
+        RigidBodyDynamics::Math::Vector3d m_halfSize; ///< Half of the size of the box along each axis
+        size_t m_first; ///< First triangle of a leaf
+        size_t m_count; ///< Number of triangles of a leaf (0 for the other nodes)
+        size_t m_left; ///< First child
+        size_t m_right; ///< Second child
+    };
+
+    MeshHierarchy(
+        const Mesh& mesh);
+
+    ///
+    /// \brief Return the distance to another hierarchy
+    /// \param other The other hierarchy
+    /// \param rotation The orientation of the other hierarchy in this reference frame
+    /// \param translation The position of the other hierarchy in this reference frame
+    /// \param maxDistance The distance above which the search stops
+    /// \param point The closest point of this mesh (set only if closer than maxDistance)
+    /// \param otherPoint The closest point of the other mesh in this reference frame (set only if closer than maxDistance)
+    /// \return The distance
+    ///
+    double distance(
+        const MeshHierarchy& other,
+        const RigidBodyDynamics::Math::Matrix3d& rotation,
+        const RigidBodyDynamics::Math::Vector3d& translation,
+        double maxDistance,
+        RigidBodyDynamics::Math::Vector3d& point,
+        RigidBodyDynamics::Math::Vector3d& otherPoint) const;
+
+    ///
+    /// \brief Return the distance from a point to the surface
+    /// \param point The point in this reference frame
+    /// \return The distance
+    ///
+    double distance(
+        const RigidBodyDynamics::Math::Vector3d& point) const;
+
+    ///
+    /// \brief Return if a point is inside the mesh (odd number of crossings of a ray)
+    /// \param point The point in this reference frame
+    /// \return If the point is inside
+    ///
+    bool isInside(
+        const RigidBodyDynamics::Math::Vector3d& point) const;
+
+    ///
+    /// \brief Return the depth of the deepest vertex of another mesh inside this one
+    /// \param other The other hierarchy
+    /// \param rotation The orientation of the other hierarchy in this reference frame
+    /// \param translation The position of the other hierarchy in this reference frame
+    /// \return The depth (0 if no vertex is inside)
+    ///
+    double depth(
+        const MeshHierarchy& other,
+        const RigidBodyDynamics::Math::Matrix3d& rotation,
+        const RigidBodyDynamics::Math::Vector3d& translation) const;
+
+    std::vector<RigidBodyDynamics::Math::Vector3d> m_vertices; ///< The vertices
+    std::vector<std::array<size_t, 3>> m_triangles; ///< The vertices of each triangle, sorted by leaf
+    std::vector<Node> m_nodes; ///< The boxes, the root being the first one
+
+protected:
+    ///
+    /// \brief Build the node of a range of triangles and its children
+    /// \param first The first triangle
+    /// \param count The number of triangles
+    /// \return The index of the node
+    ///
+    size_t build(
+        size_t first,
+        size_t count);
+};
+}
+}
+
+namespace
+{
+const size_t maxTrianglesPerLeaf(4);
+
+///
+/// \brief Return the closest point of a triangle to a point
+///
+RigidBodyDynamics::Math::Vector3d closestPointOnTriangle(
+    const RigidBodyDynamics::Math::Vector3d& p,
+    const RigidBodyDynamics::Math::Vector3d& a,
+    const RigidBodyDynamics::Math::Vector3d& b,
+    const RigidBodyDynamics::Math::Vector3d& c)
+{
+    // Find the Voronoi region of the triangle the point lies in
+    RigidBodyDynamics::Math::Vector3d ab(b - a), ac(c - a), ap(p - a);
+    double d1(ab.dot(ap)), d2(ac.dot(ap));
+    if (d1 <= 0 && d2 <= 0) {
+        return a;
+    }
+    RigidBodyDynamics::Math::Vector3d bp(p - b);
+    double d3(ab.dot(bp)), d4(ac.dot(bp));
+    if (d3 >= 0 && d4 <= d3) {
+        return b;
+    }
+    double vc(d1*d4 - d3*d2);
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        return a + d1 / (d1 - d3) * ab;
+    }
+    RigidBodyDynamics::Math::Vector3d cp(p - c);
+    double d5(ab.dot(cp)), d6(ac.dot(cp));
+    if (d6 >= 0 && d5 <= d6) {
+        return c;
+    }
+    double vb(d5*d2 - d1*d6);
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        return a + d2 / (d2 - d6) * ac;
+    }
+    double va(d3*d6 - d5*d4);
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        return b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b);
+    }
+    double denominator(1 / (va + vb + vc));
+    return a + ab * vb * denominator + ac * vc * denominator;
+}
+
+///
+/// \brief Compute the closest points of two segments
+/// \return The squared distance
+///
+double closestPointsOfSegments(
+    const RigidBodyDynamics::Math::Vector3d& p1,
+    const RigidBodyDynamics::Math::Vector3d& q1,
+    const RigidBodyDynamics::Math::Vector3d& p2,
+    const RigidBodyDynamics::Math::Vector3d& q2,
+    RigidBodyDynamics::Math::Vector3d& c1,
+    RigidBodyDynamics::Math::Vector3d& c2)
+{
+    RigidBodyDynamics::Math::Vector3d d1(q1 - p1), d2(q2 - p2), r(p1 - p2);
+    double a(d1.squaredNorm()), e(d2.squaredNorm()), f(d2.dot(r));
+    double s(0), t(0);
+    if (a <= 1e-20 && e <= 1e-20) {
+        // Both segments are points
+    } else if (a <= 1e-20) {
+        t = std::min(std::max(f / e, 0.), 1.);
+    } else {
+        double c(d1.dot(r));
+        if (e <= 1e-20) {
+            s = std::min(std::max(-c / a, 0.), 1.);
+        } else {
+            double b(d1.dot(d2));
+            double denominator(a*e - b*b);
+            if (denominator != 0) {
+                s = std::min(std::max((b*f - c*e) / denominator, 0.), 1.);
+            }
+            t = (b*s + f) / e;
+            if (t < 0) {
+                t = 0;
+                s = std::min(std::max(-c / a, 0.), 1.);
+            } else if (t > 1) {
+                t = 1;
+                s = std::min(std::max((b - c) / a, 0.), 1.);
+            }
+        }
+    }
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+    return (c1 - c2).squaredNorm();
+}
+
+///
+/// \brief Return if a ray crosses a triangle before a given length (Moller-Trumbore)
+/// \param origin The origin of the ray
+/// \param direction The direction of the ray (its length is the unit of length)
+/// \param length The length of the ray
+/// \param t The length at which the triangle is crossed
+///
+bool rayCrossesTriangle(
+    const RigidBodyDynamics::Math::Vector3d& origin,
+    const RigidBodyDynamics::Math::Vector3d& direction,
+    double length,
+    const RigidBodyDynamics::Math::Vector3d& a,
+    const RigidBodyDynamics::Math::Vector3d& b,
+    const RigidBodyDynamics::Math::Vector3d& c,
+    double& t)
+{
+    RigidBodyDynamics::Math::Vector3d ab(b - a), ac(c - a);
+    RigidBodyDynamics::Math::Vector3d h(direction.cross(ac));
+    double det(ab.dot(h));
+    if (std::fabs(det) < 1e-20) {
+        return false;
+    }
+    double invDet(1 / det);
+    RigidBodyDynamics::Math::Vector3d s(origin - a);
+    double u(invDet * s.dot(h));
+    if (u < 0 || u > 1) {
+        return false;
+    }
+    RigidBodyDynamics::Math::Vector3d q(s.cross(ab));
+    double v(invDet * direction.dot(q));
+    if (v < 0 || u + v > 1) {
+        return false;
+    }
+    t = invDet * ac.dot(q);
+    return t >= 0 && t <= length;
+}
+
+///
+/// \brief Compute the closest points of two triangles
+/// \return The distance (0 if they intersect)
+///
+double closestPointsOfTriangles(
+    const RigidBodyDynamics::Math::Vector3d* t1,
+    const RigidBodyDynamics::Math::Vector3d* t2,
+    RigidBodyDynamics::Math::Vector3d& c1,
+    RigidBodyDynamics::Math::Vector3d& c2)
+{
+    // Two triangles intersect if and only if an edge of one crosses the other
+    double t;
+    for (size_t i=0; i<3; ++i) {
+        const RigidBodyDynamics::Math::Vector3d& p1(t1[i]);
+        const RigidBodyDynamics::Math::Vector3d& q1(t1[(i+1)%3]);
+        if (rayCrossesTriangle(p1, q1 - p1, 1, t2[0], t2[1], t2[2], t)) {
+            c1 = p1 + t * (q1 - p1);
+            c2 = c1;
+            return 0;
+        }
+        const RigidBodyDynamics::Math::Vector3d& p2(t2[i]);
+        const RigidBodyDynamics::Math::Vector3d& q2(t2[(i+1)%3]);
+        if (rayCrossesTriangle(p2, q2 - p2, 1, t1[0], t1[1], t1[2], t)) {
+            c1 = p2 + t * (q2 - p2);
+            c2 = c1;
+            return 0;
+        }
+    }
+
+    // Otherwise the closest points are on two edges or a vertex and a face
+    double best(std::numeric_limits<double>::infinity());
+    RigidBodyDynamics::Math::Vector3d p, q;
+    for (size_t i=0; i<3; ++i) {
+        for (size_t j=0; j<3; ++j) {
+            double d(closestPointsOfSegments(t1[i], t1[(i+1)%3], t2[j], t2[(j+1)%3], p, q));
+            if (d < best) {
+                best = d;
+                c1 = p;
+                c2 = q;
+            }
+        }
+        p = closestPointOnTriangle(t1[i], t2[0], t2[1], t2[2]);
+        double d((p - t1[i]).squaredNorm());
+        if (d < best) {
+            best = d;
+            c1 = t1[i];
+            c2 = p;
+        }
+        p = closestPointOnTriangle(t2[i], t1[0], t1[1], t1[2]);
+        d = (p - t2[i]).squaredNorm();
+        if (d < best) {
+            best = d;
+            c1 = p;
+            c2 = t2[i];
+        }
+    }
+    return std::sqrt(best);
+}
+
+///
+/// \brief Return the distance between two boxes
+/// \param center1 The center of the first box
+/// \param halfSize1 The half size of the first box
+/// \param center2 The center of the second box, in the same reference frame
+/// \param halfSize2 The half size of the second box along the axes of the first box
+///
+double distanceOfBoxes(
+    const RigidBodyDynamics::Math::Vector3d& center1,
+    const RigidBodyDynamics::Math::Vector3d& halfSize1,
+    const RigidBodyDynamics::Math::Vector3d& center2,
+    const RigidBodyDynamics::Math::Vector3d& halfSize2)
+{
+    RigidBodyDynamics::Math::Vector3d gap(
+        ((center1 - center2).cwiseAbs() - halfSize1 - halfSize2).cwiseMax(0.));
+    return gap.norm();
+}
+
+///
+/// \brief Return the transformation of a segment in the reference frame of another one
+/// \param jcs1 The reference frame of the first segment
+/// \param jcs2 The reference frame of the second segment
+/// \param rotation The orientation of the second segment in the first one
+/// \param translation The position of the second segment in the first one
+///
+void relativeTransform(
+    const utils::RotoTrans& jcs1,
+    const utils::RotoTrans& jcs2,
+    RigidBodyDynamics::Math::Matrix3d& rotation,
+    RigidBodyDynamics::Math::Vector3d& translation)
+{
+    RigidBodyDynamics::Math::Matrix3d rotation1(jcs1.block<3, 3>(0, 0));
+    rotation = rotation1.transpose() * jcs2.block<3, 3>(0, 0);
+    translation = rotation1.transpose() * (jcs2.block<3, 1>(0, 3) - jcs1.block<3, 1>(0, 3));
+}
+}
+
+rigidbody::MeshHierarchy::MeshHierarchy(
+    const rigidbody::Mesh& mesh)
+{
+    for (size_t i=0; i<mesh.nbVertex(); ++i) {
+        m_vertices.push_back(mesh.point(i));
+    }
+
+    // The faces with more than 3 vertices are cut in fans of triangles
+    for (const auto& meshFace : mesh.faces()) {
+        rigidbody::MeshFace face(meshFace);
+        std::vector<int> vertices(face.face());
+        for (int vertex : vertices) {
+            utils::Error::check(vertex >= 0 && static_cast<size_t>(vertex) < m_vertices.size(),
+                                "A face of the mesh refers to a vertex that does not exist");
+        }
+        for (size_t j=2; j<vertices.size(); ++j) {
+            std::array<size_t, 3> triangle = {{static_cast<size_t>(vertices[0]),
+                                               static_cast<size_t>(vertices[j-1]),
+                                               static_cast<size_t>(vertices[j])}};
+            m_triangles.push_back(triangle);
+        }
+    }
+    build(0, m_triangles.size());
+}
+
+size_t rigidbody::MeshHierarchy::build(
+    size_t first,
+    size_t count)
+{
+    RigidBodyDynamics::Math::Vector3d lower(RigidBodyDynamics::Math::Vector3d::Constant(std::numeric_limits<double>::infinity()));
+    RigidBodyDynamics::Math::Vector3d upper(-lower);
+    RigidBodyDynamics::Math::Vector3d centroidLower(lower), centroidUpper(upper);
+    for (size_t i=first; i<first+count; ++i) {
+        RigidBodyDynamics::Math::Vector3d centroid(RigidBodyDynamics::Math::Vector3d::Zero());
+        for (size_t vertex : m_triangles[i]) {
+            lower = lower.cwiseMin(m_vertices[vertex]);
+            upper = upper.cwiseMax(m_vertices[vertex]);
+            centroid += m_vertices[vertex] / 3;
+        }
+        centroidLower = centroidLower.cwiseMin(centroid);
+        centroidUpper = centroidUpper.cwiseMax(centroid);
+    }
+
+    size_t idx(m_nodes.size());
+    m_nodes.push_back(Node());
+    m_nodes[idx].m_center = (lower + upper) / 2;
+    m_nodes[idx].m_halfSize = (upper - lower) / 2;
+    m_nodes[idx].m_first = first;
+    m_nodes[idx].m_count = count;
+
+    // Split the triangles at the median of their centroid along the largest side
+    size_t axis;
+    double extent((centroidUpper - centroidLower).maxCoeff(&axis));
+    if (count <= maxTrianglesPerLeaf || !(extent > 0)) {
+        return idx;
+    }
+    size_t half(count / 2);
+    std::nth_element(m_triangles.begin() + first, m_triangles.begin() + first + half,
+                     m_triangles.begin() + first + count,
+                     [this, axis](const std::array<size_t, 3>& t1, const std::array<size_t, 3>& t2) {
+        return m_vertices[t1[0]][axis] + m_vertices[t1[1]][axis] + m_vertices[t1[2]][axis]
+               < m_vertices[t2[0]][axis] + m_vertices[t2[1]][axis] + m_vertices[t2[2]][axis];
+    });
+    size_t left(build(first, half));
+    size_t right(build(first + half, count - half));
+    m_nodes[idx].m_count = 0;
+    m_nodes[idx].m_left = left;
+    m_nodes[idx].m_right = right;
+    return idx;
+}
+
+double rigidbody::MeshHierarchy::distance(
+    const rigidbody::MeshHierarchy& other,
+    const RigidBodyDynamics::Math::Matrix3d& rotation,
+    const RigidBodyDynamics::Math::Vector3d& translation,
+    double maxDistance,
+    RigidBodyDynamics::Math::Vector3d& point,
+    RigidBodyDynamics::Math::Vector3d& otherPoint) const
+{
+    if (m_triangles.empty() || other.m_triangles.empty()) {
+        return maxDistance;
+    }
+    RigidBodyDynamics::Math::Matrix3d absRotation(rotation.cwiseAbs());
+    auto lowerBound = [&](size_t node, size_t otherNode) {
+        const Node& n1(m_nodes[node]);
+        const Node& n2(other.m_nodes[otherNode]);
+        return distanceOfBoxes(n1.m_center, n1.m_halfSize,
+                               rotation * n2.m_center + translation, absRotation * n2.m_halfSize);
+    };
+
+    // Depth-first traversal of the pairs of boxes, the closest pair of children being visited first
+    double best(maxDistance);
+    std::vector<std::pair<std::pair<size_t, size_t>, double>> stack;
+    stack.push_back(std::make_pair(std::make_pair(0, 0), lowerBound(0, 0)));
+    RigidBodyDynamics::Math::Vector3d triangle[3], otherTriangle[3], p, q;
+    while (!stack.empty()) {
+        size_t node(stack.back().first.first);
+        size_t otherNode(stack.back().first.second);
+        double bound(stack.back().second);
+        stack.pop_back();
+        if (bound >= best) {
+            continue;
+        }
+        const Node& n1(m_nodes[node]);
+        const Node& n2(other.m_nodes[otherNode]);
+        if (n1.m_count && n2.m_count) {
+            for (size_t j=n2.m_first; j<n2.m_first + n2.m_count; ++j) {
+                for (size_t k=0; k<3; ++k) {
+                    otherTriangle[k] = rotation * other.m_vertices[other.m_triangles[j][k]] + translation;
+                }
+                for (size_t i=n1.m_first; i<n1.m_first + n1.m_count; ++i) {
+                    for (size_t k=0; k<3; ++k) {
+                        triangle[k] = m_vertices[m_triangles[i][k]];
+                    }
+                    double d(closestPointsOfTriangles(triangle, otherTriangle, p, q));
+                    if (d < best) {
+                        best = d;
+                        point = p;
+                        otherPoint = q;
+                        if (best == 0) {
+                            return 0;
+                        }
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Open the largest box that is not a leaf
+        std::pair<size_t, size_t> child1, child2;
+        if (!n2.m_count && (n1.m_count || n2.m_halfSize.squaredNorm() > n1.m_halfSize.squaredNorm())) {
+            child1 = std::make_pair(node, n2.m_left);
+            child2 = std::make_pair(node, n2.m_right);
+        } else {
+            child1 = std::make_pair(n1.m_left, otherNode);
+            child2 = std::make_pair(n1.m_right, otherNode);
+        }
+        double bound1(lowerBound(child1.first, child1.second));
+        double bound2(lowerBound(child2.first, child2.second));
+        if (bound1 < bound2) {
+            std::swap(child1, child2);
+            std::swap(bound1, bound2);
+        }
+        if (bound1 < best) {
+            stack.push_back(std::make_pair(child1, bound1));
+        }
+        if (bound2 < best) {
+            stack.push_back(std::make_pair(child2, bound2));
+        }
+    }
+    return best;
+}
+
+double rigidbody::MeshHierarchy::distance(
+    const RigidBodyDynamics::Math::Vector3d& point) const
+{
+    double best(std::numeric_limits<double>::infinity());
+    if (m_triangles.empty()) {
+        return best;
+    }
+    std::vector<size_t> stack(1, 0);
+    while (!stack.empty()) {
+        const Node& node(m_nodes[stack.back()]);
+        stack.pop_back();
+        if (distanceOfBoxes(node.m_center, node.m_halfSize, point,
+                            RigidBodyDynamics::Math::Vector3d::Zero()) >= best) {
+            continue;
+        }
+        if (!node.m_count) {
+            stack.push_back(node.m_left);
+            stack.push_back(node.m_right);
+            continue;
+        }
+        for (size_t i=node.m_first; i<node.m_first + node.m_count; ++i) {
+            const std::array<size_t, 3>& triangle(m_triangles[i]);
+            double d((closestPointOnTriangle(point, m_vertices[triangle[0]], m_vertices[triangle[1]],
+                                             m_vertices[triangle[2]]) - point).norm());
+            best = std::min(best, d);
+        }
+    }
+    return best;
+}
+
+bool rigidbody::MeshHierarchy::isInside(
+    const RigidBodyDynamics::Math::Vector3d& point) const
+{
+    if (m_triangles.empty() || ((point - m_nodes[0].m_center).cwiseAbs() - m_nodes[0].m_halfSize).maxCoeff() > 0) {
+        return false;
+    }
+
+    // The direction is not aligned with the axes so the ray is unlikely to hit an edge of the usual meshes
+    const RigidBodyDynamics::Math::Vector3d direction(
+        RigidBodyDynamics::Math::Vector3d(0.6136, 0.5439, 0.5724).normalized());
+    const RigidBodyDynamics::Math::Vector3d inverse(direction.cwiseInverse());
+    size_t nbCrossings(0);
+    std::vector<size_t> stack(1, 0);
+    double t;
+    while (!stack.empty()) {
+        const Node& node(m_nodes[stack.back()]);
+        stack.pop_back();
+
+        // Slab test of the ray against the box
+        RigidBodyDynamics::Math::Vector3d t1((node.m_center - node.m_halfSize - point).cwiseProduct(inverse));
+        RigidBodyDynamics::Math::Vector3d t2((node.m_center + node.m_halfSize - point).cwiseProduct(inverse));
+        if (t1.cwiseMax(t2).minCoeff() < std::max(t1.cwiseMin(t2).maxCoeff(), 0.)) {
+            continue;
+        }
+        if (!node.m_count) {
+            stack.push_back(node.m_left);
+            stack.push_back(node.m_right);
+            continue;
+        }
+        for (size_t i=node.m_first; i<node.m_first + node.m_count; ++i) {
+            const std::array<size_t, 3>& triangle(m_triangles[i]);
+            if (rayCrossesTriangle(point, direction, std::numeric_limits<double>::infinity(),
+                                   m_vertices[triangle[0]], m_vertices[triangle[1]],
+                                   m_vertices[triangle[2]], t)) {
+                ++nbCrossings;
+            }
+        }
+    }
+    return nbCrossings % 2 == 1;
+}
+
+double rigidbody::MeshHierarchy::depth(
+    const rigidbody::MeshHierarchy& other,
+    const RigidBodyDynamics::Math::Matrix3d& rotation,
+    const RigidBodyDynamics::Math::Vector3d& translation) const
+{
+    double deepest(0);
+    for (const auto& vertex : other.m_vertices) {
+        RigidBodyDynamics::Math::Vector3d point(rotation * vertex + translation);
+        if (isInside(point)) {
+            deepest = std::max(deepest, distance(point));
+        }
+    }
+    return deepest;
+}
+
+namespace
+{
+///
+/// \brief Return the distance between two meshes, 0 if one is inside the other
+/// \param point1 The closest point of the first mesh (in its reference frame)
+/// \param point2 The closest point of the second mesh (in the reference frame of the first one)
+///
+double distanceOfMeshes(
+    const rigidbody::MeshHierarchy& hierarchy1,
+    const rigidbody::MeshHierarchy& hierarchy2,
+    const RigidBodyDynamics::Math::Matrix3d& rotation,
+    const RigidBodyDynamics::Math::Vector3d& translation,
+    double maxDistance,
+    RigidBodyDynamics::Math::Vector3d& point1,
+    RigidBodyDynamics::Math::Vector3d& point2)
+{
+    double d(hierarchy1.distance(hierarchy2, rotation, translation, maxDistance, point1, point2));
+    if (d > 0) {
+        // Without any crossing of the surfaces, a mesh is inside the other if any of its vertices is
+        RigidBodyDynamics::Math::Vector3d vertex2(rotation * hierarchy2.m_vertices[0] + translation);
+        RigidBodyDynamics::Math::Vector3d vertex1(
+            rotation.transpose() * (hierarchy1.m_vertices[0] - translation));
+        if (hierarchy1.isInside(vertex2)) {
+            d = 0;
+            point1 = point2 = vertex2;
+        } else if (hierarchy2.isInside(vertex1)) {
+            d = 0;
+            point1 = point2 = hierarchy1.m_vertices[0];
+        }
+    }
+    return d;
+}
+
+///
+/// \brief Return the depth of the deepest vertex of a mesh inside the other one
+///
+double penetrationOfMeshes(
+    const rigidbody::MeshHierarchy& hierarchy1,
+    const rigidbody::MeshHierarchy& hierarchy2,
+    const RigidBodyDynamics::Math::Matrix3d& rotation,
+    const RigidBodyDynamics::Math::Vector3d& translation)
+{
+    return std::max(hierarchy1.depth(hierarchy2, rotation, translation),
+                    hierarchy2.depth(hierarchy1, rotation.transpose(), -rotation.transpose() * translation));
+}
+}
+
+rigidbody::MeshCollisions::MeshCollisions(
+    rigidbody::Joints& model,
+    size_t nbThreads) :
+    m_hierarchies(std::make_shared<std::vector<std::shared_ptr<rigidbody::MeshHierarchy>>>()),
+    m_jcs(std::make_shared<std::vector<utils::RotoTrans>>()),
+    m_pairs(std::make_shared<std::vector<std::pair<size_t, size_t>>>()),
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads))
+{
+    for (size_t i=0; i<model.nbSegment(); ++i) {
+        const rigidbody::Mesh& mesh(model.mesh(i));
+        if (mesh.faces().empty()) {
+            m_hierarchies->push_back(nullptr);
+        } else {
+            m_hierarchies->push_back(std::make_shared<rigidbody::MeshHierarchy>(mesh));
+        }
+        m_jcs->push_back(utils::RotoTrans());
+    }
+
+    // The shallow copies share the segments but not the kinematics computed by RBDL
+    m_models = std::make_shared<utils::ThreadLocal<rigidbody::Joints>>(*m_pool, [&model](size_t) {
+        return std::make_shared<rigidbody::Joints>(model);
+    });
+}
+
+rigidbody::MeshCollisions::~MeshCollisions()
+{
+
+}
+
+size_t rigidbody::MeshCollisions::nbThreads() const
+{
+    return m_pool->nbThreads();
+}
+
+size_t rigidbody::MeshCollisions::nbMeshes() const
+{
+    size_t nbMeshes(0);
+    for (const auto& hierarchy : *m_hierarchies) {
+        if (hierarchy) {
+            ++nbMeshes;
+        }
+    }
+    return nbMeshes;
+}
+
+bool rigidbody::MeshCollisions::hasMesh(
+    size_t segment) const
+{
+    utils::Error::check(segment < m_hierarchies->size(), "Segment index out of range");
+    return (*m_hierarchies)[segment] != nullptr;
+}
+
+void rigidbody::MeshCollisions::addPair(
+    size_t segment1,
+    size_t segment2)
+{
+    utils::Error::check(segment1 != segment2, "A pair must be made of two different segments");
+    hierarchy(segment1);
+    hierarchy(segment2);
+    m_pairs->push_back(std::make_pair(segment1, segment2));
+}
+
+void rigidbody::MeshCollisions::addPair(
+    const utils::String& segment1,
+    const utils::String& segment2)
+{
+    const rigidbody::Joints& model((*m_models)[0]);
+    int idx1(model.getBodyBiorbdId(segment1));
+    int idx2(model.getBodyBiorbdId(segment2));
+    utils::Error::check(idx1 >= 0, segment1 + " is not a segment of the model");
+    utils::Error::check(idx2 >= 0, segment2 + " is not a segment of the model");
+    addPair(static_cast<size_t>(idx1), static_cast<size_t>(idx2));
+}
+
+size_t rigidbody::MeshCollisions::nbPairs() const
+{
+    return m_pairs->size();
+}
+
+const std::pair<size_t, size_t>& rigidbody::MeshCollisions::pair(
+    size_t idx) const
+{
+    utils::Error::check(idx < m_pairs->size(), "Pair index out of range");
+    return (*m_pairs)[idx];
+}
+
+void rigidbody::MeshCollisions::updateTransforms(
+    const std::vector<utils::RotoTrans>& jcs)
+{
+    utils::Error::check(jcs.size() == m_jcs->size(),
+                        "The number of reference frames must be the number of segments");
+    *m_jcs = jcs;
+}
+
+void rigidbody::MeshCollisions::updateKinematics(
+    rigidbody::Joints& model,
+    const rigidbody::GeneralizedCoordinates& Q)
+{
+    updateTransforms(model.allGlobalJCS(Q, true));
+}
+
+std::vector<std::pair<size_t, size_t>> rigidbody::MeshCollisions::broadPhase(
+    double margin) const
+{
+    // The box of each mesh in the global reference frame
+    std::vector<size_t> segments;
+    std::vector<RigidBodyDynamics::Math::Vector3d> centers, halfSizes;
+    for (size_t i=0; i<m_hierarchies->size(); ++i) {
+        if (!(*m_hierarchies)[i]) {
+            continue;
+        }
+        const rigidbody::MeshHierarchy::Node& root((*m_hierarchies)[i]->m_nodes[0]);
+        const utils::RotoTrans& jcs((*m_jcs)[i]);
+        RigidBodyDynamics::Math::Matrix3d rotation(jcs.block<3, 3>(0, 0));
+        segments.push_back(i);
+        centers.push_back(rotation * root.m_center + jcs.block<3, 1>(0, 3));
+        halfSizes.push_back(rotation.cwiseAbs() * root.m_halfSize);
+    }
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i=0; i<segments.size(); ++i) {
+        for (size_t j=i+1; j<segments.size(); ++j) {
+            if (((centers[i] - centers[j]).cwiseAbs() - halfSizes[i] - halfSizes[j]).maxCoeff() <= margin) {
+                pairs.push_back(std::make_pair(segments[i], segments[j]));
+            }
+        }
+    }
+    return pairs;
+}
+
+double rigidbody::MeshCollisions::distance(
+    size_t segment1,
+    size_t segment2,
+    utils::Vector3d* point1,
+    utils::Vector3d* point2,
+    double maxDistance) const
+{
+    const rigidbody::MeshHierarchy& hierarchy1(hierarchy(segment1));
+    const rigidbody::MeshHierarchy& hierarchy2(hierarchy(segment2));
+    const utils::RotoTrans& jcs1((*m_jcs)[segment1]);
+    RigidBodyDynamics::Math::Matrix3d rotation;
+    RigidBodyDynamics::Math::Vector3d translation, p1, p2;
+    relativeTransform(jcs1, (*m_jcs)[segment2], rotation, translation);
+
+    double d(distanceOfMeshes(hierarchy1, hierarchy2, rotation, translation, maxDistance, p1, p2));
+    if (d < maxDistance) {
+        RigidBodyDynamics::Math::Matrix3d rotation1(jcs1.block<3, 3>(0, 0));
+        if (point1) {
+            *point1 = rotation1 * p1 + jcs1.block<3, 1>(0, 3);
+        }
+        if (point2) {
+            *point2 = rotation1 * p2 + jcs1.block<3, 1>(0, 3);
+        }
+    }
+    return d;
+}
+
+double rigidbody::MeshCollisions::penetration(
+    size_t segment1,
+    size_t segment2) const
+{
+    const rigidbody::MeshHierarchy& hierarchy1(hierarchy(segment1));
+    const rigidbody::MeshHierarchy& hierarchy2(hierarchy(segment2));
+    RigidBodyDynamics::Math::Matrix3d rotation;
+    RigidBodyDynamics::Math::Vector3d translation;
+    relativeTransform((*m_jcs)[segment1], (*m_jcs)[segment2], rotation, translation);
+    return penetrationOfMeshes(hierarchy1, hierarchy2, rotation, translation);
+}
+
+void rigidbody::MeshCollisions::evaluatePairs(
+    std::vector<double>& distances,
+    std::vector<double>* penetrations,
+    double maxDistance) const
+{
+    distances.resize(m_pairs->size());
+    if (penetrations) {
+        penetrations->resize(m_pairs->size());
+    }
+    evaluatePairs(*m_jcs, distances.data(), penetrations ? penetrations->data() : nullptr, maxDistance);
+}
+
+void rigidbody::MeshCollisions::evaluateTrajectory(
+    const std::vector<rigidbody::GeneralizedCoordinates>& Q,
+    std::vector<std::vector<double>>& distances,
+    std::vector<std::vector<double>>* penetrations,
+    double maxDistance)
+{
+    distances.assign(Q.size(), std::vector<double>(m_pairs->size()));
+    if (penetrations) {
+        penetrations->assign(Q.size(), std::vector<double>(m_pairs->size()));
+    }
+
+    // Only the kinematics is computed for each frame, the hierarchies are shared by the threads
+    m_pool->parallelFor(Q.size(), [&](size_t frame, size_t thread) {
+        rigidbody::Joints& model((*m_models)[thread]);
+        evaluatePairs(model.allGlobalJCS(Q[frame], true), distances[frame].data(),
+                      penetrations ? (*penetrations)[frame].data() : nullptr, maxDistance);
+    });
+}
+
+const rigidbody::MeshHierarchy& rigidbody::MeshCollisions::hierarchy(
+    size_t segment) const
+{
+    utils::Error::check(segment < m_hierarchies->size(), "Segment index out of range");
+    utils::Error::check((*m_hierarchies)[segment] != nullptr,
+                        "The segment has no mesh with faces");
+    return *(*m_hierarchies)[segment];
+}
+
+void rigidbody::MeshCollisions::evaluatePairs(
+    const std::vector<utils::RotoTrans>& jcs,
+    double* distances,
+    double* penetrations,
+    double maxDistance) const
+{
+    RigidBodyDynamics::Math::Matrix3d rotation;
+    RigidBodyDynamics::Math::Vector3d translation, p1, p2;
+    for (size_t i=0; i<m_pairs->size(); ++i) {
+        const rigidbody::MeshHierarchy& hierarchy1(*(*m_hierarchies)[(*m_pairs)[i].first]);
+        const rigidbody::MeshHierarchy& hierarchy2(*(*m_hierarchies)[(*m_pairs)[i].second]);
+        relativeTransform(jcs[(*m_pairs)[i].first], jcs[(*m_pairs)[i].second], rotation, translation);
+        distances[i] = distanceOfMeshes(hierarchy1, hierarchy2, rotation, translation, maxDistance, p1, p2);
+        if (penetrations) {
+            // Meshes apart from each other cannot penetrate
+            penetrations[i] = distances[i] > 0 ? 0 :
+                              penetrationOfMeshes(hierarchy1, hierarchy2, rotation, translation);
+        }
+    }
+}
+#endif
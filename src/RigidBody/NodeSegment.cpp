@@ -2,6 +2,7 @@
 #include "RigidBody/NodeSegment.h"
 
 #include "Utils/Error.h"
+#include "Utils/MemoryFootprint.h"
 
 using namespace BIORBD_NAMESPACE;
 
@@ -247,3 +248,14 @@ utils::String rigidbody::NodeSegment::axesToRemoveAsString() const
     }
     return axes;
 }
+
+void rigidbody::NodeSegment::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    utils::Node::memoryFootprint(footprint);
+    footprint.add(m_axesRemoved);
+    footprint.add(m_nbAxesToRemove);
+    footprint.add(m_technical);
+    footprint.add(m_anatomical);
+    footprint.add(m_id);
+}
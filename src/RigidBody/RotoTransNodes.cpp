@@ -14,7 +14,8 @@
 using namespace BIORBD_NAMESPACE;
 
 rigidbody::RotoTransNodes::RotoTransNodes() :
-    m_RTs(std::make_shared<std::vector<utils::RotoTransNode>>())
+    m_RTs(std::make_shared<std::vector<utils::RotoTransNode>>()),
+    m_RTsBodyId(std::make_shared<std::vector<unsigned int>>())
 {
     //ctor
 }
@@ -23,6 +24,7 @@ rigidbody::RotoTransNodes::RotoTransNodes(const
         rigidbody::RotoTransNodes &other)
 {
     m_RTs = other.m_RTs;
+    m_RTsBodyId = other.m_RTsBodyId;
 }
 
 rigidbody::RotoTransNodes::~RotoTransNodes()
@@ -45,6 +47,7 @@ void rigidbody::RotoTransNodes::DeepCopy(const
     for (size_t i=0; i<other.m_RTs->size(); ++i) {
         (*m_RTs)[i] = (*other.m_RTs)[i].DeepCopy();
     }
+    m_RTsBodyId->clear();
 }
 
 void rigidbody::RotoTransNodes::addRT()
@@ -130,10 +133,8 @@ utils::RotoTransNode rigidbody::RotoTransNodes::RT(
         model.UpdateKinematicsCustom (&Q);
     }
 
-    utils::RotoTransNode node = RT(idx);
-    size_t id = static_cast<size_t>(model.getBodyBiorbdId(node.parent()));
-
-    return model.globalJCS(id) * node;
+    const utils::RotoTransNode& node(RT(idx));
+    return model.globalJCS(static_cast<size_t>(model.getBodyBiorbdId(node.parent()))) * node;
 }
 
 std::vector<utils::RotoTransNode>
@@ -175,9 +176,9 @@ rigidbody::RotoTransNodes::RTsJacobian(
 
     for (size_t idx=0; idx<nbRTs(); ++idx) {
         // Actual marker
-        utils::RotoTransNode node = RT(idx);
+        const utils::RotoTransNode& node(RT(idx));
 
-        size_t id = model.GetBodyId(node.parent().c_str());
+        unsigned int id(RTsBodyId()[idx]);
         utils::Matrix G_tp(utils::Matrix::Zero(9,model.dof_count));
 
         // Calculate the Jacobian of this Tag
@@ -204,4 +205,18 @@ std::vector<utils::String> rigidbody::RotoTransNodes::RTsNames()
 
 void rigidbody::RotoTransNodes::clear() {
     m_RTs->clear();
+    m_RTsBodyId->clear();
+}
+
+const std::vector<unsigned int>& rigidbody::RotoTransNodes::RTsBodyId()
+{
+    if (m_RTsBodyId->size() != nbRTs()) {
+        // Assuming that this is also a Joints type (via BiorbdModel)
+        rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+        m_RTsBodyId->clear();
+        for (size_t i=0; i<nbRTs(); ++i) {
+            m_RTsBodyId->push_back(static_cast<unsigned int>(model.getBodyRbdlId(RT(i).parent())));
+        }
+    }
+    return *m_RTsBodyId;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <limits.h>
 #include "Utils/String.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Error.h"
 #include "Utils/Matrix3d.h"
 #include "Utils/Vector3d.h"
@@ -18,6 +19,8 @@ using namespace BIORBD_NAMESPACE;
 rigidbody::Segment::Segment() :
     utils::Node(),
     m_idxInModel(std::make_shared<int>(-1)),
+    m_firstDofIndex(std::make_shared<int>(-1)),
+    m_lastDofIndex(std::make_shared<int>(-1)),
     m_cor(std::make_shared<RigidBodyDynamics::Math::SpatialTransform>()),
     m_seqT(std::make_shared<utils::String>()),
     m_seqR(std::make_shared<utils::String>()),
@@ -62,6 +65,8 @@ rigidbody::Segment::Segment(
 
     utils::Node(name, parentName),
     m_idxInModel(std::make_shared<int>(-1)),
+    m_firstDofIndex(std::make_shared<int>(-1)),
+    m_lastDofIndex(std::make_shared<int>(-1)),
     m_cor(std::make_shared<RigidBodyDynamics::Math::SpatialTransform>(cor)),
     m_seqT(std::make_shared<utils::String>(seqT)),
     m_seqR(std::make_shared<utils::String>(seqR)),
@@ -110,6 +115,8 @@ rigidbody::Segment::Segment(
 
     utils::Node(name, parentName),
     m_idxInModel(std::make_shared<int>(-1)),
+    m_firstDofIndex(std::make_shared<int>(-1)),
+    m_lastDofIndex(std::make_shared<int>(-1)),
     m_cor(std::make_shared<RigidBodyDynamics::Math::SpatialTransform>(cor)),
     m_seqT(std::make_shared<utils::String>()),
     m_seqR(std::make_shared<utils::String>(seqR)),
@@ -153,6 +160,8 @@ void rigidbody::Segment::DeepCopy(const
 {
     utils::Node::DeepCopy(other);
     *m_idxInModel = *other.m_idxInModel;
+    *m_firstDofIndex = *other.m_firstDofIndex;
+    *m_lastDofIndex = *other.m_lastDofIndex;
     *m_cor = *other.m_cor;
     *m_seqT = *other.m_seqT;
     *m_seqR = *other.m_seqR;
@@ -299,14 +308,80 @@ void rigidbody::Segment::updateCharacteristics(
 {
 
     *m_characteristics = characteristics.DeepCopy();
-    RigidBodyDynamics::Math::SpatialRigidBodyInertia rbi =
-        RigidBodyDynamics::Math::SpatialRigidBodyInertia::createFromMassComInertiaC (
-            m_characteristics->mMass,
-            m_characteristics->mCenterOfMass,
-            m_characteristics->mInertia);
+    updateJoinedBody(model);
+}
 
-    model.Ic[*m_idxInModel] = rbi;
-    model.I[*m_idxInModel] = rbi;
+void rigidbody::Segment::updateInertia(
+    rigidbody::Joints& model,
+    const utils::Scalar& mass,
+    const utils::Vector3d& com,
+    const utils::Matrix3d& inertia)
+{
+    m_characteristics->setMass(mass);
+    m_characteristics->setCoM(com);
+    m_characteristics->setInertia(inertia);
+    updateJoinedBody(model);
+}
+
+void rigidbody::Segment::updateJoinedBody(
+    rigidbody::Joints& model) const
+{
+    // A segment without DoF is a fixed body of RBDL, joined to the body of its closest parent with a DoF
+    unsigned int movableId(static_cast<unsigned int>(id()));
+    if (model.IsFixedBodyId(movableId)) {
+        RigidBodyDynamics::FixedBody& fixedBody(model.mFixedBodies[movableId - model.fixed_body_discriminator]);
+        fixedBody.mMass = m_characteristics->mMass;
+        fixedBody.mCenterOfMass = m_characteristics->mCenterOfMass;
+        fixedBody.mInertia = m_characteristics->mInertia;
+        movableId = fixedBody.mMovableParent;
+    }
+
+    // Sum the segment of the body and the segments fixed to it in the frame of the body, the inertia
+    // being summed at the origin of that frame
+    utils::Scalar mass(0);
+    RigidBodyDynamics::Math::Vector3d massCoM(RigidBodyDynamics::Math::Vector3d::Zero());
+    RigidBodyDynamics::Math::Matrix3d inertia(RigidBodyDynamics::Math::Matrix3d::Zero());
+    for (const auto& segment : model.segments()) {
+        unsigned int segmentId(static_cast<unsigned int>(segment.id()));
+        RigidBodyDynamics::Math::Matrix3d E(RigidBodyDynamics::Math::Matrix3d::Identity());
+        RigidBodyDynamics::Math::Vector3d r(RigidBodyDynamics::Math::Vector3d::Zero());
+        if (model.IsFixedBodyId(segmentId)) {
+            const RigidBodyDynamics::FixedBody& fixedBody(model.mFixedBodies[segmentId - model.fixed_body_discriminator]);
+            if (fixedBody.mMovableParent != movableId) {
+                continue;
+            }
+            E = fixedBody.mParentTransform.E;
+            r = fixedBody.mParentTransform.r;
+        } else if (segmentId != movableId) {
+            continue;
+        }
+        const rigidbody::SegmentCharacteristics& characteristics(*segment.m_characteristics);
+        RigidBodyDynamics::Math::Vector3d com(E.transpose() * characteristics.mCenterOfMass + r);
+        mass += characteristics.mMass;
+        massCoM += characteristics.mMass * com;
+        inertia += E.transpose() * characteristics.mInertia * E
+                   + characteristics.mMass * (com.dot(com) * RigidBodyDynamics::Math::Matrix3d::Identity()
+                                              - com * com.transpose());
+    }
+
+    // Move the inertia back to the center of mass of the joined body
+    RigidBodyDynamics::Math::Vector3d com(RigidBodyDynamics::Math::Vector3d::Zero());
+#ifdef BIORBD_USE_CASADI_MATH
+    com = massCoM / mass;
+#else
+    if (mass != 0) {
+        com = massCoM / mass;
+    }
+#endif
+    inertia -= mass * (com.dot(com) * RigidBodyDynamics::Math::Matrix3d::Identity() - com * com.transpose());
+
+    RigidBodyDynamics::Math::SpatialRigidBodyInertia rbi =
+        RigidBodyDynamics::Math::SpatialRigidBodyInertia::createFromMassComInertiaC (mass, com, inertia);
+    model.Ic[movableId] = rbi;
+    model.I[movableId] = rbi;
+    model.mBodies[movableId].mMass = mass;
+    model.mBodies[movableId].mCenterOfMass = com;
+    model.mBodies[movableId].mInertia = inertia;
 }
 
 const rigidbody::SegmentCharacteristics&
@@ -533,7 +608,7 @@ void rigidbody::Segment::setJoints(
         m_idxDof->resize(*m_nbDof);
     }
 
-    unsigned int parent_id(model.GetBodyId(parent().c_str()));
+    unsigned int parent_id(static_cast<unsigned int>(model.getBodyRbdlId(parent())));
 
     if (parent_id == std::numeric_limits<unsigned int>::max()) {
         parent_id = 0;
@@ -555,6 +630,20 @@ void rigidbody::Segment::setJoints(
                 );
     }
     *m_idxInModel = static_cast<int>(model.I.size() - 1);
+
+    // The segments are added in the order of the generalized coordinates, so the dofs of this
+    // segment follow the ones already in the model. Without dof, use the ones of the parent
+    if (*m_nbDof != 0) {
+        *m_firstDofIndex = static_cast<int>(model.nbDof());
+        *m_lastDofIndex = static_cast<int>(model.nbDof() + *m_nbDof - 1);
+    } else {
+        int parentIdx(model.getBodyBiorbdId(parent()));
+        if (parentIdx >= 0) {
+            const rigidbody::Segment& parentSegment(model.segment(static_cast<size_t>(parentIdx)));
+            *m_firstDofIndex = *parentSegment.m_firstDofIndex;
+            *m_lastDofIndex = *parentSegment.m_lastDofIndex;
+        }
+    }
 }
 
 size_t rigidbody::Segment::getDofIdx(
@@ -600,24 +689,62 @@ const rigidbody::Segment& rigidbody::Segment::findFirstSegmentWithDof(
 size_t rigidbody::Segment::getFirstDofIndexInGeneralizedCoordinates(
     const rigidbody::Joints& model) const 
 {
-    const utils::String toCompare(findFirstSegmentWithDof(model).name());
-
-    // Start at root and descend the Generalized Coordinate vector until we get to the current segment
-    size_t dofCount(0); // Start 
-    for (int i = 0; i < static_cast<int>(model.nbSegment()); ++i) {
-        const rigidbody::Segment& segment(model.segment(i));
-
-        if (!segment.name().compare(toCompare)) return dofCount;
-        
-        dofCount += segment.nbDof();
+    if (*m_firstDofIndex < 0) {
+        // Raise the proper error
+        findFirstSegmentWithDof(model);
     }
-
-    throw std::runtime_error("Segment " + name() + " not found in the model");
+    return static_cast<size_t>(*m_firstDofIndex);
 }
 
 
 size_t rigidbody::Segment::getLastDofIndexInGeneralizedCoordinates(
     const rigidbody::Joints& model) const
 {
-    return getFirstDofIndexInGeneralizedCoordinates(model) + findFirstSegmentWithDof(model).nbDof() - 1;
+    if (*m_lastDofIndex < 0) {
+        // Raise the proper error
+        findFirstSegmentWithDof(model);
+    }
+    return static_cast<size_t>(*m_lastDofIndex);
+}
+
+void rigidbody::Segment::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    utils::Node::memoryFootprint(footprint);
+    footprint.add(m_idxInModel);
+    footprint.add(m_firstDofIndex);
+    footprint.add(m_lastDofIndex);
+    footprint.add(m_cor);
+    footprint.add(m_seqT);
+    footprint.add(m_seqR);
+    footprint.add(m_QRanges);
+    footprint.add(m_QDotRanges);
+    footprint.add(m_QDDotRanges);
+    footprint.add(m_nbDof);
+    footprint.add(m_nbQdot);
+    footprint.add(m_nbQddot);
+    footprint.add(m_nbDofTrue);
+    footprint.add(m_nbDofTrueOutside);
+    footprint.add(m_nbDofTrans);
+    footprint.add(m_nbDofRot);
+    footprint.add(m_nbDofQuat);
+    footprint.add(m_isQuaternion);
+    if (footprint.add(m_dof)) {
+        for (auto& dof : *m_dof) {
+            footprint.addHeap(dof.mDoFCount * sizeof(RigidBodyDynamics::Math::SpatialVector));
+        }
+    }
+    footprint.add(m_idxDof);
+    footprint.add(m_sequenceTrans);
+    footprint.add(m_sequenceRot);
+    footprint.add(m_nameDof);
+    footprint.add(m_dofPosition);
+    if (footprint.add(m_characteristics)) {
+        m_characteristics->memoryFootprint(footprint);
+    }
+    if (footprint.add(m_dofCharacteristics)) {
+        for (auto& characteristics : *m_dofCharacteristics) {
+            characteristics.memoryFootprint(footprint);
+        }
+    }
 }
@@ -2,6 +2,7 @@
 #include "RigidBody/SegmentCharacteristics.h"
 
 #include "Utils/Scalar.h"
+#include "Utils/MemoryFootprint.h"
 #include "Utils/Vector3d.h"
 #include "Utils/Matrix3d.h"
 #include "RigidBody/MeshFace.h"
@@ -103,3 +104,12 @@ void rigidbody::SegmentCharacteristics::setInertia(
 {
     mInertia = inertia;
 }
+
+void rigidbody::SegmentCharacteristics::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_length);
+    if (footprint.add(m_mesh)) {
+        m_mesh->memoryFootprint(footprint);
+    }
+}
@@ -0,0 +1,396 @@
+#define BIORBD_API_EXPORTS
+#include "RigidBody/SoftContactMesh.h"
+
+#ifndef BIORBD_USE_CASADI_MATH
+#include <array>
+#include <cmath>
+#include <map>
+#include "Utils/Error.h"
+#include "Utils/String.h"
+#include "Utils/SpatialVector.h"
+#include "RigidBody/Joints.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/Mesh.h"
+#include "RigidBody/MeshFace.h"
+#include "RigidBody/Terrain.h"
+
+using namespace BIORBD_NAMESPACE;
+
+rigidbody::SoftContactMesh::SoftContactMesh() :
+    rigidbody::SoftContactNode(),
+    m_points(std::make_shared<std::vector<utils::Vector3d>>()),
+    m_areas(std::make_shared<std::vector<double>>()),
+    m_boundingRadius(std::make_shared<double>(0)),
+    m_terrain(std::make_shared<std::shared_ptr<rigidbody::Terrain>>()),
+    m_stiffness(std::make_shared<utils::Scalar>(-1)),
+    m_damping(std::make_shared<utils::Scalar>(-1)),
+    m_muStatic(std::make_shared<utils::Scalar>(0.8)),
+    m_muDynamic(std::make_shared<utils::Scalar>(0.7)),
+    m_muViscous(std::make_shared<utils::Scalar>(0.5)),
+    m_transitionVelocity(std::make_shared<utils::Scalar>(0.01))
+{
+    setType();
+}
+
+rigidbody::SoftContactMesh::SoftContactMesh(
+        const rigidbody::SoftContactNode &other) :
+    rigidbody::SoftContactNode(other),
+    m_points(std::make_shared<std::vector<utils::Vector3d>>()),
+    m_areas(std::make_shared<std::vector<double>>()),
+    m_boundingRadius(std::make_shared<double>(0)),
+    m_terrain(std::make_shared<std::shared_ptr<rigidbody::Terrain>>()),
+    m_stiffness(std::make_shared<utils::Scalar>(-1)),
+    m_damping(std::make_shared<utils::Scalar>(-1)),
+    m_muStatic(std::make_shared<utils::Scalar>(0.8)),
+    m_muDynamic(std::make_shared<utils::Scalar>(0.7)),
+    m_muViscous(std::make_shared<utils::Scalar>(0.5)),
+    m_transitionVelocity(std::make_shared<utils::Scalar>(0.01))
+{
+    const rigidbody::SoftContactMesh& tp = dynamic_cast<const SoftContactMesh&>(other);
+    // The points are not modified once sampled so they are shared
+    m_points = tp.m_points;
+    m_areas = tp.m_areas;
+    *m_boundingRadius = *tp.m_boundingRadius;
+    *m_terrain = *tp.m_terrain;
+    *m_stiffness = *tp.m_stiffness;
+    *m_damping = *tp.m_damping;
+    *m_muStatic = *tp.m_muStatic;
+    *m_muDynamic = *tp.m_muDynamic;
+    *m_muViscous = *tp.m_muViscous;
+    *m_transitionVelocity = *tp.m_transitionVelocity;
+    setType();
+}
+
+rigidbody::SoftContactMesh::SoftContactMesh(
+        const rigidbody::Mesh &mesh,
+        double spacing,
+        const utils::Scalar &stiffness,
+        const utils::Scalar &damping,
+        const utils::Scalar &muStatic,
+        const utils::Scalar &muDynamic,
+        const utils::Scalar &muViscous,
+        const utils::String &name,
+        const utils::String &parentName,
+        int parentID) :
+    rigidbody::SoftContactNode(utils::Vector3d(0, 0, 0), name, parentName, parentID),
+    m_points(std::make_shared<std::vector<utils::Vector3d>>()),
+    m_areas(std::make_shared<std::vector<double>>()),
+    m_boundingRadius(std::make_shared<double>(0)),
+    m_terrain(std::make_shared<std::shared_ptr<rigidbody::Terrain>>()),
+    m_stiffness(std::make_shared<utils::Scalar>(stiffness)),
+    m_damping(std::make_shared<utils::Scalar>(damping)),
+    m_muStatic(std::make_shared<utils::Scalar>(muStatic)),
+    m_muDynamic(std::make_shared<utils::Scalar>(muDynamic)),
+    m_muViscous(std::make_shared<utils::Scalar>(muViscous)),
+    m_transitionVelocity(std::make_shared<utils::Scalar>(0.01))
+{
+    utils::Error::check(mesh.nbVertex() > 0, "The mesh of the soft contact has no vertex");
+    utils::Error::check(spacing >= 0, "The spacing of the soft contact points must be positive");
+
+    // Each vertex stands for a third of the area of the triangles around it (the faces with more
+    // than 3 vertices are cut in fans of triangles). Without faces, every vertex has a unit area
+    std::vector<double> vertexAreas(mesh.nbVertex(), mesh.faces().empty() ? 1. : 0.);
+    for (const auto& meshFace : mesh.faces()) {
+        rigidbody::MeshFace face(meshFace);
+        std::vector<int> vertices(face.face());
+        for (int vertex : vertices) {
+            utils::Error::check(vertex >= 0 && static_cast<size_t>(vertex) < mesh.nbVertex(),
+                                "A face of the mesh refers to a vertex that does not exist");
+        }
+        for (size_t j=2; j<vertices.size(); ++j) {
+            const utils::Vector3d& p0(mesh.point(static_cast<size_t>(vertices[0])));
+            double area((mesh.point(static_cast<size_t>(vertices[j-1])) - p0).cross(
+                            mesh.point(static_cast<size_t>(vertices[j])) - p0).norm() / 2);
+            vertexAreas[static_cast<size_t>(vertices[0])] += area / 3;
+            vertexAreas[static_cast<size_t>(vertices[j-1])] += area / 3;
+            vertexAreas[static_cast<size_t>(vertices[j])] += area / 3;
+        }
+    }
+
+    // The vertices that fall in the same cell are merged at their area-weighted centroid
+    std::map<std::array<long long, 3>, size_t> cells;
+    for (size_t i=0; i<mesh.nbVertex(); ++i) {
+        if (vertexAreas[i] <= 0) {
+            continue;
+        }
+        const utils::Vector3d& vertex(mesh.point(i));
+        if (spacing > 0) {
+            std::array<long long, 3> cell = {{
+                    static_cast<long long>(std::floor(vertex[0] / spacing)),
+                    static_cast<long long>(std::floor(vertex[1] / spacing)),
+                    static_cast<long long>(std::floor(vertex[2] / spacing))
+                }};
+            auto inserted(cells.insert(std::make_pair(cell, m_points->size())));
+            if (!inserted.second) {
+                size_t idx(inserted.first->second);
+                (*m_points)[idx] += vertexAreas[i] * vertex;
+                (*m_areas)[idx] += vertexAreas[i];
+                continue;
+            }
+        }
+        m_points->push_back(vertexAreas[i] * vertex);
+        m_areas->push_back(vertexAreas[i]);
+    }
+    utils::Error::check(!m_points->empty(), "The mesh of the soft contact has no surface");
+
+    // The node is the center of the bounding box of the points
+    utils::Vector3d lower((*m_points)[0] / (*m_areas)[0]);
+    utils::Vector3d upper(lower);
+    for (size_t i=0; i<m_points->size(); ++i) {
+        (*m_points)[i] /= (*m_areas)[i];
+        lower = lower.cwiseMin((*m_points)[i]);
+        upper = upper.cwiseMax((*m_points)[i]);
+    }
+    utils::Vector3d center((lower + upper) / 2);
+    for (const auto& point : *m_points) {
+        *m_boundingRadius = std::max(*m_boundingRadius, (point - center).norm());
+    }
+    setPosition(center);
+    setType();
+}
+
+rigidbody::SoftContactMesh rigidbody::SoftContactMesh::DeepCopy() const
+{
+    rigidbody::SoftContactMesh copy;
+    copy.DeepCopy(*this);
+    return copy;
+}
+
+void rigidbody::SoftContactMesh::DeepCopy(
+        const rigidbody::SoftContactMesh &other)
+{
+    rigidbody::SoftContactNode::DeepCopy(other);
+    *m_points = *other.m_points;
+    *m_areas = *other.m_areas;
+    *m_boundingRadius = *other.m_boundingRadius;
+    *m_terrain = *other.m_terrain;
+    *m_stiffness = *other.m_stiffness;
+    *m_damping = *other.m_damping;
+    *m_muStatic = *other.m_muStatic;
+    *m_muDynamic = *other.m_muDynamic;
+    *m_muViscous = *other.m_muViscous;
+    *m_transitionVelocity = *other.m_transitionVelocity;
+}
+
+size_t rigidbody::SoftContactMesh::nbPoints() const
+{
+    return m_points->size();
+}
+
+const utils::Vector3d& rigidbody::SoftContactMesh::point(
+        size_t idx) const
+{
+    utils::Error::check(idx < nbPoints(), "Idx for point is too high");
+    return (*m_points)[idx];
+}
+
+double rigidbody::SoftContactMesh::area(
+        size_t idx) const
+{
+    utils::Error::check(idx < nbPoints(), "Idx for area is too high");
+    return (*m_areas)[idx];
+}
+
+double rigidbody::SoftContactMesh::boundingRadius() const
+{
+    return *m_boundingRadius;
+}
+
+void rigidbody::SoftContactMesh::setTerrain(
+        const std::shared_ptr<rigidbody::Terrain> &terrain)
+{
+    *m_terrain = terrain;
+}
+
+const std::shared_ptr<rigidbody::Terrain>& rigidbody::SoftContactMesh::terrain() const
+{
+    return *m_terrain;
+}
+
+void rigidbody::SoftContactMesh::setStiffness(
+        const utils::Scalar &stiffness)
+{
+    *m_stiffness = stiffness;
+}
+
+utils::Scalar rigidbody::SoftContactMesh::stiffness() const
+{
+    return *m_stiffness;
+}
+
+void rigidbody::SoftContactMesh::setDamping(
+        const utils::Scalar &damping)
+{
+    *m_damping = damping;
+}
+
+utils::Scalar rigidbody::SoftContactMesh::damping() const
+{
+    return *m_damping;
+}
+
+void rigidbody::SoftContactMesh::setMuStatic(
+        const utils::Scalar &muStatic)
+{
+    *m_muStatic = muStatic;
+}
+
+utils::Scalar rigidbody::SoftContactMesh::muStatic() const
+{
+    return *m_muStatic;
+}
+
+void rigidbody::SoftContactMesh::setMuDynamic(
+        const utils::Scalar &muDynamic)
+{
+    *m_muDynamic = muDynamic;
+}
+
+utils::Scalar rigidbody::SoftContactMesh::muDynamic() const
+{
+    return *m_muDynamic;
+}
+
+void rigidbody::SoftContactMesh::setMuViscous(
+        const utils::Scalar &muViscous)
+{
+    *m_muViscous = muViscous;
+}
+
+utils::Scalar rigidbody::SoftContactMesh::muViscous() const
+{
+    return *m_muViscous;
+}
+
+void rigidbody::SoftContactMesh::setTransitionVelocity(
+        const utils::Scalar &transitionVelocity)
+{
+    *m_transitionVelocity = transitionVelocity;
+}
+
+utils::Scalar rigidbody::SoftContactMesh::transitionVelocity() const
+{
+    return *m_transitionVelocity;
+}
+
+utils::SpatialVector rigidbody::SoftContactMesh::computeForceAtOrigin(
+        Joints &model,
+        const GeneralizedCoordinates &Q,
+        const GeneralizedVelocity &QDot,
+        bool updateKin)
+{
+    if (updateKin) {
+        model.UpdateKinematicsCustom(&Q, &QDot);
+    }
+    utils::SpatialVector out(0., 0., 0., 0., 0., 0.);
+
+    // The pose and the velocity of the segment are shared by all the points
+    unsigned int id(parentId() >= 0 ? static_cast<unsigned int>(parentId())
+                    : static_cast<unsigned int>(model.getBodyRbdlId(parent())));
+    utils::Vector3d origin(RigidBodyDynamics::CalcBodyToBaseCoordinates(
+                               model, Q, id, utils::Vector3d(0, 0, 0), false));
+    RigidBodyDynamics::Math::Matrix3d rotation(
+        RigidBodyDynamics::CalcBodyWorldOrientation(model, Q, id, false).transpose());
+
+    // Nothing to do if no point can reach the terrain
+    const std::shared_ptr<rigidbody::Terrain>& terrain(*m_terrain);
+    if (terrain && terrain->isAbove(rotation * *this + origin, *m_boundingRadius)) {
+        return out;
+    }
+
+    RigidBodyDynamics::Math::SpatialVector velocity(RigidBodyDynamics::CalcPointVelocity6D(
+                model, Q, QDot, id, utils::Vector3d(0, 0, 0), false));
+    utils::Vector3d angularVelocity(velocity.block(0, 0, 3, 1));
+    utils::Vector3d linearVelocity(velocity.block(3, 0, 3, 1));
+
+    double depth;
+    utils::Vector3d normal;
+    for (size_t i=0; i<m_points->size(); ++i) {
+        utils::Vector3d lever(rotation * (*m_points)[i]);
+        utils::Vector3d x(lever + origin);
+        if (!penetration(x, depth, normal)) {
+            continue;
+        }
+        utils::Vector3d force(pointForce(
+                                  linearVelocity + angularVelocity.cross(lever), (*m_areas)[i], depth, normal));
+        out.block(0, 0, 3, 1) += (x + depth * normal).cross(force);
+        out.block(3, 0, 3, 1) += force;
+    }
+    return out;
+}
+
+utils::Vector3d rigidbody::SoftContactMesh::computeForce(
+        const utils::Vector3d &x,
+        const utils::Vector3d &dx,
+        const utils::Vector3d &) const
+{
+    double depth;
+    utils::Vector3d normal;
+    if (m_points->empty() || !penetration(x, depth, normal)) {
+        return utils::Vector3d(0, 0, 0);
+    }
+    double meanArea(0);
+    for (double area : *m_areas) {
+        meanArea += area;
+    }
+    meanArea /= static_cast<double>(m_areas->size());
+    return pointForce(dx, meanArea, depth, normal);
+}
+
+utils::Vector3d rigidbody::SoftContactMesh::applicationPoint(
+        const utils::Vector3d &x) const
+{
+    double depth;
+    utils::Vector3d normal;
+    if (!penetration(x, depth, normal)) {
+        return x;
+    }
+    return x + depth * normal;
+}
+
+void rigidbody::SoftContactMesh::setType()
+{
+    *m_typeOfNode = utils::NODE_TYPE::SOFT_CONTACT_MESH;
+}
+
+bool rigidbody::SoftContactMesh::penetration(
+        const utils::Vector3d &x,
+        double &depth,
+        utils::Vector3d &normal) const
+{
+    if (*m_terrain) {
+        return (*m_terrain)->penetration(x, depth, normal);
+    }
+    const utils::Vector3d& plane(m_contactPlane->first);
+    double delta(-(x - plane).dot(m_contactPlane->second));
+    if (delta <= 0) {
+        return false;
+    }
+    depth = delta;
+    normal = m_contactPlane->second;
+    return true;
+}
+
+utils::Vector3d rigidbody::SoftContactMesh::pointForce(
+        const utils::Vector3d &dx,
+        double area,
+        double depth,
+        const utils::Vector3d &normal) const
+{
+    // Decomposition into normal and tangent velocities
+    double normalVelocity(dx.dot(normal));
+    utils::Vector3d tangentVelocity(dx - normalVelocity * normal);
+
+    // Elastic foundation with Hunt-Crossley's damping, the surface only pushes
+    double normalForce(*m_stiffness * area * depth * (1. - 1.5 * *m_damping * normalVelocity));
+    if (normalForce <= 0) {
+        return utils::Vector3d(0, 0, 0);
+    }
+
+    double tangentVelocityNorm(std::sqrt(tangentVelocity.squaredNorm() + 1e-5));
+    double forceFriction(frictionForce(normalForce, tangentVelocityNorm,
+                                       *m_muStatic, *m_muDynamic, *m_muViscous, *m_transitionVelocity));
+    return normalForce * normal - forceFriction / tangentVelocityNorm * tangentVelocity;
+}
+#endif
@@ -84,17 +84,15 @@ utils::SpatialVector rigidbody::SoftContactNode::computeForceAtOrigin(
     updateKin = false;
 #endif
 
-    unsigned int id = model.GetBodyId(parent().c_str());
+    // The parent is resolved when the contact is read, only look it up for contacts declared without it
+    unsigned int id(parentId() >= 0 ? static_cast<unsigned int>(parentId())
+                    : static_cast<unsigned int>(model.getBodyRbdlId(parent())));
     utils::Vector3d x(RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q, id, *this, updateKin));
     utils::Vector3d dx(rigidbody::NodeSegment(RigidBodyDynamics::CalcPointVelocity(model, Q, QDot, id, *this, updateKin)));
     utils::Vector3d angularVelocity(RigidBodyDynamics::CalcPointVelocity6D(model, Q, QDot, id, utils::Vector3d(0, 0, 0), updateKin).block(0, 0, 3, 1));
 
     utils::Vector3d force(computeForce(x, dx, angularVelocity));
 
-    // Transport to CoM (Bour's formula)
-    const utils::Vector3d& CoM(model.segment(parent()).characteristics().CoM());
-    utils::Vector3d CoMinGlobal(RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q, id, CoM, updateKin));
-
     // Find the application point of the force
     utils::SpatialVector out(0., 0., 0., 0., 0., 0.);
     out.block(0, 0, 3, 1) = force.cross(- applicationPoint(x));
@@ -102,6 +100,21 @@ utils::SpatialVector rigidbody::SoftContactNode::computeForceAtOrigin(
     return out;
 }
 
+utils::Scalar rigidbody::SoftContactNode::frictionForce(
+        const utils::Scalar &normalForce,
+        const utils::Scalar &tangentVelocityNorm,
+        const utils::Scalar &muStatic,
+        const utils::Scalar &muDynamic,
+        const utils::Scalar &muViscous,
+        const utils::Scalar &transitionVelocity)
+{
+    utils::Scalar frictionVelocity = tangentVelocityNorm / transitionVelocity;
+    return normalForce * muDynamic * std::tanh(4. * frictionVelocity)
+            + normalForce * (muStatic - muDynamic) * frictionVelocity
+                   / ((0.25 * frictionVelocity * frictionVelocity + 0.75) * (0.25 * frictionVelocity * frictionVelocity + 0.75))
+            + normalForce * muViscous * tangentVelocityNorm;
+}
+
 void rigidbody::SoftContactNode::setType()
 {
     *m_typeOfNode = utils::NODE_TYPE::SOFT_CONTACT;
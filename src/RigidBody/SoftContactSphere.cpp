@@ -257,13 +257,8 @@ utils::Vector3d rigidbody::SoftContactSphere::computeForce(
     utils::Scalar normalForce = fHC * fslope;
 
     utils::Scalar tangentVelocityNorm(std::sqrt(tangentVelocity.squaredNorm() + 1e-5));
-    utils::Scalar frictionVelocity = tangentVelocityNorm / *m_transitionVelocity;
-
-    // from Peter Brown 2017
-    utils::Scalar forceFriction = normalForce * *m_muDynamic * std::tanh(4. * frictionVelocity)
-            + normalForce * (*m_muStatic - *m_muDynamic) * frictionVelocity
-                   / ((0.25 * frictionVelocity * frictionVelocity + 0.75) * (0.25 * frictionVelocity * frictionVelocity + 0.75))
-            + normalForce * *m_muViscous * tangentVelocityNorm;
+    utils::Scalar forceFriction = frictionForce(normalForce, tangentVelocityNorm,
+            *m_muStatic, *m_muDynamic, *m_muViscous, *m_transitionVelocity);
 
     // Total Force
     return normalForce * normal + forceFriction * -tangentVelocity / tangentVelocityNorm;
@@ -2,8 +2,10 @@
 #include "RigidBody/SoftContacts.h"
 
 #include "Utils/String.h"
+#include "Utils/Matrix.h"
 #include "RigidBody/SoftContactNode.h"
 #include "RigidBody/SoftContactSphere.h"
+#include "RigidBody/SoftContactMesh.h"
 #include "RigidBody/Joints.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
@@ -16,7 +18,9 @@
 using namespace BIORBD_NAMESPACE;
 
 rigidbody::SoftContacts::SoftContacts():
-    m_softContacts(std::make_shared<std::vector<std::shared_ptr<SoftContactNode>>>())
+    m_softContacts(std::make_shared<std::vector<std::shared_ptr<SoftContactNode>>>()),
+    m_softContactsBodyId(std::make_shared<std::vector<unsigned int>>()),
+    m_softContactsSegmentIdx(std::make_shared<std::vector<size_t>>())
 {
 
 }
@@ -35,11 +39,18 @@ void rigidbody::SoftContacts::DeepCopy(
     for (size_t i=0; i<other.m_softContacts->size(); ++i) {
         if ((*other.m_softContacts)[i]->typeOfNode() == utils::NODE_TYPE::SOFT_CONTACT_SPHERE){
             (*m_softContacts)[i] = std::make_shared<rigidbody::SoftContactSphere>();
+#ifndef BIORBD_USE_CASADI_MATH
+        } else if ((*other.m_softContacts)[i]->typeOfNode() == utils::NODE_TYPE::SOFT_CONTACT_MESH){
+            (*m_softContacts)[i] = std::make_shared<rigidbody::SoftContactMesh>(
+                dynamic_cast<const rigidbody::SoftContactMesh&>(*(*other.m_softContacts)[i]).DeepCopy());
+#endif
         } else {
             utils::Error::raise("DeepCopy failed");
         }
         (*m_softContacts)[i]->DeepCopy(*((*other.m_softContacts)[i]));
     }
+    m_softContactsBodyId->clear();
+    m_softContactsSegmentIdx->clear();
 }
 
 utils::String rigidbody::SoftContacts::softContactName(
@@ -62,11 +73,27 @@ void rigidbody::SoftContacts::addSoftContact(
 {
     if (contact.typeOfNode() == utils::NODE_TYPE::SOFT_CONTACT_SPHERE) {
         m_softContacts->push_back(std::make_shared<rigidbody::SoftContactSphere>(contact));
+#ifndef BIORBD_USE_CASADI_MATH
+    } else if (contact.typeOfNode() == utils::NODE_TYPE::SOFT_CONTACT_MESH) {
+        m_softContacts->push_back(std::make_shared<rigidbody::SoftContactMesh>(contact));
+#endif
     } else {
         utils::Error::raise(utils::String("The ") + contact.typeOfNode() + " does not exist");
     }
 }
 
+#ifndef BIORBD_USE_CASADI_MATH
+void rigidbody::SoftContacts::setTerrain(
+        const std::shared_ptr<rigidbody::Terrain> &terrain)
+{
+    for (auto& contact : *m_softContacts) {
+        if (contact->typeOfNode() == utils::NODE_TYPE::SOFT_CONTACT_MESH) {
+            static_cast<rigidbody::SoftContactMesh&>(*contact).setTerrain(terrain);
+        }
+    }
+}
+#endif
+
 rigidbody::SoftContactNode& rigidbody::SoftContacts::softContact(
         size_t idx)
 {
@@ -84,7 +111,7 @@ rigidbody::NodeSegment rigidbody::SoftContacts::softContact(
 #endif
 
     const rigidbody::SoftContactNode& sc(softContact(idx));
-    unsigned int id = model.GetBodyId(sc.parent().c_str());
+    unsigned int id(softContactsBodyId()[idx]);
     return rigidbody::NodeSegment(RigidBodyDynamics::CalcBodyToBaseCoordinates(model, Q, id, sc, updateKin));
 }
 
@@ -102,6 +129,57 @@ std::vector<rigidbody::NodeSegment> rigidbody::SoftContacts::softContacts(
     return out;
 }
 
+const std::vector<unsigned int>& rigidbody::SoftContacts::softContactsBodyId()
+{
+    if (m_softContactsBodyId->size() != nbSoftContacts()) {
+        rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+        m_softContactsBodyId->clear();
+        for (size_t i=0; i<nbSoftContacts(); ++i) {
+            m_softContactsBodyId->push_back(
+                static_cast<unsigned int>(model.getBodyRbdlId(softContact(i).parent())));
+        }
+    }
+    return *m_softContactsBodyId;
+}
+
+const std::vector<size_t>& rigidbody::SoftContacts::softContactsSegmentIdx()
+{
+    if (m_softContactsSegmentIdx->size() != nbSoftContacts()) {
+        rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+        m_softContactsSegmentIdx->clear();
+        for (size_t i=0; i<nbSoftContacts(); ++i) {
+            m_softContactsSegmentIdx->push_back(
+                static_cast<size_t>(model.getBodyBiorbdId(softContact(i).parent())));
+        }
+    }
+    return *m_softContactsSegmentIdx;
+}
+
+void rigidbody::SoftContacts::softContactsInMatrix(
+        const rigidbody::GeneralizedCoordinates &Q,
+        utils::Matrix& positions,
+        bool updateKin)
+{
+    rigidbody::Joints &model = dynamic_cast<rigidbody::Joints &>(*this);
+#ifdef BIORBD_USE_CASADI_MATH
+    updateKin = true;
+#endif
+    if (updateKin) {
+        model.UpdateKinematicsCustom(&Q);
+    }
+
+    const std::vector<unsigned int>& bodyId(softContactsBodyId());
+    if (static_cast<size_t>(positions.rows()) != 3
+            || static_cast<size_t>(positions.cols()) != nbSoftContacts()) {
+        positions = utils::Matrix(3, nbSoftContacts());
+    }
+    for (size_t i=0; i<nbSoftContacts(); ++i) {
+        positions.block(0, static_cast<unsigned int>(i), 3, 1) =
+            RigidBodyDynamics::CalcBodyToBaseCoordinates(
+                model, Q, bodyId[i], *(*m_softContacts)[i], false);
+    }
+}
+
 rigidbody::NodeSegment rigidbody::SoftContacts::softContactVelocity(
             const rigidbody::GeneralizedCoordinates &Q,
             const rigidbody::GeneralizedVelocity &Qdot,
@@ -115,7 +193,7 @@ rigidbody::NodeSegment rigidbody::SoftContacts::softContactVelocity(
 #endif
 
     const rigidbody::SoftContactNode& sc(softContact(idx));
-    unsigned int id(model.GetBodyId(sc.parent().c_str()));
+    unsigned int id(softContactsBodyId()[idx]);
     // Calculate the velocity of the point
     return rigidbody::NodeSegment(
         RigidBodyDynamics::CalcPointVelocity(model, Q, Qdot, id, sc, updateKin)
@@ -137,7 +215,7 @@ rigidbody::NodeSegment rigidbody::SoftContacts::softContactAngularVelocity(
     const rigidbody::SoftContactNode& sc(softContact(idx));
 
     // Calculate the velocity of the point
-    unsigned int id(model.GetBodyId(sc.parent().c_str()));
+    unsigned int id(softContactsBodyId()[idx]);
     return rigidbody::NodeSegment(
         RigidBodyDynamics::CalcPointVelocity6D(model, Q, Qdot, id, sc, updateKin).block(0, 0, 3, 1)
     );
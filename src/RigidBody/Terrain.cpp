@@ -0,0 +1,11 @@
+#define BIORBD_API_EXPORTS
+#include "RigidBody/Terrain.h"
+
+using namespace BIORBD_NAMESPACE;
+
+#ifndef BIORBD_USE_CASADI_MATH
+rigidbody::Terrain::~Terrain()
+{
+
+}
+#endif
@@ -0,0 +1,102 @@
+#define BIORBD_API_EXPORTS
+#include "RigidBody/TerrainHeightfield.h"
+
+#ifndef BIORBD_USE_CASADI_MATH
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Utils/Error.h"
+#include "Utils/Matrix.h"
+#include "Utils/Vector3d.h"
+
+using namespace BIORBD_NAMESPACE;
+
+rigidbody::TerrainHeightfield::TerrainHeightfield(
+    double originX,
+    double originY,
+    double spacingX,
+    double spacingY,
+    const utils::Matrix& heights) :
+    m_heights(std::make_shared<utils::Matrix>(heights)),
+    m_originX(originX),
+    m_originY(originY),
+    m_spacingX(spacingX),
+    m_spacingY(spacingY),
+    m_maxHeight(0)
+{
+    utils::Error::check(spacingX > 0 && spacingY > 0, "The spacing of the height field must be positive");
+    utils::Error::check(heights.rows() >= 2 && heights.cols() >= 2,
+                        "The height field must have at least 2 nodes along each axis");
+    m_maxHeight = heights.maxCoeff();
+}
+
+double rigidbody::TerrainHeightfield::height(
+    double x,
+    double y) const
+{
+    unsigned int i, j;
+    double u, v;
+    if (!cell(x, y, i, j, u, v)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    const utils::Matrix& h(*m_heights);
+    return (1 - u) * (1 - v) * h(i, j) + u * (1 - v) * h(i+1, j)
+           + (1 - u) * v * h(i, j+1) + u * v * h(i+1, j+1);
+}
+
+bool rigidbody::TerrainHeightfield::penetration(
+    const utils::Vector3d& point,
+    double& depth,
+    utils::Vector3d& normal) const
+{
+    unsigned int i, j;
+    double u, v;
+    if (point[2] >= m_maxHeight || !cell(point[0], point[1], i, j, u, v)) {
+        return false;
+    }
+    const utils::Matrix& h(*m_heights);
+    double surface((1 - u) * (1 - v) * h(i, j) + u * (1 - v) * h(i+1, j)
+                   + (1 - u) * v * h(i, j+1) + u * v * h(i+1, j+1));
+    if (point[2] >= surface) {
+        return false;
+    }
+
+    // The slopes of the bilinear interpolation give the normal
+    double slopeX(((1 - v) * (h(i+1, j) - h(i, j)) + v * (h(i+1, j+1) - h(i, j+1))) / m_spacingX);
+    double slopeY(((1 - u) * (h(i, j+1) - h(i, j)) + u * (h(i+1, j+1) - h(i+1, j))) / m_spacingY);
+    normal = utils::Vector3d(-slopeX, -slopeY, 1).normalized();
+    depth = (surface - point[2]) * normal[2];
+    return true;
+}
+
+bool rigidbody::TerrainHeightfield::isAbove(
+    const utils::Vector3d& center,
+    double radius) const
+{
+    return center[2] - radius > m_maxHeight;
+}
+
+bool rigidbody::TerrainHeightfield::cell(
+    double x,
+    double y,
+    unsigned int& i,
+    unsigned int& j,
+    double& u,
+    double& v) const
+{
+    double gridX((x - m_originX) / m_spacingX);
+    double gridY((y - m_originY) / m_spacingY);
+    double lastX(static_cast<double>(m_heights->rows() - 1));
+    double lastY(static_cast<double>(m_heights->cols() - 1));
+    if (!(gridX >= 0 && gridX <= lastX && gridY >= 0 && gridY <= lastY)) {
+        return false;
+    }
+
+    // The last node belongs to the last cell
+    i = static_cast<unsigned int>(std::min(std::floor(gridX), lastX - 1));
+    j = static_cast<unsigned int>(std::min(std::floor(gridY), lastY - 1));
+    u = gridX - i;
+    v = gridY - j;
+    return true;
+}
+#endif
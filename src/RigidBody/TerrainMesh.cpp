@@ -0,0 +1,189 @@
+#define BIORBD_API_EXPORTS
+#include "RigidBody/TerrainMesh.h"
+
+#ifndef BIORBD_USE_CASADI_MATH
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Utils/Error.h"
+#include "Utils/Vector3d.h"
+#include "RigidBody/Mesh.h"
+#include "RigidBody/MeshFace.h"
+
+using namespace BIORBD_NAMESPACE;
+
+rigidbody::TerrainMesh::TerrainMesh(
+    const rigidbody::Mesh& mesh,
+    double cellSize) :
+    m_triangles(std::make_shared<std::vector<double>>()),
+    m_normals(std::make_shared<std::vector<double>>()),
+    m_cellStart(std::make_shared<std::vector<size_t>>()),
+    m_cellTriangles(std::make_shared<std::vector<size_t>>()),
+    m_originX(0),
+    m_originY(0),
+    m_cellSize(cellSize),
+    m_nbCellsX(1),
+    m_nbCellsY(1),
+    m_maxHeight(-std::numeric_limits<double>::infinity())
+{
+    utils::Error::check(cellSize >= 0, "The size of the cells of the terrain must be positive");
+
+    // The faces with more than 3 vertices are cut in fans of triangles, the vertical ones are dropped
+    double minX(std::numeric_limits<double>::infinity());
+    double minY(minX);
+    double maxX(-minX);
+    double maxY(-minX);
+    double sumOfSizes(0);
+    for (const auto& meshFace : mesh.faces()) {
+        rigidbody::MeshFace face(meshFace);
+        std::vector<int> vertices(face.face());
+        for (int vertex : vertices) {
+            utils::Error::check(vertex >= 0 && static_cast<size_t>(vertex) < mesh.nbVertex(),
+                                "A face of the mesh refers to a vertex that does not exist");
+        }
+        for (size_t j=2; j<vertices.size(); ++j) {
+            const utils::Vector3d& p0(mesh.point(static_cast<size_t>(vertices[0])));
+            const utils::Vector3d& p1(mesh.point(static_cast<size_t>(vertices[j-1])));
+            const utils::Vector3d& p2(mesh.point(static_cast<size_t>(vertices[j])));
+            utils::Vector3d normal((p1 - p0).cross(p2 - p0));
+            double norm(normal.norm());
+            if (norm == 0 || std::fabs(normal[2]) < 1e-6 * norm) {
+                continue;
+            }
+            normal /= normal[2] > 0 ? norm : -norm;
+            for (const utils::Vector3d* p : {&p0, &p1, &p2}) {
+                for (size_t k=0; k<3; ++k) {
+                    m_triangles->push_back((*p)[k]);
+                }
+                minX = std::min(minX, (*p)[0]);
+                minY = std::min(minY, (*p)[1]);
+                maxX = std::max(maxX, (*p)[0]);
+                maxY = std::max(maxY, (*p)[1]);
+                m_maxHeight = std::max(m_maxHeight, (*p)[2]);
+            }
+            for (size_t k=0; k<3; ++k) {
+                m_normals->push_back(normal[k]);
+            }
+            sumOfSizes += std::max({(p1 - p0).norm(), (p2 - p1).norm(), (p0 - p2).norm()});
+        }
+    }
+    utils::Error::check(nbTriangles() > 0, "The terrain mesh has no triangle facing up");
+
+    if (m_cellSize == 0) {
+        m_cellSize = sumOfSizes / static_cast<double>(nbTriangles());
+    }
+    m_originX = minX;
+    m_originY = minY;
+    m_nbCellsX = static_cast<size_t>(std::floor((maxX - minX) / m_cellSize)) + 1;
+    m_nbCellsY = static_cast<size_t>(std::floor((maxY - minY) / m_cellSize)) + 1;
+
+    // Sort the triangles in every cell their bounding box overlaps, counting them first
+    std::vector<size_t> bounds(4 * nbTriangles());
+    m_cellStart->assign(m_nbCellsX * m_nbCellsY + 1, 0);
+    for (size_t t=0; t<nbTriangles(); ++t) {
+        const double* p(&(*m_triangles)[9 * t]);
+        double lowX(std::min({p[0], p[3], p[6]})), highX(std::max({p[0], p[3], p[6]}));
+        double lowY(std::min({p[1], p[4], p[7]})), highY(std::max({p[1], p[4], p[7]}));
+        bounds[4*t] = std::min(static_cast<size_t>((lowX - m_originX) / m_cellSize), m_nbCellsX - 1);
+        bounds[4*t+1] = std::min(static_cast<size_t>((highX - m_originX) / m_cellSize), m_nbCellsX - 1);
+        bounds[4*t+2] = std::min(static_cast<size_t>((lowY - m_originY) / m_cellSize), m_nbCellsY - 1);
+        bounds[4*t+3] = std::min(static_cast<size_t>((highY - m_originY) / m_cellSize), m_nbCellsY - 1);
+        for (size_t i=bounds[4*t]; i<=bounds[4*t+1]; ++i) {
+            for (size_t j=bounds[4*t+2]; j<=bounds[4*t+3]; ++j) {
+                ++(*m_cellStart)[i * m_nbCellsY + j + 1];
+            }
+        }
+    }
+    for (size_t c=0; c<m_nbCellsX * m_nbCellsY; ++c) {
+        (*m_cellStart)[c + 1] += (*m_cellStart)[c];
+    }
+    m_cellTriangles->resize(m_cellStart->back());
+    std::vector<size_t> next(m_cellStart->begin(), m_cellStart->end() - 1);
+    for (size_t t=0; t<nbTriangles(); ++t) {
+        for (size_t i=bounds[4*t]; i<=bounds[4*t+1]; ++i) {
+            for (size_t j=bounds[4*t+2]; j<=bounds[4*t+3]; ++j) {
+                (*m_cellTriangles)[next[i * m_nbCellsY + j]++] = t;
+            }
+        }
+    }
+}
+
+size_t rigidbody::TerrainMesh::nbTriangles() const
+{
+    return m_triangles->size() / 9;
+}
+
+double rigidbody::TerrainMesh::height(
+    double x,
+    double y) const
+{
+    double z;
+    if (surface(x, y, z) == nbTriangles()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return z;
+}
+
+bool rigidbody::TerrainMesh::penetration(
+    const utils::Vector3d& point,
+    double& depth,
+    utils::Vector3d& normal) const
+{
+    if (point[2] >= m_maxHeight) {
+        return false;
+    }
+    double z;
+    size_t triangle(surface(point[0], point[1], z));
+    if (triangle == nbTriangles() || point[2] >= z) {
+        return false;
+    }
+    const double* n(&(*m_normals)[3 * triangle]);
+    normal = utils::Vector3d(n[0], n[1], n[2]);
+    depth = (z - point[2]) * n[2];
+    return true;
+}
+
+bool rigidbody::TerrainMesh::isAbove(
+    const utils::Vector3d& center,
+    double radius) const
+{
+    return center[2] - radius > m_maxHeight;
+}
+
+size_t rigidbody::TerrainMesh::surface(
+    double x,
+    double y,
+    double& surface) const
+{
+    double gridX((x - m_originX) / m_cellSize);
+    double gridY((y - m_originY) / m_cellSize);
+    if (!(gridX >= 0 && gridX < static_cast<double>(m_nbCellsX)
+            && gridY >= 0 && gridY < static_cast<double>(m_nbCellsY))) {
+        return nbTriangles();
+    }
+    size_t cell(static_cast<size_t>(gridX) * m_nbCellsY + static_cast<size_t>(gridY));
+
+    // Keep the highest of the triangles that contain the position in the XY plane
+    size_t highest(nbTriangles());
+    for (size_t k=(*m_cellStart)[cell]; k<(*m_cellStart)[cell + 1]; ++k) {
+        size_t t((*m_cellTriangles)[k]);
+        const double* p(&(*m_triangles)[9 * t]);
+        double e1x(p[3] - p[0]), e1y(p[4] - p[1]);
+        double e2x(p[6] - p[0]), e2y(p[7] - p[1]);
+        double dx(x - p[0]), dy(y - p[1]);
+        double det(e1x * e2y - e2x * e1y);
+        double u((dx * e2y - e2x * dy) / det);
+        double v((e1x * dy - dx * e1y) / det);
+        const double tolerance(1e-12);
+        if (u < -tolerance || v < -tolerance || u + v > 1 + tolerance) {
+            continue;
+        }
+        double z(p[2] + u * (p[5] - p[2]) + v * (p[8] - p[2]));
+        if (highest == nbTriangles() || z > surface) {
+            highest = t;
+            surface = z;
+        }
+    }
+    return highest;
+}
+#endif
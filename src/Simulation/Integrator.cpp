@@ -0,0 +1,451 @@
+#define BIORBD_API_EXPORTS
+#include "Simulation/Integrator.h"
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "BiorbdModel.h"
+#include "Utils/Error.h"
+#include "Utils/String.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
+#ifdef MODULE_MUSCLES
+#include "InternalForces/Muscles/Muscle.h"
+#include "InternalForces/Muscles/StateDynamics.h"
+#include "InternalForces/Muscles/FatigueModel.h"
+#include "InternalForces/Muscles/FatigueDynamicState.h"
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+///
+/// \brief Settings, layout of the state and buffers of an integrator
+///
+class simulation::Integrator::IntegratorWorkspace
+{
+public:
+    INTEGRATOR_TYPE m_type; ///< The integration scheme
+    double m_dt; ///< The time step
+    double m_relativeTolerance; ///< The relative tolerance of the adaptive schemes
+    double m_absoluteTolerance; ///< The absolute tolerance of the adaptive schemes
+    Controller m_controller; ///< The controller (empty for zero controls)
+    Controls m_controls; ///< The controls of the current evaluation
+
+    size_t m_nbQ; ///< Number of generalized coordinates
+    size_t m_nbQdot; ///< Number of generalized velocities
+    size_t m_nbMuscles; ///< Number of muscle activations
+    size_t m_nbFatigue; ///< Number of fatigue states (3 per fatigable muscle)
+    std::vector<std::pair<unsigned int, unsigned int>> m_quaternions; ///< Index in Q of the vector part and of the scalar part of each quaternion
+
+#ifdef MODULE_MUSCLES
+    std::vector<std::shared_ptr<internal_forces::muscles::Muscle>> m_muscles; ///< The muscles
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> m_states; ///< The states of the muscles
+    std::vector<bool> m_isDynamic; ///< If the activation of the muscle has a dynamic (it is constant otherwise)
+    std::vector<size_t> m_fatigable; ///< Index of the muscles with a dynamic fatigue model
+    std::vector<std::shared_ptr<internal_forces::muscles::FatigueModel>> m_fatigueModels; ///< The muscles with a dynamic fatigue model
+#endif
+
+    rigidbody::GeneralizedCoordinates m_Q; ///< Q of the current evaluation
+    rigidbody::GeneralizedVelocity m_QDot; ///< QDot of the current evaluation
+    rigidbody::GeneralizedTorque m_tau; ///< Total generalized torques of the current evaluation
+    std::vector<utils::Vector> m_k; ///< The stages of the schemes
+    utils::Vector m_xStage; ///< The state of the current stage
+    utils::Vector m_xNew; ///< The state at the end of the step
+    utils::Vector m_error; ///< The error estimate of the adaptive schemes
+    double m_tNew; ///< The time at the end of the last step
+    bool m_isLastStageValid; ///< If m_k[6] holds the derivative at (m_tNew, m_xNew)
+
+    size_t m_nbSteps; ///< Number of accepted steps
+    size_t m_nbRejectedSteps; ///< Number of rejected steps
+    double m_stepsPerSecond; ///< Steps per second of the last integration
+};
+
+simulation::Integrator::Integrator(
+    Model& model,
+    simulation::INTEGRATOR_TYPE type) :
+    m_model(model),
+    m_workspace(std::make_shared<IntegratorWorkspace>())
+{
+    IntegratorWorkspace& w(*m_workspace);
+    w.m_type = type;
+    w.m_dt = 1e-3;
+    w.m_relativeTolerance = 1e-6;
+    w.m_absoluteTolerance = 1e-8;
+    w.m_nbQ = model.nbQ();
+    w.m_nbQdot = model.nbQdot();
+    w.m_nbMuscles = 0;
+    w.m_nbFatigue = 0;
+
+    // RBDL stores the scalar part of the quaternions after all the other coordinates
+    for (unsigned int j=1; j<model.mJoints.size(); ++j) {
+        if (model.mJoints[j].mJointType == RigidBodyDynamics::JointTypeSpherical) {
+            w.m_quaternions.push_back(std::make_pair(model.mJoints[j].q_index, model.multdof3_w_index[j]));
+        }
+    }
+
+#ifdef MODULE_MUSCLES
+    w.m_muscles = model.muscles();
+    w.m_states = model.stateSet();
+    w.m_nbMuscles = w.m_muscles.size();
+    for (size_t i=0; i<w.m_muscles.size(); ++i) {
+        w.m_isDynamic.push_back(
+            dynamic_cast<internal_forces::muscles::StateDynamics*>(w.m_states[i].get()) != nullptr);
+        std::shared_ptr<internal_forces::muscles::FatigueModel> fatigue(
+            std::dynamic_pointer_cast<internal_forces::muscles::FatigueModel>(w.m_muscles[i]));
+        if (fatigue && w.m_isDynamic[i]
+                && dynamic_cast<internal_forces::muscles::FatigueDynamicState*>(&fatigue->fatigueState())) {
+            w.m_fatigable.push_back(i);
+            w.m_fatigueModels.push_back(fatigue);
+        }
+    }
+    w.m_nbFatigue = 3 * w.m_fatigable.size();
+#endif
+
+    w.m_controls.m_tau = rigidbody::GeneralizedTorque(model);
+    w.m_controls.m_excitations = utils::Vector(static_cast<unsigned int>(w.m_nbMuscles));
+    w.m_Q = rigidbody::GeneralizedCoordinates(model);
+    w.m_QDot = rigidbody::GeneralizedVelocity(model);
+    w.m_tau = rigidbody::GeneralizedTorque(model);
+    w.m_k.resize(7, utils::Vector(static_cast<unsigned int>(nbStates())));
+    w.m_xStage = utils::Vector(static_cast<unsigned int>(nbStates()));
+    w.m_xNew = utils::Vector(static_cast<unsigned int>(nbStates()));
+    w.m_error = utils::Vector(static_cast<unsigned int>(nbStates()));
+    w.m_tNew = 0;
+    w.m_isLastStageValid = false;
+    w.m_nbSteps = 0;
+    w.m_nbRejectedSteps = 0;
+    w.m_stepsPerSecond = 0;
+}
+
+simulation::Integrator::~Integrator()
+{
+
+}
+
+void simulation::Integrator::setType(
+    simulation::INTEGRATOR_TYPE type)
+{
+    m_workspace->m_type = type;
+    m_workspace->m_isLastStageValid = false;
+}
+
+simulation::INTEGRATOR_TYPE simulation::Integrator::type() const
+{
+    return m_workspace->m_type;
+}
+
+void simulation::Integrator::setTimeStep(
+    double dt)
+{
+    utils::Error::check(dt > 0, "The time step must be positive");
+    m_workspace->m_dt = dt;
+}
+
+double simulation::Integrator::timeStep() const
+{
+    return m_workspace->m_dt;
+}
+
+void simulation::Integrator::setTolerances(
+    double relative,
+    double absolute)
+{
+    utils::Error::check(relative > 0 && absolute > 0, "The tolerances must be positive");
+    m_workspace->m_relativeTolerance = relative;
+    m_workspace->m_absoluteTolerance = absolute;
+}
+
+void simulation::Integrator::setController(
+    const simulation::Controller& controller)
+{
+    m_workspace->m_controller = controller;
+    m_workspace->m_isLastStageValid = false;
+}
+
+size_t simulation::Integrator::nbStates() const
+{
+    const IntegratorWorkspace& w(*m_workspace);
+    return w.m_nbQ + w.m_nbQdot + w.m_nbMuscles + w.m_nbFatigue;
+}
+
+utils::Vector simulation::Integrator::state(
+    const rigidbody::GeneralizedCoordinates& Q,
+    const rigidbody::GeneralizedVelocity& QDot) const
+{
+    const IntegratorWorkspace& w(*m_workspace);
+    utils::Error::check(static_cast<size_t>(Q.size()) == w.m_nbQ, "Wrong size for Q");
+    utils::Error::check(static_cast<size_t>(QDot.size()) == w.m_nbQdot, "Wrong size for QDot");
+
+    utils::Vector x(static_cast<unsigned int>(nbStates()));
+    x.segment(0, w.m_nbQ) = Q;
+    x.segment(w.m_nbQ, w.m_nbQdot) = QDot;
+#ifdef MODULE_MUSCLES
+    size_t offset(w.m_nbQ + w.m_nbQdot);
+    for (size_t i=0; i<w.m_nbMuscles; ++i) {
+        x[offset + i] = w.m_states[i]->activation();
+    }
+    offset += w.m_nbMuscles;
+    for (size_t k=0; k<w.m_fatigable.size(); ++k) {
+        const internal_forces::muscles::FatigueState& fatigue(w.m_fatigueModels[k]->fatigueState());
+        x[offset + 3*k] = fatigue.activeFibers();
+        x[offset + 3*k + 1] = fatigue.fatiguedFibers();
+        x[offset + 3*k + 2] = fatigue.restingFibers();
+    }
+#endif
+    return x;
+}
+
+rigidbody::GeneralizedCoordinates simulation::Integrator::Q(
+    const utils::Vector& x) const
+{
+    return x.segment(0, m_workspace->m_nbQ);
+}
+
+rigidbody::GeneralizedVelocity simulation::Integrator::QDot(
+    const utils::Vector& x) const
+{
+    return x.segment(m_workspace->m_nbQ, m_workspace->m_nbQdot);
+}
+
+utils::Vector simulation::Integrator::activations(
+    const utils::Vector& x) const
+{
+    const IntegratorWorkspace& w(*m_workspace);
+    return x.segment(w.m_nbQ + w.m_nbQdot, w.m_nbMuscles);
+}
+
+utils::Vector simulation::Integrator::fatigue(
+    const utils::Vector& x) const
+{
+    const IntegratorWorkspace& w(*m_workspace);
+    return x.segment(w.m_nbQ + w.m_nbQdot + w.m_nbMuscles, w.m_nbFatigue);
+}
+
+void simulation::Integrator::derivative(
+    double t,
+    const utils::Vector& x,
+    utils::Vector& xDot)
+{
+    IntegratorWorkspace& w(*m_workspace);
+    if (static_cast<size_t>(xDot.size()) != nbStates()) {
+        xDot.resize(static_cast<unsigned int>(nbStates()));
+    }
+
+    w.m_Q = x.segment(0, w.m_nbQ);
+    w.m_QDot = x.segment(w.m_nbQ, w.m_nbQdot);
+    w.m_controls.m_tau.setZero();
+    w.m_controls.m_excitations.setZero();
+    if (w.m_controller) {
+        w.m_controller(t, x, w.m_controls);
+    }
+    w.m_tau = w.m_controls.m_tau;
+
+#ifdef MODULE_MUSCLES
+    if (w.m_nbMuscles) {
+        const size_t offsetActivation(w.m_nbQ + w.m_nbQdot);
+        const size_t offsetFatigue(offsetActivation + w.m_nbMuscles);
+        for (size_t i=0; i<w.m_nbMuscles; ++i) {
+            w.m_states[i]->setExcitation(w.m_controls.m_excitations[i], true);
+            w.m_states[i]->setActivation(x[offsetActivation + i], true);
+        }
+        for (size_t k=0; k<w.m_fatigable.size(); ++k) {
+            // The stages of the schemes can slightly leave the admissible set
+            internal_forces::muscles::FatigueState& fatigue(w.m_fatigueModels[k]->fatigueState());
+            fatigue.setState(
+                x[offsetFatigue + 3*k],
+                std::min(std::max(x[offsetFatigue + 3*k + 1], 0.0), 1.0),
+                x[offsetFatigue + 3*k + 2],
+                true);
+        }
+
+        w.m_tau += m_model.muscularJointTorque(w.m_states, w.m_Q, w.m_QDot);
+
+        for (size_t i=0; i<w.m_nbMuscles; ++i) {
+            xDot[offsetActivation + i] = w.m_isDynamic[i] ? w.m_muscles[i]->activationDot(*w.m_states[i], true) : 0;
+        }
+        for (size_t k=0; k<w.m_fatigable.size(); ++k) {
+            internal_forces::muscles::FatigueModel& fatigueModel(*w.m_fatigueModels[k]);
+            fatigueModel.computeTimeDerivativeState(
+                dynamic_cast<const internal_forces::muscles::StateDynamics&>(*w.m_states[w.m_fatigable[k]]));
+            const internal_forces::muscles::FatigueDynamicState& fatigue(
+                static_cast<const internal_forces::muscles::FatigueDynamicState&>(fatigueModel.fatigueState()));
+            xDot[offsetFatigue + 3*k] = fatigue.activeFibersDot();
+            xDot[offsetFatigue + 3*k + 1] = fatigue.fatiguedFibersDot();
+            xDot[offsetFatigue + 3*k + 2] = fatigue.restingFibersDot();
+        }
+    }
+#endif
+
+    if (m_model.nbContacts() > 0) {
+        xDot.segment(w.m_nbQ, w.m_nbQdot) = m_model.ForwardDynamicsConstraintsDirect(w.m_Q, w.m_QDot, w.m_tau);
+    } else {
+        xDot.segment(w.m_nbQ, w.m_nbQdot) = m_model.ForwardDynamics(w.m_Q, w.m_QDot, w.m_tau);
+    }
+
+    if (w.m_quaternions.empty()) {
+        xDot.segment(0, w.m_nbQ) = w.m_QDot;
+    } else {
+        xDot.segment(0, w.m_nbQ) = m_model.computeQdot(w.m_Q, rigidbody::GeneralizedCoordinates(w.m_QDot));
+    }
+}
+
+void simulation::Integrator::step(
+    double& t,
+    utils::Vector& x,
+    double tMax)
+{
+    IntegratorWorkspace& w(*m_workspace);
+    utils::Error::check(static_cast<size_t>(x.size()) == nbStates(), "Wrong size for the state");
+    double h(std::min(w.m_dt, tMax - t));
+    utils::Error::check(h > 0, "The time is already at tMax");
+    std::vector<utils::Vector>& k(w.m_k);
+
+    switch (w.m_type) {
+    case INTEGRATOR_RK4: {
+        derivative(t, x, k[0]);
+        w.m_xStage = x + h / 2 * k[0];
+        derivative(t + h / 2, w.m_xStage, k[1]);
+        w.m_xStage = x + h / 2 * k[1];
+        derivative(t + h / 2, w.m_xStage, k[2]);
+        w.m_xStage = x + h * k[2];
+        derivative(t + h, w.m_xStage, k[3]);
+        x += h / 6 * (k[0] + 2 * k[1] + 2 * k[2] + k[3]);
+        t += h;
+        break;
+    }
+    case INTEGRATOR_SEMI_IMPLICIT_EULER: {
+        // The velocities (and the muscle states) are updated first, the positions use the new velocities
+        derivative(t, x, k[0]);
+        const size_t nbOthers(nbStates() - w.m_nbQ);
+        x.segment(w.m_nbQ, nbOthers) += h * k[0].segment(w.m_nbQ, nbOthers);
+        if (w.m_quaternions.empty()) {
+            x.segment(0, w.m_nbQ) += h * x.segment(w.m_nbQ, w.m_nbQdot);
+        } else {
+            w.m_Q = x.segment(0, w.m_nbQ);
+            w.m_QDot = x.segment(w.m_nbQ, w.m_nbQdot);
+            x.segment(0, w.m_nbQ) += h * m_model.computeQdot(w.m_Q, rigidbody::GeneralizedCoordinates(w.m_QDot));
+        }
+        t += h;
+        break;
+    }
+    case INTEGRATOR_RK45: {
+        // Dormand-Prince 5(4), the last stage of a step is the first one of the next (FSAL)
+        static const double a21(1./5);
+        static const double a31(3./40), a32(9./40);
+        static const double a41(44./45), a42(-56./15), a43(32./9);
+        static const double a51(19372./6561), a52(-25360./2187), a53(64448./6561), a54(-212./729);
+        static const double a61(9017./3168), a62(-355./33), a63(46732./5247), a64(49./176), a65(-5103./18656);
+        static const double b1(35./384), b3(500./1113), b4(125./192), b5(-2187./6784), b6(11./84);
+        static const double e1(71./57600), e3(-71./16695), e4(71./1920), e5(-17253./339200), e6(22./525), e7(-1./40);
+
+        if (w.m_isLastStageValid && w.m_tNew == t && w.m_xNew == x) {
+            k[0].swap(k[6]);
+        } else {
+            derivative(t, x, k[0]);
+        }
+        w.m_isLastStageValid = false;
+
+        while (true) {
+            const bool isShortened(h < w.m_dt);
+            w.m_xStage = x + h * a21 * k[0];
+            derivative(t + h / 5, w.m_xStage, k[1]);
+            w.m_xStage = x + h * (a31 * k[0] + a32 * k[1]);
+            derivative(t + 3 * h / 10, w.m_xStage, k[2]);
+            w.m_xStage = x + h * (a41 * k[0] + a42 * k[1] + a43 * k[2]);
+            derivative(t + 4 * h / 5, w.m_xStage, k[3]);
+            w.m_xStage = x + h * (a51 * k[0] + a52 * k[1] + a53 * k[2] + a54 * k[3]);
+            derivative(t + 8 * h / 9, w.m_xStage, k[4]);
+            w.m_xStage = x + h * (a61 * k[0] + a62 * k[1] + a63 * k[2] + a64 * k[3] + a65 * k[4]);
+            derivative(t + h, w.m_xStage, k[5]);
+            w.m_xNew = x + h * (b1 * k[0] + b3 * k[2] + b4 * k[3] + b5 * k[4] + b6 * k[5]);
+            derivative(t + h, w.m_xNew, k[6]);
+            w.m_error = h * (e1 * k[0] + e3 * k[2] + e4 * k[3] + e5 * k[4] + e6 * k[5] + e7 * k[6]);
+
+            double errorNorm(0);
+            for (unsigned int i=0; i<w.m_error.size(); ++i) {
+                double scale(w.m_absoluteTolerance + w.m_relativeTolerance * std::max(std::fabs(x[i]), std::fabs(w.m_xNew[i])));
+                errorNorm += (w.m_error[i] / scale) * (w.m_error[i] / scale);
+            }
+            errorNorm = std::sqrt(errorNorm / static_cast<double>(w.m_error.size()));
+
+            if (errorNorm <= 1) {
+                double factor(errorNorm == 0 ? 5 : std::min(5.0, std::max(0.2, 0.9 * std::pow(errorNorm, -0.2))));
+                // A step shortened to reach tMax must not shrink the next steps
+                if (!isShortened || h * factor < w.m_dt) {
+                    w.m_dt = h * factor;
+                }
+                t += h;
+                x = w.m_xNew;
+                w.m_tNew = t;
+                w.m_isLastStageValid = w.m_quaternions.empty();
+                break;
+            }
+
+            ++w.m_nbRejectedSteps;
+            h *= std::max(0.2, 0.9 * std::pow(errorNorm, -0.2));
+            w.m_dt = h;
+            utils::Error::check(h > 1e-14 * std::max(1.0, std::fabs(t)),
+                                "The time step of the adaptive integrator became too small");
+        }
+        break;
+    }
+    default:
+        utils::Error::raise(utils::String("The ") + INTEGRATOR_TYPE_toStr(w.m_type) + " integrator is not available");
+    }
+
+    normalizeQuaternions(x);
+    ++w.m_nbSteps;
+}
+
+size_t simulation::Integrator::integrate(
+    double t0,
+    double tf,
+    utils::Vector& x)
+{
+    IntegratorWorkspace& w(*m_workspace);
+    utils::Error::check(tf >= t0, "The final time must be after the initial time");
+
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    size_t nbSteps(0);
+    double t(t0);
+    const double epsilon(1e-12 * std::max(1.0, std::fabs(tf)));
+    while (tf - t > epsilon) {
+        step(t, x, tf);
+        ++nbSteps;
+    }
+    double elapsed(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    w.m_stepsPerSecond = elapsed > 0 ? static_cast<double>(nbSteps) / elapsed : 0;
+    return nbSteps;
+}
+
+size_t simulation::Integrator::nbSteps() const
+{
+    return m_workspace->m_nbSteps;
+}
+
+size_t simulation::Integrator::nbRejectedSteps() const
+{
+    return m_workspace->m_nbRejectedSteps;
+}
+
+double simulation::Integrator::stepsPerSecond() const
+{
+    return m_workspace->m_stepsPerSecond;
+}
+
+void simulation::Integrator::normalizeQuaternions(
+    utils::Vector& x) const
+{
+    for (const auto& quaternion : m_workspace->m_quaternions) {
+        double norm(std::sqrt(
+                        x[quaternion.first] * x[quaternion.first]
+                        + x[quaternion.first + 1] * x[quaternion.first + 1]
+                        + x[quaternion.first + 2] * x[quaternion.first + 2]
+                        + x[quaternion.second] * x[quaternion.second]));
+        if (norm > 0) {
+            x.segment(quaternion.first, 3) /= norm;
+            x[quaternion.second] /= norm;
+        }
+    }
+}
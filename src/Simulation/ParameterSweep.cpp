@@ -0,0 +1,404 @@
+#define BIORBD_API_EXPORTS
+#include "Simulation/ParameterSweep.h"
+
+#include "BiorbdModel.h"
+#include "Utils/Error.h"
+#include "Utils/Matrix.h"
+#include "Utils/Matrix3d.h"
+#include "Utils/Path.h"
+#include "Utils/String.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/Vector3d.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
+#include "RigidBody/GeneralizedTorque.h"
+#include "RigidBody/Segment.h"
+#include "RigidBody/SegmentCharacteristics.h"
+#ifdef MODULE_MUSCLES
+#include "InternalForces/Muscles/Characteristics.h"
+#include "InternalForces/Muscles/Muscle.h"
+#include "InternalForces/Muscles/MuscleGroup.h"
+#include "InternalForces/Muscles/State.h"
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+namespace BIORBD_NAMESPACE
+{
+namespace simulation
+{
+///
+/// \brief A swept parameter, where it goes in the model and its value in the loaded model
+///
+class SweepParameter
+{
+public:
+    SweepParameter(
+        SWEEP_PARAMETER type,
+        size_t index,
+        size_t group,
+        double nominal) :
+        m_type(type),
+        m_index(index),
+        m_group(group),
+        m_nominal(nominal)
+    {
+
+    }
+
+    SWEEP_PARAMETER m_type; ///< The type of the parameter
+    size_t m_index; ///< The index of the segment in the sweep, or of the muscle in its group
+    size_t m_group; ///< The muscle group of the muscle
+    double m_nominal; ///< The value in the loaded model
+};
+
+///
+/// \brief A segment with swept parameters and its inertia in the loaded model
+///
+class SweepSegment
+{
+public:
+    SweepSegment(
+        size_t idx,
+        const rigidbody::SegmentCharacteristics& characteristics) :
+        m_idx(idx),
+        m_mass(characteristics.mMass),
+        m_com(characteristics.mCenterOfMass),
+        m_inertia(characteristics.mInertia)
+    {
+
+    }
+
+    size_t m_idx; ///< The index of the segment in the model
+    utils::Scalar m_mass; ///< The mass in the loaded model
+    utils::Vector3d m_com; ///< The center of mass in the loaded model
+    utils::Matrix3d m_inertia; ///< The inertia in the loaded model
+    std::vector<size_t> m_parameters; ///< The rows of the swept parameters of the segment
+};
+
+///
+/// \brief The model of a thread and the buffers of its samples
+///
+class SweepWorker
+{
+public:
+    SweepWorker(
+        const utils::Path& path) :
+        m_model(std::make_shared<Model>(path))
+    {
+
+    }
+
+    std::shared_ptr<Model> m_model; ///< The model overlaid with the parameters of the current sample
+    rigidbody::GeneralizedTorque m_tau; ///< The generalized torques of the current sample
+};
+
+}
+}
+
+simulation::ParameterSweep::ParameterSweep(
+    const utils::Path& path,
+    size_t nbThreads) :
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads))
+{
+    for (size_t i=0; i<m_pool->nbThreads(); ++i) {
+        m_workers.push_back(std::make_shared<SweepWorker>(path));
+    }
+}
+
+simulation::ParameterSweep::~ParameterSweep()
+{
+
+}
+
+size_t simulation::ParameterSweep::nbThreads() const
+{
+    return m_pool->nbThreads();
+}
+
+Model& simulation::ParameterSweep::model(
+    size_t thread)
+{
+    utils::Error::check(thread < m_workers.size(), "Thread index is out of range");
+    return *m_workers[thread]->m_model;
+}
+
+size_t simulation::ParameterSweep::addSegmentParameter(
+    size_t segment,
+    simulation::SWEEP_PARAMETER parameter)
+{
+    const Model& model(*m_workers[0]->m_model);
+    utils::Error::check(segment < model.nbSegment(), "Segment index is out of range");
+    utils::Error::check(parameter <= SEGMENT_INERTIA_YZ,
+                        utils::String(SWEEP_PARAMETER_toStr(parameter))
+                        + " is not a parameter of a segment");
+
+    size_t idx(0);
+    while (idx < m_segments.size() && m_segments[idx]->m_idx != segment) {
+        ++idx;
+    }
+    if (idx == m_segments.size()) {
+        m_segments.push_back(std::make_shared<SweepSegment>(
+                                 segment, model.segment(segment).characteristics()));
+    }
+    const SweepSegment& sweepSegment(*m_segments[idx]);
+
+    double nominal;
+    switch (parameter) {
+    case SEGMENT_MASS:
+        nominal = sweepSegment.m_mass;
+        break;
+    case SEGMENT_COM_X:
+    case SEGMENT_COM_Y:
+    case SEGMENT_COM_Z:
+        nominal = sweepSegment.m_com[parameter - SEGMENT_COM_X];
+        break;
+    case SEGMENT_INERTIA_XX:
+    case SEGMENT_INERTIA_YY:
+    case SEGMENT_INERTIA_ZZ:
+        nominal = sweepSegment.m_inertia(parameter - SEGMENT_INERTIA_XX,
+                                         parameter - SEGMENT_INERTIA_XX);
+        break;
+    case SEGMENT_INERTIA_XY:
+        nominal = sweepSegment.m_inertia(0, 1);
+        break;
+    case SEGMENT_INERTIA_XZ:
+        nominal = sweepSegment.m_inertia(0, 2);
+        break;
+    default:
+        nominal = sweepSegment.m_inertia(1, 2);
+        break;
+    }
+
+    m_segments[idx]->m_parameters.push_back(m_parameters.size());
+    m_parameters.push_back(std::make_shared<SweepParameter>(parameter, idx, 0, nominal));
+    return m_parameters.size() - 1;
+}
+
+size_t simulation::ParameterSweep::addSegmentParameter(
+    const utils::String& segment,
+    simulation::SWEEP_PARAMETER parameter)
+{
+    int idx(m_workers[0]->m_model->getBodyBiorbdId(segment));
+    utils::Error::check(idx >= 0, "Segment " + segment + " is not in the model");
+    return addSegmentParameter(static_cast<size_t>(idx), parameter);
+}
+
+#ifdef MODULE_MUSCLES
+size_t simulation::ParameterSweep::addMuscleParameter(
+    size_t muscle,
+    simulation::SWEEP_PARAMETER parameter)
+{
+    const Model& model(*m_workers[0]->m_model);
+    utils::Error::check(muscle < model.nbMuscles(), "Muscle index is out of range");
+    utils::Error::check(parameter >= MUSCLE_FORCE_ISO_MAX && parameter < NO_SWEEP_PARAMETER,
+                        utils::String(SWEEP_PARAMETER_toStr(parameter))
+                        + " is not a parameter of a muscle");
+
+    // The muscles are set through their group
+    size_t group(0);
+    while (muscle >= model.muscleGroup(group).nbMuscles()) {
+        muscle -= model.muscleGroup(group).nbMuscles();
+        ++group;
+    }
+    const internal_forces::muscles::Characteristics& characteristics(
+        model.muscleGroup(group).muscle(muscle).characteristics());
+
+    double nominal;
+    switch (parameter) {
+    case MUSCLE_FORCE_ISO_MAX:
+        nominal = characteristics.forceIsoMax();
+        break;
+    case MUSCLE_OPTIMAL_LENGTH:
+        nominal = characteristics.optimalLength();
+        break;
+    case MUSCLE_TENDON_SLACK_LENGTH:
+        nominal = characteristics.tendonSlackLength();
+        break;
+    default:
+        nominal = characteristics.pennationAngle();
+        break;
+    }
+
+    m_parameters.push_back(std::make_shared<SweepParameter>(parameter, muscle, group, nominal));
+    return m_parameters.size() - 1;
+}
+#endif
+
+size_t simulation::ParameterSweep::nbParameters() const
+{
+    return m_parameters.size();
+}
+
+utils::Vector simulation::ParameterSweep::nominalParameters() const
+{
+    utils::Vector nominal(static_cast<unsigned int>(m_parameters.size()));
+    for (size_t i=0; i<m_parameters.size(); ++i) {
+        nominal[i] = m_parameters[i]->m_nominal;
+    }
+    return nominal;
+}
+
+size_t simulation::ParameterSweep::nbResults(
+    simulation::SWEEP_QUANTITY quantity) const
+{
+    switch (quantity) {
+    case SWEEP_INVERSE_DYNAMICS_RESIDUALS:
+        return m_workers[0]->m_model->nbGeneralizedTorque();
+#ifdef MODULE_MUSCLES
+    case SWEEP_MUSCLE_FORCES:
+        return m_workers[0]->m_model->nbMuscles();
+#endif
+    case SWEEP_CENTER_OF_MASS:
+        return 3;
+    default:
+        utils::Error::raise(utils::String(SWEEP_QUANTITY_toStr(quantity))
+                            + " cannot be evaluated by a sweep");
+    }
+#ifdef _WIN32
+    // It is impossible to get here, but it's better to have a return for the compiler
+    return 0;
+#endif
+}
+
+void simulation::ParameterSweep::evaluate(
+    const utils::Matrix& parameters,
+    simulation::SWEEP_QUANTITY quantity,
+    const utils::Vector& Q,
+    const utils::Vector* QDot,
+    const utils::Vector* QDDot,
+    const utils::Vector* Tau,
+    utils::Matrix& results)
+{
+    evaluateSamples(parameters, quantity, Q, QDot, QDDot, Tau, nullptr, results);
+}
+
+#ifdef MODULE_MUSCLES
+void simulation::ParameterSweep::evaluate(
+    const utils::Matrix& parameters,
+    simulation::SWEEP_QUANTITY quantity,
+    const utils::Vector& Q,
+    const utils::Vector* QDot,
+    const utils::Vector* QDDot,
+    const utils::Vector* Tau,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    utils::Matrix& results)
+{
+    evaluateSamples(parameters, quantity, Q, QDot, QDDot, Tau, &emg, results);
+}
+#endif
+
+void simulation::ParameterSweep::evaluateSamples(
+    const utils::Matrix& parameters,
+    simulation::SWEEP_QUANTITY quantity,
+    const utils::Vector& Q,
+    const utils::Vector* QDot,
+    const utils::Vector* QDDot,
+    const utils::Vector* Tau,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>* emg,
+    utils::Matrix& results)
+{
+    const Model& model(*m_workers[0]->m_model);
+    size_t nbRows(nbResults(quantity));
+    utils::Error::check(static_cast<size_t>(parameters.rows()) == m_parameters.size(),
+                        "The parameters must have a row per swept parameter");
+    utils::Error::check(static_cast<size_t>(Q.size()) == model.nbQ(),
+                        "Q has the wrong size");
+    if (quantity == SWEEP_INVERSE_DYNAMICS_RESIDUALS) {
+        utils::Error::check(QDot && QDDot,
+                            "QDot and QDDot are needed by the inverse dynamics residuals");
+        utils::Error::check(static_cast<size_t>(QDot->size()) == model.nbQdot()
+                            && static_cast<size_t>(QDDot->size()) == model.nbQddot(),
+                            "QDot or QDDot has the wrong size");
+        utils::Error::check(!Tau || static_cast<size_t>(Tau->size()) == nbRows,
+                            "Tau has the wrong size");
+    }
+#ifdef MODULE_MUSCLES
+    if (quantity == SWEEP_MUSCLE_FORCES) {
+        utils::Error::check(QDot && static_cast<size_t>(QDot->size()) == model.nbQdot(),
+                            "QDot is needed by the muscle forces");
+        utils::Error::check(emg && emg->size() == nbRows,
+                            "A state is needed for each muscle");
+    }
+#endif
+
+    // The inputs are the same for all the samples
+    rigidbody::GeneralizedCoordinates q(Q);
+    rigidbody::GeneralizedVelocity qDot(QDot ? *QDot : utils::Vector::Zero(model.nbQdot()));
+    rigidbody::GeneralizedAcceleration qDDot(QDDot ? *QDDot : utils::Vector::Zero(model.nbQddot()));
+
+    size_t nbSamples(static_cast<size_t>(parameters.cols()));
+    if (static_cast<size_t>(results.rows()) != nbRows
+            || static_cast<size_t>(results.cols()) != nbSamples) {
+        results.resize(static_cast<unsigned int>(nbRows), static_cast<unsigned int>(nbSamples));
+    }
+
+    m_pool->parallelFor(nbSamples, [&](size_t sample, size_t thread) {
+        SweepWorker& worker(*m_workers[thread]);
+        Model& overlaid(*worker.m_model);
+
+        // Overlay the parameters of the sample, a segment at a time so its inertia is set once
+        for (const auto& segment : m_segments) {
+            utils::Scalar mass(segment->m_mass);
+            utils::Vector3d com(segment->m_com);
+            utils::Matrix3d inertia(segment->m_inertia);
+            for (size_t row : segment->m_parameters) {
+                double value(parameters(row, sample));
+                SWEEP_PARAMETER type(m_parameters[row]->m_type);
+                if (type == SEGMENT_MASS) {
+                    mass = value;
+                } else if (type <= SEGMENT_COM_Z) {
+                    com[type - SEGMENT_COM_X] = value;
+                } else if (type <= SEGMENT_INERTIA_ZZ) {
+                    inertia(type - SEGMENT_INERTIA_XX, type - SEGMENT_INERTIA_XX) = value;
+                } else {
+                    size_t i(type == SEGMENT_INERTIA_YZ ? 1 : 0);
+                    size_t j(type == SEGMENT_INERTIA_XY ? 1 : 2);
+                    inertia(i, j) = value;
+                    inertia(j, i) = value;
+                }
+            }
+            overlaid.updateSegmentInertia(segment->m_idx, mass, com, inertia);
+        }
+#ifdef MODULE_MUSCLES
+        for (size_t row=0; row<m_parameters.size(); ++row) {
+            const SweepParameter& parameter(*m_parameters[row]);
+            if (parameter.m_type < MUSCLE_FORCE_ISO_MAX) {
+                continue;
+            }
+            internal_forces::muscles::Muscle& muscle(
+                overlaid.muscleGroup(parameter.m_group).muscle(parameter.m_index));
+            double value(parameters(row, sample));
+            if (parameter.m_type == MUSCLE_FORCE_ISO_MAX) {
+                muscle.setForceIsoMax(value);
+            } else if (parameter.m_type == MUSCLE_OPTIMAL_LENGTH) {
+                muscle.setOptimalLength(value);
+            } else if (parameter.m_type == MUSCLE_TENDON_SLACK_LENGTH) {
+                muscle.setTendonSlackLength(value);
+            } else {
+                muscle.setPennationAngle(value);
+            }
+        }
+#endif
+
+        switch (quantity) {
+        case SWEEP_INVERSE_DYNAMICS_RESIDUALS:
+            worker.m_tau = overlaid.InverseDynamics(q, qDot, qDDot);
+            if (Tau) {
+                results.col(sample) = worker.m_tau - *Tau;
+            } else {
+                results.col(sample) = worker.m_tau;
+            }
+            break;
+#ifdef MODULE_MUSCLES
+        case SWEEP_MUSCLE_FORCES:
+            results.col(sample) = overlaid.muscleForces(*emg, q, qDot);
+            break;
+#endif
+        default:
+            results.col(sample) = overlaid.CoM(q, true);
+            break;
+        }
+    });
+}
@@ -0,0 +1,112 @@
+#define BIORBD_API_EXPORTS
+#include "Simulation/Rollouts.h"
+
+#include <chrono>
+#include "BiorbdModel.h"
+#include "Utils/Error.h"
+#include "Utils/Path.h"
+#include "Utils/ThreadPool.h"
+
+using namespace BIORBD_NAMESPACE;
+
+simulation::Rollouts::Rollouts(
+    const utils::Path& path,
+    simulation::INTEGRATOR_TYPE type,
+    size_t nbThreads) :
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads)),
+    m_nbSteps(0),
+    m_stepsPerSecond(0)
+{
+    for (size_t i=0; i<m_pool->nbThreads(); ++i) {
+        m_models.push_back(std::make_shared<Model>(path));
+        m_integrators.push_back(std::make_shared<Integrator>(*m_models.back(), type));
+    }
+}
+
+simulation::Rollouts::~Rollouts()
+{
+
+}
+
+size_t simulation::Rollouts::nbThreads() const
+{
+    return m_pool->nbThreads();
+}
+
+simulation::Integrator& simulation::Rollouts::integrator(
+    size_t thread)
+{
+    utils::Error::check(thread < m_integrators.size(), "Thread index is out of range");
+    return *m_integrators[thread];
+}
+
+void simulation::Rollouts::setTimeStep(
+    double dt)
+{
+    for (auto& integrator : m_integrators) {
+        integrator->setTimeStep(dt);
+    }
+}
+
+void simulation::Rollouts::setTolerances(
+    double relative,
+    double absolute)
+{
+    for (auto& integrator : m_integrators) {
+        integrator->setTolerances(relative, absolute);
+    }
+}
+
+void simulation::Rollouts::setController(
+    const simulation::RolloutController& controller)
+{
+    m_controller = controller;
+}
+
+void simulation::Rollouts::run(
+    double t0,
+    double tf,
+    std::vector<utils::Vector>& states)
+{
+    std::vector<size_t> nbSteps(states.size(), 0);
+    // The adaptive schemes start each rollout from the same time step
+    std::vector<double> dt(m_integrators.size());
+    for (size_t i=0; i<m_integrators.size(); ++i) {
+        dt[i] = m_integrators[i]->timeStep();
+    }
+
+    std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    m_pool->parallelFor(states.size(), [&](size_t rollout, size_t thread) {
+        Integrator& integrator(*m_integrators[thread]);
+        integrator.setTimeStep(dt[thread]);
+        if (m_controller) {
+            const RolloutController& controller(m_controller);
+            integrator.setController([&controller, rollout](double t, const utils::Vector& x, Controls& controls) {
+                controller(rollout, t, x, controls);
+            });
+        } else {
+            integrator.setController(Controller());
+        }
+        nbSteps[rollout] = integrator.integrate(t0, tf, states[rollout]);
+    });
+    double elapsed(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    for (size_t i=0; i<m_integrators.size(); ++i) {
+        m_integrators[i]->setTimeStep(dt[i]);
+    }
+    m_nbSteps = 0;
+    for (size_t n : nbSteps) {
+        m_nbSteps += n;
+    }
+    m_stepsPerSecond = elapsed > 0 ? static_cast<double>(m_nbSteps) / elapsed : 0;
+}
+
+size_t simulation::Rollouts::nbSteps() const
+{
+    return m_nbSteps;
+}
+
+double simulation::Rollouts::stepsPerSecond() const
+{
+    return m_stepsPerSecond;
+}
@@ -0,0 +1,357 @@
+#define BIORBD_API_EXPORTS
+#include "Simulation/Scene.h"
+
+#include "BiorbdModel.h"
+#include "Utils/Error.h"
+#include "Utils/Matrix.h"
+#include "Utils/Path.h"
+#include "Utils/String.h"
+#include "Utils/ThreadPool.h"
+#include "RigidBody/ExternalForceSet.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
+#include "RigidBody/GeneralizedTorque.h"
+#include "RigidBody/KinematicsResults.h"
+#ifdef MODULE_MUSCLES
+#include "InternalForces/Muscles/State.h"
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+namespace BIORBD_NAMESPACE
+{
+namespace simulation
+{
+///
+/// \brief A subject of the scene, its place in the layout of the scene and its buffers
+///
+class SceneSubject
+{
+public:
+    SceneSubject(
+        const std::shared_ptr<Model>& model,
+        const SceneSubject* previous) :
+        m_model(model),
+        m_externalForces(std::make_shared<rigidbody::ExternalForceSet>(*model)),
+        m_firstQ(previous ? previous->m_firstQ + previous->m_model->nbQ() : 0),
+        m_firstQdot(previous ? previous->m_firstQdot + previous->m_model->nbQdot() : 0),
+        m_firstMarker(previous ? previous->m_firstMarker + previous->m_model->nbMarkers() : 0),
+        m_firstContact(previous ? previous->m_firstContact + previous->m_model->nbContacts() : 0),
+#ifdef MODULE_MUSCLES
+        m_firstMuscle(previous ? previous->m_firstMuscle + previous->m_model->nbMuscles() : 0),
+#endif
+        m_Q(*model),
+        m_QDot(*model),
+        m_QDDot(*model),
+        m_tau(*model)
+    {
+
+    }
+
+    std::shared_ptr<Model> m_model; ///< The model of the subject
+    std::shared_ptr<rigidbody::ExternalForceSet> m_externalForces; ///< The (empty) external forces of the subject
+    size_t m_firstQ; ///< The index of the first generalized coordinate in the scene
+    size_t m_firstQdot; ///< The index of the first generalized velocity in the scene
+    size_t m_firstMarker; ///< The index of the first marker in the scene
+    size_t m_firstContact; ///< The index of the first contact in the scene
+#ifdef MODULE_MUSCLES
+    size_t m_firstMuscle; ///< The index of the first muscle in the scene
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> m_emg; ///< The states of the muscles of the subject
+#endif
+    rigidbody::GeneralizedCoordinates m_Q; ///< The generalized coordinates of the subject
+    rigidbody::GeneralizedVelocity m_QDot; ///< The generalized velocities of the subject
+    rigidbody::GeneralizedAcceleration m_QDDot; ///< The generalized accelerations of the subject
+    rigidbody::GeneralizedTorque m_tau; ///< The generalized torques of the subject
+    utils::Matrix m_markers; ///< The markers of the subject
+};
+
+}
+}
+
+simulation::Scene::Scene(
+    size_t nbThreads) :
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads))
+{
+
+}
+
+simulation::Scene::Scene(
+    const std::vector<utils::Path>& paths,
+    size_t nbThreads) :
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads))
+{
+    for (const auto& path : paths) {
+        addSubject(path);
+    }
+}
+
+simulation::Scene::~Scene()
+{
+
+}
+
+size_t simulation::Scene::addSubject(
+    const utils::Path& path)
+{
+    return addSubject(std::make_shared<Model>(path));
+}
+
+size_t simulation::Scene::addSubject(
+    const std::shared_ptr<Model>& model)
+{
+    utils::Error::check(model != nullptr, "The model of the subject must be defined");
+    // The subjects are evaluated concurrently, so they cannot update the same model. The shallow copies
+    // of a model share all its data, the segments included, which is how they are recognized
+    for (const auto& subject : m_subjects) {
+        utils::Error::check(&subject->m_model->segments() != &model->segments(),
+                            "The model is already the one of another subject, or a shallow copy of it");
+    }
+    m_subjects.push_back(std::make_shared<SceneSubject>(
+                             model, m_subjects.empty() ? nullptr : m_subjects.back().get()));
+    return m_subjects.size() - 1;
+}
+
+size_t simulation::Scene::nbSubjects() const
+{
+    return m_subjects.size();
+}
+
+Model& simulation::Scene::subject(
+    size_t idx)
+{
+    utils::Error::check(idx < m_subjects.size(), "Subject index is out of range");
+    return *m_subjects[idx]->m_model;
+}
+
+size_t simulation::Scene::nbThreads() const
+{
+    return m_pool->nbThreads();
+}
+
+size_t simulation::Scene::nbQ() const
+{
+    return m_subjects.empty() ? 0 : m_subjects.back()->m_firstQ + m_subjects.back()->m_model->nbQ();
+}
+
+size_t simulation::Scene::nbQdot() const
+{
+    return m_subjects.empty() ? 0 : m_subjects.back()->m_firstQdot + m_subjects.back()->m_model->nbQdot();
+}
+
+size_t simulation::Scene::nbGeneralizedTorque() const
+{
+    // The generalized torques follow the layout of the generalized velocities
+    return nbQdot();
+}
+
+size_t simulation::Scene::nbMarkers() const
+{
+    return m_subjects.empty() ? 0 : m_subjects.back()->m_firstMarker + m_subjects.back()->m_model->nbMarkers();
+}
+
+size_t simulation::Scene::nbContacts() const
+{
+    return m_subjects.empty() ? 0 : m_subjects.back()->m_firstContact + m_subjects.back()->m_model->nbContacts();
+}
+
+#ifdef MODULE_MUSCLES
+size_t simulation::Scene::nbMuscles() const
+{
+    return m_subjects.empty() ? 0 : m_subjects.back()->m_firstMuscle + m_subjects.back()->m_model->nbMuscles();
+}
+#endif
+
+size_t simulation::Scene::firstQIndex(
+    size_t idx) const
+{
+    utils::Error::check(idx < m_subjects.size(), "Subject index is out of range");
+    return m_subjects[idx]->m_firstQ;
+}
+
+size_t simulation::Scene::firstQdotIndex(
+    size_t idx) const
+{
+    utils::Error::check(idx < m_subjects.size(), "Subject index is out of range");
+    return m_subjects[idx]->m_firstQdot;
+}
+
+void simulation::Scene::evaluate(
+    const utils::Vector& Q,
+    const utils::Vector* QDot,
+    const utils::Vector* QDDot,
+    int quantities,
+    std::vector<rigidbody::KinematicsResults>& results)
+{
+    checkSize(Q, nbQ(), "Q");
+    if (QDot) {
+        checkSize(*QDot, nbQdot(), "QDot");
+    }
+    if (QDDot) {
+        checkSize(*QDDot, nbQdot(), "QDDot");
+    }
+    results.resize(m_subjects.size());
+
+    m_pool->parallelFor(m_subjects.size(), [&](size_t idx, size_t) {
+        SceneSubject& subject(*m_subjects[idx]);
+        subject.m_Q = Q.segment(subject.m_firstQ, subject.m_model->nbQ());
+        if (QDot) {
+            subject.m_QDot = QDot->segment(subject.m_firstQdot, subject.m_model->nbQdot());
+        }
+        if (QDDot) {
+            subject.m_QDDot = QDDot->segment(subject.m_firstQdot, subject.m_model->nbQdot());
+        }
+        subject.m_model->evaluate(subject.m_Q, QDot ? &subject.m_QDot : nullptr,
+                                  QDDot ? &subject.m_QDDot : nullptr, quantities, results[idx]);
+    });
+}
+
+void simulation::Scene::markers(
+    const utils::Vector& Q,
+    utils::Matrix& positions,
+    bool removeAxis)
+{
+    checkSize(Q, nbQ(), "Q");
+    if (positions.rows() != 3 || static_cast<size_t>(positions.cols()) != nbMarkers()) {
+        positions.resize(3, static_cast<unsigned int>(nbMarkers()));
+    }
+
+    m_pool->parallelFor(m_subjects.size(), [&](size_t idx, size_t) {
+        SceneSubject& subject(*m_subjects[idx]);
+        subject.m_Q = Q.segment(subject.m_firstQ, subject.m_model->nbQ());
+        subject.m_model->markersInMatrix(subject.m_Q, subject.m_markers, removeAxis, true);
+        // The subjects write in distinct columns
+        positions.middleCols(subject.m_firstMarker, subject.m_markers.cols()) = subject.m_markers;
+    });
+}
+
+void simulation::Scene::ForwardDynamics(
+    const utils::Vector& Q,
+    const utils::Vector& QDot,
+    const utils::Vector& Tau,
+    utils::Vector& QDDot)
+{
+    checkSize(Q, nbQ(), "Q");
+    checkSize(QDot, nbQdot(), "QDot");
+    checkSize(Tau, nbGeneralizedTorque(), "Tau");
+    if (static_cast<size_t>(QDDot.size()) != nbQdot()) {
+        QDDot.resize(static_cast<unsigned int>(nbQdot()));
+    }
+
+    m_pool->parallelFor(m_subjects.size(), [&](size_t idx, size_t) {
+        SceneSubject& subject(*m_subjects[idx]);
+        size_t nbQdot(subject.m_model->nbQdot());
+        subject.m_Q = Q.segment(subject.m_firstQ, subject.m_model->nbQ());
+        subject.m_QDot = QDot.segment(subject.m_firstQdot, nbQdot);
+        subject.m_tau = Tau.segment(subject.m_firstQdot, nbQdot);
+        QDDot.segment(subject.m_firstQdot, nbQdot) =
+            subject.m_model->ForwardDynamics(subject.m_Q, subject.m_QDot, subject.m_tau,
+                                             *subject.m_externalForces);
+    });
+}
+
+void simulation::Scene::ForwardDynamicsConstraintsDirect(
+    const utils::Vector& Q,
+    const utils::Vector& QDot,
+    const utils::Vector& Tau,
+    utils::Vector& QDDot,
+    utils::Vector* contactForces)
+{
+    checkSize(Q, nbQ(), "Q");
+    checkSize(QDot, nbQdot(), "QDot");
+    checkSize(Tau, nbGeneralizedTorque(), "Tau");
+    if (static_cast<size_t>(QDDot.size()) != nbQdot()) {
+        QDDot.resize(static_cast<unsigned int>(nbQdot()));
+    }
+    if (contactForces && static_cast<size_t>(contactForces->size()) != nbContacts()) {
+        contactForces->resize(static_cast<unsigned int>(nbContacts()));
+    }
+
+    m_pool->parallelFor(m_subjects.size(), [&](size_t idx, size_t) {
+        SceneSubject& subject(*m_subjects[idx]);
+        Model& model(*subject.m_model);
+        size_t nbQdot(model.nbQdot());
+        subject.m_Q = Q.segment(subject.m_firstQ, model.nbQ());
+        subject.m_QDot = QDot.segment(subject.m_firstQdot, nbQdot);
+        subject.m_tau = Tau.segment(subject.m_firstQdot, nbQdot);
+        rigidbody::Contacts& CS(model.getConstraints());
+        model.ForwardDynamicsConstraintsDirect(subject.m_Q, subject.m_QDot, subject.m_tau, CS,
+                                               *subject.m_externalForces, subject.m_QDDot);
+        QDDot.segment(subject.m_firstQdot, nbQdot) = subject.m_QDDot;
+        if (contactForces && model.nbContacts()) {
+            contactForces->segment(subject.m_firstContact, model.nbContacts()) = CS.getForce();
+        }
+    });
+}
+
+void simulation::Scene::InverseDynamics(
+    const utils::Vector& Q,
+    const utils::Vector& QDot,
+    const utils::Vector& QDDot,
+    utils::Vector& Tau)
+{
+    checkSize(Q, nbQ(), "Q");
+    checkSize(QDot, nbQdot(), "QDot");
+    checkSize(QDDot, nbQdot(), "QDDot");
+    if (static_cast<size_t>(Tau.size()) != nbGeneralizedTorque()) {
+        Tau.resize(static_cast<unsigned int>(nbGeneralizedTorque()));
+    }
+
+    m_pool->parallelFor(m_subjects.size(), [&](size_t idx, size_t) {
+        SceneSubject& subject(*m_subjects[idx]);
+        size_t nbQdot(subject.m_model->nbQdot());
+        subject.m_Q = Q.segment(subject.m_firstQ, subject.m_model->nbQ());
+        subject.m_QDot = QDot.segment(subject.m_firstQdot, nbQdot);
+        subject.m_QDDot = QDDot.segment(subject.m_firstQdot, nbQdot);
+        Tau.segment(subject.m_firstQdot, nbQdot) =
+            subject.m_model->InverseDynamics(subject.m_Q, subject.m_QDot, subject.m_QDDot,
+                                             *subject.m_externalForces);
+    });
+}
+
+#ifdef MODULE_MUSCLES
+void simulation::Scene::muscleDrivenForwardDynamics(
+    const utils::Vector& Q,
+    const utils::Vector& QDot,
+    const std::vector<std::shared_ptr<internal_forces::muscles::State>>& emg,
+    utils::Vector& QDDot,
+    const utils::Vector* residualTau)
+{
+    checkSize(Q, nbQ(), "Q");
+    checkSize(QDot, nbQdot(), "QDot");
+    if (residualTau) {
+        checkSize(*residualTau, nbGeneralizedTorque(), "residualTau");
+    }
+    utils::Error::check(emg.size() == nbMuscles(),
+                        "The number of muscle states must be equal to the number of muscles of the scene");
+    if (static_cast<size_t>(QDDot.size()) != nbQdot()) {
+        QDDot.resize(static_cast<unsigned int>(nbQdot()));
+    }
+
+    m_pool->parallelFor(m_subjects.size(), [&](size_t idx, size_t) {
+        SceneSubject& subject(*m_subjects[idx]);
+        Model& model(*subject.m_model);
+        size_t nbQdot(model.nbQdot());
+        subject.m_Q = Q.segment(subject.m_firstQ, model.nbQ());
+        subject.m_QDot = QDot.segment(subject.m_firstQdot, nbQdot);
+        if (residualTau) {
+            subject.m_tau = residualTau->segment(subject.m_firstQdot, nbQdot);
+        }
+        subject.m_emg.assign(emg.begin() + static_cast<std::ptrdiff_t>(subject.m_firstMuscle),
+                             emg.begin() + static_cast<std::ptrdiff_t>(subject.m_firstMuscle + model.nbMuscles()));
+        model.muscleDrivenForwardDynamics(subject.m_Q, subject.m_QDot, subject.m_emg,
+                                          residualTau ? &subject.m_tau : nullptr, nullptr, false, subject.m_QDDot);
+        QDDot.segment(subject.m_firstQdot, nbQdot) = subject.m_QDDot;
+    });
+}
+#endif
+
+void simulation::Scene::checkSize(
+    const utils::Vector& vector,
+    size_t size,
+    const char* name) const
+{
+    if (static_cast<size_t>(vector.size()) != size) {
+        utils::Error::raise(utils::String("The size of ") + name + " must be equal to the one of the scene");
+    }
+}
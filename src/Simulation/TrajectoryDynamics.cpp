@@ -0,0 +1,107 @@
+#define BIORBD_API_EXPORTS
+#include "Simulation/TrajectoryDynamics.h"
+
+#include "BiorbdModel.h"
+#include "Utils/Error.h"
+#include "Utils/Matrix.h"
+#include "Utils/Path.h"
+#include "Utils/String.h"
+#include "Utils/ThreadPool.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
+#include "RigidBody/GeneralizedTorque.h"
+
+using namespace BIORBD_NAMESPACE;
+
+simulation::TrajectoryDynamics::TrajectoryDynamics(
+    const utils::Path& path,
+    size_t nbThreads) :
+    m_pool(std::make_shared<utils::ThreadPool>(nbThreads))
+{
+    for (size_t i=0; i<m_pool->nbThreads(); ++i) {
+        m_models.push_back(std::make_shared<Model>(path));
+    }
+}
+
+simulation::TrajectoryDynamics::~TrajectoryDynamics()
+{
+
+}
+
+size_t simulation::TrajectoryDynamics::nbThreads() const
+{
+    return m_pool->nbThreads();
+}
+
+Model& simulation::TrajectoryDynamics::model(
+    size_t thread)
+{
+    utils::Error::check(thread < m_models.size(), "Thread index is out of range");
+    return *m_models[thread];
+}
+
+void simulation::TrajectoryDynamics::InverseDynamics(
+    const utils::Matrix& Q,
+    const utils::Matrix& QDot,
+    const utils::Matrix& QDDot,
+    utils::Matrix& Tau)
+{
+    const Model& model(*m_models[0]);
+    size_t nbFrames(checkFrames(Q, QDot, QDDot, model.nbQddot(), "QDDot"));
+    unsigned int nbTau(static_cast<unsigned int>(model.nbGeneralizedTorque()));
+    if (static_cast<unsigned int>(Tau.rows()) != nbTau
+            || static_cast<size_t>(Tau.cols()) != nbFrames) {
+        Tau.resize(nbTau, static_cast<unsigned int>(nbFrames));
+    }
+
+    m_pool->parallelFor(nbFrames, [&](size_t frame, size_t thread) {
+        Model& model(*m_models[thread]);
+        unsigned int col(static_cast<unsigned int>(frame));
+        rigidbody::GeneralizedCoordinates q(utils::Vector(Q.col(col)));
+        rigidbody::GeneralizedVelocity qDot(utils::Vector(QDot.col(col)));
+        rigidbody::GeneralizedAcceleration qDDot(utils::Vector(QDDot.col(col)));
+        Tau.block(0, col, nbTau, 1) = model.InverseDynamics(q, qDot, qDDot);
+    });
+}
+
+void simulation::TrajectoryDynamics::ForwardDynamics(
+    const utils::Matrix& Q,
+    const utils::Matrix& QDot,
+    const utils::Matrix& Tau,
+    utils::Matrix& QDDot)
+{
+    const Model& model(*m_models[0]);
+    size_t nbFrames(checkFrames(Q, QDot, Tau, model.nbGeneralizedTorque(), "Tau"));
+    unsigned int nbQddot(static_cast<unsigned int>(model.nbQddot()));
+    if (static_cast<unsigned int>(QDDot.rows()) != nbQddot
+            || static_cast<size_t>(QDDot.cols()) != nbFrames) {
+        QDDot.resize(nbQddot, static_cast<unsigned int>(nbFrames));
+    }
+
+    m_pool->parallelFor(nbFrames, [&](size_t frame, size_t thread) {
+        Model& model(*m_models[thread]);
+        unsigned int col(static_cast<unsigned int>(frame));
+        rigidbody::GeneralizedCoordinates q(utils::Vector(Q.col(col)));
+        rigidbody::GeneralizedVelocity qDot(utils::Vector(QDot.col(col)));
+        rigidbody::GeneralizedTorque tau(utils::Vector(Tau.col(col)));
+        QDDot.block(0, col, nbQddot, 1) = model.ForwardDynamics(q, qDot, tau);
+    });
+}
+
+size_t simulation::TrajectoryDynamics::checkFrames(
+    const utils::Matrix& first,
+    const utils::Matrix& second,
+    const utils::Matrix& third,
+    size_t nbRowsThird,
+    const utils::String& nameThird) const
+{
+    const Model& model(*m_models[0]);
+    utils::Error::check(static_cast<size_t>(first.rows()) == model.nbQ(), "Q has the wrong number of rows");
+    utils::Error::check(static_cast<size_t>(second.rows()) == model.nbQdot(), "QDot has the wrong number of rows");
+    utils::Error::check(static_cast<size_t>(third.rows()) == nbRowsThird,
+                        nameThird + " has the wrong number of rows");
+    utils::Error::check(first.cols() == second.cols() && first.cols() == third.cols(),
+                        "All the inputs must have the same number of frames");
+    return static_cast<size_t>(first.cols());
+}
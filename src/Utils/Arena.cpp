@@ -0,0 +1,93 @@
+#define BIORBD_API_EXPORTS
+#include "Utils/Arena.h"
+
+#include <cstddef>
+#include <vector>
+#include "Utils/Error.h"
+
+using namespace BIORBD_NAMESPACE;
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+///
+/// \brief A block of memory of an arena and the destructors of its objects
+///
+class ArenaBlock
+{
+public:
+    ArenaBlock(
+        size_t size) :
+        m_memory(new std::max_align_t[(size + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]),
+        m_size(size),
+        m_used(0)
+    {
+    }
+
+    ~ArenaBlock()
+    {
+        // Destroy in the reverse order of construction, as for members
+        for (size_t i = m_destructors.size(); i > 0; --i) {
+            m_destructors[i-1].second(m_destructors[i-1].first);
+        }
+    }
+
+    std::unique_ptr<std::max_align_t[]> m_memory; ///< The memory of the objects
+    size_t m_size; ///< The size of the memory
+    size_t m_used; ///< The number of bytes already given to objects
+    std::vector<std::pair<void*, void(*)(void*)>> m_destructors; ///< The objects that must be destroyed
+};
+}
+}
+
+utils::Arena::Arena(
+    size_t blockSize) :
+    m_blockSize(blockSize),
+    m_nbBlocks(0),
+    m_bytes(0)
+{
+
+}
+
+utils::Arena::~Arena()
+{
+
+}
+
+size_t utils::Arena::nbBlocks() const
+{
+    return m_nbBlocks;
+}
+
+size_t utils::Arena::bytes() const
+{
+    return m_bytes;
+}
+
+void* utils::Arena::allocate(
+    size_t size,
+    size_t alignment)
+{
+    utils::Error::check(alignment <= alignof(std::max_align_t),
+                        "The alignment of the object is not supported by the arena");
+    size_t start(0);
+    if (m_block) {
+        start = (m_block->m_used + alignment - 1) / alignment * alignment;
+    }
+    if (!m_block || start + size > m_block->m_size) {
+        m_block = std::make_shared<ArenaBlock>(size > m_blockSize ? size : m_blockSize);
+        ++m_nbBlocks;
+        start = 0;
+    }
+    m_bytes += start + size - m_block->m_used;
+    m_block->m_used = start + size;
+    return reinterpret_cast<char*>(m_block->m_memory.get()) + start;
+}
+
+void utils::Arena::addDestructor(
+    void* object,
+    void (*destructor)(void*))
+{
+    m_block->m_destructors.push_back(std::make_pair(object, destructor));
+}
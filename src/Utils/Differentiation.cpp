@@ -0,0 +1,36 @@
+#define BIORBD_API_EXPORTS
+#include "Utils/Differentiation.h"
+
+#include "Utils/Error.h"
+
+using namespace BIORBD_NAMESPACE;
+
+#ifndef BIORBD_USE_CASADI_MATH
+utils::Matrix utils::Differentiation::finiteDifferences(
+    const std::function<utils::Vector(const utils::Vector&)>& f,
+    const utils::Vector& x,
+    double step,
+    utils::Vector* value)
+{
+    utils::Error::check(step > 0, "The step of the finite differences must be positive");
+    if (value) {
+        *value = f(x);
+    }
+
+    unsigned int nbInputs(static_cast<unsigned int>(x.size()));
+    utils::Matrix jacobian;
+    utils::Vector xStep(x);
+    for (unsigned int i = 0; i < nbInputs; ++i) {
+        xStep[i] = x[i] + step;
+        utils::Vector forward(f(xStep));
+        xStep[i] = x[i] - step;
+        utils::Vector backward(f(xStep));
+        xStep[i] = x[i];
+        if (i == 0) {
+            jacobian = utils::Matrix(static_cast<unsigned int>(forward.size()), nbInputs);
+        }
+        jacobian.col(i) = (forward - backward) / (2 * step);
+    }
+    return jacobian;
+}
+#endif
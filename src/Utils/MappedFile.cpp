@@ -0,0 +1,322 @@
+#define BIORBD_API_EXPORTS
+#include "Utils/MappedFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "Utils/Error.h"
+#include "Utils/Equation.h"
+#include "Utils/Path.h"
+#include "Utils/String.h"
+
+#ifdef _WIN32
+// Keep windows.h from defining the min and max macros that break std::min and std::max
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+///
+/// \brief The mapping of a file, released at destruction
+///
+class MappedFileHandle
+{
+public:
+    MappedFileHandle(
+        const utils::String& path) :
+        m_data(nullptr),
+        m_size(0)
+    {
+#ifdef _WIN32
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        utils::Error::check(m_file != INVALID_HANDLE_VALUE, "Could not open the file " + path);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size)) {
+            CloseHandle(m_file);
+            utils::Error::raise("Could not read the size of the file " + path);
+        }
+        m_size = static_cast<size_t>(size.QuadPart);
+        m_mapping = nullptr;
+        if (m_size) {
+            m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            utils::Error::check(m_mapping != nullptr, "Could not map the file " + path);
+            m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            utils::Error::check(m_data != nullptr, "Could not map the file " + path);
+        }
+#else
+        m_file = open(path.c_str(), O_RDONLY);
+        utils::Error::check(m_file >= 0, "Could not open the file " + path);
+        // The destructor is not called if the constructor raises, so the file is closed here
+        struct stat status;
+        if (fstat(m_file, &status) != 0) {
+            close(m_file);
+            utils::Error::raise("Could not read the size of the file " + path);
+        }
+        m_size = static_cast<size_t>(status.st_size);
+        if (m_size) {
+            void* data(mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0));
+            if (data == MAP_FAILED) {
+                close(m_file);
+                utils::Error::raise("Could not map the file " + path);
+            }
+            m_data = static_cast<const char*>(data);
+            // The files are parsed from the beginning to the end
+            madvise(data, m_size, MADV_SEQUENTIAL);
+        }
+#endif
+    }
+
+    ~MappedFileHandle()
+    {
+#ifdef _WIN32
+        if (m_data) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+        }
+        CloseHandle(m_file);
+#else
+        if (m_data) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+        close(m_file);
+#endif
+    }
+
+    const char* m_data; ///< The content of the file
+    size_t m_size; ///< The size of the file
+#ifdef _WIN32
+    HANDLE m_file; ///< The file
+    HANDLE m_mapping; ///< The mapping of the file
+#else
+    int m_file; ///< The file descriptor
+#endif
+};
+
+///
+/// \brief Parse a number with the C locale, so the decimal separator is always a dot
+/// \param buffer The terminated string to parse
+/// \param parsed The end of the parsed number
+/// \return The number
+///
+/// std::strtod follows the global locale, which the application embedding biorbd may have changed
+///
+static double toNumberInCLocale(
+    const char* buffer,
+    char** parsed)
+{
+#ifdef _WIN32
+    static _locale_t locale(_create_locale(LC_NUMERIC, "C"));
+    return _strtod_l(buffer, parsed, locale);
+#else
+    static locale_t locale(newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0)));
+    return strtod_l(buffer, parsed, locale);
+#endif
+}
+
+}
+}
+
+utils::MappedFile::MappedFile(
+    const utils::Path& path) :
+#ifdef _WIN32
+    m_handle(std::make_shared<MappedFileHandle>(utils::Path::toWindowsFormat(path.absolutePath()))),
+#else
+    m_handle(std::make_shared<MappedFileHandle>(path.absolutePath())),
+#endif
+    m_position(std::make_shared<size_t>(0))
+{
+
+}
+
+utils::MappedFile::~MappedFile()
+{
+
+}
+
+size_t utils::MappedFile::size() const
+{
+    return m_handle->m_size;
+}
+
+size_t utils::MappedFile::position() const
+{
+    return *m_position;
+}
+
+void utils::MappedFile::setPosition(
+    size_t position)
+{
+    *m_position = std::min(position, m_handle->m_size);
+}
+
+bool utils::MappedFile::eof() const
+{
+    return *m_position >= m_handle->m_size;
+}
+
+bool utils::MappedFile::readWord(
+    const char*& begin,
+    const char*& end)
+{
+    const char* data(m_handle->m_data);
+    size_t size(m_handle->m_size);
+    size_t& i(*m_position);
+    while (true) {
+        while (i < size && std::isspace(static_cast<unsigned char>(data[i]))) {
+            ++i;
+        }
+        if (i >= size) {
+            return false;
+        }
+        if (i + 1 < size && data[i] == '/' && data[i+1] == '/') {
+            while (i < size && data[i] != '\n') {
+                ++i;
+            }
+            continue;
+        }
+        if (i + 1 < size && data[i] == '/' && data[i+1] == '*') {
+            i += 2;
+            while (i + 1 < size && !(data[i] == '*' && data[i+1] == '/')) {
+                ++i;
+            }
+            i = std::min(i + 2, size);
+            continue;
+        }
+        break;
+    }
+    begin = data + i;
+    while (i < size && !std::isspace(static_cast<unsigned char>(data[i]))) {
+        ++i;
+    }
+    end = data + i;
+    return true;
+}
+
+bool utils::MappedFile::readTag(
+    const char* tag)
+{
+    const char* begin;
+    const char* end;
+    if (!readWord(begin, end)) {
+        return false;
+    }
+    size_t length(std::strlen(tag));
+    if (static_cast<size_t>(end - begin) != length) {
+        return false;
+    }
+    for (size_t i=0; i<length; ++i) {
+        if (std::tolower(static_cast<unsigned char>(begin[i]))
+                != std::tolower(static_cast<unsigned char>(tag[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool utils::MappedFile::reachTag(
+    const char* tag)
+{
+    while (!eof()) {
+        if (readTag(tag)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool utils::MappedFile::readNumber(
+    double& value)
+{
+    const char* begin;
+    const char* end;
+    if (!readWord(begin, end)) {
+        return false;
+    }
+    value = toNumber(begin, end);
+    return true;
+}
+
+bool utils::MappedFile::readLine(
+    const char*& begin,
+    const char*& end)
+{
+    const char* data(m_handle->m_data);
+    size_t size(m_handle->m_size);
+    size_t& i(*m_position);
+    if (i >= size) {
+        return false;
+    }
+    begin = data + i;
+    const char* newLine(static_cast<const char*>(std::memchr(begin, '\n', size - i)));
+    end = newLine ? newLine : data + size;
+    i = static_cast<size_t>(end - data) + (newLine ? 1 : 0);
+    if (end > begin && *(end - 1) == '\r') {
+        --end;
+    }
+    return true;
+}
+
+double utils::MappedFile::toNumber(
+    const char* begin,
+    const char* end)
+{
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(*(end - 1)))) {
+        --end;
+    }
+    if (begin == end) {
+        return 0;
+    }
+
+    // The parsing needs a terminated string, the numbers are short enough for the stack
+    char buffer[64];
+    size_t length(static_cast<size_t>(end - begin));
+    if (length < sizeof(buffer)) {
+        std::memcpy(buffer, begin, length);
+        buffer[length] = '\0';
+        char* parsed;
+        double value(toNumberInCLocale(buffer, &parsed));
+        if (parsed == buffer + length) {
+            return value;
+        }
+    }
+
+    // Not a plain number, it may be an equation
+    utils::Equation equation(std::string(begin, end));
+    try {
+        return utils::Equation::evaluateEquation(equation);
+    } catch (std::runtime_error&) {
+        utils::Error::raise("The following expression cannot be parsed properly: \""
+                                    + equation + "\"");
+    }
+#ifdef _WIN32
+    // It is impossible to get here, but it's better to have a return for the compiler
+    return 0;
+#endif
+}
@@ -0,0 +1,64 @@
+#define BIORBD_API_EXPORTS
+#include "Utils/MemoryFootprint.h"
+
+#include "Utils/String.h"
+
+using namespace BIORBD_NAMESPACE;
+
+utils::MemoryFootprint::MemoryFootprint() :
+    m_nbBlocks(0),
+    m_bytes(0)
+{
+
+}
+
+size_t utils::MemoryFootprint::nbBlocks() const
+{
+    return m_nbBlocks;
+}
+
+size_t utils::MemoryFootprint::bytes() const
+{
+    return m_bytes;
+}
+
+bool utils::MemoryFootprint::add(
+    const std::shared_ptr<utils::String>& text)
+{
+    if (!text || !addObject(text.get(), std::weak_ptr<const void>(text), sizeof(utils::String))) {
+        return false;
+    }
+    // Short strings are stored in the object itself
+    const char* object(reinterpret_cast<const char*>(text.get()));
+    if (text->data() < object || text->data() >= object + sizeof(utils::String)) {
+        addHeap(text->capacity() + 1);
+    }
+    return true;
+}
+
+void utils::MemoryFootprint::addHeap(
+    size_t bytes)
+{
+    if (bytes == 0) {
+        return;
+    }
+    ++m_nbBlocks;
+    m_bytes += bytes;
+}
+
+bool utils::MemoryFootprint::addObject(
+    const void* object,
+    const std::weak_ptr<const void>& owner,
+    size_t size)
+{
+    if (!m_objects.insert(object).second) {
+        return false;
+    }
+    if (m_owners.insert(owner).second) {
+        // The control block of the std::shared_ptr (vtable and the two counters)
+        ++m_nbBlocks;
+        m_bytes += sizeof(void*) + 2 * sizeof(int);
+    }
+    m_bytes += size;
+    return true;
+}
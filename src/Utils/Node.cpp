@@ -1,5 +1,6 @@
 #define BIORBD_API_EXPORTS
 #include "Utils/Node.h"
+#include "Utils/MemoryFootprint.h"
 
 #include "Utils/String.h"
 
@@ -81,3 +82,11 @@ utils::NODE_TYPE utils::Node::typeOfNode() const
 {
     return *m_typeOfNode;
 }
+
+void utils::Node::memoryFootprint(
+    utils::MemoryFootprint& footprint) const
+{
+    footprint.add(m_name);
+    footprint.add(m_parentName);
+    footprint.add(m_typeOfNode);
+}
@@ -0,0 +1,313 @@
+#define BIORBD_API_EXPORTS
+#include "Utils/Profiler.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include "Utils/Error.h"
+#include "Utils/String.h"
+#include "Utils/Path.h"
+
+using namespace BIORBD_NAMESPACE;
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+///
+/// \brief Number of calls and time spent in a zone
+///
+class ProfilerZoneTotal
+{
+public:
+    ProfilerZoneTotal() :
+        m_nbCalls(0),
+        m_duration(0),
+        m_selfDuration(0)
+    {
+    }
+
+    long long m_nbCalls; ///< Number of times the zone was closed
+    long long m_duration; ///< Total duration of the zone in nanoseconds
+    long long m_selfDuration; ///< Total duration of the zone without its nested zones in nanoseconds
+};
+
+///
+/// \brief Zones recorded by one thread
+///
+class ProfilerThreadBuffer
+{
+public:
+    std::mutex m_mutex; ///< Taken by the thread while it records and by the readers of the buffer
+    unsigned int m_threadId; ///< Index of the thread
+    std::vector<ProfilerEvent> m_events; ///< The closed zones, up to the maximum number of zones
+    std::vector<ProfilerEvent> m_opened; ///< The zones that are still opened
+    std::unordered_map<const char*, ProfilerZoneTotal> m_totals; ///< Totals of all the closed zones, kept or not
+};
+
+///
+/// \brief Shared state of the profiler
+///
+class ProfilerRegistry
+{
+public:
+    ProfilerRegistry() :
+        m_epoch(std::chrono::steady_clock::now()),
+        m_isEnabled(true),
+        m_maxEvents(1000000)
+    {
+    }
+
+    std::chrono::steady_clock::time_point m_epoch; ///< Time reference of all the zones
+    std::atomic<bool> m_isEnabled; ///< If the zones are recorded
+    std::atomic<size_t> m_maxEvents; ///< Maximum number of zones kept per thread
+    std::mutex m_mutex; ///< Protects the list of buffers
+    std::vector<std::shared_ptr<ProfilerThreadBuffer>> m_buffers; ///< Buffers of all the threads
+
+    ///
+    /// \brief Return the registry of the profiler
+    /// \return The registry
+    ///
+    static ProfilerRegistry& get()
+    {
+        static ProfilerRegistry registry;
+        return registry;
+    }
+
+    ///
+    /// \brief Return the buffer of the calling thread, registering it the first time
+    /// \return The buffer of the thread
+    ///
+    static ProfilerThreadBuffer& threadBuffer()
+    {
+        // The shared_ptr keeps the buffer alive in the registry after the thread ends
+        static thread_local std::shared_ptr<ProfilerThreadBuffer> buffer;
+        if (!buffer) {
+            ProfilerRegistry& registry(get());
+            std::lock_guard<std::mutex> lock(registry.m_mutex);
+            buffer = std::make_shared<ProfilerThreadBuffer>();
+            buffer->m_threadId = static_cast<unsigned int>(registry.m_buffers.size());
+            registry.m_buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    ///
+    /// \brief Return the time elapsed since the epoch
+    /// \return The time in nanoseconds
+    ///
+    long long now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - m_epoch).count();
+    }
+};
+
+}
+}
+
+void utils::Profiler::beginZone(
+    const char* name)
+{
+    ProfilerRegistry& registry(ProfilerRegistry::get());
+    ProfilerThreadBuffer& buffer(ProfilerRegistry::threadBuffer());
+    std::lock_guard<std::mutex> lock(buffer.m_mutex);
+
+    ProfilerEvent event;
+    event.m_name = name;
+    event.m_duration = 0;
+    event.m_childrenDuration = 0;
+    event.m_depth = static_cast<unsigned int>(buffer.m_opened.size());
+    event.m_threadId = buffer.m_threadId;
+    event.m_start = registry.now();
+    buffer.m_opened.push_back(event);
+}
+
+///
+/// \brief Close the last opened zone of the current thread
+/// \return If there was an opened zone
+///
+static bool closeLastZone()
+{
+    utils::ProfilerRegistry& registry(utils::ProfilerRegistry::get());
+    long long end(registry.now());
+    utils::ProfilerThreadBuffer& buffer(utils::ProfilerRegistry::threadBuffer());
+    std::lock_guard<std::mutex> lock(buffer.m_mutex);
+    if (buffer.m_opened.empty()) {
+        return false;
+    }
+
+    utils::ProfilerEvent event(buffer.m_opened.back());
+    event.m_duration = end - event.m_start;
+    buffer.m_opened.pop_back();
+    if (!buffer.m_opened.empty()) {
+        buffer.m_opened.back().m_childrenDuration += event.m_duration;
+    }
+
+    utils::ProfilerZoneTotal& total(buffer.m_totals[event.m_name]);
+    ++total.m_nbCalls;
+    total.m_duration += event.m_duration;
+    total.m_selfDuration += event.m_duration - event.m_childrenDuration;
+    if (buffer.m_events.size() < registry.m_maxEvents) {
+        buffer.m_events.push_back(event);
+    }
+    return true;
+}
+
+void utils::Profiler::endZone()
+{
+    utils::Error::check(closeLastZone(), "No profiler zone is opened on this thread");
+}
+
+void utils::Profiler::setEnabled(
+    bool enabled)
+{
+    ProfilerRegistry::get().m_isEnabled = enabled;
+}
+
+bool utils::Profiler::isEnabled()
+{
+    return ProfilerRegistry::get().m_isEnabled;
+}
+
+void utils::Profiler::setMaxEvents(
+    size_t maxEvents)
+{
+    ProfilerRegistry::get().m_maxEvents = maxEvents;
+}
+
+size_t utils::Profiler::maxEvents()
+{
+    return ProfilerRegistry::get().m_maxEvents;
+}
+
+void utils::Profiler::clear()
+{
+    ProfilerRegistry& registry(ProfilerRegistry::get());
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    for (auto& buffer : registry.m_buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->m_mutex);
+        utils::Error::check(buffer->m_opened.empty(),
+                            "The profiler cannot be cleared while zones are opened");
+        buffer->m_events.clear();
+        buffer->m_totals.clear();
+    }
+}
+
+std::vector<utils::ProfilerEvent> utils::Profiler::events()
+{
+    ProfilerRegistry& registry(ProfilerRegistry::get());
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    std::vector<ProfilerEvent> out;
+    for (auto& buffer : registry.m_buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->m_mutex);
+        out.insert(out.end(), buffer->m_events.begin(), buffer->m_events.end());
+    }
+    return out;
+}
+
+void utils::Profiler::exportChromeTrace(
+    const utils::Path& path)
+{
+    std::ofstream file(path.absolutePath().c_str(), std::ios::out);
+    utils::Error::check(file.is_open(), "File " + path.absolutePath() + " could not be open");
+
+    const std::vector<ProfilerEvent>& all(events());
+    file << "{\"traceEvents\":[";
+    file << std::fixed << std::setprecision(3);
+    for (size_t i=0; i<all.size(); ++i) {
+        std::string name;
+        for (const char* c = all[i].m_name; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                name += '\\';
+            }
+            name += *c;
+        }
+        if (i != 0) {
+            file << ",";
+        }
+        file << "\n{\"name\":\"" << name << "\",\"cat\":\"biorbd\",\"ph\":\"X\""
+             << ",\"ts\":" << static_cast<double>(all[i].m_start) / 1e3
+             << ",\"dur\":" << static_cast<double>(all[i].m_duration) / 1e3
+             << ",\"pid\":0,\"tid\":" << all[i].m_threadId << "}";
+    }
+    file << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+utils::String utils::Profiler::summary()
+{
+    // Aggregate the totals of the threads by name, they also hold the zones that were not kept
+    std::map<std::string, std::vector<long long>> zones; // count, total, self
+    {
+        ProfilerRegistry& registry(ProfilerRegistry::get());
+        std::lock_guard<std::mutex> lock(registry.m_mutex);
+        for (auto& buffer : registry.m_buffers) {
+            std::lock_guard<std::mutex> bufferLock(buffer->m_mutex);
+            for (const auto& total : buffer->m_totals) {
+                std::vector<long long>& zone(zones[total.first]);
+                if (zone.empty()) {
+                    zone.resize(3, 0);
+                }
+                zone[0] += total.second.m_nbCalls;
+                zone[1] += total.second.m_duration;
+                zone[2] += total.second.m_selfDuration;
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, std::vector<long long>>> sorted(zones.begin(), zones.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<std::string, std::vector<long long>>& a,
+    const std::pair<std::string, std::vector<long long>>& b) {
+        return a.second[1] > b.second[1];
+    });
+
+    size_t nameWidth(4);
+    for (const auto& zone : sorted) {
+        nameWidth = std::max(nameWidth, zone.first.size());
+    }
+
+    std::stringstream ss;
+    ss << std::left << std::setw(static_cast<int>(nameWidth)) << "Zone" << std::right
+       << std::setw(12) << "Calls"
+       << std::setw(16) << "Total (ms)"
+       << std::setw(16) << "Self (ms)"
+       << std::setw(16) << "Mean (us)" << "\n";
+    ss << std::fixed << std::setprecision(3);
+    for (const auto& zone : sorted) {
+        ss << std::left << std::setw(static_cast<int>(nameWidth)) << zone.first << std::right
+           << std::setw(12) << zone.second[0]
+           << std::setw(16) << static_cast<double>(zone.second[1]) / 1e6
+           << std::setw(16) << static_cast<double>(zone.second[2]) / 1e6
+           << std::setw(16) << static_cast<double>(zone.second[1]) / static_cast<double>(zone.second[0]) / 1e3
+           << "\n";
+    }
+    return ss.str();
+}
+
+utils::ProfilerZone::ProfilerZone(
+    const char* name) :
+    m_isOpened(Profiler::isEnabled())
+{
+    if (m_isOpened) {
+        Profiler::beginZone(name);
+    }
+}
+
+utils::ProfilerZone::~ProfilerZone()
+{
+    // A destructor must not throw, so a zone that was already closed (e.g. by an explicit endZone)
+    // is only reported in debug
+    if (m_isOpened) {
+        bool isClosed(closeLastZone());
+        assert(isClosed && "No profiler zone is opened on this thread");
+        (void)isClosed;
+    }
+}
@@ -0,0 +1,289 @@
+#define BIORBD_API_EXPORTS
+#include "Utils/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Utils/Error.h"
+
+using namespace BIORBD_NAMESPACE;
+
+namespace BIORBD_NAMESPACE
+{
+namespace utils
+{
+class ThreadPoolWorkers;
+
+///
+/// \brief The pool whose tasks the current thread is running (nullptr outside of a task)
+///
+static thread_local const ThreadPoolWorkers* currentWorkers(nullptr);
+
+///
+/// \brief The range of tasks owned by a thread
+///
+class ThreadPoolRange
+{
+public:
+    ThreadPoolRange() :
+        m_begin(0),
+        m_end(0)
+    {
+    }
+
+    std::mutex m_mutex; ///< Protects the range against the thieves
+    size_t m_begin; ///< The first task left
+    size_t m_end; ///< One past the last task left
+};
+
+///
+/// \brief Threads of a pool and the job they share
+///
+class ThreadPoolWorkers
+{
+public:
+    ThreadPoolWorkers() :
+        m_task(nullptr),
+        m_chunkSize(1),
+        m_deterministic(false),
+        m_abort(false),
+        m_nbBusy(0),
+        m_generation(0),
+        m_stop(false)
+    {
+    }
+
+    std::vector<std::thread> m_threads; ///< The threads (the calling thread is not in there)
+    std::vector<std::unique_ptr<ThreadPoolRange>> m_ranges; ///< The tasks left to each thread (the calling thread included)
+    std::mutex m_submit; ///< Serializes the calls to parallelFor
+    std::mutex m_mutex; ///< Protects the job
+    std::condition_variable m_wakeUp; ///< Signals a new job or the stop to the threads
+    std::condition_variable m_done; ///< Signals that the threads finished the job
+    const std::function<void(size_t, size_t)>* m_task; ///< The current job
+    size_t m_chunkSize; ///< The number of tasks taken at once from a range
+    bool m_deterministic; ///< If the threads only run their own range
+    std::atomic<bool> m_abort; ///< Set when a task threw, to skip the remaining tasks
+    size_t m_nbBusy; ///< The number of threads still on the current job
+    unsigned long long m_generation; ///< Incremented for each job, so a thread runs it once
+    bool m_stop; ///< If the threads must stop
+    std::exception_ptr m_error; ///< The first exception thrown by a task
+
+    ///
+    /// \brief Take the next chunk of the range of a thread
+    /// \param thread The index of the thread
+    /// \param begin The first task of the chunk
+    /// \param end One past the last task of the chunk
+    /// \return If there was a task left
+    ///
+    bool pop(
+        size_t thread,
+        size_t& begin,
+        size_t& end)
+    {
+        ThreadPoolRange& range(*m_ranges[thread]);
+        std::lock_guard<std::mutex> lock(range.m_mutex);
+        if (range.m_begin >= range.m_end) {
+            return false;
+        }
+        begin = range.m_begin;
+        end = std::min(range.m_begin + m_chunkSize, range.m_end);
+        range.m_begin = end;
+        return true;
+    }
+
+    ///
+    /// \brief Move the second half of the range of another thread to the range of a thread
+    /// \param thread The index of the thief
+    /// \return If some tasks were stolen
+    ///
+    bool steal(
+        size_t thread)
+    {
+        size_t nbRanges(m_ranges.size());
+        for (size_t i=1; i<nbRanges; ++i) {
+            ThreadPoolRange& victim(*m_ranges[(thread + i) % nbRanges]);
+            size_t begin;
+            size_t end;
+            {
+                std::lock_guard<std::mutex> lock(victim.m_mutex);
+                if (victim.m_begin >= victim.m_end) {
+                    continue;
+                }
+                end = victim.m_end;
+                begin = victim.m_begin + (victim.m_end - victim.m_begin) / 2;
+                victim.m_end = begin;
+            }
+            ThreadPoolRange& range(*m_ranges[thread]);
+            std::lock_guard<std::mutex> lock(range.m_mutex);
+            range.m_begin = begin;
+            range.m_end = end;
+            return true;
+        }
+        return false;
+    }
+
+    ///
+    /// \brief Run tasks of the current job until there is none left
+    /// \param thread The index of the thread
+    ///
+    void run(
+        size_t thread)
+    {
+        const ThreadPoolWorkers* previous(currentWorkers);
+        currentWorkers = this;
+        size_t begin;
+        size_t end;
+        while (pop(thread, begin, end) || (!m_deterministic && steal(thread) && pop(thread, begin, end))) {
+            for (size_t i = begin; i < end && !m_abort; ++i) {
+                try {
+                    (*m_task)(i, thread);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_error) {
+                        m_error = std::current_exception();
+                    }
+                    m_abort = true;
+                }
+            }
+        }
+        currentWorkers = previous;
+    }
+
+    ///
+    /// \brief Loop of a thread of the pool
+    /// \param thread The index of the thread
+    ///
+    void loop(
+        size_t thread)
+    {
+        unsigned long long generation(0);
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeUp.wait(lock, [&]() {
+                    return m_stop || m_generation != generation;
+                });
+                if (m_stop) {
+                    return;
+                }
+                generation = m_generation;
+            }
+            run(thread);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_nbBusy == 0) {
+                    m_done.notify_one();
+                }
+            }
+        }
+    }
+};
+
+}
+}
+
+utils::ThreadPool::ThreadPool(
+    size_t nbThreads) :
+    m_workers(std::make_shared<ThreadPoolWorkers>())
+{
+    if (nbThreads == 0) {
+        nbThreads = std::max(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(1));
+    }
+    ThreadPoolWorkers* workers(m_workers.get());
+    for (size_t i=0; i<nbThreads; ++i) {
+        m_workers->m_ranges.push_back(std::unique_ptr<ThreadPoolRange>(new ThreadPoolRange()));
+    }
+    for (size_t i=1; i<nbThreads; ++i) {
+        m_workers->m_threads.push_back(std::thread([workers, i]() {
+            workers->loop(i);
+        }));
+    }
+}
+
+utils::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_workers->m_mutex);
+        m_workers->m_stop = true;
+    }
+    m_workers->m_wakeUp.notify_all();
+    for (auto& thread : m_workers->m_threads) {
+        thread.join();
+    }
+}
+
+size_t utils::ThreadPool::nbThreads() const
+{
+    return m_workers->m_threads.size() + 1;
+}
+
+void utils::ThreadPool::parallelFor(
+    size_t nbTasks,
+    const std::function<void(size_t, size_t)>& task)
+{
+    if (nbTasks == 0) {
+        return;
+    }
+
+    ThreadPoolWorkers& workers(*m_workers);
+    // A task of this pool would wait forever for the job it is part of
+    utils::Error::check(currentWorkers != &workers, "A task cannot call parallelFor of its own pool");
+    std::lock_guard<std::mutex> submit(workers.m_submit);
+    {
+        std::lock_guard<std::mutex> lock(workers.m_mutex);
+        // Contiguous ranges, so each thread starts on tasks that are next to each other
+        size_t nbRanges(workers.m_ranges.size());
+        for (size_t i=0; i<nbRanges; ++i) {
+            ThreadPoolRange& range(*workers.m_ranges[i]);
+            std::lock_guard<std::mutex> rangeLock(range.m_mutex);
+            range.m_begin = i * nbTasks / nbRanges;
+            range.m_end = (i + 1) * nbTasks / nbRanges;
+        }
+        workers.m_task = &task;
+        workers.m_abort = false;
+        workers.m_nbBusy = workers.m_threads.size();
+        workers.m_error = nullptr;
+        ++workers.m_generation;
+    }
+    workers.m_wakeUp.notify_all();
+
+    workers.run(0);
+    {
+        std::unique_lock<std::mutex> lock(workers.m_mutex);
+        workers.m_done.wait(lock, [&]() {
+            return workers.m_nbBusy == 0;
+        });
+    }
+    if (workers.m_error) {
+        std::rethrow_exception(workers.m_error);
+    }
+}
+
+void utils::ThreadPool::setChunkSize(
+    size_t chunkSize)
+{
+    utils::Error::check(chunkSize > 0, "The chunk size must be positive");
+    std::lock_guard<std::mutex> submit(m_workers->m_submit);
+    m_workers->m_chunkSize = chunkSize;
+}
+
+size_t utils::ThreadPool::chunkSize() const
+{
+    return m_workers->m_chunkSize;
+}
+
+void utils::ThreadPool::setDeterministic(
+    bool deterministic)
+{
+    std::lock_guard<std::mutex> submit(m_workers->m_submit);
+    m_workers->m_deterministic = deterministic;
+}
+
+bool utils::ThreadPool::deterministic() const
+{
+    return m_workers->m_deterministic;
+}
@@ -1,19 +1,26 @@
 #include <iostream>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <rbdl/Dynamics.h>
 
 #include "BiorbdModel.h"
 #include "RigidBody/Joints.h"
+#include "ModelReader.h"
 #include "ModelWriter.h"
+#include "ReducedModel.h"
 #include "biorbdConfig.h"
 #include "Utils/String.h"
+#include "Utils/Matrix.h"
+#include "Utils/Vector3d.h"
 #include "Utils/RotoTrans.h"
 #include "Utils/RotoTransNode.h"
 #include "RigidBody/Segment.h"
+#include "RigidBody/SegmentCharacteristics.h"
 #include "RigidBody/NodeSegment.h"
 #include "RigidBody/IMU.h"
 #include "RigidBody/GeneralizedCoordinates.h"
 #include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
 #include "RigidBody/GeneralizedTorque.h"
 
 using namespace BIORBD_NAMESPACE;
@@ -88,6 +95,106 @@ TEST(FileIO, WriteModel)
 }
 #endif
 
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(FileIO, ReadDataFiles)
+{
+    utils::String kinPath("temporary.bioKin");
+    {
+        std::ofstream file(kinPath.c_str());
+        file << "version 1\n"
+             << "// A comment before the header\n"
+             << "nddl 3\n"
+             << "nbintervals 2\n"
+             << "T 0\n 0.1 0.2 0.3\n"
+             << "T 0.5 /* a comment\n in the data */ 1.1 -1.2e-1 pi/2\n"
+             << "T 1.0\r\n 2.1 2.2 2.3\r\n";
+    }
+    double expected[3][3] = {{0.1, 0.2, 0.3}, {1.1, -0.12, M_PI/2}, {2.1, 2.2, 2.3}};
+    double expectedTime[3] = {0, 0.5, 1};
+
+    // All at once
+    utils::Matrix Q;
+    utils::Vector time;
+    Reader::readQDataFile(kinPath, Q, time);
+    EXPECT_EQ(Q.rows(), 3);
+    EXPECT_EQ(Q.cols(), 3);
+    for (unsigned int j=0; j<3; ++j) {
+        EXPECT_NEAR(time[j], expectedTime[j], requiredPrecision);
+        for (unsigned int i=0; i<3; ++i) {
+            EXPECT_NEAR(Q(i, j), expected[j][i], requiredPrecision);
+        }
+    }
+
+    // As vectors
+    std::vector<rigidbody::GeneralizedCoordinates> Qvector(Reader::readQDataFile(kinPath));
+    EXPECT_EQ(Qvector.size(), 3);
+    for (unsigned int j=0; j<3; ++j) {
+        for (unsigned int i=0; i<3; ++i) {
+            EXPECT_NEAR(Qvector[j][i], expected[j][i], requiredPrecision);
+        }
+    }
+
+    // Frame by frame, twice
+    DataFileStream stream(kinPath, "nddl");
+    EXPECT_EQ(stream.nbVariables(), 3);
+    EXPECT_EQ(stream.nbFrames(), 3);
+    for (size_t k=0; k<2; ++k) {
+        double t;
+        utils::Vector values;
+        for (unsigned int j=0; j<3; ++j) {
+            EXPECT_EQ(stream.frame(), j);
+            EXPECT_TRUE(stream.next(t, values));
+            EXPECT_NEAR(t, expectedTime[j], requiredPrecision);
+            for (unsigned int i=0; i<3; ++i) {
+                EXPECT_NEAR(values[i], expected[j][i], requiredPrecision);
+            }
+        }
+        EXPECT_FALSE(stream.next(t, values));
+        stream.rewind();
+    }
+
+    // The size tag must be in the file
+    EXPECT_THROW(Reader::readTorqueDataFile(kinPath, Q, time), std::runtime_error);
+    remove(kinPath.c_str());
+
+    utils::String forcePath("temporary.csv");
+    {
+        std::ofstream file(forcePath.c_str());
+        file << "Devices\n"
+             << "1000\n"
+             << "\n"
+             << "Frame,Sub Frame,Cx,Cy,Cz,Fx,Fy,Fz,Mx,My,Mz\n"
+             << ",,mm,mm,mm,N,N,N,N.mm,N.mm,N.mm\n"
+             << "1,0,100,200,0,1,2,3,1000,2000,3000\n"
+             << "1,1,110,210,0,4,5,6,4000,5000,6000\n"
+             << "\n";
+    }
+    std::vector<utils::Matrix> forces;
+    std::vector<size_t> frequency;
+    Reader::readViconForceFile(forcePath, forces, frequency);
+    EXPECT_EQ(forces.size(), 1);
+    EXPECT_EQ(frequency[0], 1000);
+    EXPECT_EQ(forces[0].rows(), 10);
+    EXPECT_EQ(forces[0].cols(), 2);
+    double expectedForce[10] = {1, 0.11, 0.21, 0, 4, 5, 6, 4, 5, 6};
+    for (unsigned int i=0; i<10; ++i) {
+        EXPECT_NEAR(forces[0](i, 1), expectedForce[i], requiredPrecision);
+    }
+
+    std::vector<std::vector<size_t>> frame;
+    std::vector<std::vector<utils::Vector3d>> force;
+    std::vector<std::vector<utils::Vector3d>> moment;
+    std::vector<std::vector<utils::Vector3d>> cop;
+    frequency.clear();
+    Reader::readViconForceFile(forcePath, frame, frequency, force, moment, cop);
+    EXPECT_EQ(frame[0].size(), 2);
+    EXPECT_NEAR(cop[0][0][1], 0.2, requiredPrecision);
+    EXPECT_NEAR(force[0][0][2], 3, requiredPrecision);
+    EXPECT_NEAR(moment[0][1][0], 4, requiredPrecision);
+    remove(forcePath.c_str());
+}
+#endif
+
 TEST(GenericTests, mass)
 {
     Model model(modelPathForGeneralTesting);
@@ -95,6 +202,109 @@ TEST(GenericTests, mass)
     EXPECT_NEAR(mass, 52.41212, requiredPrecision);
 }
 
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(ReducedModel, lockDofs)
+{
+    Model model("models/pyomecaman.bioMod");
+    std::vector<size_t> lockedDofs = {0, 3, 6};
+    std::vector<double> lockedValues = {0.1, -0.3, 0.4};
+    ReducedModel reduced(model, lockedDofs, lockedValues);
+
+    // Locking the last rotation of BrasG splits it in two
+    EXPECT_EQ(reduced.nbQ(), model.nbQ() - 3);
+    EXPECT_EQ(reduced.nbQFull(), model.nbQ());
+    EXPECT_EQ(reduced.nbSegment(), model.nbSegment() + 1);
+    EXPECT_EQ(reduced.nbMarkers(), model.nbMarkers());
+    EXPECT_EQ(reduced.nbContacts(), model.nbContacts());
+    SCALAR_TO_DOUBLE(mass, model.mass());
+    SCALAR_TO_DOUBLE(reducedMass, reduced.mass());
+    EXPECT_NEAR(reducedMass, mass, requiredPrecision);
+
+    rigidbody::GeneralizedCoordinates QReduced(reduced);
+    rigidbody::GeneralizedVelocity QDotReduced(reduced);
+    rigidbody::GeneralizedAcceleration QDDotReduced(reduced);
+    for (unsigned int i=0; i<reduced.nbQ(); ++i) {
+        QReduced[i] = 0.1 * i - 0.5;
+        QDotReduced[i] = 0.2 * i;
+        QDDotReduced[i] = 1 - 0.3 * i;
+    }
+    rigidbody::GeneralizedCoordinates Q(reduced.expandQ(QReduced));
+    rigidbody::GeneralizedVelocity QDot(reduced.expand(QDotReduced));
+    rigidbody::GeneralizedAcceleration QDDot(reduced.expand(QDDotReduced));
+    for (size_t i=0; i<lockedDofs.size(); ++i) {
+        EXPECT_NEAR(Q[static_cast<unsigned int>(lockedDofs[i])], lockedValues[i], requiredPrecision);
+        EXPECT_NEAR(QDot[static_cast<unsigned int>(lockedDofs[i])], 0, requiredPrecision);
+    }
+    utils::Vector QBack(reduced.reduce(Q));
+    for (unsigned int i=0; i<reduced.nbQ(); ++i) {
+        EXPECT_NEAR(QBack[i], QReduced[i], requiredPrecision);
+    }
+
+    std::vector<rigidbody::NodeSegment> markers(model.markers(Q));
+    std::vector<rigidbody::NodeSegment> reducedMarkers(reduced.markers(QReduced));
+    for (size_t i=0; i<reducedMarkers.size(); ++i) {
+        for (unsigned int j=0; j<3; ++j) {
+            EXPECT_NEAR(reducedMarkers[i][j], markers[reduced.markerIndices()[i]][j], requiredPrecision);
+        }
+    }
+    utils::Vector3d com(model.CoM(Q));
+    utils::Vector3d reducedCom(reduced.CoM(QReduced));
+    for (unsigned int j=0; j<3; ++j) {
+        EXPECT_NEAR(reducedCom[j], com[j], requiredPrecision);
+    }
+
+    // The torques of the free DoF do not depend on how the locked ones are held
+    rigidbody::GeneralizedTorque Tau(model.InverseDynamics(Q, QDot, QDDot));
+    rigidbody::GeneralizedTorque TauReduced(reduced.InverseDynamics(QReduced, QDotReduced, QDDotReduced));
+    for (unsigned int i=0; i<reduced.nbGeneralizedTorque(); ++i) {
+        EXPECT_NEAR(TauReduced[i], Tau[static_cast<unsigned int>(reduced.dofIndices()[i])], requiredPrecision);
+    }
+
+    EXPECT_THROW(ReducedModel(model, {0, 0}, {0.1, 0.2}), std::runtime_error);
+    EXPECT_THROW(ReducedModel(model, {model.nbQ()}, {0.1}), std::runtime_error);
+}
+
+TEST(ReducedModel, pruneSegments)
+{
+    Model model("models/pyomecaman.bioMod");
+    ReducedModel reduced(model, {}, {}, {"CuisseG"});
+
+    // The children of CuisseG are removed with it
+    EXPECT_EQ(reduced.nbSegment(), model.nbSegment() - 3);
+    EXPECT_EQ(reduced.nbQ(), model.nbQ() - 3);
+    double prunedMass(0);
+    for (size_t i=0; i<model.nbSegment(); ++i) {
+        const utils::String& name(model.segment(i).name());
+        if (name == "CuisseG" || name == "JambeG" || name == "PiedG") {
+            SCALAR_TO_DOUBLE(segmentMass, model.segment(i).characteristics().mass());
+            prunedMass += segmentMass;
+        }
+    }
+    SCALAR_TO_DOUBLE(mass, model.mass());
+    SCALAR_TO_DOUBLE(reducedMass, reduced.mass());
+    EXPECT_NEAR(reducedMass, mass - prunedMass, requiredPrecision);
+    EXPECT_EQ(reduced.nbMarkers(), reduced.markerIndices().size());
+    EXPECT_LT(reduced.nbMarkers(), model.nbMarkers());
+
+    rigidbody::GeneralizedCoordinates QReduced(reduced);
+    for (unsigned int i=0; i<reduced.nbQ(); ++i) {
+        QReduced[i] = 0.3 - 0.1 * i;
+    }
+    rigidbody::GeneralizedCoordinates Q(reduced.expandQ(QReduced));
+    std::vector<rigidbody::NodeSegment> markers(model.markers(Q));
+    std::vector<rigidbody::NodeSegment> reducedMarkers(reduced.markers(QReduced));
+    for (size_t i=0; i<reducedMarkers.size(); ++i) {
+        EXPECT_STREQ(reducedMarkers[i].utils::Node::name().c_str(),
+                     markers[reduced.markerIndices()[i]].utils::Node::name().c_str());
+        for (unsigned int j=0; j<3; ++j) {
+            EXPECT_NEAR(reducedMarkers[i][j], markers[reduced.markerIndices()[i]][j], requiredPrecision);
+        }
+    }
+
+    EXPECT_THROW(ReducedModel(model, {}, {}, {"NotASegment"}), std::runtime_error);
+}
+#endif
+
 TEST(MeshFile, FileIO)
 {
     EXPECT_NO_THROW(Model model(modelPathWithMeshFile));
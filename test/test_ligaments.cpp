@@ -538,6 +538,42 @@ TEST(Ligaments, AddLigaments)
     }
 }
 
+TEST(Ligaments, DeepCopy)
+{
+    Model model(modelPathForGenericTest);
+    internal_forces::ligaments::Ligaments shallowCopy(model);
+    internal_forces::ligaments::Ligaments deepCopy(model.internal_forces::ligaments::Ligaments::DeepCopy());
+    EXPECT_EQ(deepCopy.nbLigaments(), model.nbLigaments());
+
+    std::vector<utils::String> originalNames;
+    std::vector<double> originalSlackLengths;
+    for (size_t i=0; i<model.nbLigaments(); ++i) {
+        originalNames.push_back(model.ligament(i).name());
+        SCALAR_TO_DOUBLE(slackLength, model.ligament(i).characteristics().ligamentSlackLength());
+        originalSlackLengths.push_back(slackLength);
+        EXPECT_STREQ(deepCopy.ligament(i).name().c_str(), originalNames[i].c_str());
+        EXPECT_EQ(deepCopy.ligament(i).type(), model.ligament(i).type());
+    }
+
+    // Changing every ligament of the deep copy leaves the original (and its shallow copies) untouched
+    for (size_t i=0; i<deepCopy.nbLigaments(); ++i) {
+        deepCopy.ligament(i).setName("CopiedLigament");
+        internal_forces::ligaments::LigamentCharacteristics characteristics(
+            deepCopy.ligament(i).characteristics());
+        characteristics.setLigamentSlackLength(originalSlackLengths[i] + 1);
+        deepCopy.ligament(i).setCharacteristics(characteristics);
+    }
+    for (size_t i=0; i<model.nbLigaments(); ++i) {
+        EXPECT_STREQ(deepCopy.ligament(i).name().c_str(), "CopiedLigament");
+        EXPECT_STREQ(model.ligament(i).name().c_str(), originalNames[i].c_str());
+        EXPECT_STREQ(shallowCopy.ligament(i).name().c_str(), originalNames[i].c_str());
+        SCALAR_TO_DOUBLE(slackLength, model.ligament(i).characteristics().ligamentSlackLength());
+        SCALAR_TO_DOUBLE(copiedSlackLength, deepCopy.ligament(i).characteristics().ligamentSlackLength());
+        EXPECT_NEAR(slackLength, originalSlackLengths[i], requiredPrecision);
+        EXPECT_NEAR(copiedSlackLength, originalSlackLengths[i] + 1, requiredPrecision);
+    }
+}
+
 TEST(ligamentForce, force)
 {
     Model model(modelPathForGenericTest);
@@ -582,6 +618,44 @@ TEST(LigamentTorque, torqueFromLigaments)
     }
 }
 
+TEST(LigamentTorque, batchedMatchesLigamentByLigament)
+{
+    Model model(modelPathForGenericTest);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q = Q.setOnes()/5;
+    QDot = QDot.setOnes()/3;
+
+    // Reference computed one ligament at a time
+    std::vector<double> forcesExpected;
+    for (size_t i=0; i<model.nbLigaments(); ++i) {
+        SCALAR_TO_DOUBLE(force, model.ligament(i).force(model, Q, QDot));
+        forcesExpected.push_back(force);
+    }
+    utils::Vector forces(model.nbLigaments());
+    for (size_t i=0; i<model.nbLigaments(); ++i) {
+        forces(static_cast<unsigned int>(i)) = forcesExpected[i];
+    }
+    model.updateLigaments(Q, QDot, true);
+    rigidbody::GeneralizedTorque tauExpected(
+        -model.ligamentsLengthJacobian().transpose() * forces);
+
+    const utils::Vector& F = model.ligamentForces(Q, QDot);
+    for (unsigned int i=0; i<model.nbLigaments(); ++i) {
+        SCALAR_TO_DOUBLE(val, F(i));
+        EXPECT_NEAR(val, forcesExpected[i], requiredPrecision);
+        SCALAR_TO_DOUBLE(valLigament, model.ligament(i).force());
+        EXPECT_NEAR(valLigament, forcesExpected[i], requiredPrecision);
+    }
+
+    rigidbody::GeneralizedTorque tau(model.ligamentsJointTorque(Q, QDot));
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        SCALAR_TO_DOUBLE(val, tau(i));
+        SCALAR_TO_DOUBLE(valExpected, tauExpected(i));
+        EXPECT_NEAR(val, valExpected, requiredPrecision);
+    }
+}
+
 TEST(LigamentCharacterics, unittest)
 {
     {
@@ -3,6 +3,7 @@
 
 #include <rbdl/Dynamics.h>
 #include "BiorbdModel.h"
+#include "ReducedModel.h"
 #include "biorbdConfig.h"
 #include "Utils/Matrix.h"
 #include "RigidBody/GeneralizedCoordinates.h"
@@ -10,6 +11,7 @@
 #include "RigidBody/GeneralizedAcceleration.h"
 #include "RigidBody/GeneralizedTorque.h"
 #include "RigidBody/NodeSegment.h"
+#include "RigidBody/ExternalForceSet.h"
 #include "InternalForces/Muscles/all.h"
 #include "InternalForces/all.h"
 
@@ -2570,6 +2572,99 @@ TEST(Muscles, errors)
 
     EXPECT_THROW(muscles.muscleGroup(1), std::runtime_error);
     EXPECT_THROW(muscles.muscleGroup("nameNoExists"), std::runtime_error);
+    EXPECT_THROW(muscles.addMuscleGroup("muscleGroupName", "originName", "insertionName"),
+                 std::runtime_error);
+}
+
+TEST(Muscles, groupIndex)
+{
+    internal_forces::muscles::Muscles muscles;
+    muscles.addMuscleGroup("first", "originName", "insertionName");
+    muscles.addMuscleGroup("second", "originName", "insertionName");
+    EXPECT_EQ(muscles.getMuscleGroupId("first"), 0);
+    EXPECT_EQ(muscles.getMuscleGroupId("second"), 1);
+    EXPECT_EQ(muscles.getMuscleGroupId("third"), -1);
+
+    // A renamed group is found from its new name only
+    muscles.muscleGroup(1).setName("third");
+    EXPECT_EQ(muscles.getMuscleGroupId("second"), -1);
+    EXPECT_EQ(muscles.getMuscleGroupId("third"), 1);
+    EXPECT_STREQ(muscles.muscleGroup("third").origin().c_str(), "originName");
+}
+
+TEST(Muscles, activationsDot)
+{
+#ifndef BIORBD_USE_CASADI_MATH
+    std::vector<std::string> paths = {
+        modelPathForMuscleForce, modelPathForBuchananDynamics, modelPathForDeGrooteDynamics
+    };
+    for (const auto& path : paths) {
+        Model model(path);
+        unsigned int nbMuscles(static_cast<unsigned int>(model.nbMuscles()));
+        std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+        utils::Vector excitations(nbMuscles);
+        utils::Vector activations(nbMuscles);
+        for (unsigned int i=0; i<nbMuscles; ++i) {
+            // Activating and deactivating muscles, the first one being below the minimal activation
+            excitations(i) = static_cast<double>(i) / nbMuscles;
+            activations(i) = 0.4;
+            states[i]->setExcitation(excitations(i));
+            states[i]->setActivation(activations(i));
+        }
+
+        for (bool normalized : {true, false}) {
+            utils::Vector expected(model.activationDot(states, normalized));
+            utils::Vector activationsDot;
+            model.activationsDot(excitations, activations, activationsDot, normalized);
+            EXPECT_EQ(activationsDot.size(), nbMuscles);
+            for (unsigned int i=0; i<nbMuscles; ++i) {
+                EXPECT_NEAR(activationsDot(i), expected(i), requiredPrecision);
+            }
+        }
+
+        utils::Vector activationsDot;
+        EXPECT_THROW(model.activationsDot(utils::Vector(nbMuscles + 1), activations,
+                                          activationsDot), std::runtime_error);
+    }
+#endif
+}
+
+TEST(Muscles, fatigueStatesDot)
+{
+#ifndef BIORBD_USE_CASADI_MATH
+    Model model(modelPathForXiaDerivativeTest);
+    unsigned int nbMuscles(static_cast<unsigned int>(model.nbMuscles()));
+    utils::Vector activations(nbMuscles);
+    utils::Vector activeFibers(nbMuscles);
+    utils::Vector fatiguedFibers(nbMuscles);
+    utils::Vector restingFibers(nbMuscles);
+    for (unsigned int i=0; i<nbMuscles; ++i) {
+        // Developing with and without enough resting fibers, and recovering
+        activations(i) = i % 3 == 2 ? 0.1 : 1.0;
+        activeFibers(i) = 0.5;
+        fatiguedFibers(i) = i % 3 == 0 ? 0.0 : 0.4;
+        restingFibers(i) = 1.0 - activeFibers(i) - fatiguedFibers(i);
+    }
+
+    utils::Vector activeFibersDot;
+    utils::Vector fatiguedFibersDot;
+    utils::Vector restingFibersDot;
+    model.fatigueStatesDot(activations, activeFibers, fatiguedFibers, restingFibers,
+                           activeFibersDot, fatiguedFibersDot, restingFibersDot);
+    for (unsigned int i=0; i<nbMuscles; ++i) {
+        internal_forces::muscles::StateDynamics emg(0, activations(i));
+        internal_forces::muscles::FatigueDynamicStateXia fatigue;
+        fatigue.setState(activeFibers(i), fatiguedFibers(i), restingFibers(i));
+        fatigue.timeDerivativeState(emg, model.muscle(i).characteristics());
+        EXPECT_NEAR(activeFibersDot(i), fatigue.activeFibersDot(), requiredPrecision);
+        EXPECT_NEAR(fatiguedFibersDot(i), fatigue.fatiguedFibersDot(), requiredPrecision);
+        EXPECT_NEAR(restingFibersDot(i), fatigue.restingFibersDot(), requiredPrecision);
+    }
+
+    EXPECT_THROW(model.fatigueStatesDot(activations, activeFibers, fatiguedFibers,
+                                        utils::Vector(nbMuscles - 1), activeFibersDot, fatiguedFibersDot,
+                                        restingFibersDot), std::runtime_error);
+#endif
 }
 
 TEST(Muscles, deepCopy)
@@ -2798,6 +2893,153 @@ TEST(MuscleForce, torqueFromMuscles)
     }
 }
 
+TEST(MuscleForce, muscleDrivenForwardDynamics)
+{
+    {
+        Model model(modelPathForMuscleForce);
+        rigidbody::GeneralizedCoordinates Q(model);
+        rigidbody::GeneralizedVelocity QDot(model);
+        Q.setOnes();
+        QDot.setOnes();
+        std::vector<std::shared_ptr<internal_forces::muscles::State>> states;
+        for (size_t i=0; i<model.nbMuscleTotal(); ++i) {
+            states.push_back(std::make_shared<internal_forces::muscles::StateDynamics>(0, 0.2));
+        }
+
+        // Same values as the torqueFromMuscles test
+        std::vector<double> QDDotExpected({-21.778696890631039, -26.807322754152935});
+        rigidbody::GeneralizedAcceleration QDDot(model.muscleDrivenForwardDynamics(Q, QDot, states));
+        rigidbody::ExternalForceSet externalForces(model.externalForceSet());
+        rigidbody::GeneralizedAcceleration QDDotWithForces(
+            model.muscleDrivenForwardDynamics(Q, QDot, states, externalForces));
+        for (unsigned int i=0; i<QDDot.size(); ++i) {
+            SCALAR_TO_DOUBLE(val, QDDot(i));
+            EXPECT_NEAR(val, QDDotExpected[i], requiredPrecision);
+            SCALAR_TO_DOUBLE(valWithForces, QDDotWithForces(i));
+            EXPECT_NEAR(valWithForces, QDDotExpected[i], requiredPrecision);
+        }
+
+        // The residual torques are added to the muscle torques
+        rigidbody::GeneralizedTorque residualTau(model);
+        residualTau.setOnes();
+        rigidbody::GeneralizedTorque Tau(model.muscularJointTorque(states, Q, QDot));
+        Tau += residualTau;
+        rigidbody::GeneralizedAcceleration QDDotExpectedWithResidual(model.ForwardDynamics(Q, QDot, Tau));
+        model.muscleDrivenForwardDynamics(Q, QDot, states, &residualTau, nullptr, false, QDDot);
+        for (unsigned int i=0; i<QDDot.size(); ++i) {
+            SCALAR_TO_DOUBLE(val, QDDot(i));
+            SCALAR_TO_DOUBLE(expected, QDDotExpectedWithResidual(i));
+            EXPECT_NEAR(val, expected, requiredPrecision);
+        }
+
+        states.pop_back();
+        EXPECT_THROW(model.muscleDrivenForwardDynamics(Q, QDot, states), std::runtime_error);
+    }
+
+#if defined(MODULE_LIGAMENTS) && defined(MODULE_PASSIVE_TORQUES)
+    for (const auto& path : {"models/arm26_WithLigaments.bioMod", "models/arm26_WithPassiveTorques.bioMod"}) {
+        // The ligaments and the passive torques are accumulated with the muscles
+        Model model(path);
+        rigidbody::GeneralizedCoordinates Q(model);
+        rigidbody::GeneralizedVelocity QDot(model);
+        Q.setOnes();
+        QDot.setOnes();
+        std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+        for (auto& state : states) {
+            state->setActivation(0.2);
+        }
+
+        rigidbody::GeneralizedTorque Tau(model.muscularJointTorque(states, Q, QDot));
+        if (model.nbLigaments()) {
+            Tau += model.ligamentsJointTorque(Q, QDot);
+        }
+        if (model.nbPassiveTorques()) {
+            Tau += model.passiveJointTorque(Q, QDot);
+        }
+        rigidbody::GeneralizedAcceleration QDDotExpected(model.ForwardDynamics(Q, QDot, Tau));
+        rigidbody::GeneralizedAcceleration QDDot(model.muscleDrivenForwardDynamics(Q, QDot, states));
+        for (unsigned int i=0; i<QDDot.size(); ++i) {
+            SCALAR_TO_DOUBLE(val, QDDot(i));
+            SCALAR_TO_DOUBLE(expected, QDDotExpected(i));
+            EXPECT_NEAR(val, expected, requiredPrecision);
+        }
+    }
+#endif
+}
+
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(MuscleForce, reducedModel)
+{
+    Model model(modelPathForMuscleForce);
+    ReducedModel reduced(model, {1}, {0.5});
+
+    // The muscles between the humerus and the forearm cannot move with a locked elbow
+    EXPECT_EQ(reduced.nbQ(), 1);
+    EXPECT_EQ(reduced.nbMuscleGroups(), 1);
+    EXPECT_STREQ(reduced.muscleGroup(0).name().c_str(), "base_to_r_ulna_radius_hand");
+    EXPECT_EQ(reduced.nbMuscles(), reduced.muscleIndices().size());
+    EXPECT_LT(reduced.nbMuscles(), model.nbMuscles());
+
+    rigidbody::GeneralizedCoordinates QReduced(reduced);
+    rigidbody::GeneralizedVelocity QDotReduced(reduced);
+    QReduced.setOnes();
+    QDotReduced.setOnes();
+    rigidbody::GeneralizedCoordinates Q(reduced.expandQ(QReduced));
+    rigidbody::GeneralizedVelocity QDot(reduced.expand(QDotReduced));
+
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+    for (auto& state : states) {
+        state->setActivation(0.3);
+    }
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> reducedStates(reduced.stateSet());
+    for (auto& state : reducedStates) {
+        state->setActivation(0.3);
+    }
+    rigidbody::GeneralizedTorque Tau(model.muscularJointTorque(states, Q, QDot));
+    rigidbody::GeneralizedTorque TauReduced(reduced.muscularJointTorque(reducedStates, QReduced, QDotReduced));
+    SCALAR_TO_DOUBLE(shoulder, Tau[0]);
+    SCALAR_TO_DOUBLE(shoulderReduced, TauReduced[0]);
+    EXPECT_NEAR(shoulderReduced, shoulder, requiredPrecision);
+
+    // Unless they are explicitly kept
+    ReducedModel reducedWithAllMuscles(model, {1}, {0.5}, {}, true);
+    EXPECT_EQ(reducedWithAllMuscles.nbMuscleGroups(), model.nbMuscleGroups());
+    EXPECT_EQ(reducedWithAllMuscles.nbMuscles(), model.nbMuscles());
+}
+#endif
+
+TEST(MuscleForce, memoryFootprint)
+{
+    Model model(modelPathForMuscleForce);
+    std::map<utils::String, utils::MemoryFootprint> footprints(model.memoryFootprint());
+    for (auto subsystem : {"segments", "markers", "imus", "rts", "contacts", "muscles"}) {
+        EXPECT_EQ(footprints.count(subsystem), 1);
+    }
+    EXPECT_GT(footprints["segments"].nbBlocks(), 0);
+    EXPECT_GT(footprints["muscles"].nbBlocks(), 0);
+    EXPECT_GT(footprints["muscles"].bytes(), footprints["muscles"].nbBlocks());
+
+    // A shallow copy shares the memory of the muscle, a deep copy shares nothing
+    const internal_forces::muscles::HillType& muscle(
+        dynamic_cast<const internal_forces::muscles::HillType&>(
+            model.muscleGroup(muscleGroupForHillType).muscle(muscleForHillType)));
+    utils::MemoryFootprint footprint;
+    muscle.memoryFootprint(footprint);
+    size_t nbBlocks(footprint.nbBlocks());
+    size_t bytes(footprint.bytes());
+    internal_forces::muscles::HillType shallowCopy(muscle);
+    shallowCopy.memoryFootprint(footprint);
+    EXPECT_EQ(footprint.nbBlocks(), nbBlocks);
+    EXPECT_EQ(footprint.bytes(), bytes);
+    internal_forces::muscles::HillType deepCopy(muscle.DeepCopy());
+    utils::MemoryFootprint deepFootprint;
+    deepCopy.memoryFootprint(deepFootprint);
+    deepCopy.memoryFootprint(footprint);
+    EXPECT_GT(deepFootprint.nbBlocks(), 0);
+    EXPECT_EQ(footprint.nbBlocks(), nbBlocks + deepFootprint.nbBlocks());
+    EXPECT_EQ(footprint.bytes(), bytes + deepFootprint.bytes());
+}
+
 TEST(MuscleCharacterics, unittest)
 {
     {
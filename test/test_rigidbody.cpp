@@ -3,6 +3,7 @@
 #include <rbdl/rbdl_math.h>
 #include <rbdl/Dynamics.h>
 #include <string.h>
+#include <limits>
 
 #include "BiorbdModel.h"
 #include "biorbdConfig.h"
@@ -17,14 +18,21 @@
 #include "RigidBody/GeneralizedVelocity.h"
 #include "RigidBody/GeneralizedAcceleration.h"
 #include "RigidBody/GeneralizedTorque.h"
+#include "RigidBody/KinematicsResults.h"
 #include "RigidBody/Mesh.h"
 #include "RigidBody/SegmentCharacteristics.h"
 #include "RigidBody/SoftContactSphere.h"
 #include "RigidBody/NodeSegment.h"
+#include "RigidBody/MarkersInverseKinematics.h"
+#include "RigidBody/MeshCollisions.h"
+#include "RigidBody/SoftContactMesh.h"
+#include "RigidBody/TerrainHeightfield.h"
+#include "RigidBody/TerrainMesh.h"
 #include "RigidBody/Segment.h"
 #include "RigidBody/IMU.h"
 #ifdef MODULE_KALMAN
     #include "RigidBody/KalmanReconsMarkers.h"
+    #include "RigidBody/KalmanReconsMarkersTrials.h"
     #include "RigidBody/KalmanReconsIMU.h"
 #endif
 
@@ -47,6 +55,7 @@ static std::string modelSimple("models/cube.bioMod");
 static std::string modelWithRigidContactsExternalForces("models/cubeWithRigidContactsExternalForces.bioMod");
 static std::string modelWithSoftContactRigidContactsExternalForces("models/cubeWithSoftContactsRigidContactsExternalForces.bioMod");
 static std::string modelWithSoftContact("models/cubeWithSoftContacts.bioMod");
+static std::string modelWithMeshSoftContact("models/cubeWithMeshSoftContact.bioMod");
 
 
 TEST(Gravity, change)
@@ -1023,6 +1032,40 @@ TEST(Segment, findDofs) {
 
 }
 
+TEST(Segment, nameIndices) {
+    Model model(modelPathForGeneralTesting);
+
+    size_t dofCount(0);
+    for (size_t i=0; i<model.nbSegment(); ++i) {
+        const rigidbody::Segment& segment(model.segment(i));
+        EXPECT_EQ(model.getBodyBiorbdId(segment.name()), static_cast<int>(i));
+        EXPECT_EQ(model.getBodyRbdlId(segment.name()),
+                  static_cast<int>(model.GetBodyId(segment.name().c_str())));
+        EXPECT_EQ(model.getBodyRbdlIdToBiorbdId(
+                      static_cast<int>(model.getBodyBiorbdIdToRbdlId(static_cast<int>(i)))),
+                  static_cast<int>(i));
+        for (size_t j=0; j<segment.nbDof(); ++j) {
+            EXPECT_EQ(model.getDofIndex(segment.name(), segment.nameDof(j)), dofCount + j);
+        }
+        if (segment.nbDof() > 0) {
+            EXPECT_EQ(segment.getFirstDofIndexInGeneralizedCoordinates(model), dofCount);
+            EXPECT_EQ(segment.getLastDofIndexInGeneralizedCoordinates(model),
+                      dofCount + segment.nbDof() - 1);
+        }
+        dofCount += segment.nbDof();
+    }
+    EXPECT_EQ(model.getBodyBiorbdId("NoSuchSegment"), -1);
+    EXPECT_EQ(model.getBodyRbdlId("NoSuchSegment"),
+              static_cast<int>(std::numeric_limits<unsigned int>::max()));
+    EXPECT_THROW(model.getDofIndex("NoSuchSegment", "RotX"), std::runtime_error);
+
+    // The indices are kept by the copies
+    rigidbody::Joints copy(model.rigidbody::Joints::DeepCopy());
+    EXPECT_EQ(copy.getBodyBiorbdId(model.segment(2).name()), 2);
+    EXPECT_EQ(copy.segment(2).getFirstDofIndexInGeneralizedCoordinates(copy),
+              model.segment(2).getFirstDofIndexInGeneralizedCoordinates(model));
+}
+
 static std::string modelPathForRTsane("models/IMUandCustomRT/RT_sane.bioMod");
 static std::string
 modelPathForRTwrong1("models/IMUandCustomRT/RT_wrong1.bioMod");
@@ -1324,6 +1367,111 @@ TEST(CoM, kinematics)
     }
 }
 
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(Kinematics, evaluate)
+{
+    Model model(modelPathForGeneralTesting);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity Qdot(model);
+    rigidbody::GeneralizedAcceleration Qddot(model);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        Q[i] = QtestPyomecaman[i];
+        Qdot[i] = QtestPyomecaman[i]*10;
+        Qddot[i] = QtestPyomecaman[i]*100;
+    }
+
+    rigidbody::KinematicsResults results;
+    model.evaluate(Q, &Qdot, &Qddot, rigidbody::KINEMATICS_ALL, results);
+
+    utils::Matrix markers(model.markersInMatrix(Q));
+    EXPECT_EQ(results.m_markers.cols(), markers.cols());
+    for (unsigned int j=0; j<markers.cols(); ++j) {
+        for (unsigned int i=0; i<3; ++i) {
+            EXPECT_NEAR(results.m_markers(i, j), markers(i, j), requiredPrecision);
+        }
+    }
+    utils::Vector3d com(model.CoM(Q));
+    utils::Vector3d comDot(model.CoMdot(Q, Qdot));
+    utils::Vector3d comDdot(model.CoMddot(Q, Qdot, Qddot));
+    utils::Vector3d angularMomentum(model.angularMomentum(Q, Qdot));
+    for (unsigned int i=0; i<3; ++i) {
+        EXPECT_NEAR(results.m_CoM[i], com[i], requiredPrecision);
+        EXPECT_NEAR(results.m_CoMdot[i], comDot[i], requiredPrecision);
+        EXPECT_NEAR(results.m_CoMddot[i], comDdot[i], requiredPrecision);
+        EXPECT_NEAR(results.m_angularMomentum[i], angularMomentum[i], requiredPrecision);
+    }
+    std::vector<utils::Vector3d> segmentsMomentum(model.CalcSegmentsAngularMomentum(Q, Qdot, true));
+    EXPECT_EQ(static_cast<size_t>(results.m_segmentsAngularMomentum.cols()), segmentsMomentum.size());
+    for (unsigned int j=0; j<segmentsMomentum.size(); ++j) {
+        for (unsigned int i=0; i<3; ++i) {
+            EXPECT_NEAR(results.m_segmentsAngularMomentum(i, j), segmentsMomentum[j][i], requiredPrecision);
+        }
+    }
+    EXPECT_NEAR(results.m_kineticEnergy, model.KineticEnergy(Q, Qdot), requiredPrecision);
+    EXPECT_NEAR(results.m_potentialEnergy, model.PotentialEnergy(Q), requiredPrecision);
+    EXPECT_NEAR(results.m_kineticEnergy + results.m_potentialEnergy, model.TotalEnergy(Q, Qdot),
+                requiredPrecision);
+    std::vector<utils::RotoTrans> jcs(model.allGlobalJCS(Q));
+    EXPECT_EQ(results.m_globalJCS.size(), jcs.size());
+    for (size_t k=0; k<jcs.size(); ++k) {
+        for (unsigned int i=0; i<4; ++i) {
+            for (unsigned int j=0; j<4; ++j) {
+                EXPECT_NEAR(results.m_globalJCS[k](i, j), jcs[k](i, j), requiredPrecision);
+            }
+        }
+    }
+
+    // Only the requested quantities are updated
+    Q.setZero();
+    model.evaluate(Q, nullptr, nullptr, rigidbody::KINEMATICS_COM, results);
+    com = model.CoM(Q);
+    for (unsigned int i=0; i<3; ++i) {
+        EXPECT_NEAR(results.m_CoM[i], com[i], requiredPrecision);
+        EXPECT_NEAR(results.m_CoMdot[i], comDot[i], requiredPrecision);
+    }
+
+    // The velocities are required for the velocity dependent quantities
+    EXPECT_THROW(model.evaluate(Q, nullptr, nullptr, rigidbody::KINEMATICS_KINETIC_ENERGY, results),
+                 std::runtime_error);
+    EXPECT_THROW(model.evaluate(Q, &Qdot, nullptr, rigidbody::KINEMATICS_COM_DDOT, results),
+                 std::runtime_error);
+}
+
+TEST(Kinematics, evaluateAfterUpdateSegmentInertia)
+{
+    Model model(modelPathForGeneralTesting);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity Qdot(model);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        Q[i] = QtestPyomecaman[i];
+        Qdot[i] = QtestPyomecaman[i]*10;
+    }
+
+    const rigidbody::SegmentCharacteristics& characteristics(model.segment(0).characteristics());
+    utils::Vector3d com(characteristics.CoM() + utils::Vector3d(0.1, -0.2, 0.05));
+    utils::Matrix3d inertia(characteristics.inertia() * 1.5);
+    model.updateSegmentInertia(0, characteristics.mMass * 2, com, inertia);
+
+    rigidbody::KinematicsResults results;
+    model.evaluate(Q, &Qdot, nullptr,
+                   rigidbody::KINEMATICS_COM | rigidbody::KINEMATICS_COM_DOT
+                   | rigidbody::KINEMATICS_ANGULAR_MOMENTUM | rigidbody::KINEMATICS_KINETIC_ENERGY
+                   | rigidbody::KINEMATICS_POTENTIAL_ENERGY, results);
+    utils::Vector3d expectedCoM(model.CoM(Q));
+    utils::Vector3d expectedCoMdot(model.CoMdot(Q, Qdot));
+    utils::Vector3d expectedAngularMomentum(model.angularMomentum(Q, Qdot));
+    for (unsigned int i=0; i<3; ++i) {
+        EXPECT_NEAR(results.m_CoM[i], expectedCoM[i], requiredPrecision);
+        EXPECT_NEAR(results.m_CoMdot[i], expectedCoMdot[i], requiredPrecision);
+        EXPECT_NEAR(results.m_angularMomentum[i], expectedAngularMomentum[i], requiredPrecision);
+    }
+    EXPECT_NEAR(results.m_kineticEnergy, model.KineticEnergy(Q, Qdot), requiredPrecision);
+    EXPECT_NEAR(results.m_potentialEnergy, -model.mass() * expectedCoM.dot(model.getGravity()),
+                requiredPrecision);
+    EXPECT_NEAR(results.m_potentialEnergy, model.PotentialEnergy(Q), requiredPrecision);
+}
+#endif
+
 TEST(Segment, copy)
 {
     Model model(modelPathForGeneralTesting);
@@ -1550,6 +1698,334 @@ TEST(Markers, individualPositions)
     }
 }
 
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(Markers, inMatrix)
+{
+    Model model(modelPathForGeneralTesting);
+    DECLARE_GENERALIZED_COORDINATES(Q, model);
+    Q.setOnes();
+
+    // Wrongly sized output must be resized, the second call reuses it
+    utils::Matrix positions;
+    for (size_t k=0; k<2; ++k) {
+        model.markersInMatrix(Q, positions);
+        std::vector<rigidbody::NodeSegment> markers(model.markers(Q));
+        EXPECT_EQ(positions.rows(), 3);
+        EXPECT_EQ(static_cast<size_t>(positions.cols()), model.nbMarkers());
+        for (size_t i=0; i<model.nbMarkers(); ++i) {
+            for (unsigned int j=0; j<3; ++j) {
+                EXPECT_NEAR(positions(j, i), markers[i](j), requiredPrecision);
+            }
+        }
+    }
+
+    model.technicalMarkersInMatrix(Q, positions, false);
+    std::vector<rigidbody::NodeSegment> technicals(model.technicalMarkers(Q, false));
+    EXPECT_EQ(static_cast<size_t>(positions.cols()), model.nbTechnicalMarkers());
+    for (size_t i=0; i<technicals.size(); ++i) {
+        for (unsigned int j=0; j<3; ++j) {
+            EXPECT_NEAR(positions(j, i), technicals[i](j), requiredPrecision);
+        }
+    }
+
+    // Markers added after the first query must be found
+    model.addMarker(rigidbody::NodeSegment(0.1, 0.2, 0.3), "newMarker", "Pelvis", true, true, "");
+    model.markersInMatrix(Q, positions);
+    EXPECT_EQ(static_cast<size_t>(positions.cols()), model.nbMarkers());
+    rigidbody::NodeSegment newMarker(model.marker(Q, model.nbMarkers() - 1));
+    for (unsigned int j=0; j<3; ++j) {
+        EXPECT_NEAR(positions(j, model.nbMarkers() - 1), newMarker(j), requiredPrecision);
+    }
+}
+
+TEST(Markers, inverseKinematicsTrial)
+{
+    Model model(modelPathForGeneralTesting);
+
+    // A trajectory in the middle of the ranges of the model
+    DECLARE_GENERALIZED_COORDINATES(Qmiddle, model);
+    DECLARE_GENERALIZED_COORDINATES(Qmin, model);
+    DECLARE_GENERALIZED_COORDINATES(Qmax, model);
+    unsigned int cmpDof(0);
+    for (size_t i=0; i<model.nbSegment(); ++i) {
+        const std::vector<utils::Range>& ranges(model.segment(i).QRanges());
+        for (size_t j=0; j<model.segment(i).nbDof(); ++j) {
+            Qmin[cmpDof] = ranges[j].min();
+            Qmax[cmpDof] = ranges[j].max();
+            Qmiddle[cmpDof] = (ranges[j].min() + ranges[j].max()) / 2;
+            ++cmpDof;
+        }
+    }
+    size_t nbFrames(30);
+    std::vector<rigidbody::GeneralizedCoordinates> Qtrue;
+    std::vector<utils::Matrix> markers(nbFrames);
+    for (size_t f=0; f<nbFrames; ++f) {
+        rigidbody::GeneralizedCoordinates Q(Qmiddle);
+        for (unsigned int i=0; i<model.nbQ(); ++i) {
+            Q[i] += 0.2 * std::sin(0.05 * static_cast<double>(f) + i);
+        }
+        Qtrue.push_back(Q);
+        model.technicalMarkersInMatrix(Q, markers[f]);
+    }
+
+    rigidbody::MarkersInverseKinematics ik(model, true, 3);
+    EXPECT_EQ(ik.nbMarkers(), model.nbTechnicalMarkers());
+    EXPECT_EQ(ik.nbThreads(), 3);
+    std::vector<rigidbody::GeneralizedCoordinates> Q;
+    EXPECT_EQ(ik.solveTrial(markers, Qmiddle, Q), nbFrames);
+    EXPECT_EQ(Q.size(), nbFrames);
+    for (size_t f=0; f<nbFrames; ++f) {
+        for (unsigned int i=0; i<model.nbQ(); ++i) {
+            EXPECT_NEAR(Q[f][i], Qtrue[f][i], 1e-6);
+        }
+    }
+
+    // An occluded marker is ignored
+    utils::Matrix occluded(markers[0]);
+    occluded(0, 0) = std::nan("");
+    occluded(2, 3) = std::nan("");
+    rigidbody::GeneralizedCoordinates Qoccluded(Qmiddle);
+    EXPECT_TRUE(ik.solveFrame(occluded, Qoccluded));
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        EXPECT_NEAR(Qoccluded[i], Qtrue[0][i], 1e-6);
+    }
+
+    // The solution remains in the ranges, even if the markers were produced outside of them
+    rigidbody::GeneralizedCoordinates Qoutside(Qtrue[0]);
+    Qoutside[model.nbQ() - 1] = Qmax[model.nbQ() - 1] + 0.3;
+    utils::Matrix markersOutside;
+    model.technicalMarkersInMatrix(Qoutside, markersOutside);
+    rigidbody::GeneralizedCoordinates Qbounded(Qmiddle);
+    ik.solveFrame(markersOutside, Qbounded);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        EXPECT_GE(Qbounded[i], Qmin[i] - requiredPrecision);
+        EXPECT_LE(Qbounded[i], Qmax[i] + requiredPrecision);
+    }
+    EXPECT_NEAR(Qbounded[model.nbQ() - 1], Qmax[model.nbQ() - 1], 1e-6);
+
+    // Without the ranges, the markers are tracked exactly
+    ik.setUseQRanges(false);
+    Qbounded = Qmiddle;
+    EXPECT_TRUE(ik.solveFrame(markersOutside, Qbounded));
+    EXPECT_NEAR(Qbounded[model.nbQ() - 1], Qoutside[model.nbQ() - 1], 1e-6);
+
+    // Wrong sizes are caught
+    utils::Vector weights(static_cast<unsigned int>(ik.nbMarkers() + 1));
+    EXPECT_THROW(ik.setWeights(weights), std::runtime_error);
+    EXPECT_THROW(ik.solveFrame(utils::Matrix(3, 2), Qbounded), std::runtime_error);
+}
+
+TEST(SoftContacts, inMatrix)
+{
+    Model model(modelWithSoftContact);
+    DECLARE_GENERALIZED_COORDINATES(Q, model);
+    Q.setOnes();
+
+    utils::Matrix positions;
+    model.softContactsInMatrix(Q, positions);
+    std::vector<rigidbody::NodeSegment> contacts(model.softContacts(Q));
+    EXPECT_EQ(static_cast<size_t>(positions.cols()), model.nbSoftContacts());
+    for (size_t i=0; i<contacts.size(); ++i) {
+        for (unsigned int j=0; j<3; ++j) {
+            EXPECT_NEAR(positions(j, i), contacts[i](j), requiredPrecision);
+        }
+    }
+}
+
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(SoftContacts, meshSampling)
+{
+    Model model(modelWithMeshSoftContact);
+    EXPECT_EQ(model.nbSoftContacts(), 1);
+    const rigidbody::SoftContactMesh& contact(
+        dynamic_cast<const rigidbody::SoftContactMesh&>(model.softContact(0)));
+    EXPECT_EQ(contact.typeOfNode(), utils::NODE_TYPE::SOFT_CONTACT_MESH);
+    EXPECT_NEAR(contact.muStatic(), 0.9, requiredPrecision);
+    EXPECT_NEAR(contact.muDynamic(), 0.7, requiredPrecision);
+
+    // One point per vertex, sharing the whole surface of the cube
+    EXPECT_EQ(contact.nbPoints(), 8);
+    double area(0);
+    for (size_t i=0; i<contact.nbPoints(); ++i) {
+        area += contact.area(i);
+    }
+    EXPECT_NEAR(area, 24, requiredPrecision);
+    EXPECT_NEAR(contact.boundingRadius(), std::sqrt(3.), requiredPrecision);
+
+    // The vertices of a 4x4 grid merged in cells of 2x2
+    rigidbody::Mesh grid;
+    for (int i=0; i<5; ++i) {
+        for (int j=0; j<5; ++j) {
+            grid.addPoint(utils::Vector3d(i, j, 0));
+        }
+    }
+    for (int i=0; i<4; ++i) {
+        for (int j=0; j<4; ++j) {
+            grid.addFace(std::vector<int>({i*5 + j, (i+1)*5 + j, (i+1)*5 + j+1, i*5 + j+1}));
+        }
+    }
+    rigidbody::SoftContactMesh merged(grid, 2, 1, 0, 0.8, 0.7, 0.5, "grid", "Cube", -1);
+    EXPECT_EQ(merged.nbPoints(), 9);
+    area = 0;
+    for (size_t i=0; i<merged.nbPoints(); ++i) {
+        area += merged.area(i);
+    }
+    EXPECT_NEAR(area, 16, requiredPrecision);
+}
+
+TEST(SoftContacts, meshAgainstTerrains)
+{
+    Model model(modelWithMeshSoftContact);
+    rigidbody::SoftContactMesh& contact(
+        dynamic_cast<rigidbody::SoftContactMesh&>(model.softContact(0)));
+    DECLARE_GENERALIZED_COORDINATES(Q, model);
+    DECLARE_GENERALIZED_VELOCITY(QDot, model);
+    FILL_VECTOR(Q, std::vector<double>({0, 0, 0.95, 0}));
+    QDot.setZero();
+
+    // The 4 bottom vertices (an area of 12) are 0.05 under the surface, the fan cut of the
+    // faces gives more area to the vertices at y = -1
+    std::vector<double> expected = {-20000. / 3., 0, 0, 0, 0, 60000};
+    utils::Matrix flat(3, 3);
+    flat.setZero();
+    rigidbody::Mesh quad;
+    quad.addPoint(utils::Vector3d(-5, -5, 0));
+    quad.addPoint(utils::Vector3d(5, -5, 0));
+    quad.addPoint(utils::Vector3d(5, 5, 0));
+    quad.addPoint(utils::Vector3d(-5, 5, 0));
+    quad.addFace(std::vector<int>({0, 1, 2, 3}));
+    std::vector<std::shared_ptr<rigidbody::Terrain>> terrains = {
+        nullptr,
+        std::make_shared<rigidbody::TerrainHeightfield>(-5, -5, 5, 5, flat),
+        std::make_shared<rigidbody::TerrainMesh>(quad, 1)
+    };
+    for (const auto& terrain : terrains) {
+        model.setTerrain(terrain);
+        utils::SpatialVector force(contact.computeForceAtOrigin(model, Q, QDot));
+        for (unsigned int i=0; i<6; ++i) {
+            EXPECT_NEAR(force(i), expected[i], 1e-6);
+        }
+    }
+
+    // Far from the terrain
+    Q[2] = 3;
+    utils::SpatialVector force(contact.computeForceAtOrigin(model, Q, QDot));
+    for (unsigned int i=0; i<6; ++i) {
+        EXPECT_NEAR(force(i), 0, requiredPrecision);
+    }
+
+    // A slope of 0.1 along X
+    utils::Matrix slope(3, 3);
+    for (unsigned int i=0; i<3; ++i) {
+        for (unsigned int j=0; j<3; ++j) {
+            slope(i, j) = 0.1 * (-5. + 5. * i);
+        }
+    }
+    rigidbody::TerrainHeightfield heightfield(-5, -5, 5, 5, slope);
+    EXPECT_NEAR(heightfield.height(1, 0), 0.1, requiredPrecision);
+    EXPECT_TRUE(std::isnan(heightfield.height(6, 0)));
+    double depth;
+    utils::Vector3d normal;
+    EXPECT_FALSE(heightfield.penetration(utils::Vector3d(1, 0, 0.2), depth, normal));
+    EXPECT_TRUE(heightfield.penetration(utils::Vector3d(1, 0, -0.5), depth, normal));
+    EXPECT_NEAR(depth, 0.6 / std::sqrt(1.01), requiredPrecision);
+    EXPECT_NEAR(normal[0], -0.1 / std::sqrt(1.01), requiredPrecision);
+    EXPECT_NEAR(normal[2], 1 / std::sqrt(1.01), requiredPrecision);
+
+    // The top of a cube used as a terrain
+    rigidbody::TerrainMesh cube(model.mesh(0), 0.5);
+    EXPECT_EQ(cube.nbTriangles(), 4);
+    EXPECT_NEAR(cube.height(0.2, 0.3), 1, requiredPrecision);
+    EXPECT_TRUE(cube.penetration(utils::Vector3d(0.2, 0.3, 0.5), depth, normal));
+    EXPECT_NEAR(depth, 0.5, requiredPrecision);
+    EXPECT_NEAR(normal[2], 1, requiredPrecision);
+}
+#endif
+
+TEST(IMUs, inMatrix)
+{
+    Model model(modelPathForPyomecaman_withIMUs);
+    DECLARE_GENERALIZED_COORDINATES(Q, model);
+    Q.setOnes();
+
+    utils::Matrix rotoTrans;
+    model.IMUInMatrix(Q, rotoTrans);
+    std::vector<rigidbody::IMU> imus(model.IMU(Q));
+    EXPECT_EQ(rotoTrans.rows(), 4);
+    EXPECT_EQ(static_cast<size_t>(rotoTrans.cols()), 4 * model.nbIMUs());
+    for (size_t i=0; i<imus.size(); ++i) {
+        for (unsigned int row=0; row<4; ++row) {
+            for (unsigned int col=0; col<4; ++col) {
+                EXPECT_NEAR(rotoTrans(row, 4*i + col), imus[i](row, col), requiredPrecision);
+            }
+        }
+    }
+}
+
+TEST(MeshCollisions, distanceAndPenetration)
+{
+    Model model("models/meshCollisions.bioMod");
+    rigidbody::MeshCollisions collisions(model, 2);
+    EXPECT_EQ(collisions.nbThreads(), 2);
+    EXPECT_EQ(collisions.nbMeshes(), 2);
+    EXPECT_TRUE(collisions.hasMesh(0));
+    EXPECT_FALSE(collisions.hasMesh(1));
+    EXPECT_THROW(collisions.addPair(0, 1), std::runtime_error);
+    collisions.addPair("Cube", "SmallCube");
+    EXPECT_EQ(collisions.nbPairs(), 1);
+    EXPECT_EQ(collisions.pair(0).second, 2);
+
+    // Apart from each other (the faces are 1.5 apart)
+    DECLARE_GENERALIZED_COORDINATES(Q, model);
+    Q[0] = 3;
+    Q[1] = 0;
+    collisions.updateKinematics(model, Q);
+    utils::Vector3d point1, point2;
+    EXPECT_NEAR(collisions.distance(0, 2, &point1, &point2), 1.5, requiredPrecision);
+    EXPECT_NEAR(point1[0], 1, requiredPrecision);
+    EXPECT_NEAR(point2[0], 2.5, requiredPrecision);
+    EXPECT_NEAR(collisions.distance(0, 2, nullptr, nullptr, 0.5), 0.5, requiredPrecision);
+    EXPECT_NEAR(collisions.penetration(0, 2), 0, requiredPrecision);
+    EXPECT_EQ(collisions.broadPhase().size(), 0);
+    EXPECT_EQ(collisions.broadPhase(2).size(), 1);
+
+    // Overlapping, the deepest vertex of the small cube is 0.3 inside
+    Q[0] = 1.2;
+    collisions.updateTransforms(model.allGlobalJCS(Q));
+    EXPECT_NEAR(collisions.distance(0, 2), 0, requiredPrecision);
+    EXPECT_NEAR(collisions.penetration(0, 2), 0.3, requiredPrecision);
+    EXPECT_EQ(collisions.broadPhase().size(), 1);
+
+    // The small cube inside the big one
+    Q[0] = 0;
+    collisions.updateKinematics(model, Q);
+    EXPECT_NEAR(collisions.distance(0, 2), 0, requiredPrecision);
+    EXPECT_NEAR(collisions.penetration(0, 2), 0.5, requiredPrecision);
+
+    // Over a trajectory with the small cube turned, a corner gets closest first
+    std::vector<rigidbody::GeneralizedCoordinates> trajectory;
+    for (size_t i=0; i<4; ++i) {
+        Q[0] = 3 - static_cast<double>(i);
+        Q[1] = M_PI / 4;
+        trajectory.push_back(Q);
+    }
+    std::vector<std::vector<double>> distances, penetrations;
+    collisions.evaluateTrajectory(trajectory, distances, &penetrations);
+    EXPECT_EQ(distances.size(), 4);
+    std::vector<double> expectedDistances = {2 - std::sqrt(0.5), 1 - std::sqrt(0.5), 0, 0};
+    std::vector<double> expectedPenetrations = {0, 0, 0.5, 1 - std::sqrt(0.5)};
+    for (size_t i=0; i<trajectory.size(); ++i) {
+        EXPECT_NEAR(distances[i][0], expectedDistances[i], requiredPrecision);
+        EXPECT_NEAR(penetrations[i][0], expectedPenetrations[i], requiredPrecision);
+    }
+
+    // The trajectory does not change the transformations of the last update
+    std::vector<double> current;
+    collisions.evaluatePairs(current);
+    EXPECT_NEAR(current[0], 0, requiredPrecision);
+}
+#endif
+
 TEST(Mesh, position)
 {
     Model model(modelPathMeshEqualsMarker);
@@ -1714,6 +2190,54 @@ TEST(Dynamics, ForwardDynamicsFreeFloatingBase)
             std::runtime_error);
     }
 
+#ifndef BIORBD_USE_CASADI_MATH
+    // Same result as solving with the root block of the full mass matrix and the inverse dynamics
+    for (const std::string& path : {modelPathForGeneralTesting, std::string("models/simple_quat.bioMod")}) {
+        Model model(path);
+        size_t nbRoot(model.nbRoot());
+        rigidbody::GeneralizedCoordinates Q(model);
+        rigidbody::GeneralizedVelocity QDot(model);
+        rigidbody::GeneralizedAcceleration QJointsDDot(
+            static_cast<unsigned int>(model.nbQddot() - nbRoot));
+        for (unsigned int trial = 0; trial < 3; ++trial) {
+            for (unsigned int i = 0; i < model.nbQ(); ++i) {
+                Q[i] = 0.3 * std::sin(1.7 * i + trial);
+            }
+            for (unsigned int i = 0; i < model.nbQdot(); ++i) {
+                QDot[i] = 2. * std::cos(0.9 * i - trial);
+            }
+            for (unsigned int i = 0; i < QJointsDDot.size(); ++i) {
+                QJointsDDot[i] = 10. * std::sin(2.3 * i + trial);
+            }
+            if (model.nbQuat()) {
+                // The generalized coordinates of this model are only the quaternion of the root
+                Q.normalize();
+            }
+
+            rigidbody::GeneralizedAcceleration QRootDDot(
+                model.ForwardDynamicsFreeFloatingBase(Q, QDot, QJointsDDot));
+
+            rigidbody::GeneralizedAcceleration QDDot(model);
+            QDDot.setZero();
+            QDDot.segment(nbRoot, QJointsDDot.size()) = QJointsDDot;
+            utils::Matrix massMatrix(model.massMatrix(Q));
+            rigidbody::GeneralizedTorque nlEffects(model.InverseDynamics(Q, QDot, QDDot));
+            utils::Vector expected(massMatrix.block(0, 0, nbRoot, nbRoot).llt().solve(
+                                       -nlEffects.segment(0, nbRoot)));
+            ASSERT_EQ(static_cast<size_t>(QRootDDot.size()), nbRoot);
+            for (unsigned int i = 0; i < nbRoot; ++i) {
+                EXPECT_NEAR(QRootDDot[i], expected[i], 1e-8);
+            }
+
+            // The root is not actuated
+            QDDot.segment(0, nbRoot) = QRootDDot;
+            rigidbody::GeneralizedTorque tau(model.InverseDynamics(Q, QDot, QDDot));
+            for (unsigned int i = 0; i < nbRoot; ++i) {
+                EXPECT_NEAR(tau[i], 0, 1e-8);
+            }
+        }
+    }
+#endif
 }
 
 #ifdef MODULE_ACTUATORS
@@ -1881,6 +2405,116 @@ TEST(Dynamics, ForwardLoopConstraint)
     }
 }
 
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(Dynamics, calcConstrainedDynamics)
+{
+    Model model(modelPathForLoopConstraintTesting);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        Q[i] = static_cast<double>(i) * 1.1;
+        QDot[i] = static_cast<double>(i) * 1.1;
+        Tau[i] = static_cast<double>(i) * 1.1;
+    }
+    rigidbody::ExternalForceSet externalForces(model);
+
+    rigidbody::GeneralizedAcceleration QDDotExpected(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+    utils::Vector forcesExpected(model.getForce());
+    std::vector<utils::SpatialVector> loopForcesExpected(model.calcLoopConstraintForces(Q, QDot, Tau));
+
+    // The outputs are wrongly sized on purpose, then reused
+    rigidbody::GeneralizedAcceleration QDDot;
+    utils::Vector forces;
+    std::vector<utils::SpatialVector> loopForces;
+    for (size_t k=0; k<2; ++k) {
+        model.calcConstrainedDynamics(Q, QDot, Tau, externalForces, QDDot, forces, loopForces);
+        EXPECT_EQ(QDDot.size(), QDDotExpected.size());
+        for (unsigned int i=0; i<model.nbQddot(); ++i) {
+            EXPECT_NEAR(QDDot[i], QDDotExpected[i], requiredPrecision);
+        }
+        EXPECT_EQ(forces.size(), forcesExpected.size());
+        for (unsigned int i=0; i<forces.size(); ++i) {
+            EXPECT_NEAR(forces[i], forcesExpected[i], requiredPrecision);
+        }
+        EXPECT_EQ(loopForces.size(), model.nbLoopConstraints());
+        for (size_t i=0; i<loopForces.size(); ++i) {
+            for (unsigned int j=0; j<6; ++j) {
+                EXPECT_NEAR(loopForces[i][j], loopForcesExpected[i][j], requiredPrecision);
+            }
+        }
+    }
+}
+
+TEST(Dynamics, ForwardDynamicsConstraintsSolvers)
+{
+    std::vector<std::string> paths({
+        modelWithRigidContactsExternalForces, modelPathForLoopConstraintTesting});
+    std::vector<rigidbody::CONSTRAINTS_SOLVER> solvers({
+        rigidbody::CONSTRAINTS_SOLVER_RANGE_SPACE_SPARSE, rigidbody::CONSTRAINTS_SOLVER_NULL_SPACE});
+    for (const auto& path : paths) {
+        Model model(path);
+        rigidbody::GeneralizedCoordinates Q(model);
+        rigidbody::GeneralizedVelocity QDot(model);
+        rigidbody::GeneralizedTorque Tau(model);
+        for (unsigned int i=0; i<model.nbQ(); ++i) {
+            Q[i] = static_cast<double>(i) * 0.1;
+            QDot[i] = static_cast<double>(i) * 0.2;
+            Tau[i] = static_cast<double>(i) * 0.3;
+        }
+        rigidbody::GeneralizedAcceleration QDDotDirect(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+        utils::Vector forceDirect(model.getForce());
+        double scale(std::max(1.0, QDDotDirect.norm()));
+
+        for (auto solver : solvers) {
+            model.setConstraintsSolver(solver);
+            EXPECT_EQ(model.constraintsSolver(), solver);
+            rigidbody::GeneralizedAcceleration QDDot(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+            for (unsigned int i=0; i<model.nbQddot(); ++i) {
+                EXPECT_NEAR(QDDot[i] / scale, QDDotDirect[i] / scale, 1e-6);
+            }
+        }
+        model.setConstraintsSolver(rigidbody::CONSTRAINTS_SOLVER_DIRECT);
+
+        // The first call factorizes the system and solves with it, then only Tau changes and the factorization is reused
+        model.setFactorizationReuse(true);
+        EXPECT_TRUE(model.factorizationReuse());
+        rigidbody::GeneralizedAcceleration QDDotFactorized(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau));
+        for (unsigned int i=0; i<model.nbQddot(); ++i) {
+            EXPECT_NEAR(QDDotFactorized[i] / scale, QDDotDirect[i] / scale, 1e-6);
+        }
+        rigidbody::GeneralizedTorque Tau2(Tau * 2 + rigidbody::GeneralizedTorque(Tau).setOnes());
+        rigidbody::GeneralizedAcceleration QDDotReused(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau2));
+        utils::Vector forceReused(model.getForce());
+
+        // Reusing the factorization still updates the kinematics
+        size_t lastSegment(model.nbSegment() - 1);
+        rigidbody::GeneralizedCoordinates QOther(Q * 2);
+        utils::RotoTrans expectedJCS(model.globalJCS(Q, lastSegment));
+        model.globalJCS(QOther, lastSegment);
+        model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau2);
+        utils::RotoTrans jcs(model.globalJCS(lastSegment));
+        for (unsigned int i=0; i<4; ++i) {
+            for (unsigned int j=0; j<4; ++j) {
+                EXPECT_NEAR(jcs(i, j), expectedJCS(i, j), requiredPrecision);
+            }
+        }
+
+        model.setFactorizationReuse(false);
+        rigidbody::GeneralizedAcceleration QDDotExpected(model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau2));
+        utils::Vector forceExpected(model.getForce());
+        scale = std::max(1.0, QDDotExpected.norm());
+        for (unsigned int i=0; i<model.nbQddot(); ++i) {
+            EXPECT_NEAR(QDDotReused[i] / scale, QDDotExpected[i] / scale, 1e-6);
+        }
+        double forceScale(std::max(1.0, forceExpected.norm()));
+        for (unsigned int i=0; i<forceExpected.size(); ++i) {
+            EXPECT_NEAR(forceReused[i] / forceScale, forceExpected[i] / forceScale, 1e-6);
+        }
+    }
+}
+#endif
+
 TEST(Dynamics, ForwardAccelerationConstraint)
 {
     Model model(modelPathForGeneralTesting);
@@ -1922,6 +2556,223 @@ TEST(Dynamics, ForwardAccelerationConstraint)
     }
 }
 
+#ifndef BIORBD_USE_CASADI_MATH
+static double finiteDifferencesStep(1e-6);
+static double finiteDifferencesPrecision(1e-5);
+
+TEST(Dynamics, InverseDynamicsDerivatives)
+{
+    Model model(modelPathForGeneralTesting);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedAcceleration QDDot(model);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        Q[i] = 0.1 * static_cast<double>(i + 1);
+        QDot[i] = 0.3 - 0.05 * static_cast<double>(i);
+        QDDot[i] = 0.2 * static_cast<double>(i) - 1.0;
+    }
+
+    utils::Matrix dTau_dQ, dTau_dQdot, dTau_dQddot;
+    rigidbody::GeneralizedTorque Tau(model.InverseDynamicsDerivatives(
+                Q, QDot, QDDot, dTau_dQ, dTau_dQdot, dTau_dQddot));
+    rigidbody::GeneralizedTorque Tau_expected(model.InverseDynamics(Q, QDot, QDDot));
+    utils::Matrix massMatrix(model.massMatrix(Q));
+    for (unsigned int i=0; i<model.nbGeneralizedTorque(); ++i) {
+        EXPECT_NEAR(Tau[i], Tau_expected[i], requiredPrecision);
+        for (unsigned int j=0; j<model.nbQ(); ++j) {
+            EXPECT_NEAR(dTau_dQddot(i, j), massMatrix(i, j), requiredPrecision);
+        }
+    }
+
+    for (unsigned int j=0; j<model.nbQ(); ++j) {
+        rigidbody::GeneralizedCoordinates Qp(Q), Qm(Q);
+        Qp[j] += finiteDifferencesStep;
+        Qm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedTorque dQ(
+                    (model.InverseDynamics(Qp, QDot, QDDot) - model.InverseDynamics(Qm, QDot, QDDot))
+                    / (2 * finiteDifferencesStep));
+
+        rigidbody::GeneralizedVelocity QDotp(QDot), QDotm(QDot);
+        QDotp[j] += finiteDifferencesStep;
+        QDotm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedTorque dQdot(
+                    (model.InverseDynamics(Q, QDotp, QDDot) - model.InverseDynamics(Q, QDotm, QDDot))
+                    / (2 * finiteDifferencesStep));
+
+        for (unsigned int i=0; i<model.nbGeneralizedTorque(); ++i) {
+            EXPECT_NEAR(dTau_dQ(i, j), dQ[i], finiteDifferencesPrecision);
+            EXPECT_NEAR(dTau_dQdot(i, j), dQdot[i], finiteDifferencesPrecision);
+        }
+    }
+
+    // The torques are linear with respect to the external forces
+    rigidbody::ExternalForceSet externalForces(model);
+    externalForces.add("PiedD", utils::SpatialVector(11.1, 22.2, 33.3, 44.4, 55.5, 66.6));
+    externalForces.add("PiedG", utils::SpatialVector(22.2, 44.4, 66.6, 88.8, 111.0, 133.2));
+    utils::Matrix dTau_dFext;
+    rigidbody::GeneralizedTorque TauWithForces(model.InverseDynamicsDerivatives(
+                Q, QDot, QDDot, externalForces, dTau_dQ, dTau_dQdot, dTau_dQddot, dTau_dFext));
+    std::vector<utils::SpatialVector> forces(externalForces.computeSpatialVectors(Q, QDot));
+    EXPECT_EQ(static_cast<size_t>(dTau_dFext.cols()), 6 * forces.size());
+    utils::Vector stackedForces(static_cast<unsigned int>(6 * forces.size()));
+    for (unsigned int k=0; k<forces.size(); ++k) {
+        stackedForces.block(6 * k, 0, 6, 1) = forces[k];
+    }
+    utils::Vector TauFromForces(Tau_expected + dTau_dFext * stackedForces);
+    rigidbody::GeneralizedTorque TauWithForces_expected(model.InverseDynamics(Q, QDot, QDDot, externalForces));
+    for (unsigned int i=0; i<model.nbGeneralizedTorque(); ++i) {
+        EXPECT_NEAR(TauWithForces[i], TauWithForces_expected[i], requiredPrecision);
+        EXPECT_NEAR(TauFromForces[i], TauWithForces_expected[i], 1e-8);
+    }
+}
+
+TEST(Dynamics, ForwardDynamicsDerivatives)
+{
+    Model model(modelPathForGeneralTesting);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        Q[i] = 0.1 * static_cast<double>(i + 1);
+        QDot[i] = 0.3 - 0.05 * static_cast<double>(i);
+        Tau[i] = 0.5 * static_cast<double>(i) - 2.0;
+    }
+
+    utils::Matrix dQddot_dQ, dQddot_dQdot, dQddot_dTau;
+    rigidbody::GeneralizedAcceleration QDDot(model.ForwardDynamicsDerivatives(
+                Q, QDot, Tau, dQddot_dQ, dQddot_dQdot, dQddot_dTau));
+    rigidbody::GeneralizedAcceleration QDDot_expected(model.ForwardDynamics(Q, QDot, Tau));
+    utils::Matrix massMatrixInverse(model.massMatrixInverse(Q));
+    for (unsigned int i=0; i<model.nbQddot(); ++i) {
+        EXPECT_NEAR(QDDot[i], QDDot_expected[i], requiredPrecision);
+        for (unsigned int j=0; j<model.nbGeneralizedTorque(); ++j) {
+            EXPECT_NEAR(dQddot_dTau(i, j), massMatrixInverse(i, j), 1e-8);
+        }
+    }
+
+    for (unsigned int j=0; j<model.nbQ(); ++j) {
+        rigidbody::GeneralizedCoordinates Qp(Q), Qm(Q);
+        Qp[j] += finiteDifferencesStep;
+        Qm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedAcceleration dQ(
+                    (model.ForwardDynamics(Qp, QDot, Tau) - model.ForwardDynamics(Qm, QDot, Tau))
+                    / (2 * finiteDifferencesStep));
+
+        rigidbody::GeneralizedVelocity QDotp(QDot), QDotm(QDot);
+        QDotp[j] += finiteDifferencesStep;
+        QDotm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedAcceleration dQdot(
+                    (model.ForwardDynamics(Q, QDotp, Tau) - model.ForwardDynamics(Q, QDotm, Tau))
+                    / (2 * finiteDifferencesStep));
+
+        for (unsigned int i=0; i<model.nbQddot(); ++i) {
+            EXPECT_NEAR(dQddot_dQ(i, j), dQ[i], finiteDifferencesPrecision * std::max(1.0, std::fabs(dQ[i])));
+            EXPECT_NEAR(dQddot_dQdot(i, j), dQdot[i], finiteDifferencesPrecision * std::max(1.0, std::fabs(dQdot[i])));
+        }
+    }
+
+    // Same with external forces, which the accelerations depend on linearly
+    rigidbody::ExternalForceSet externalForces(model);
+    externalForces.add("PiedD", utils::SpatialVector(1.1, 2.2, 3.3, 4.4, 5.5, 6.6));
+    externalForces.add("PiedG", utils::SpatialVector(2.2, 4.4, 6.6, 8.8, 11.0, 13.2));
+    utils::Matrix dQddot_dFext;
+    rigidbody::GeneralizedAcceleration QDDotWithForces(model.ForwardDynamicsDerivatives(
+                Q, QDot, Tau, externalForces, dQddot_dQ, dQddot_dQdot, dQddot_dTau, dQddot_dFext));
+    rigidbody::GeneralizedAcceleration QDDotWithForces_expected(model.ForwardDynamics(Q, QDot, Tau, externalForces));
+    std::vector<utils::SpatialVector> forces(externalForces.computeSpatialVectors(Q, QDot));
+    EXPECT_EQ(static_cast<size_t>(dQddot_dFext.cols()), 6 * forces.size());
+    utils::Vector stackedForces(static_cast<unsigned int>(6 * forces.size()));
+    for (unsigned int k=0; k<forces.size(); ++k) {
+        stackedForces.block(6 * k, 0, 6, 1) = forces[k];
+    }
+    utils::Vector QDDotFromForces(QDDot_expected + dQddot_dFext * stackedForces);
+    for (unsigned int i=0; i<model.nbQddot(); ++i) {
+        EXPECT_NEAR(QDDotWithForces[i], QDDotWithForces_expected[i], requiredPrecision);
+        EXPECT_NEAR(QDDotFromForces[i], QDDotWithForces_expected[i], 1e-8);
+    }
+
+    for (unsigned int j=0; j<model.nbQ(); ++j) {
+        rigidbody::GeneralizedCoordinates Qp(Q), Qm(Q);
+        Qp[j] += finiteDifferencesStep;
+        Qm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedAcceleration dQ(
+                    (model.ForwardDynamics(Qp, QDot, Tau, externalForces)
+                     - model.ForwardDynamics(Qm, QDot, Tau, externalForces))
+                    / (2 * finiteDifferencesStep));
+
+        rigidbody::GeneralizedVelocity QDotp(QDot), QDotm(QDot);
+        QDotp[j] += finiteDifferencesStep;
+        QDotm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedAcceleration dQdot(
+                    (model.ForwardDynamics(Q, QDotp, Tau, externalForces)
+                     - model.ForwardDynamics(Q, QDotm, Tau, externalForces))
+                    / (2 * finiteDifferencesStep));
+
+        for (unsigned int i=0; i<model.nbQddot(); ++i) {
+            EXPECT_NEAR(dQddot_dQ(i, j), dQ[i], finiteDifferencesPrecision * std::max(1.0, std::fabs(dQ[i])));
+            EXPECT_NEAR(dQddot_dQdot(i, j), dQdot[i], finiteDifferencesPrecision * std::max(1.0, std::fabs(dQdot[i])));
+        }
+    }
+}
+
+TEST(Dynamics, ForwardDynamicsConstraintsDirectDerivatives)
+{
+    Model model(modelPathForGeneralTesting);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    rigidbody::GeneralizedTorque Tau(model);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        Q[i] = 0.1 * static_cast<double>(i + 1);
+        QDot[i] = 0.3 - 0.05 * static_cast<double>(i);
+        Tau[i] = 0.5 * static_cast<double>(i) - 2.0;
+    }
+
+    rigidbody::ExternalForceSet externalForces(model);
+    externalForces.add("PiedD", utils::SpatialVector(1.1, 2.2, 3.3, 4.4, 5.5, 6.6));
+
+    utils::Matrix dQddot_dQ, dQddot_dQdot, dQddot_dTau, dQddot_dFext;
+    rigidbody::GeneralizedAcceleration QDDot(model.ForwardDynamicsConstraintsDirectDerivatives(
+                Q, QDot, Tau, externalForces, dQddot_dQ, dQddot_dQdot, dQddot_dTau, dQddot_dFext));
+    rigidbody::GeneralizedAcceleration QDDot_expected(
+                model.ForwardDynamicsConstraintsDirect(Q, QDot, Tau, externalForces));
+    for (unsigned int i=0; i<model.nbQddot(); ++i) {
+        EXPECT_NEAR(QDDot[i], QDDot_expected[i], requiredPrecision);
+    }
+
+    for (unsigned int j=0; j<model.nbQ(); ++j) {
+        rigidbody::GeneralizedCoordinates Qp(Q), Qm(Q);
+        Qp[j] += finiteDifferencesStep;
+        Qm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedAcceleration dQ(
+                    (model.ForwardDynamicsConstraintsDirect(Qp, QDot, Tau, externalForces)
+                     - model.ForwardDynamicsConstraintsDirect(Qm, QDot, Tau, externalForces))
+                    / (2 * finiteDifferencesStep));
+
+        rigidbody::GeneralizedVelocity QDotp(QDot), QDotm(QDot);
+        QDotp[j] += finiteDifferencesStep;
+        QDotm[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedAcceleration dQdot(
+                    (model.ForwardDynamicsConstraintsDirect(Q, QDotp, Tau, externalForces)
+                     - model.ForwardDynamicsConstraintsDirect(Q, QDotm, Tau, externalForces))
+                    / (2 * finiteDifferencesStep));
+
+        rigidbody::GeneralizedTorque Taup(Tau), Taum(Tau);
+        Taup[j] += finiteDifferencesStep;
+        Taum[j] -= finiteDifferencesStep;
+        rigidbody::GeneralizedAcceleration dTau(
+                    (model.ForwardDynamicsConstraintsDirect(Q, QDot, Taup, externalForces)
+                     - model.ForwardDynamicsConstraintsDirect(Q, QDot, Taum, externalForces))
+                    / (2 * finiteDifferencesStep));
+
+        for (unsigned int i=0; i<model.nbQddot(); ++i) {
+            EXPECT_NEAR(dQddot_dQ(i, j), dQ[i], finiteDifferencesPrecision * std::max(1.0, std::fabs(dQ[i])));
+            EXPECT_NEAR(dQddot_dQdot(i, j), dQdot[i], finiteDifferencesPrecision * std::max(1.0, std::fabs(dQdot[i])));
+            EXPECT_NEAR(dQddot_dTau(i, j), dTau[i], finiteDifferencesPrecision * std::max(1.0, std::fabs(dTau[i])));
+        }
+    }
+}
+#endif
+
 TEST(QuaternionInModel, sizes)
 {
     Model m("models/simple_quat.bioMod");
@@ -2096,6 +2947,30 @@ TEST(ExternalForces, toRbdl_softContactOnly)
 }
 
 
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(ExternalForces, toRbdl_softContactMesh)
+{
+    Model model(modelWithMeshSoftContact);
+    DECLARE_GENERALIZED_COORDINATES(Q, model);
+    DECLARE_GENERALIZED_VELOCITY(QDot, model);
+    FILL_VECTOR(Q, std::vector<double>({0.1, -0.2, 0.9, 0.05}));
+    FILL_VECTOR(QDot, std::vector<double>({0.3, 0.1, -0.2, 0.5}));
+
+    rigidbody::ExternalForceSet externalForces = model.externalForceSet(false, true);
+    std::vector<RigidBodyDynamics::Math::SpatialVector> forceInRbdl = externalForces.computeRbdlSpatialVectors(Q, QDot);
+    utils::SpatialVector expected(model.softContact(0).computeForceAtOrigin(model, Q, QDot));
+    EXPECT_GT(expected(5), 0);
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 6; ++j) {
+            EXPECT_NEAR(forceInRbdl[i](j), 0, requiredPrecision);
+        }
+    }
+    for (size_t j = 0; j < 6; ++j) {
+        EXPECT_NEAR(forceInRbdl[4](j), expected(j), 1e-6);
+    }
+}
+#endif
+
 TEST(ExternalForces, toRbdl_externalForcesAndLinearForces)
 {
     Model model(modelWithRigidContactsExternalForces);
@@ -2336,6 +3211,52 @@ TEST(Kalman, markers)
 }
 #endif
 
+#ifndef SKIP_LONG_TESTS
+TEST(Kalman, markersTrials)
+{
+    Model model(modelPathForGeneralTesting);
+
+    // Trials of a few frames that move toward different poses
+    std::vector<std::vector<utils::Vector>> markers(3);
+    for (size_t trial=0; trial<markers.size(); ++trial) {
+        for (size_t frame=0; frame<4; ++frame) {
+            rigidbody::GeneralizedCoordinates Qref(model);
+            Qref.setConstant(0.1 * static_cast<double>(trial + 1) + 0.01 * static_cast<double>(frame));
+            std::vector<rigidbody::NodeSegment> targetMarkers(model.technicalMarkers(Qref));
+            utils::Vector frameMarkers(static_cast<unsigned int>(3 * targetMarkers.size()));
+            for (size_t i=0; i<targetMarkers.size(); ++i) {
+                frameMarkers.block(static_cast<unsigned int>(3 * i), 0, 3, 1) = targetMarkers[i];
+            }
+            markers[trial].push_back(frameMarkers);
+        }
+    }
+
+    rigidbody::KalmanReconsMarkersTrials trials(modelPathForGeneralTesting, rigidbody::KalmanParam(), 2);
+    EXPECT_EQ(trials.nbThreads(), 2);
+    std::vector<std::vector<rigidbody::GeneralizedCoordinates>> Q;
+    std::vector<std::vector<rigidbody::GeneralizedVelocity>> Qdot;
+    trials.reconstructTrials(markers, Q, &Qdot);
+    EXPECT_EQ(Q.size(), markers.size());
+    EXPECT_EQ(Qdot.size(), markers.size());
+
+    // Each trial is reconstructed as by its own filter
+    for (size_t trial=0; trial<markers.size(); ++trial) {
+        rigidbody::KalmanReconsMarkers kalman(model);
+        rigidbody::GeneralizedCoordinates QExpected(model);
+        rigidbody::GeneralizedVelocity QdotExpected(model);
+        rigidbody::GeneralizedAcceleration QddotExpected(model);
+        EXPECT_EQ(Q[trial].size(), markers[trial].size());
+        for (size_t frame=0; frame<markers[trial].size(); ++frame) {
+            kalman.reconstructFrame(model, markers[trial][frame], &QExpected, &QdotExpected, &QddotExpected);
+            for (size_t i=0; i<model.nbQ(); ++i) {
+                EXPECT_NEAR(Q[trial][frame][i], QExpected[i], requiredPrecision);
+                EXPECT_NEAR(Qdot[trial][frame][i], QdotExpected[i], requiredPrecision);
+            }
+        }
+    }
+}
+#endif
+
 #ifndef SKIP_LONG_TESTS
 TEST(Kalman, imu)
 {
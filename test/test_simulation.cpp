@@ -0,0 +1,633 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <gtest/gtest.h>
+
+#include "BiorbdModel.h"
+#include "Utils/Error.h"
+#include "RigidBody/GeneralizedCoordinates.h"
+#include "RigidBody/GeneralizedVelocity.h"
+#include "RigidBody/GeneralizedAcceleration.h"
+#include "RigidBody/GeneralizedTorque.h"
+#include "Simulation/Integrator.h"
+#include "Simulation/Rollouts.h"
+#include "Simulation/Scene.h"
+#include "Simulation/ParameterSweep.h"
+#include "Simulation/TrajectoryDynamics.h"
+#include "RigidBody/Contacts.h"
+#include "RigidBody/Segment.h"
+#include "RigidBody/SegmentCharacteristics.h"
+#include "Utils/Matrix.h"
+#include "Utils/Matrix3d.h"
+#include "Utils/Path.h"
+#include "Utils/Vector3d.h"
+#ifdef MODULE_MUSCLES
+#include "InternalForces/Muscles/all.h"
+#endif
+
+using namespace BIORBD_NAMESPACE;
+
+static std::string modelPathPendulum("models/pendulum.bioMod");
+static std::string modelPathQuaternion("models/simple_quat.bioMod");
+static std::string modelPathPyomecaman("models/pyomecaman.bioMod");
+#ifdef MODULE_MUSCLES
+static std::string modelPathMuscles("models/arm26.bioMod");
+#endif
+
+TEST(Integrator, stateLayout)
+{
+    Model model(modelPathPendulum);
+    simulation::Integrator integrator(model);
+#ifdef MODULE_MUSCLES
+    EXPECT_EQ(integrator.nbStates(), model.nbQ() + model.nbQdot() + model.nbMuscles());
+#else
+    EXPECT_EQ(integrator.nbStates(), model.nbQ() + model.nbQdot());
+#endif
+
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        Q[i] = 0.1 * (i+1);
+        QDot[i] = -0.2 * (i+1);
+    }
+    utils::Vector x(integrator.state(Q, QDot));
+    EXPECT_EQ(static_cast<size_t>(x.size()), integrator.nbStates());
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        EXPECT_DOUBLE_EQ(integrator.Q(x)[i], Q[i]);
+        EXPECT_DOUBLE_EQ(integrator.QDot(x)[i], QDot[i]);
+    }
+    EXPECT_EQ(integrator.fatigue(x).size(), 0);
+
+    // The derivative of the state is QDot and the forward dynamics
+    utils::Vector xDot;
+    integrator.derivative(0, x, xDot);
+    rigidbody::GeneralizedTorque Tau(model);
+    Tau.setZero();
+    rigidbody::GeneralizedAcceleration QDDot(model.ForwardDynamics(Q, QDot, Tau));
+    for (unsigned int i=0; i<model.nbQ(); ++i) {
+        EXPECT_NEAR(xDot[i], QDot[i], 1e-10);
+        EXPECT_NEAR(xDot[model.nbQ() + i], QDDot[i], 1e-10);
+    }
+}
+
+TEST(Integrator, schemesAgree)
+{
+    Model model(modelPathPendulum);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setZero();
+    Q[1] = 0.5;
+    QDot.setZero();
+
+    simulation::Integrator reference(model, simulation::INTEGRATOR_RK45);
+    reference.setTolerances(1e-10, 1e-12);
+    utils::Vector xRef(reference.state(Q, QDot));
+    reference.integrate(0, 1, xRef);
+    EXPECT_GT(reference.nbSteps(), 0);
+    EXPECT_GT(reference.stepsPerSecond(), 0);
+
+    simulation::Integrator rk4(model, simulation::INTEGRATOR_RK4);
+    rk4.setTimeStep(1e-3);
+    utils::Vector x(rk4.state(Q, QDot));
+    size_t nbSteps(rk4.integrate(0, 1, x));
+    EXPECT_EQ(nbSteps, 1000);
+    for (unsigned int i=0; i<2*model.nbQ(); ++i) {
+        EXPECT_NEAR(x[i], xRef[i], 1e-6);
+    }
+
+    // The semi-implicit Euler is only first order, but it keeps the energy bounded
+    simulation::Integrator euler(model, simulation::INTEGRATOR_SEMI_IMPLICIT_EULER);
+    euler.setTimeStep(1e-4);
+    x = euler.state(Q, QDot);
+    double energy(model.TotalEnergy(Q, QDot));
+    euler.integrate(0, 1, x);
+    for (unsigned int i=0; i<2*model.nbQ(); ++i) {
+        EXPECT_NEAR(x[i], xRef[i], 1e-2);
+    }
+    EXPECT_NEAR(model.TotalEnergy(euler.Q(x), euler.QDot(x)), energy, 1e-2);
+
+    // The time step must be positive
+    EXPECT_THROW(rk4.setTimeStep(0), std::runtime_error);
+}
+
+TEST(Integrator, controller)
+{
+    Model model(modelPathPendulum);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setZero();
+    QDot.setZero();
+
+    // Compensate the gravity at all time, so the model does not move
+    simulation::Integrator integrator(model);
+    integrator.setController([&model](double, const utils::Vector& x,
+    simulation::Controls& controls) {
+        rigidbody::GeneralizedCoordinates Q(x.segment(0, model.nbQ()));
+        rigidbody::GeneralizedVelocity QDot(x.segment(model.nbQ(), model.nbQdot()));
+        rigidbody::GeneralizedAcceleration QDDot(model);
+        QDDot.setZero();
+        controls.m_tau = model.InverseDynamics(Q, QDot, QDDot);
+    });
+    utils::Vector x(integrator.state(Q, QDot));
+    integrator.integrate(0, 0.5, x);
+    for (unsigned int i=0; i<2*model.nbQ(); ++i) {
+        EXPECT_NEAR(x[i], 0, 1e-10);
+    }
+}
+
+TEST(Integrator, quaternions)
+{
+    Model model(modelPathQuaternion);
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setZero();
+    Q[model.nbQ() - 1] = 1;
+    for (unsigned int i=0; i<model.nbQdot(); ++i) {
+        QDot[i] = 1. + i;
+    }
+
+    for (simulation::INTEGRATOR_TYPE type : {
+                simulation::INTEGRATOR_RK4,
+                simulation::INTEGRATOR_SEMI_IMPLICIT_EULER,
+                simulation::INTEGRATOR_RK45
+            }) {
+        simulation::Integrator integrator(model, type);
+        integrator.setTimeStep(1e-2);
+        utils::Vector x(integrator.state(Q, QDot));
+        integrator.integrate(0, 0.5, x);
+        utils::Vector quaternion(integrator.Q(x).segment(model.nbQ() - 4, 4));
+        EXPECT_NEAR(quaternion.norm(), 1, 1e-10);
+    }
+}
+
+#ifdef MODULE_MUSCLES
+TEST(Integrator, muscles)
+{
+    Model model(modelPathMuscles);
+    simulation::Integrator integrator(model, simulation::INTEGRATOR_RK4);
+    integrator.setTimeStep(1e-3);
+    EXPECT_EQ(integrator.activations(utils::Vector(static_cast<unsigned int>(integrator.nbStates()))).size(),
+              static_cast<int>(model.nbMuscles()));
+
+    // Only one muscle of the model has a dynamic fatigue
+    EXPECT_EQ(integrator.fatigue(utils::Vector(static_cast<unsigned int>(integrator.nbStates()))).size(), 3);
+
+    rigidbody::GeneralizedCoordinates Q(model);
+    rigidbody::GeneralizedVelocity QDot(model);
+    Q.setOnes();
+    Q *= 0.5;
+    QDot.setZero();
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states(model.stateSet());
+    for (auto& state : states) {
+        state->setActivation(0.1, true);
+    }
+    for (size_t i=0; i<model.nbMuscles(); ++i) {
+        std::shared_ptr<internal_forces::muscles::FatigueModel> fatigue(
+            std::dynamic_pointer_cast<internal_forces::muscles::FatigueModel>(model.muscles()[i]));
+        if (fatigue) {
+            fatigue->fatigueState().setState(0, 0, 1);
+        }
+    }
+
+    integrator.setController([](double, const utils::Vector&, simulation::Controls& controls) {
+        controls.m_excitations.setOnes();
+    });
+    utils::Vector x(integrator.state(Q, QDot));
+    utils::Vector activations(integrator.activations(x));
+    utils::Vector fatigue(integrator.fatigue(x));
+    integrator.integrate(0, 0.1, x);
+
+    utils::Vector newActivations(integrator.activations(x));
+    for (unsigned int i=0; i<newActivations.size(); ++i) {
+        EXPECT_GT(newActivations[i], activations[i]);
+        EXPECT_LE(newActivations[i], 1 + 1e-10);
+    }
+    // The fibers are recruited and the proportions still sum to 1
+    utils::Vector newFatigue(integrator.fatigue(x));
+    EXPECT_GT(newFatigue[0], fatigue[0]);
+    EXPECT_NEAR(newFatigue[0] + newFatigue[1] + newFatigue[2], 1, 1e-8);
+}
+#endif
+
+TEST(Rollouts, sameAsSequential)
+{
+    Model model(modelPathPendulum);
+    simulation::Integrator integrator(model);
+    integrator.setTimeStep(1e-3);
+    std::vector<utils::Vector> initialStates;
+    for (unsigned int i=0; i<7; ++i) {
+        rigidbody::GeneralizedCoordinates Q(model);
+        rigidbody::GeneralizedVelocity QDot(model);
+        Q.setZero();
+        Q[1] = 0.1 * i;
+        QDot.setZero();
+        initialStates.push_back(integrator.state(Q, QDot));
+    }
+    simulation::RolloutController controller([](size_t rollout, double,
+    const utils::Vector&, simulation::Controls& controls) {
+        controls.m_tau.setZero();
+        controls.m_tau[0] = static_cast<double>(rollout);
+    });
+
+    simulation::Rollouts rollouts(modelPathPendulum, simulation::INTEGRATOR_RK4, 3);
+    EXPECT_EQ(rollouts.nbThreads(), 3);
+    rollouts.setTimeStep(1e-3);
+    rollouts.setController(controller);
+    std::vector<utils::Vector> states(initialStates);
+    rollouts.run(0, 0.2, states);
+    EXPECT_EQ(rollouts.nbSteps(), 7 * 200);
+    EXPECT_GT(rollouts.stepsPerSecond(), 0);
+
+    for (size_t i=0; i<initialStates.size(); ++i) {
+        integrator.setController([&controller, i](double t, const utils::Vector& x,
+        simulation::Controls& controls) {
+            controller(i, t, x, controls);
+        });
+        utils::Vector x(initialStates[i]);
+        integrator.integrate(0, 0.2, x);
+        for (unsigned int j=0; j<x.size(); ++j) {
+            EXPECT_DOUBLE_EQ(states[i][j], x[j]);
+        }
+    }
+}
+
+TEST(Scene, sameAsSubjects)
+{
+    std::vector<utils::Path> paths({modelPathPendulum, modelPathQuaternion,
+                                    "models/cubeWithRigidContactsExternalForces.bioMod"});
+    simulation::Scene scene(paths, 2);
+    EXPECT_EQ(scene.nbSubjects(), 3);
+    EXPECT_EQ(scene.nbThreads(), 2);
+
+    std::vector<std::shared_ptr<Model>> models;
+    size_t nbQ(0), nbQdot(0), nbMarkers(0), nbContacts(0);
+    for (size_t i=0; i<paths.size(); ++i) {
+        models.push_back(std::make_shared<Model>(paths[i]));
+        EXPECT_EQ(scene.firstQIndex(i), nbQ);
+        EXPECT_EQ(scene.firstQdotIndex(i), nbQdot);
+        nbQ += models[i]->nbQ();
+        nbQdot += models[i]->nbQdot();
+        nbMarkers += models[i]->nbMarkers();
+        nbContacts += models[i]->nbContacts();
+    }
+    EXPECT_EQ(scene.nbQ(), nbQ);
+    EXPECT_EQ(scene.nbQdot(), nbQdot);
+    EXPECT_EQ(scene.nbGeneralizedTorque(), nbQdot);
+    EXPECT_EQ(scene.nbMarkers(), nbMarkers);
+    EXPECT_EQ(scene.nbContacts(), nbContacts);
+
+    utils::Vector Q(static_cast<unsigned int>(nbQ));
+    utils::Vector QDot(static_cast<unsigned int>(nbQdot));
+    utils::Vector Tau(static_cast<unsigned int>(nbQdot));
+    for (unsigned int i=0; i<nbQ; ++i) {
+        Q[i] = 0.1 * (i + 1);
+    }
+    for (unsigned int i=0; i<nbQdot; ++i) {
+        QDot[i] = 0.2 * i;
+        Tau[i] = 0.5 - 0.1 * i;
+    }
+    // The quaternion must be normalized
+    Q.segment(scene.firstQIndex(1), models[1]->nbQ()) =
+        Q.segment(scene.firstQIndex(1), models[1]->nbQ()).normalized();
+
+    utils::Vector QDDot;
+    scene.ForwardDynamics(Q, QDot, Tau, QDDot);
+    utils::Vector QDDotConstraints;
+    utils::Vector contactForces;
+    scene.ForwardDynamicsConstraintsDirect(Q, QDot, Tau, QDDotConstraints, &contactForces);
+    EXPECT_EQ(contactForces.size(), nbContacts);
+    utils::Vector TauFromQDDot;
+    scene.InverseDynamics(Q, QDot, QDDot, TauFromQDDot);
+    utils::Matrix markers;
+    scene.markers(Q, markers);
+    EXPECT_EQ(markers.cols(), nbMarkers);
+
+    size_t firstMarker(0), firstContact(0);
+    for (size_t s=0; s<models.size(); ++s) {
+        Model& model(*models[s]);
+        rigidbody::GeneralizedCoordinates QSubject(Q.segment(scene.firstQIndex(s), model.nbQ()));
+        rigidbody::GeneralizedVelocity QDotSubject(QDot.segment(scene.firstQdotIndex(s), model.nbQdot()));
+        rigidbody::GeneralizedTorque TauSubject(Tau.segment(scene.firstQdotIndex(s), model.nbQdot()));
+
+        rigidbody::GeneralizedAcceleration QDDotSubject(model.ForwardDynamics(QSubject, QDotSubject, TauSubject));
+        rigidbody::GeneralizedAcceleration QDDotConstraintsSubject(
+            model.ForwardDynamicsConstraintsDirect(QSubject, QDotSubject, TauSubject));
+        utils::Vector forces(model.getConstraints().getForce());
+        rigidbody::GeneralizedTorque TauFromQDDotSubject(
+            model.InverseDynamics(QSubject, QDotSubject, QDDotSubject));
+        for (unsigned int i=0; i<model.nbQdot(); ++i) {
+            unsigned int idx(static_cast<unsigned int>(scene.firstQdotIndex(s)) + i);
+            EXPECT_NEAR(QDDot[idx], QDDotSubject[i], 1e-10);
+            EXPECT_NEAR(QDDotConstraints[idx], QDDotConstraintsSubject[i], 1e-10);
+            EXPECT_NEAR(TauFromQDDot[idx], TauFromQDDotSubject[i], 1e-10);
+        }
+        for (unsigned int i=0; i<model.nbContacts(); ++i) {
+            EXPECT_NEAR(contactForces[static_cast<unsigned int>(firstContact) + i], forces[i], 1e-10);
+        }
+        utils::Matrix markersSubject(model.markersInMatrix(QSubject));
+        for (unsigned int i=0; i<model.nbMarkers(); ++i) {
+            for (unsigned int j=0; j<3; ++j) {
+                EXPECT_NEAR(markers(j, static_cast<unsigned int>(firstMarker) + i), markersSubject(j, i), 1e-10);
+            }
+        }
+        firstMarker += model.nbMarkers();
+        firstContact += model.nbContacts();
+    }
+
+    EXPECT_THROW(scene.ForwardDynamics(Q.head(nbQ - 1), QDot, Tau, QDDot), std::runtime_error);
+}
+
+TEST(Scene, sharedModel)
+{
+    simulation::Scene scene;
+    std::shared_ptr<Model> model(std::make_shared<Model>(modelPathPendulum));
+    EXPECT_EQ(scene.addSubject(model), 0);
+    EXPECT_THROW(scene.addSubject(model), std::runtime_error);
+    EXPECT_THROW(scene.addSubject(std::make_shared<Model>(*model)), std::runtime_error);
+    EXPECT_EQ(scene.nbSubjects(), 1);
+    EXPECT_EQ(scene.addSubject(std::make_shared<Model>(modelPathPendulum)), 1);
+    EXPECT_EQ(&scene.subject(0), model.get());
+}
+
+#ifdef MODULE_MUSCLES
+TEST(Scene, muscleDrivenForwardDynamics)
+{
+    simulation::Scene scene(std::vector<utils::Path>({modelPathMuscles, modelPathPendulum, modelPathMuscles}));
+    EXPECT_EQ(scene.nbMuscles(), 2 * scene.subject(0).nbMuscles());
+
+    utils::Vector Q(utils::Vector::Constant(static_cast<unsigned int>(scene.nbQ()), 0.3));
+    utils::Vector QDot(utils::Vector::Constant(static_cast<unsigned int>(scene.nbQdot()), 0.1));
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states;
+    for (size_t i=0; i<scene.nbMuscles(); ++i) {
+        states.push_back(std::make_shared<internal_forces::muscles::StateDynamics>(0, 0.1 + 0.05 * i));
+    }
+    utils::Vector QDDot;
+    scene.muscleDrivenForwardDynamics(Q, QDot, states, QDDot);
+
+    size_t firstMuscle(0);
+    for (size_t s=0; s<scene.nbSubjects(); ++s) {
+        Model& model(scene.subject(s));
+        rigidbody::GeneralizedCoordinates QSubject(Q.segment(scene.firstQIndex(s), model.nbQ()));
+        rigidbody::GeneralizedVelocity QDotSubject(QDot.segment(scene.firstQdotIndex(s), model.nbQdot()));
+        std::vector<std::shared_ptr<internal_forces::muscles::State>> statesSubject(
+            states.begin() + static_cast<std::ptrdiff_t>(firstMuscle),
+            states.begin() + static_cast<std::ptrdiff_t>(firstMuscle + model.nbMuscles()));
+        rigidbody::GeneralizedAcceleration QDDotSubject(
+            model.muscleDrivenForwardDynamics(QSubject, QDotSubject, statesSubject));
+        for (unsigned int i=0; i<model.nbQdot(); ++i) {
+            EXPECT_NEAR(QDDot[static_cast<unsigned int>(scene.firstQdotIndex(s)) + i], QDDotSubject[i],
+                        1e-10);
+        }
+        firstMuscle += model.nbMuscles();
+    }
+}
+#endif
+
+TEST(TrajectoryDynamics, sameAsSequential)
+{
+    Model model(modelPathPyomecaman);
+    unsigned int nbFrames(11);
+    utils::Matrix Q(static_cast<unsigned int>(model.nbQ()), nbFrames);
+    utils::Matrix QDot(static_cast<unsigned int>(model.nbQdot()), nbFrames);
+    utils::Matrix QDDot(static_cast<unsigned int>(model.nbQddot()), nbFrames);
+    for (unsigned int i=0; i<Q.rows(); ++i) {
+        for (unsigned int j=0; j<nbFrames; ++j) {
+            Q(i, j) = 0.1 * i - 0.05 * j;
+            QDot(i, j) = 0.2 * j - 0.1 * i;
+            QDDot(i, j) = 0.3 * i * j - 1;
+        }
+    }
+
+    simulation::TrajectoryDynamics trajectory(modelPathPyomecaman, 3);
+    EXPECT_EQ(trajectory.nbThreads(), 3);
+    utils::Matrix Tau;
+    trajectory.InverseDynamics(Q, QDot, QDDot, Tau);
+    utils::Matrix QDDotForward;
+    trajectory.ForwardDynamics(Q, QDot, Tau, QDDotForward);
+    ASSERT_EQ(static_cast<size_t>(Tau.rows()), model.nbGeneralizedTorque());
+    ASSERT_EQ(Tau.cols(), nbFrames);
+    ASSERT_EQ(QDDotForward.cols(), nbFrames);
+    for (unsigned int j=0; j<nbFrames; ++j) {
+        rigidbody::GeneralizedCoordinates q(utils::Vector(Q.col(j)));
+        rigidbody::GeneralizedVelocity qDot(utils::Vector(QDot.col(j)));
+        rigidbody::GeneralizedAcceleration qDDot(utils::Vector(QDDot.col(j)));
+        rigidbody::GeneralizedTorque tau(model.InverseDynamics(q, qDot, qDDot));
+        for (unsigned int i=0; i<tau.size(); ++i) {
+            EXPECT_DOUBLE_EQ(Tau(i, j), tau[i]);
+            EXPECT_NEAR(QDDotForward(i, j), QDDot(i, j), 1e-8);
+        }
+    }
+
+    utils::Matrix wrongFrames(QDot.block(0, 0, QDot.rows(), nbFrames - 1));
+    EXPECT_THROW(trajectory.InverseDynamics(Q, wrongFrames, QDDot, Tau), std::runtime_error);
+}
+
+TEST(ParameterSweep, sameAsSequential)
+{
+    simulation::ParameterSweep sweep(modelPathPendulum, 2);
+    EXPECT_EQ(sweep.addSegmentParameter(utils::String("Seg1"), simulation::SEGMENT_MASS), 0);
+    EXPECT_EQ(sweep.addSegmentParameter(1, simulation::SEGMENT_COM_Z), 1);
+    EXPECT_EQ(sweep.addSegmentParameter(1, simulation::SEGMENT_INERTIA_XX), 2);
+    EXPECT_EQ(sweep.addSegmentParameter(1, simulation::SEGMENT_INERTIA_YZ), 3);
+    EXPECT_EQ(sweep.nbParameters(), 4);
+    EXPECT_THROW(sweep.addSegmentParameter(2, simulation::SEGMENT_MASS), std::runtime_error);
+    EXPECT_THROW(sweep.addSegmentParameter(0, simulation::MUSCLE_FORCE_ISO_MAX), std::runtime_error);
+
+    utils::Vector nominal(sweep.nominalParameters());
+    std::vector<double> expectedNominal({1, -0.9542, 0.0391, -0.0032});
+    for (unsigned int i=0; i<4; ++i) {
+        EXPECT_NEAR(nominal[i], expectedNominal[i], 1e-10);
+    }
+
+    size_t nbSamples(7);
+    utils::Matrix parameters(4, static_cast<unsigned int>(nbSamples));
+    for (unsigned int i=0; i<nbSamples; ++i) {
+        double scale(0.7 + 0.1 * i);
+        for (unsigned int j=0; j<4; ++j) {
+            parameters(j, i) = scale * nominal[j];
+        }
+    }
+
+    Model reference(modelPathPendulum);
+    utils::Vector Q(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQ()), 0.3));
+    utils::Vector QDot(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQdot()), 0.5));
+    utils::Vector QDDot(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQddot()), -1.2));
+    utils::Vector Tau(utils::Vector::Constant(static_cast<unsigned int>(reference.nbGeneralizedTorque()), 0.8));
+    utils::Matrix residuals;
+    sweep.evaluate(parameters, simulation::SWEEP_INVERSE_DYNAMICS_RESIDUALS, Q, &QDot, &QDDot, &Tau, residuals);
+    EXPECT_EQ(residuals.rows(), reference.nbGeneralizedTorque());
+    EXPECT_EQ(residuals.cols(), nbSamples);
+    utils::Matrix com;
+    sweep.evaluate(parameters, simulation::SWEEP_CENTER_OF_MASS, Q, nullptr, nullptr, nullptr, com);
+    EXPECT_EQ(com.rows(), 3);
+
+    for (unsigned int i=0; i<nbSamples; ++i) {
+        Model model(modelPathPendulum);
+        rigidbody::SegmentCharacteristics seg1(model.segment(0).characteristics().DeepCopy());
+        seg1.setMass(parameters(0, i));
+        model.updateSegmentCharacteristics(0, seg1);
+        rigidbody::SegmentCharacteristics seg2(model.segment(1).characteristics().DeepCopy());
+        utils::Vector3d segCoM(seg2.CoM());
+        segCoM[2] = parameters(1, i);
+        seg2.setCoM(segCoM);
+        utils::Matrix3d inertia(seg2.inertia());
+        inertia(0, 0) = parameters(2, i);
+        inertia(1, 2) = parameters(3, i);
+        inertia(2, 1) = parameters(3, i);
+        seg2.setInertia(inertia);
+        model.updateSegmentCharacteristics(1, seg2);
+
+        rigidbody::GeneralizedCoordinates QSample(Q);
+        rigidbody::GeneralizedTorque TauSample(model.InverseDynamics(
+                QSample, rigidbody::GeneralizedVelocity(QDot), rigidbody::GeneralizedAcceleration(QDDot)));
+        for (unsigned int j=0; j<model.nbGeneralizedTorque(); ++j) {
+            EXPECT_NEAR(residuals(j, i), TauSample[j] - Tau[j], 1e-10);
+        }
+        utils::Vector3d comSample(model.CoM(QSample));
+        for (unsigned int j=0; j<3; ++j) {
+            EXPECT_NEAR(com(j, i), comSample[j], 1e-10);
+        }
+    }
+
+    EXPECT_THROW(sweep.evaluate(parameters.topRows(3), simulation::SWEEP_CENTER_OF_MASS, Q, nullptr,
+                                nullptr, nullptr, com), std::runtime_error);
+    EXPECT_THROW(sweep.evaluate(parameters, simulation::SWEEP_INVERSE_DYNAMICS_RESIDUALS, Q, nullptr,
+                                nullptr, nullptr, residuals), std::runtime_error);
+}
+
+// Copy a model, replacing the mass and the center of mass of some segments
+static void writeModelWithInertia(
+    const std::string& path,
+    const std::map<std::string, std::pair<double, utils::Vector3d>>& inertias,
+    const std::string& savePath)
+{
+    std::ifstream file(path);
+    std::ofstream copy(savePath);
+    std::string line;
+    std::string segment;
+    while (std::getline(file, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "segment") {
+            words >> segment;
+        } else if (keyword == "endsegment") {
+            segment.clear();
+        }
+        auto it(inertias.find(segment));
+        if (it != inertias.end() && keyword == "mass") {
+            copy << "mass " << std::setprecision(17) << it->second.first << std::endl;
+        } else if (it != inertias.end() && keyword == "com") {
+            const utils::Vector3d& com(it->second.second);
+            copy << "com " << std::setprecision(17) << com[0] << " " << com[1] << " " << com[2] << std::endl;
+        } else {
+            copy << line << std::endl;
+        }
+    }
+}
+
+TEST(ParameterSweep, segmentsWithoutDof)
+{
+    // Tronc and Tete have no DoF, so RBDL joins them into the body of Pelvis
+    simulation::ParameterSweep sweep(modelPathPyomecaman, 2);
+    sweep.addSegmentParameter(utils::String("Pelvis"), simulation::SEGMENT_MASS);
+    sweep.addSegmentParameter(utils::String("Tronc"), simulation::SEGMENT_MASS);
+    sweep.addSegmentParameter(utils::String("Tronc"), simulation::SEGMENT_COM_Y);
+    sweep.addSegmentParameter(utils::String("Tete"), simulation::SEGMENT_COM_Z);
+
+    utils::Vector nominal(sweep.nominalParameters());
+    size_t nbSamples(4);
+    utils::Matrix parameters(4, static_cast<unsigned int>(nbSamples));
+    for (unsigned int i=0; i<nbSamples; ++i) {
+        for (unsigned int j=0; j<4; ++j) {
+            parameters(j, i) = (0.6 + 0.3 * i + 0.05 * j) * nominal[j];
+        }
+    }
+
+    Model reference(modelPathPyomecaman);
+    utils::Vector Q(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQ()), 0.3));
+    utils::Vector QDot(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQdot()), 0.5));
+    utils::Vector QDDot(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQddot()), -1.2));
+    utils::Matrix residuals;
+    sweep.evaluate(parameters, simulation::SWEEP_INVERSE_DYNAMICS_RESIDUALS, Q, &QDot, &QDDot, nullptr, residuals);
+    utils::Matrix com;
+    sweep.evaluate(parameters, simulation::SWEEP_CENTER_OF_MASS, Q, nullptr, nullptr, nullptr, com);
+
+    for (unsigned int i=0; i<nbSamples; ++i) {
+        // The reference is reloaded from a bioMod holding the values of the sample
+        std::map<std::string, std::pair<double, utils::Vector3d>> inertias;
+        inertias["Pelvis"] = std::make_pair(
+                                 static_cast<double>(parameters(0, i)), reference.segment(0).characteristics().CoM());
+        utils::Vector3d comTronc(reference.segment(1).characteristics().CoM());
+        comTronc[1] = parameters(2, i);
+        inertias["Tronc"] = std::make_pair(static_cast<double>(parameters(1, i)), comTronc);
+        utils::Vector3d comTete(reference.segment(2).characteristics().CoM());
+        comTete[2] = parameters(3, i);
+        inertias["Tete"] = std::make_pair(
+                               static_cast<double>(reference.segment(2).characteristics().mMass), comTete);
+        writeModelWithInertia(modelPathPyomecaman, inertias, "temporarySweep.bioMod");
+        Model model("temporarySweep.bioMod");
+
+        rigidbody::GeneralizedCoordinates QSample(Q);
+        rigidbody::GeneralizedTorque TauSample(model.InverseDynamics(
+                QSample, rigidbody::GeneralizedVelocity(QDot), rigidbody::GeneralizedAcceleration(QDDot)));
+        for (unsigned int j=0; j<model.nbGeneralizedTorque(); ++j) {
+            EXPECT_NEAR(residuals(j, i), TauSample[j], 1e-10);
+        }
+        utils::Vector3d comSample(model.CoM(QSample));
+        for (unsigned int j=0; j<3; ++j) {
+            EXPECT_NEAR(com(j, i), comSample[j], 1e-10);
+        }
+    }
+}
+
+#ifdef MODULE_MUSCLES
+TEST(ParameterSweep, muscleForces)
+{
+    simulation::ParameterSweep sweep(modelPathMuscles, 2);
+    EXPECT_EQ(sweep.model().muscleGroup(0).nbMuscles(), 3);
+    sweep.addMuscleParameter(0, simulation::MUSCLE_FORCE_ISO_MAX);
+    sweep.addMuscleParameter(1, simulation::MUSCLE_OPTIMAL_LENGTH);
+    sweep.addMuscleParameter(4, simulation::MUSCLE_TENDON_SLACK_LENGTH);
+    sweep.addSegmentParameter(utils::String("r_ulna_radius_hand"), simulation::SEGMENT_MASS);
+    EXPECT_THROW(sweep.addMuscleParameter(0, simulation::SEGMENT_MASS), std::runtime_error);
+    EXPECT_THROW(sweep.addMuscleParameter(6, simulation::MUSCLE_FORCE_ISO_MAX), std::runtime_error);
+
+    utils::Vector nominal(sweep.nominalParameters());
+    size_t nbSamples(5);
+    utils::Matrix parameters(4, static_cast<unsigned int>(nbSamples));
+    for (unsigned int i=0; i<nbSamples; ++i) {
+        for (unsigned int j=0; j<4; ++j) {
+            parameters(j, i) = (0.9 + 0.05 * i) * nominal[j];
+        }
+    }
+
+    Model reference(modelPathMuscles);
+    utils::Vector Q(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQ()), 0.3));
+    utils::Vector QDot(utils::Vector::Constant(static_cast<unsigned int>(reference.nbQdot()), 0.1));
+    std::vector<std::shared_ptr<internal_forces::muscles::State>> states;
+    for (size_t i=0; i<reference.nbMuscles(); ++i) {
+        states.push_back(std::make_shared<internal_forces::muscles::StateDynamics>(0, 0.1 + 0.1 * i));
+    }
+    utils::Matrix forces;
+    sweep.evaluate(parameters, simulation::SWEEP_MUSCLE_FORCES, Q, &QDot, nullptr, nullptr, states, forces);
+    EXPECT_EQ(forces.rows(), reference.nbMuscles());
+
+    for (unsigned int i=0; i<nbSamples; ++i) {
+        Model model(modelPathMuscles);
+        model.muscleGroup(0).muscle(0).setForceIsoMax(parameters(0, i));
+        model.muscleGroup(0).muscle(1).setOptimalLength(parameters(1, i));
+        model.muscleGroup(1).muscle(1).setTendonSlackLength(parameters(2, i));
+        utils::Vector forcesSample(model.muscleForces(
+                                       states, rigidbody::GeneralizedCoordinates(Q), rigidbody::GeneralizedVelocity(QDot)));
+        for (unsigned int j=0; j<model.nbMuscles(); ++j) {
+            EXPECT_NEAR(forces(j, i), forcesSample[j], 1e-10);
+        }
+    }
+
+    EXPECT_THROW(sweep.evaluate(parameters, simulation::SWEEP_MUSCLE_FORCES, Q, &QDot, nullptr,
+                                nullptr, forces), std::runtime_error);
+}
+#endif
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <sstream>
 #include <gtest/gtest.h>
 #include <rbdl/Dynamics.h>
 
@@ -6,6 +7,12 @@
 
 #include "Utils/String.h"
 #include "Utils/Path.h"
+#include "Utils/Profiler.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/Arena.h"
+#include "Utils/MemoryFootprint.h"
+#include "Utils/Benchmark.h"
+#include "Utils/Differentiation.h"
 #include "Utils/Matrix.h"
 #include "Utils/Vector3d.h"
 #include "Utils/RotoTrans.h"
@@ -1416,3 +1423,243 @@ TEST(Vector, normGradient)
 }
 
 #endif 
+
+TEST(Profiler, nestedZones)
+{
+    utils::Profiler::clear();
+    {
+        utils::ProfilerZone outer("outer");
+        for (size_t i=0; i<3; ++i) {
+            utils::ProfilerZone inner("inner");
+            utils::Benchmark::wasteTime(1e-4);
+        }
+    }
+
+    std::vector<utils::ProfilerEvent> events(utils::Profiler::events());
+    EXPECT_EQ(events.size(), 4);
+    long long innerDuration(0);
+    long long outerDuration(0);
+    long long outerChildrenDuration(0);
+    for (const auto& event : events) {
+        if (utils::String(event.m_name) == "inner") {
+            EXPECT_EQ(event.m_depth, 1);
+            innerDuration += event.m_duration;
+        } else {
+            EXPECT_EQ(event.m_depth, 0);
+            outerDuration = event.m_duration;
+            outerChildrenDuration = event.m_childrenDuration;
+        }
+    }
+    EXPECT_EQ(outerChildrenDuration, innerDuration);
+    EXPECT_GE(outerDuration, innerDuration);
+
+    utils::String summary(utils::Profiler::summary());
+    EXPECT_NE(summary.find("outer"), std::string::npos);
+    EXPECT_NE(summary.find("inner"), std::string::npos);
+
+    utils::Profiler::setEnabled(false);
+    {
+        utils::ProfilerZone ignored("ignored");
+    }
+    utils::Profiler::setEnabled(true);
+    EXPECT_EQ(utils::Profiler::events().size(), 4);
+
+    utils::Profiler::clear();
+    EXPECT_EQ(utils::Profiler::events().size(), 0);
+
+    // Past the maximum, the zones are only counted in the summary
+    size_t maxEvents(utils::Profiler::maxEvents());
+    utils::Profiler::setMaxEvents(2);
+    EXPECT_EQ(utils::Profiler::maxEvents(), 2);
+    for (size_t i=0; i<5; ++i) {
+        utils::ProfilerZone capped("capped");
+    }
+    EXPECT_EQ(utils::Profiler::events().size(), 2);
+    summary = utils::Profiler::summary();
+    std::stringstream line(summary.substr(summary.find("capped")));
+    std::string name;
+    long long nbCalls;
+    line >> name >> nbCalls;
+    EXPECT_EQ(nbCalls, 5);
+    utils::Profiler::setMaxEvents(maxEvents);
+    utils::Profiler::clear();
+}
+
+TEST(ThreadPool, parallelFor)
+{
+    utils::ThreadPool pool(4);
+    EXPECT_EQ(pool.nbThreads(), 4);
+
+    // Each task writes its own result, the threads accumulate their own sums
+    std::vector<size_t> results(1000, 0);
+    std::vector<size_t> sums(pool.nbThreads(), 0);
+    for (size_t repeat=0; repeat<3; ++repeat) {
+        pool.parallelFor(results.size(), [&](size_t task, size_t thread) {
+            results[task] = task * task;
+            sums[thread] += task;
+        });
+    }
+    size_t sum(0);
+    for (size_t i=0; i<sums.size(); ++i) {
+        sum += sums[i];
+    }
+    EXPECT_EQ(sum, 3 * 999 * 1000 / 2);
+    for (size_t i=0; i<results.size(); ++i) {
+        EXPECT_EQ(results[i], i * i);
+    }
+
+    // The exceptions of the tasks are sent back to the caller and the pool remains usable
+    EXPECT_THROW(pool.parallelFor(100, [](size_t task, size_t) {
+        if (task == 42) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+    size_t nbTasks(0);
+    utils::ThreadPool sequential(1);
+    sequential.parallelFor(10, [&](size_t, size_t thread) {
+        EXPECT_EQ(thread, 0);
+        ++nbTasks;
+    });
+    EXPECT_EQ(nbTasks, 10);
+}
+
+TEST(ThreadPool, scheduling)
+{
+    utils::ThreadPool pool(4);
+    EXPECT_EQ(pool.chunkSize(), 1);
+    EXPECT_FALSE(pool.deterministic());
+    EXPECT_THROW(pool.setChunkSize(0), std::runtime_error);
+
+    // Uneven tasks are all run once, whatever the chunks and the stealing
+    std::vector<size_t> nbRuns(257, 0);
+    pool.setChunkSize(8);
+    pool.parallelFor(nbRuns.size(), [&](size_t task, size_t) {
+        volatile double sum(0);
+        for (size_t i=0; i<(task % 7) * 1000; ++i) {
+            sum += static_cast<double>(i);
+        }
+        ++nbRuns[task];
+    });
+    for (size_t i=0; i<nbRuns.size(); ++i) {
+        EXPECT_EQ(nbRuns[i], 1);
+    }
+
+    // In deterministic mode each thread runs its own contiguous range
+    pool.setDeterministic(true);
+    std::vector<size_t> threads(nbRuns.size(), 0);
+    pool.parallelFor(threads.size(), [&](size_t task, size_t thread) {
+        threads[task] = thread;
+    });
+    for (size_t i=0; i<threads.size(); ++i) {
+        EXPECT_GE(i, threads[i] * threads.size() / pool.nbThreads());
+        EXPECT_LT(i, (threads[i] + 1) * threads.size() / pool.nbThreads());
+    }
+
+    // The workspaces of the threads are not shared
+    utils::ThreadLocal<std::vector<size_t>> workspaces(pool, [](size_t thread) {
+        return std::make_shared<std::vector<size_t>>(1, thread);
+    });
+    EXPECT_EQ(workspaces.size(), pool.nbThreads());
+    pool.parallelFor(100, [&](size_t task, size_t thread) {
+        workspaces[thread].push_back(task);
+    });
+    size_t nbTasks(0);
+    for (size_t i=0; i<workspaces.size(); ++i) {
+        EXPECT_EQ(workspaces[i][0], i);
+        nbTasks += workspaces[i].size() - 1;
+    }
+    EXPECT_EQ(nbTasks, 100);
+
+    // A task calling the same pool fails instead of deadlocking, another pool can be used
+    EXPECT_THROW(pool.parallelFor(4, [&](size_t, size_t) {
+        pool.parallelFor(2, [](size_t, size_t) {});
+    }), std::runtime_error);
+    utils::ThreadPool other(2);
+    std::vector<size_t> nbNested(4, 0);
+    pool.parallelFor(nbNested.size(), [&](size_t task, size_t) {
+        other.parallelFor(3, [&](size_t, size_t) {});
+        nbNested[task] = 1;
+    });
+    for (size_t n : nbNested) {
+        EXPECT_EQ(n, 1);
+    }
+}
+
+struct ArenaCounter {
+    ArenaCounter(int& count) : m_count(count) {}
+    ~ArenaCounter()
+    {
+        ++m_count;
+    }
+    int& m_count;
+};
+
+TEST(Arena, sharedBlocks)
+{
+    int nbDestroyed(0);
+    std::shared_ptr<double> first;
+    std::shared_ptr<std::string> text;
+    std::shared_ptr<ArenaCounter> counter;
+    {
+        utils::Arena arena(64);
+        first = arena.make<double>(1.5);
+        std::shared_ptr<double> second(arena.make<double>(2.5));
+        text = arena.make<std::string>("a string long enough to be stored on the heap");
+        counter = arena.make<ArenaCounter>(nbDestroyed);
+        EXPECT_EQ(arena.nbBlocks(), 1);
+        EXPECT_EQ(*first, 1.5);
+        EXPECT_EQ(*second, 2.5);
+        EXPECT_EQ(static_cast<void*>(second.get()), static_cast<void*>(first.get() + 1));
+
+        // The objects of a block share their owner
+        utils::MemoryFootprint footprint;
+        EXPECT_TRUE(footprint.add(first));
+        EXPECT_TRUE(footprint.add(second));
+        EXPECT_FALSE(footprint.add(first));
+        EXPECT_EQ(footprint.nbBlocks(), 1);
+
+        // A new block is started when the current one is full
+        std::shared_ptr<std::vector<double>> large(arena.make<std::vector<double>>(3, 0.5));
+        EXPECT_EQ(arena.nbBlocks(), 2);
+        EXPECT_EQ((*large)[2], 0.5);
+        EXPECT_TRUE(footprint.add(large));
+        EXPECT_EQ(footprint.nbBlocks(), 3);
+    }
+
+    // The block lives as long as one of its objects
+    EXPECT_EQ(*first, 1.5);
+    EXPECT_EQ(text->size(), 45);
+    EXPECT_EQ(nbDestroyed, 0);
+    first.reset();
+    text.reset();
+    EXPECT_EQ(nbDestroyed, 0);
+    counter.reset();
+    EXPECT_EQ(nbDestroyed, 1);
+}
+
+#ifndef BIORBD_USE_CASADI_MATH
+TEST(Differentiation, finiteDifferences)
+{
+    // The finite differences of a marker match its analytical Jacobian
+    Model model(modelPathForGeneralTesting);
+    rigidbody::GeneralizedCoordinates Q(model);
+    for (unsigned int i = 0; i < model.nbQ(); ++i) {
+        Q[i] = 0.1 * i;
+    }
+    utils::Matrix markersJacobian(utils::Differentiation::finiteDifferences(
+    [&model](const utils::Vector& x) {
+        rigidbody::GeneralizedCoordinates Q(x);
+        return utils::Vector(model.marker(Q, 0));
+    }, Q));
+    utils::Matrix expectedJacobian(model.markersJacobian(Q)[0]);
+    for (unsigned int i = 0; i < 3; ++i) {
+        for (unsigned int j = 0; j < model.nbQ(); ++j) {
+            EXPECT_NEAR(markersJacobian(i, j), expectedJacobian(i, j), 1e-6);
+        }
+    }
+    EXPECT_THROW(utils::Differentiation::finiteDifferences(
+    [](const utils::Vector& x) {
+        return x;
+    }, Q, 0), std::runtime_error);
+}
+#endif